@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -64,6 +65,10 @@ class CarnotImpl final : public Carnot {
     agent_md_callback_ = func;
   };
 
+  void RegisterQueryYieldCallback(QueryYieldCallbackFunc func) override {
+    query_yield_callback_ = func;
+  }
+
   const udf::Registry* FuncRegistry() const override { return engine_state_->func_registry(); }
 
   EngineState* GetEngineState() override { return engine_state_.get(); }
@@ -90,6 +95,7 @@ class CarnotImpl final : public Carnot {
   void GRPCServerFunc();
 
   AgentMetadataCallbackFunc agent_md_callback_;
+  QueryYieldCallbackFunc query_yield_callback_;
   planner::compiler::Compiler compiler_;
   std::unique_ptr<EngineState> engine_state_;
 
@@ -172,6 +178,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
         return WalkExpression(exec_state, *filter.expression());
       })
       .OnLimit(no_op)
+      .OnSort(no_op)
       .OnMemorySink(no_op)
       .OnMemorySource(no_op)
       .OnUnion(no_op)
@@ -340,11 +347,18 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
     exec_state->set_metadata_state(metadata_state);
   }
 
+  if (query_yield_callback_) {
+    exec_state->set_yield_func([this, query_id](bool waiting_for_data) {
+      query_yield_callback_(query_id, waiting_for_data);
+    });
+  }
+
   PX_RETURN_IF_ERROR(RegisterUDFs(exec_state.get(), &plan));
 
   auto plan_state = engine_state_->CreatePlanState();
   int64_t bytes_processed = 0;
   int64_t rows_processed = 0;
+  int64_t peak_memory_bytes = 0;
   queryresultspb::AgentExecutionStats agent_operator_exec_stats;
   ToProto(agent_id_, agent_operator_exec_stats.mutable_agent_id());
   timer.Start();
@@ -367,6 +381,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
             auto exec_stats = exec_graph.GetStats();
             bytes_processed += exec_stats.bytes_processed;
             rows_processed += exec_stats.rows_processed;
+            peak_memory_bytes = std::max(peak_memory_bytes, exec_stats.peak_memory_bytes);
 
             if (analyze) {
               for (int64_t node_id : pf->dag().TopologicalSort()) {
@@ -375,6 +390,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                     absl::Substitute("$0 (id=$1)", pf->nodes()[node_id]->DebugString(), node_id);
                 exec::ExecNodeStats* stats = exec_node->stats();
                 stats->AddExtraMetric("batches_output", stats->batches_output);
+                stats->AddExtraMetric("peak_memory_bytes", exec_node->PeakMemoryBytes());
                 int64_t total_time_ns = stats->TotalExecTime();
                 int64_t self_time_ns = stats->SelfExecTime();
                 LOG(INFO) << absl::Substitute(
@@ -429,6 +445,8 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
     incoming_agents.push_back(id);
   }
   timer.Stop();
+  VLOG(1) << absl::Substitute("Query $0 allocated at most $1 bytes.", query_id.str(),
+                              peak_memory_bytes);
 
   std::vector<queryresultspb::AgentExecutionStats> input_agent_stats;
   if (HasGRPCServer() && !incoming_agents.empty()) {
@@ -60,6 +60,8 @@ class Carnot : public NotCopyable {
       std::unique_ptr<ClientsConfig> clients_config, std::unique_ptr<ServerConfig> server_config);
 
   using AgentMetadataCallbackFunc = std::function<std::shared_ptr<const md::AgentMetadataState>()>;
+  using QueryYieldCallbackFunc =
+      std::function<void(const sole::uuid& query_id, bool waiting_for_data)>;
 
   virtual ~Carnot() = default;
 
@@ -86,6 +88,13 @@ class Carnot : public NotCopyable {
    */
   virtual void RegisterAgentMetadataCallback(AgentMetadataCallbackFunc func) = 0;
 
+  /**
+   * Registers the callback that queries call from their execution thread between passes over
+   * their sources, and with waiting_for_data set before they wait for their sources to have data.
+   * The callback may block to let other queries run.
+   */
+  virtual void RegisterQueryYieldCallback(QueryYieldCallbackFunc func) = 0;
+
   /**
    * Returns a const pointer to carnot's function registry.
    */
@@ -23,6 +23,9 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <type_traits>
 
 #include <magic_enum.hpp>
 
@@ -64,6 +67,24 @@ void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx)
   PX_UNUSED(status);
 }
 
+template <types::DataType DT, typename TKey>
+void AppendKeyToBuilder(arrow::ArrayBuilder* builder, const TKey& key) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  auto status = static_cast<ArrowBuilder*>(builder)->Append(udf::UnWrap(ValueType(key)));
+  PX_DCHECK_OK(status);
+  PX_UNUSED(status);
+}
+
+void AppendInt64KeyToBuilder(types::DataType dt, arrow::ArrayBuilder* builder, int64_t key) {
+  if (dt == types::TIME64NS) {
+    AppendKeyToBuilder<types::TIME64NS>(builder, key);
+  } else {
+    DCHECK_EQ(types::INT64, dt);
+    AppendKeyToBuilder<types::INT64>(builder, key);
+  }
+}
+
 template <types::DataType DT>
 void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
                             const table_store::schema::RowBatch& rb, size_t col_idx,
@@ -110,7 +131,27 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     return error::InvalidArgument("Output size mismatch in aggregate");
   }
 
+  if (!plan_node_->partial_agg()) {
+    // The input is the output of the partial aggregates: the groups, followed by one serialized
+    // state per value.
+    if (input_descriptor_->size() != output_size) {
+      return error::InvalidArgument(
+          "Aggregate merging partial aggregates expects $0 input columns, got $1", output_size,
+          input_descriptor_->size());
+    }
+    for (size_t i = plan_node_->groups().size(); i < output_size; ++i) {
+      if (input_descriptor_->type(i) != types::STRING) {
+        return error::InvalidArgument(
+            "Aggregate merging partial aggregates expects serialized states in column $0, got $1",
+            i, types::ToString(input_descriptor_->type(i)));
+      }
+    }
+  }
+
   if (HasNoGroups()) {
+    if (HasStreamingWindow()) {
+      return error::InvalidArgument("Streaming window aggregates need a window group");
+    }
     return Status::OK();
   }
 
@@ -126,6 +167,7 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     DCHECK(group.idx < input_descriptor_->size());
     group_data_types_.emplace_back(input_descriptor_->type(group.idx));
   }
+  key_layout_ = SelectKeyLayout(group_data_types_);
 
   auto values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
@@ -134,9 +176,44 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
+  if (HasStreamingWindow()) {
+    PX_RETURN_IF_ERROR(InitStreamingWindow());
+  }
   return CreateColumnMapping();
 }
 
+Status AggNode::InitStreamingWindow() {
+  const auto& window = plan_node_->streaming_window();
+  if (window.group_index() < 0 ||
+      window.group_index() >= static_cast<int64_t>(group_data_types_.size())) {
+    return error::InvalidArgument("Streaming window group $0 is out of range", window.group_index());
+  }
+  auto window_type = group_data_types_[window.group_index()];
+  if (window_type != types::INT64 && window_type != types::TIME64NS) {
+    return error::InvalidArgument("Streaming window group must be INT64 or TIME64NS, got $0",
+                                  types::ToString(window_type));
+  }
+  if (window.size_ns() <= 0) {
+    return error::InvalidArgument("Streaming window size must be positive, got $0",
+                                  window.size_ns());
+  }
+  if (window.slide_ns() < 0 || window.slide_ns() > window.size_ns() ||
+      (window.slide_ns() > 0 && window.size_ns() % window.slide_ns() != 0)) {
+    return error::InvalidArgument(
+        "Streaming window size $0 must be a multiple of its slide $1, which can't be larger",
+        window.size_ns(), window.slide_ns());
+  }
+  if (window.allowed_lateness_ns() < 0) {
+    return error::InvalidArgument("Streaming window allowed lateness can't be negative, got $0",
+                                  window.allowed_lateness_ns());
+  }
+  if (key_layout_ == KeyLayout::kUInt128) {
+    return error::InvalidArgument("Streaming window aggregates can't group by a UINT128 only");
+  }
+  pane_ns_ = window.slide_ns() > 0 ? window.slide_ns() : window.size_ns();
+  return Status::OK();
+}
+
 Status AggNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
   return Status::OK();
@@ -153,17 +230,32 @@ Status AggNode::OpenImpl(ExecState* exec_state) {
 }
 
 Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (EmitsPartialStates() && exec_state->exec_metrics() != nullptr) {
+    exec_state->exec_metrics()->partial_agg_input_bytes_counter.Increment(rb.NumBytes());
+  }
   if (HasNoGroups()) {
     return AggregateGroupByNone(exec_state, rb);
   }
   return AggregateGroupByClause(exec_state, rb);
 }
 
+Status AggNode::SendOutputRowBatch(ExecState* exec_state, const RowBatch& output_rb) {
+  if (EmitsPartialStates() && exec_state->exec_metrics() != nullptr) {
+    exec_state->exec_metrics()->partial_agg_output_bytes_counter.Increment(output_rb.NumBytes());
+  }
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
 Status AggNode::CloseImpl(ExecState*) {
   udas_no_groups_.clear();
   group_args_chunk_.clear();
   group_args_pool_.Clear();
-  udas_pool_.Clear();
+  ClearGroups(&groups_);
+  if (HasStreamingWindow()) {
+    panes_.clear();
+    ClearGroups(&late_groups_);
+    stats()->AddExtraInfo("late_rows", absl::StrCat(num_late_rows_));
+  }
 
   return Status::OK();
 }
@@ -177,10 +269,30 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     udas_no_groups_.clear();
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
-  agg_hash_map_.clear();
+  ClearGroups(&groups_);
   return Status::OK();
 }
 
+void AggNode::ClearGroups(AggGroupState* state) {
+  state->row_tuple_map.clear();
+  state->int64_map.clear();
+  state->uint128_map.clear();
+  // Frees the values and keys of the groups, so the memory doesn't grow from window to window.
+  state->pool.Clear();
+}
+
+size_t AggNode::NumGroups(const AggGroupState& state) const {
+  switch (key_layout_) {
+    case KeyLayout::kInt64:
+      return state.int64_map.size();
+    case KeyLayout::kUInt128:
+      return state.uint128_map.size();
+    case KeyLayout::kRowTuple:
+      return state.row_tuple_map.size();
+  }
+  return 0;
+}
+
 Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb) {
   auto values = plan_node_->values();
   if (plan_node_->partial_agg()) {
@@ -213,7 +325,7 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
     }
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    PX_RETURN_IF_ERROR(SendOutputRowBatch(exec_state, output_rb));
     PX_RETURN_IF_ERROR(ClearAggState(exec_state));
   }
   return Status::OK();
@@ -229,6 +341,10 @@ Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
       group_args_chunk_.emplace_back(CreateGroupArgsRowTuple());
     }
   }
+  if (key_layout_ != KeyLayout::kRowTuple) {
+    // Fixed width keys are read straight from the group column when hashing.
+    return Status::OK();
+  }
 
   // Scan through all the group args in column order and extract the entire column.
   for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
@@ -246,26 +362,49 @@ Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
 }
 
 Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PX_UNUSED(exec_state);
+  std::vector<const arrow::Array*> group_cols;
+  group_cols.reserve(plan_node_->groups().size());
+  for (const auto& group : plan_node_->groups()) {
+    group_cols.push_back(rb.ColumnAt(group.idx).get());
+  }
+  // Hash all of the group columns up front, so the lookups below only have to compare keys.
+  HashKeyColumns(group_cols, group_data_types_, rb.num_rows(), &group_hashes_);
+  if (HasStreamingWindow()) {
+    PX_RETURN_IF_ERROR(AssignRowsToPanes(
+        group_cols[plan_node_->streaming_window().group_index()], rb.num_rows()));
+  }
+
   // Loop through all the row and basically store the values into column chunk based on which
   // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& ga = group_args_chunk_[row_idx];
-    AggHashValue* val = nullptr;
-    // Check to see if in hash
-    // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
-    // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
-      // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
-    } else {
-      val = it->second;
+  auto find_or_insert_groups = [&](auto hash_map, auto get_key) {
+    for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      auto& ga = group_args_chunk_[row_idx];
+      AggGroupState* state = HasStreamingWindow() ? row_groups_[row_idx] : &groups_;
+      bool inserted;
+      auto* entry =
+          (state->*hash_map).FindOrInsert(group_hashes_[row_idx], get_key(row_idx), &inserted);
+      if (inserted) {
+        entry->value = CreateAggHashValue(exec_state, &state->pool);
+        if constexpr (std::is_same_v<decltype(entry->key), RowTuple*>) {
+          entry->key = CopyGroupKey(*ga.rt, &state->pool);
+        }
+      }
+      ga.av = entry->value;
     }
-    ga.av = val;
+  };
+  switch (key_layout_) {
+    case KeyLayout::kInt64:
+      find_or_insert_groups(&AggGroupState::int64_map,
+                            [&](int64_t row_idx) { return GetInt64Key(group_cols[0], row_idx); });
+      break;
+    case KeyLayout::kUInt128:
+      find_or_insert_groups(&AggGroupState::uint128_map,
+                            [&](int64_t row_idx) { return GetUInt128Key(group_cols[0], row_idx); });
+      break;
+    case KeyLayout::kRowTuple:
+      find_or_insert_groups(&AggGroupState::row_tuple_map,
+                            [&](int64_t row_idx) { return group_args_chunk_[row_idx].rt; });
+      break;
   }
 
   // Now extract the values in the agg hash value.
@@ -306,21 +445,19 @@ Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_reco
 }
 
 Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
+  // Reset the group args. The hash maps hold copies of the keys, so the row tuples can be reused
+  // for the next batch. We also reset the agg hash value to nullptr.
   for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
     group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
+    if (group_args_chunk_[i].rt != nullptr) {
       group_args_chunk_[i].rt->Reset();
     }
   }
   return Status::OK();
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
+Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, const AggGroupState& state,
+                                            RowBatch* output_rb) {
   PX_UNUSED(exec_state);
   DCHECK(output_rb != nullptr);
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
@@ -333,35 +470,31 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
   }
 
   // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
-
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
-
-#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
-#undef TYPE_CASE
-    }
-    if (plan_node_->partial_agg()) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
-    }
-
-    if (plan_node_->finalize_results()) {
-      // Actually Finalize the UDA based on the column wrapper chunks.
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                       value_builders[i].get()));
+  switch (key_layout_) {
+    case KeyLayout::kInt64:
+      for (const auto& entry : state.int64_map) {
+        AppendInt64KeyToBuilder(group_data_types_[0], group_builders[0].get(), entry.key);
+        PX_RETURN_IF_ERROR(AppendAggValues(exec_state, entry.value, &value_builders));
       }
-    } else {
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                        value_builders[i].get()));
+      break;
+    case KeyLayout::kUInt128:
+      for (const auto& entry : state.uint128_map) {
+        AppendKeyToBuilder<types::UINT128>(group_builders[0].get(), entry.key);
+        PX_RETURN_IF_ERROR(AppendAggValues(exec_state, entry.value, &value_builders));
       }
-    }
+      break;
+    case KeyLayout::kRowTuple:
+      for (const auto& entry : state.row_tuple_map) {
+        for (size_t i = 0; i < group_data_types_.size(); ++i) {
+          DCHECK(i < group_builders.size());
+
+#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), entry.key, i);
+          PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+        }
+        PX_RETURN_IF_ERROR(AppendAggValues(exec_state, entry.value, &value_builders));
+      }
+      break;
   }
 
   for (const auto& group_builder : group_builders) {
@@ -379,6 +512,30 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
   return Status::OK();
 }
 
+Status AggNode::AppendAggValues(
+    ExecState* exec_state, AggHashValue* val,
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>>* value_builders) {
+  if (plan_node_->partial_agg()) {
+    PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
+  }
+
+  if (plan_node_->finalize_results()) {
+    // Actually Finalize the UDA based on the column wrapper chunks.
+    for (size_t i = 0; i < val->udas.size(); ++i) {
+      const auto& uda_info = val->udas[i];
+      PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
+                                                     (*value_builders)[i].get()));
+    }
+  } else {
+    for (size_t i = 0; i < val->udas.size(); ++i) {
+      const auto& uda_info = val->udas[i];
+      PX_RETURN_IF_ERROR(uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(),
+                                                      (*value_builders)[i].get()));
+    }
+  }
+  return Status::OK();
+}
+
 Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
   // Extracts the row tuples (column wise).
   // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
@@ -394,12 +551,17 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
     PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
   }
   PX_RETURN_IF_ERROR(ResetGroupArgs());
+  if (HasStreamingWindow()) {
+    // The rows of windows that were already emitted have nowhere to go.
+    ClearGroups(&late_groups_);
+    return EmitCompleteWindows(exec_state, rb);
+  }
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+    RowBatch output_rb(*output_descriptor_, NumGroups(groups_));
+    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, groups_, &output_rb));
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    PX_RETURN_IF_ERROR(SendOutputRowBatch(exec_state, output_rb));
     PX_RETURN_IF_ERROR(ClearAggState(exec_state));
   }
   return Status::OK();
@@ -549,8 +711,158 @@ Status AggNode::CreateColumnMapping() {
   return Status::OK();
 }
 
-AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
+Status AggNode::AssignRowsToPanes(const arrow::Array* window_col, int64_t num_rows) {
+  row_groups_.resize(num_rows);
+  // Batches are mostly ordered by time, so consecutive rows tend to share a pane.
+  int64_t last_pane_start = 0;
+  AggGroupState* last_pane = nullptr;
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    int64_t pane_start = GetInt64Key(window_col, row_idx);
+    if (pane_start % pane_ns_ != 0) {
+      return error::InvalidArgument(
+          "Streaming window aggregate got $0, which is not aligned to its $1ns panes", pane_start,
+          pane_ns_);
+    }
+    if (pane_start < next_window_start_) {
+      ++num_late_rows_;
+      row_groups_[row_idx] = &late_groups_;
+      continue;
+    }
+    if (last_pane == nullptr || pane_start != last_pane_start) {
+      auto& pane = panes_[pane_start];
+      if (pane == nullptr) {
+        pane = std::make_unique<AggGroupState>();
+      }
+      last_pane = pane.get();
+      last_pane_start = pane_start;
+      max_pane_start_ = std::max(max_pane_start_, pane_start);
+    }
+    row_groups_[row_idx] = last_pane;
+  }
+  return Status::OK();
+}
+
+Status AggNode::EmitCompleteWindows(ExecState* exec_state, const RowBatch& rb) {
+  const auto& window = plan_node_->streaming_window();
+  // A window is complete once the watermark, which trails the latest pane by the allowed
+  // lateness, passes its end. Everything is complete at eos.
+  while (!panes_.empty()) {
+    int64_t watermark = max_pane_start_ - window.allowed_lateness_ns();
+    // The first window that covers the oldest pane, unless it was emitted already.
+    int64_t window_start =
+        std::max(next_window_start_, panes_.begin()->first - window.size_ns() + pane_ns_);
+    if (!rb.eos() && window_start + window.size_ns() > watermark) {
+      break;
+    }
+    next_window_start_ = window_start;
+    PX_RETURN_IF_ERROR(EmitWindow(exec_state, window_start));
+    next_window_start_ += pane_ns_;
+    // The panes before the next window aren't part of any window that is left.
+    while (!panes_.empty() && panes_.begin()->first < next_window_start_) {
+      panes_.erase(panes_.begin());
+    }
+  }
+  if (rb.eos()) {
+    PX_ASSIGN_OR_RETURN(auto output_rb,
+                        RowBatch::WithZeroRows(*output_descriptor_, /*eow*/ true, /*eos*/ true));
+    PX_RETURN_IF_ERROR(SendOutputRowBatch(exec_state, *output_rb));
+  }
+  return Status::OK();
+}
+
+Status AggNode::EmitWindow(ExecState* exec_state, int64_t window_start) {
+  const auto& window = plan_node_->streaming_window();
+  const AggGroupState* window_groups = nullptr;
+  AggGroupState merged_groups;
+  if (window.slide_ns() == 0 || window.slide_ns() == window.size_ns()) {
+    // Tumbling windows are made of a single pane, which already has the right keys.
+    auto it = panes_.find(window_start);
+    if (it == panes_.end()) {
+      return Status::OK();
+    }
+    window_groups = it->second.get();
+  } else {
+    for (auto it = panes_.lower_bound(window_start);
+         it != panes_.end() && it->first < window_start + window.size_ns(); ++it) {
+      PX_RETURN_IF_ERROR(MergePaneIntoWindow(exec_state, window_start, *it->second,
+                                             &merged_groups));
+    }
+    window_groups = &merged_groups;
+  }
+  if (NumGroups(*window_groups) == 0) {
+    return Status::OK();
+  }
+  RowBatch output_rb(*output_descriptor_, NumGroups(*window_groups));
+  PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, *window_groups, &output_rb));
+  output_rb.set_eow(true);
+  output_rb.set_eos(false);
+  return SendOutputRowBatch(exec_state, output_rb);
+}
+
+Status AggNode::MergePaneIntoWindow(ExecState* exec_state, int64_t window_start,
+                                    const AggGroupState& pane, AggGroupState* window) {
+  switch (key_layout_) {
+    case KeyLayout::kInt64:
+      // The window column is the only group, so every group of the pane goes to the same key.
+      for (const auto& entry : pane.int64_map) {
+        bool inserted;
+        auto* window_entry =
+            window->int64_map.FindOrInsert(HashInt64Key(window_start), window_start, &inserted);
+        if (inserted) {
+          window_entry->value = CreateAggHashValue(exec_state, &window->pool);
+        }
+        PX_RETURN_IF_ERROR(MergeAggHashValue(exec_state, entry.value, window_entry->value));
+      }
+      return Status::OK();
+    case KeyLayout::kRowTuple: {
+      int64_t window_col_idx = plan_node_->streaming_window().group_index();
+      for (const auto& entry : pane.row_tuple_map) {
+        RowTuple* key = CopyGroupKey(*entry.key, &window->pool);
+        if (group_data_types_[window_col_idx] == types::TIME64NS) {
+          key->SetValue(window_col_idx, types::Time64NSValue(window_start));
+        } else {
+          key->SetValue(window_col_idx, types::Int64Value(window_start));
+        }
+        bool inserted;
+        auto* window_entry =
+            window->row_tuple_map.FindOrInsert(HashRowTupleKey(*key), key, &inserted);
+        if (inserted) {
+          window_entry->value = CreateAggHashValue(exec_state, &window->pool);
+        }
+        PX_RETURN_IF_ERROR(MergeAggHashValue(exec_state, entry.value, window_entry->value));
+      }
+      return Status::OK();
+    }
+    case KeyLayout::kUInt128:
+      break;
+  }
+  return error::Internal("Streaming window aggregates don't support key layout $0",
+                         magic_enum::enum_name(key_layout_));
+}
+
+Status AggNode::MergeAggHashValue(ExecState* exec_state, AggHashValue* pane_value,
+                                  AggHashValue* window_value) {
+  if (plan_node_->partial_agg()) {
+    // Aggregate the rows that are still buffered in the pane first.
+    PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, pane_value));
+  }
+  for (size_t i = 0; i < window_value->udas.size(); ++i) {
+    const auto& uda_info = window_value->udas[i];
+    PX_RETURN_IF_ERROR(uda_info.def->Merge(uda_info.uda.get(), pane_value->udas[i].uda.get(),
+                                           function_ctx_.get()));
+  }
+  return Status::OK();
+}
+
+RowTuple* AggNode::CopyGroupKey(const RowTuple& key, ObjectPool* pool) {
+  auto* copy = pool->Add(new RowTuple(&group_data_types_));
+  copy->fixed_values = key.fixed_values;
+  copy->variable_values = key.variable_values;
+  return copy;
+}
+
+AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state, ObjectPool* pool) {
+  auto* val = pool->Add(new AggHashValue);
   PX_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
   for (const auto& dt : stored_cols_data_types_) {
     val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
@@ -610,8 +922,15 @@ Status AggNode::DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatc
     DCHECK_EQ(types::STRING, rb.desc().type(col_idx));
     auto serialized =
         types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(col_idx).get(), row_idx);
-    PX_RETURN_IF_ERROR(deserial_uda_info.def->Deserialize(deserial_uda_info.uda.get(),
-                                                          function_ctx_.get(), serialized));
+    // Not every UDA resets its state in Deserialize (some accumulate into it), so each state is
+    // deserialized into a fresh instance rather than the one used for the previous row.
+    deserial_uda_info.uda = deserial_uda_info.def->Make();
+    auto s = deserial_uda_info.def->Deserialize(deserial_uda_info.uda.get(), function_ctx_.get(),
+                                                serialized);
+    if (!s.ok()) {
+      return error::InvalidArgument("Failed to deserialize partial state of $0 in column $1: $2",
+                                    deserial_uda_info.def->name(), col_idx, s.msg());
+    }
     PX_RETURN_IF_ERROR(merge_uda_info.def->Merge(merge_uda_info.uda.get(),
                                                  deserial_uda_info.uda.get(), function_ctx_.get()));
   }
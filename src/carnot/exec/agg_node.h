@@ -18,6 +18,7 @@
 
 #pragma once
 #include <cstddef>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/key_hash_table.h"
 #include "src/carnot/exec/row_tuple.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
@@ -60,6 +62,16 @@ struct AggHashValue {
   std::vector<types::SharedColumnWrapper> agg_cols;
 };
 
+// The groups of an aggregate, and the memory that holds them. Only the hash map for the key layout
+// of the aggregate is used.
+struct AggGroupState {
+  RowTupleKeyHashTable<AggHashValue*> row_tuple_map;
+  Int64KeyHashTable<AggHashValue*> int64_map;
+  UInt128KeyHashTable<AggHashValue*> uint128_map;
+  // Owns the values of the groups and the RowTuples of their keys.
+  ObjectPool pool{"agg_group_pool"};
+};
+
 struct GroupArgs {
   explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
   RowTuple* rt;
@@ -67,8 +79,6 @@ struct GroupArgs {
 };
 
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
-
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
@@ -86,14 +96,59 @@ class AggNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  AggHashMap agg_hash_map_;
+  // Only the hash map for key_layout_ is used. The fixed width layouts store the group value
+  // inline, so they don't need RowTuples at all.
+  KeyLayout key_layout_ = KeyLayout::kRowTuple;
+  AggGroupState groups_;
+  // The hashes of the group keys of the current row batch.
+  std::vector<uint64_t> group_hashes_;
+  size_t NumGroups(const AggGroupState& state) const;
+  void ClearGroups(AggGroupState* state);
+
+  // Variables specific to streaming window aggregates. Instead of groups_, the groups are kept per
+  // pane, and every window is merged from the panes it covers once the watermark passes its end.
+  bool HasStreamingWindow() const { return plan_node_->has_streaming_window(); }
+  Status InitStreamingWindow();
+  // Finds the pane of every row of the batch, creating the panes that don't exist yet.
+  Status AssignRowsToPanes(const arrow::Array* window_col, int64_t num_rows);
+  // Emits and evicts the windows that the watermark has passed, or all of them at eos.
+  Status EmitCompleteWindows(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status EmitWindow(ExecState* exec_state, int64_t window_start);
+  Status MergePaneIntoWindow(ExecState* exec_state, int64_t window_start,
+                             const AggGroupState& pane, AggGroupState* window);
+  Status MergeAggHashValue(ExecState* exec_state, AggHashValue* pane_value,
+                           AggHashValue* window_value);
+
+  // The size of the panes, which is the slide of the windows (or their size if they don't slide).
+  int64_t pane_ns_ = 0;
+  // The groups of each pane that is part of a window which hasn't been emitted yet, by pane start.
+  std::map<int64_t, std::unique_ptr<AggGroupState>> panes_;
+  // Collects the rows of the current batch whose windows were all emitted already. They are
+  // dropped after the batch.
+  AggGroupState late_groups_;
+  // The groups that each row of the current batch is aggregated into.
+  std::vector<AggGroupState*> row_groups_;
+  // The start of the latest pane seen, which is what the watermark trails.
+  int64_t max_pane_start_ = std::numeric_limits<int64_t>::min();
+  // The start of the first window that hasn't been emitted yet.
+  int64_t next_window_start_ = std::numeric_limits<int64_t>::min();
+  int64_t num_late_rows_ = 0;
+  // END: Variables specific to streaming window aggregates.
+
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  // Returns true if this is the partial side of a split aggregate, which emits serialized UDA
+  // states instead of finalized values.
+  bool EmitsPartialStates() const {
+    return plan_node_->partial_agg() && !plan_node_->finalize_results();
+  }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
   // reached. In the blocking aggregate case, this happens at eos only.
   bool ReadyToEmitBatches(const table_store::schema::RowBatch& rb) const;
   // When we see a new window, we need to be able to clear the aggregate state.
   Status ClearAggState(ExecState* exec_state);
+  // Sends an output batch to the children, recording its size if it holds partial states.
+  Status SendOutputRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& output_rb);
 
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
@@ -134,7 +189,6 @@ class AggNode : public ProcessingNode {
   std::vector<types::DataType> stored_cols_data_types_;
 
   ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
@@ -149,14 +203,23 @@ class AggNode : public ProcessingNode {
   Status CreateColumnMapping();
 
   Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
+  // Appends the aggregate values of a single group to value_builders.
+  Status AppendAggValues(ExecState* exec_state, AggHashValue* val,
+                         std::vector<std::unique_ptr<arrow::ArrayBuilder>>* value_builders);
   Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
   Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
+  Status ConvertAggHashMapToRowBatch(ExecState* exec_state, const AggGroupState& state,
                                      table_store::schema::RowBatch* output_rb);
 
-  AggHashValue* CreateAggHashValue(ExecState* exec_state);
+  AggHashValue* CreateAggHashValue(ExecState* exec_state, ObjectPool* pool);
+  // The RowTuples of the current batch are reused for the next one, so the group states keep
+  // their own copies of the keys.
+  RowTuple* CopyGroupKey(const RowTuple& key, ObjectPool* pool);
   RowTuple* CreateGroupArgsRowTuple() {
+    if (key_layout_ != KeyLayout::kRowTuple) {
+      return nullptr;
+    }
     return group_args_pool_.Add(new RowTuple(&group_data_types_));
   }
 
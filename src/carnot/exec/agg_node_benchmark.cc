@@ -0,0 +1,210 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/memory_pool.h>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <google/protobuf/text_format.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/plan/operators.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+#include "src/datagen/datagen.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+using px::carnot::exec::AggNode;
+using px::carnot::exec::ExecState;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::udf::FunctionContext;
+using px::carnot::udf::Registry;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using px::types::Int64Value;
+using px::types::StringValue;
+using px::types::ToArrow;
+
+constexpr int64_t kBatchSize = 1024;
+
+class SumUDA : public px::carnot::udf::UDA {
+ public:
+  void Update(FunctionContext*, Int64Value val) { sum_ = sum_.val + val.val; }
+  void Merge(FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  Int64Value Finalize(FunctionContext*) { return sum_; }
+  StringValue Serialize(FunctionContext*) { return absl::StrCat(sum_.val); }
+  px::Status Deserialize(FunctionContext*, const StringValue& serialized) {
+    if (!absl::SimpleAtoi(serialized, &sum_.val)) {
+      return px::error::InvalidArgument("invalid serialized sum");
+    }
+    return px::Status::OK();
+  }
+
+ protected:
+  Int64Value sum_ = 0;
+};
+
+// Groups by column 0 and sums column 1. For the merge, column 1 holds the serialized sums instead.
+constexpr char kAggPbtxt[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "sum"
+    args {
+      column {
+        node: 0
+        index: 1
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: $0
+  finalize_results: $1
+})";
+
+std::unique_ptr<px::carnot::plan::Operator> MakeAggPlan(bool partial_agg, bool finalize_results) {
+  px::carnot::planpb::Operator op_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(kAggPbtxt, partial_agg, finalize_results), &op_pb));
+  return px::carnot::plan::AggregateOperator::FromProto(op_pb, 1);
+}
+
+std::vector<std::unique_ptr<RowBatch>> MakeInputBatches(const RowDescriptor& rd, int64_t num_rows,
+                                                        int64_t num_groups) {
+  std::vector<std::unique_ptr<RowBatch>> batches;
+  for (int64_t offset = 0; offset < num_rows; offset += kBatchSize) {
+    int64_t size = std::min(kBatchSize, num_rows - offset);
+    auto groups = px::datagen::CreateLargeData<Int64Value>(size, 0, num_groups);
+    auto values = px::datagen::CreateLargeData<Int64Value>(size, 0, 1000);
+    auto rb = std::make_unique<RowBatch>(rd, size);
+    PX_CHECK_OK(rb->AddColumn(ToArrow(groups, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb->AddColumn(ToArrow(values, arrow::default_memory_pool())));
+    rb->set_eow(offset + size >= num_rows);
+    rb->set_eos(offset + size >= num_rows);
+    batches.push_back(std::move(rb));
+  }
+  return batches;
+}
+
+std::unique_ptr<ExecState> MakeExecState(Registry* registry) {
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
+                                                MockMetricsStubGenerator, MockTraceStubGenerator,
+                                                sole::uuid4(), nullptr);
+  PX_CHECK_OK(exec_state->AddUDA(0, "sum", std::vector<DataType>({DataType::INT64})));
+  return exec_state;
+}
+
+// Aggregates all of the raw rows in a single node. This is what the Kelvin does when the rows are
+// shipped to it without partial aggregation, so the bytes shipped are the bytes of the input.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_FullAgg(benchmark::State& state) {
+  int64_t num_rows = state.range(0);
+  int64_t num_groups = state.range(1);
+  auto registry = std::make_unique<Registry>("test_registry");
+  PX_CHECK_OK(registry->Register<SumUDA>("sum"));
+  auto exec_state = MakeExecState(registry.get());
+
+  RowDescriptor input_rd({DataType::INT64, DataType::INT64});
+  RowDescriptor output_rd({DataType::INT64, DataType::INT64});
+  auto batches = MakeInputBatches(input_rd, num_rows, num_groups);
+  auto plan = MakeAggPlan(/* partial_agg */ true, /* finalize_results */ true);
+
+  int64_t bytes_shipped = 0;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    AggNode node;
+    PX_CHECK_OK(node.Init(*plan, output_rd, {input_rd}, /* collect_exec_stats */ true));
+    PX_CHECK_OK(node.Prepare(exec_state.get()));
+    PX_CHECK_OK(node.Open(exec_state.get()));
+    for (const auto& rb : batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), *rb, 0));
+    }
+    PX_CHECK_OK(node.Close(exec_state.get()));
+    bytes_shipped = node.stats()->bytes_input;
+  }
+  state.counters["bytes_shipped"] = bytes_shipped;
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+
+// Aggregates the rows into partial states, which are then deserialized and merged by a second
+// node, i.e. the PEM and Kelvin sides of a split aggregate. The bytes shipped are the bytes of the
+// partial states.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PartialAndMergeAgg(benchmark::State& state) {
+  int64_t num_rows = state.range(0);
+  int64_t num_groups = state.range(1);
+  auto registry = std::make_unique<Registry>("test_registry");
+  PX_CHECK_OK(registry->Register<SumUDA>("sum"));
+  auto exec_state = MakeExecState(registry.get());
+
+  RowDescriptor input_rd({DataType::INT64, DataType::INT64});
+  RowDescriptor partial_rd({DataType::INT64, DataType::STRING});
+  RowDescriptor output_rd({DataType::INT64, DataType::INT64});
+  auto batches = MakeInputBatches(input_rd, num_rows, num_groups);
+  auto partial_plan = MakeAggPlan(/* partial_agg */ true, /* finalize_results */ false);
+  auto merge_plan = MakeAggPlan(/* partial_agg */ false, /* finalize_results */ true);
+
+  int64_t bytes_shipped = 0;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    AggNode partial_node;
+    AggNode merge_node;
+    partial_node.AddChild(&merge_node, 0);
+    PX_CHECK_OK(
+        partial_node.Init(*partial_plan, partial_rd, {input_rd}, /* collect_exec_stats */ true));
+    PX_CHECK_OK(merge_node.Init(*merge_plan, output_rd, {partial_rd}));
+    PX_CHECK_OK(partial_node.Prepare(exec_state.get()));
+    PX_CHECK_OK(merge_node.Prepare(exec_state.get()));
+    PX_CHECK_OK(partial_node.Open(exec_state.get()));
+    PX_CHECK_OK(merge_node.Open(exec_state.get()));
+    for (const auto& rb : batches) {
+      PX_CHECK_OK(partial_node.ConsumeNext(exec_state.get(), *rb, 0));
+    }
+    PX_CHECK_OK(partial_node.Close(exec_state.get()));
+    PX_CHECK_OK(merge_node.Close(exec_state.get()));
+    bytes_shipped = partial_node.stats()->bytes_output;
+  }
+  state.counters["bytes_shipped"] = bytes_shipped;
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+
+BENCHMARK(BM_FullAgg)->ArgsProduct({{1 << 14, 1 << 18}, {16, 1024}});
+BENCHMARK(BM_PartialAndMergeAgg)->ArgsProduct({{1 << 14, 1 << 18}, {16, 1024}});
@@ -137,6 +137,36 @@ agg_op {
   finalize_results: true
 })";
 
+// Groups by a UINT128 column (index 0) and sums the INT64 column (index 1).
+constexpr char kBlockingSingleUInt128GroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+})";
+
 constexpr char kBlockingMultipleGroupAgg[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -472,6 +502,81 @@ agg_op {
   finalize_results: true
 })";
 
+// Sums column 1 over 10ns tumbling windows of the pane starts in column 0.
+constexpr char kStreamingTumblingAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "window"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+  streaming_window {
+    group_index: 0
+    size_ns: 10
+  }
+})";
+
+// Sums column 2 by the key in column 1 over 20ns windows that slide by 10ns, where column 0 holds
+// the pane starts.
+constexpr char kStreamingSlidingAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  groups {
+     node: 0
+     index: 1
+  }
+  group_names: "window"
+  group_names: "key"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+  streaming_window {
+    group_index: 0
+    size_ns: 20
+    slide_ns: 10
+  }
+})";
+
 std::unique_ptr<ExecState> MakeTestExecState(udf::Registry* registry) {
   auto table_store = std::make_shared<table_store::TableStore>();
   return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
@@ -585,6 +690,37 @@ TEST_F(AggNodeTest, single_group_blocking) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_uint128_group_blocking) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleUInt128GroupAgg);
+  RowDescriptor input_rd({types::DataType::UINT128, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::UINT128, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  types::UInt128Value upid1(1, 2);
+  types::UInt128Value upid2(2, 1);
+  types::UInt128Value upid3(1, 3);
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::UInt128Value>({upid1, upid1, upid2, upid2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, true, true)
+                       .AddColumn<types::UInt128Value>({upid3, upid1})
+                       .AddColumn<types::Int64Value>({1, 5})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::UInt128Value>({upid1, upid2, upid3})
+                          .AddColumn<types::Int64Value>({10, 4, 1})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, multiple_groups_blocking) {
   auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
@@ -919,6 +1055,21 @@ TEST_F(AggNodeTest, single_group_partial_finalize) {
       .Close();
 }
 
+TEST_F(AggNodeTest, partial_finalize_invalid_input) {
+  auto plan_node = PlanNodeFromPbtxt(kPartialSingleGroupAggFinalize);
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  // The serialized states have to be strings.
+  AggNode non_string_node;
+  EXPECT_NOT_OK(non_string_node.Init(*plan_node, output_rd,
+                                     {RowDescriptor({types::DataType::INT64, types::DataType::INT64})}));
+
+  // There has to be exactly one serialized state per value.
+  AggNode missing_state_node;
+  EXPECT_NOT_OK(missing_state_node.Init(*plan_node, output_rd,
+                                        {RowDescriptor({types::DataType::INT64})}));
+}
+
 TEST_F(AggNodeTest, multiple_groups_partial) {
   auto plan_node = PlanNodeFromPbtxt(kPartialMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
@@ -982,6 +1133,106 @@ TEST_F(AggNodeTest, multiple_groups_partial_finalize) {
       .Close();
 }
 
+TEST_F(AggNodeTest, streaming_tumbling_windows) {
+  auto plan_node = PlanNodeFromPbtxt(kStreamingTumblingAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      // Seeing the pane at 10 completes the window at 0.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({0, 0, 10})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({0})
+                          .AddColumn<types::Int64Value>({3})
+                          .get())
+      // The row at 0 is late, its window was already emitted.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, false, false)
+                       .AddColumn<types::Int64Value>({10, 0, 20})
+                       .AddColumn<types::Int64Value>({4, 5, 6})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({10})
+                          .AddColumn<types::Int64Value>({7})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, false, true)
+                       .AddColumn<types::Int64Value>({20})
+                       .AddColumn<types::Int64Value>({1})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({20})
+                          .AddColumn<types::Int64Value>({7})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, true, true)
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Int64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(AggNodeTest, streaming_sliding_windows) {
+  auto plan_node = PlanNodeFromPbtxt(kStreamingSlidingAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      // Only the window at -10, which covers the panes at -10 and 0, is complete.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({0, 0, 10})
+                       .AddColumn<types::Int64Value>({1, 2, 1})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, false)
+                          .AddColumn<types::Int64Value>({-10, -10})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .get(),
+                      false)
+      // Every pane is merged into the two windows that cover it.
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, false, true)
+                       .AddColumn<types::Int64Value>({20})
+                       .AddColumn<types::Int64Value>({1})
+                       .AddColumn<types::Int64Value>({5})
+                       .get(),
+                   0, 4)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, false)
+                          .AddColumn<types::Int64Value>({0, 0})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({4, 2})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({10})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({8})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({20})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({5})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, true, true)
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Int64Value>({})
+                          .get())
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/compiled_expression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+std::optional<KernelValueType> ToKernelValueType(types::DataType data_type) {
+  switch (data_type) {
+    case types::INT64:
+    case types::TIME64NS:
+      return KernelValueType::kInt64;
+    case types::FLOAT64:
+      return KernelValueType::kFloat64;
+    case types::BOOLEAN:
+      return KernelValueType::kBool;
+    default:
+      return std::nullopt;
+  }
+}
+
+size_t KernelValueSize(KernelValueType type) {
+  switch (type) {
+    case KernelValueType::kInt64:
+      return sizeof(int64_t);
+    case KernelValueType::kFloat64:
+      return sizeof(double);
+    case KernelValueType::kBool:
+      return sizeof(uint8_t);
+  }
+  return 0;
+}
+
+namespace {
+
+// The ops below must produce exactly the same results as the UDFs in
+// src/carnot/funcs/builtins/math_ops.h that they stand in for.
+struct AddOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    return a + b;
+  }
+};
+
+struct SubtractOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    return a - b;
+  }
+};
+
+struct MultiplyOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    return a * b;
+  }
+};
+
+struct DivideOp {
+  template <typename A, typename B>
+  static double Apply(A a, B b) {
+    return static_cast<double>(a) / static_cast<double>(b);
+  }
+};
+
+struct ModuloOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    // Modulo is only registered for integer types.
+    if constexpr (std::is_integral_v<A> && std::is_integral_v<B>) {
+      return a % b;
+    } else {
+      return std::fmod(a, b);
+    }
+  }
+};
+
+struct EqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a == b;
+  }
+};
+
+struct NotEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a != b;
+  }
+};
+
+struct ApproxEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return std::abs(a - b) < std::numeric_limits<double>::epsilon();
+  }
+};
+
+struct ApproxNotEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return std::abs(a - b) > std::numeric_limits<double>::epsilon();
+  }
+};
+
+struct GreaterThanOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a > b;
+  }
+};
+
+struct GreaterThanEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a >= b;
+  }
+};
+
+struct LessThanOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a < b;
+  }
+};
+
+struct LessThanEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a <= b;
+  }
+};
+
+struct LogicalAndOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a && b;
+  }
+};
+
+struct LogicalOrOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a || b;
+  }
+};
+
+struct NegateOp {
+  template <typename A>
+  static auto Apply(A a) {
+    return -a;
+  }
+};
+
+struct LogicalNotOp {
+  template <typename A>
+  static bool Apply(A a) {
+    return !a;
+  }
+};
+
+template <typename TOp, typename TOut, typename TA, typename TB>
+void BinaryKernel(const KernelOperand* args, size_t num_rows, void* out_data) {
+  auto* out = static_cast<TOut*>(out_data);
+  const auto* a = static_cast<const TA*>(args[0].data);
+  const auto* b = static_cast<const TB*>(args[1].data);
+  // Specialize the loops on which operands are scalars, so that the common column/column and
+  // column/constant cases compile to tight (and vectorizable) loops.
+  if (args[0].is_scalar && args[1].is_scalar) {
+    std::fill(out, out + num_rows, static_cast<TOut>(TOp::Apply(a[0], b[0])));
+  } else if (args[0].is_scalar) {
+    const TA a_val = a[0];
+    for (size_t i = 0; i < num_rows; ++i) {
+      out[i] = static_cast<TOut>(TOp::Apply(a_val, b[i]));
+    }
+  } else if (args[1].is_scalar) {
+    const TB b_val = b[0];
+    for (size_t i = 0; i < num_rows; ++i) {
+      out[i] = static_cast<TOut>(TOp::Apply(a[i], b_val));
+    }
+  } else {
+    for (size_t i = 0; i < num_rows; ++i) {
+      out[i] = static_cast<TOut>(TOp::Apply(a[i], b[i]));
+    }
+  }
+}
+
+template <typename TOp, typename TOut, typename TA>
+void UnaryKernel(const KernelOperand* args, size_t num_rows, void* out_data) {
+  auto* out = static_cast<TOut*>(out_data);
+  const auto* a = static_cast<const TA*>(args[0].data);
+  if (args[0].is_scalar) {
+    std::fill(out, out + num_rows, static_cast<TOut>(TOp::Apply(a[0])));
+    return;
+  }
+  for (size_t i = 0; i < num_rows; ++i) {
+    out[i] = static_cast<TOut>(TOp::Apply(a[i]));
+  }
+}
+
+// Calls fn with a value of the native type that stores the given kernel value type.
+template <typename TFn>
+KernelFn DispatchValueType(KernelValueType type, TFn fn) {
+  switch (type) {
+    case KernelValueType::kInt64:
+      return fn(int64_t{});
+    case KernelValueType::kFloat64:
+      return fn(double{});
+    case KernelValueType::kBool:
+      return fn(uint8_t{});
+  }
+  return nullptr;
+}
+
+template <typename TOp>
+KernelFn SelectBinaryKernel(KernelValueType a, KernelValueType b, KernelValueType out) {
+  return DispatchValueType(out, [&](auto out_val) {
+    return DispatchValueType(a, [&](auto a_val) {
+      return DispatchValueType(b, [&](auto b_val) -> KernelFn {
+        return &BinaryKernel<TOp, decltype(out_val), decltype(a_val), decltype(b_val)>;
+      });
+    });
+  });
+}
+
+template <typename TOp>
+KernelFn SelectUnaryKernel(KernelValueType a, KernelValueType out) {
+  return DispatchValueType(out, [&](auto out_val) {
+    return DispatchValueType(a, [&](auto a_val) -> KernelFn {
+      return &UnaryKernel<TOp, decltype(out_val), decltype(a_val)>;
+    });
+  });
+}
+
+KernelFn LookupBinaryKernel(std::string_view name, types::DataType a_type, types::DataType b_type,
+                            KernelValueType a, KernelValueType b, KernelValueType out) {
+  // The only FLOAT64 overloads of equal and notEqual are the approximate comparisons.
+  bool both_float = a_type == types::FLOAT64 && b_type == types::FLOAT64;
+  if (name == "add") {
+    return SelectBinaryKernel<AddOp>(a, b, out);
+  }
+  if (name == "subtract") {
+    return SelectBinaryKernel<SubtractOp>(a, b, out);
+  }
+  if (name == "multiply") {
+    return SelectBinaryKernel<MultiplyOp>(a, b, out);
+  }
+  if (name == "divide") {
+    return SelectBinaryKernel<DivideOp>(a, b, out);
+  }
+  if (name == "modulo") {
+    if (a != KernelValueType::kInt64 || b != KernelValueType::kInt64) {
+      return nullptr;
+    }
+    return SelectBinaryKernel<ModuloOp>(a, b, out);
+  }
+  if (name == "equal") {
+    return both_float ? SelectBinaryKernel<ApproxEqualOp>(a, b, out)
+                      : SelectBinaryKernel<EqualOp>(a, b, out);
+  }
+  if (name == "notEqual") {
+    return both_float ? SelectBinaryKernel<ApproxNotEqualOp>(a, b, out)
+                      : SelectBinaryKernel<NotEqualOp>(a, b, out);
+  }
+  if (name == "approxEqual") {
+    return SelectBinaryKernel<ApproxEqualOp>(a, b, out);
+  }
+  if (name == "greaterThan") {
+    return SelectBinaryKernel<GreaterThanOp>(a, b, out);
+  }
+  if (name == "greaterThanEqual") {
+    return SelectBinaryKernel<GreaterThanEqualOp>(a, b, out);
+  }
+  if (name == "lessThan") {
+    return SelectBinaryKernel<LessThanOp>(a, b, out);
+  }
+  if (name == "lessThanEqual") {
+    return SelectBinaryKernel<LessThanEqualOp>(a, b, out);
+  }
+  if (name == "logicalAnd") {
+    return SelectBinaryKernel<LogicalAndOp>(a, b, out);
+  }
+  if (name == "logicalOr") {
+    return SelectBinaryKernel<LogicalOrOp>(a, b, out);
+  }
+  return nullptr;
+}
+
+KernelFn LookupUnaryKernel(std::string_view name, KernelValueType a, KernelValueType out) {
+  if (name == "negate") {
+    return SelectUnaryKernel<NegateOp>(a, out);
+  }
+  if (name == "logicalNot") {
+    return SelectUnaryKernel<LogicalNotOp>(a, out);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+KernelFn LookupKernel(std::string_view name, const std::vector<types::DataType>& arg_types,
+                      types::DataType return_type) {
+  auto out = ToKernelValueType(return_type);
+  if (!out.has_value()) {
+    return nullptr;
+  }
+  std::vector<KernelValueType> args;
+  for (const auto& arg_type : arg_types) {
+    auto arg = ToKernelValueType(arg_type);
+    if (!arg.has_value()) {
+      return nullptr;
+    }
+    args.push_back(arg.value());
+  }
+  switch (args.size()) {
+    case 1:
+      return LookupUnaryKernel(name, args[0], out.value());
+    case 2:
+      return LookupBinaryKernel(name, arg_types[0], arg_types[1], args[0], args[1], out.value());
+    default:
+      return nullptr;
+  }
+}
+
+CompiledKernelCache* CompiledKernelCache::Global() {
+  static CompiledKernelCache cache;
+  return &cache;
+}
+
+std::shared_ptr<const CompiledKernel> CompiledKernelCache::GetOrCompile(
+    const std::string& key, const std::function<std::unique_ptr<CompiledKernel>()>& compile) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = kernels_.find(key);
+  if (it != kernels_.end()) {
+    ++hits_;
+    return it->second;
+  }
+  ++misses_;
+  if (kernels_.size() >= kMaxCachedKernels) {
+    kernels_.clear();
+  }
+  std::shared_ptr<const CompiledKernel> kernel = compile();
+  kernels_.emplace(key, kernel);
+  return kernel;
+}
+
+size_t CompiledKernelCache::size() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return kernels_.size();
+}
+
+void CompiledKernelCache::Clear() {
+  std::lock_guard<std::mutex> lock(mu_);
+  kernels_.clear();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * The in-memory representation of values inside a compiled kernel. INT64 and TIME64NS values are
+ * both stored as int64_t, FLOAT64 values as double and BOOLEAN values as one byte per value.
+ */
+enum class KernelValueType : uint8_t {
+  kInt64 = 0,
+  kFloat64 = 1,
+  kBool = 2,
+};
+
+/**
+ * Returns the kernel value type used to store values of the given data type, or std::nullopt if
+ * the data type can't be used in compiled kernels.
+ */
+std::optional<KernelValueType> ToKernelValueType(types::DataType data_type);
+
+/**
+ * Returns the size in bytes of a single value of the given kernel value type.
+ */
+size_t KernelValueSize(KernelValueType type);
+
+struct KernelOperand {
+  const void* data = nullptr;
+  // Scalar operands hold a single value which is used for every row.
+  bool is_scalar = false;
+};
+
+/**
+ * A kernel evaluates a single scalar function over num_rows rows of its operands, writing the
+ * results to out.
+ */
+using KernelFn = void (*)(const KernelOperand* args, size_t num_rows, void* out);
+
+/**
+ * Looks up the kernel that implements the builtin scalar function `name` for the given argument
+ * and return types. The kernels mirror the builtin math_ops UDFs of the same name.
+ * @return the kernel, or nullptr if the function doesn't have a compiled form.
+ */
+KernelFn LookupKernel(std::string_view name, const std::vector<types::DataType>& arg_types,
+                      types::DataType return_type);
+
+/**
+ * A CompiledKernel is a straight line program of kernels, compiled from a tree of scalar functions
+ * that all have a compiled form. It only depends on the shape of the tree and its types, so a
+ * single CompiledKernel is shared by every expression with the same shape.
+ *
+ * The leaves of the tree (columns and constants) are bound by the caller in the order they are
+ * visited by a depth first, left to right walk. Slots [0, num_leaves) hold the leaves and slot
+ * num_leaves + i holds the output of the i-th instruction. The output of the last instruction is
+ * the output of the expression.
+ */
+struct CompiledKernel {
+  struct Instruction {
+    KernelFn fn;
+    std::vector<int64_t> arg_slots;
+    KernelValueType out_type;
+  };
+
+  int64_t num_slots() const { return leaf_types.size() + instructions.size(); }
+
+  std::vector<KernelValueType> leaf_types;
+  std::vector<Instruction> instructions;
+};
+
+/**
+ * Process wide cache of compiled kernels keyed by the shape of the expression they were compiled
+ * from, so that long running queries and repeated executions of the same script only compile their
+ * expressions once.
+ */
+class CompiledKernelCache {
+ public:
+  static CompiledKernelCache* Global();
+
+  /**
+   * Returns the kernel cached for `key`, calling `compile` to create it on a miss.
+   */
+  std::shared_ptr<const CompiledKernel> GetOrCompile(
+      const std::string& key, const std::function<std::unique_ptr<CompiledKernel>()>& compile);
+
+  int64_t hits() const { return hits_; }
+  int64_t misses() const { return misses_; }
+  size_t size() const;
+  void Clear();
+
+ private:
+  // Expression shapes come from user scripts, so bound the size of the cache. When it's full we
+  // just start over, since the working set of shapes is small in practice.
+  static constexpr size_t kMaxCachedKernels = 4096;
+
+  mutable std::mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const CompiledKernel>> kernels_;
+  std::atomic<int64_t> hits_ = 0;
+  std::atomic<int64_t> misses_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -65,6 +65,10 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     // Make the probe table the left table when we need to preserve the order of the left table in
     // the output.
     probe_table_ = EquijoinNode::JoinInputTable::kLeftTable;
+  } else if (!plan_node_->order_by_time() &&
+             plan_node_->build_side() == planpb::JoinOperator::BUILD_RIGHT) {
+    // The planner estimated the right table to be the smaller one.
+    probe_table_ = EquijoinNode::JoinInputTable::kLeftTable;
   } else {
     probe_table_ = EquijoinNode::JoinInputTable::kRightTable;
   }
@@ -99,6 +103,7 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     probe_spec_.key_indices.emplace_back(
         probe_table_ == EquijoinNode::JoinInputTable::kLeftTable ? left_index : right_index);
   }
+  key_layout_ = SelectKeyLayout(key_data_types_);
 
   const auto& output_cols = plan_node_->output_columns();
   for (size_t i = 0; i < output_cols.size(); ++i) {
@@ -115,18 +120,25 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
-Status EquijoinNode::InitializeColumnBuilders() {
+RuntimeJoinFilter* EquijoinNode::runtime_filter() {
+  if (runtime_filter_ == nullptr) {
+    DCHECK(build_buffer_.empty() && int64_build_buffer_.empty() && uint128_build_buffer_.empty());
+    runtime_filter_ = std::make_unique<RuntimeJoinFilter>(key_data_types_);
+  }
+  return runtime_filter_.get();
+}
+
+Status EquijoinNode::InitializeColumnBuilders(arrow::MemoryPool* mem_pool) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
-    column_builders_[i] =
-        MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+    column_builders_[i] = MakeArrowBuilder(output_descriptor_->type(i), mem_pool);
     PX_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
   }
   return Status::OK();
 }
 
-Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::PrepareImpl(ExecState* exec_state) {
   column_builders_.resize(output_descriptor_->size());
-  PX_RETURN_IF_ERROR(InitializeColumnBuilders());
+  PX_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state->exec_mem_pool()));
 
   return Status::OK();
 }
@@ -135,8 +147,10 @@ Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK();
 
 Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
   join_keys_chunk_.clear();
+  probe_entries_chunk_.clear();
   build_buffer_.clear();
-  probed_keys_.clear();
+  int64_build_buffer_.clear();
+  uint128_build_buffer_.clear();
   key_values_pool_.Clear();
   return Status::OK();
 }
@@ -188,6 +202,35 @@ Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch
   return Status::OK();
 }
 
+Status EquijoinNode::HashJoinKeys(const table_store::schema::RowBatch& rb, bool is_probe) {
+  const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
+  key_cols_.clear();
+  for (const auto& input_col_idx : spec.key_indices) {
+    key_cols_.push_back(rb.ColumnAt(input_col_idx).get());
+  }
+  HashKeyColumns(key_cols_, key_data_types_, rb.num_rows(), &key_hashes_);
+  if (key_layout_ != KeyLayout::kRowTuple) {
+    // Fixed width keys are read straight from the key column.
+    return Status::OK();
+  }
+  return ExtractJoinKeysForBatch(rb, is_probe);
+}
+
+template <typename TFn>
+Status EquijoinNode::VisitBuildBuffer(TFn fn) {
+  switch (key_layout_) {
+    case KeyLayout::kInt64:
+      return fn(&int64_build_buffer_,
+                [this](int64_t row_idx) { return GetInt64Key(key_cols_[0], row_idx); });
+    case KeyLayout::kUInt128:
+      return fn(&uint128_build_buffer_,
+                [this](int64_t row_idx) { return GetUInt128Key(key_cols_[0], row_idx); });
+    case KeyLayout::kRowTuple:
+      break;
+  }
+  return fn(&build_buffer_, [this](int64_t row_idx) { return join_keys_chunk_[row_idx]; });
+}
+
 std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
                                                        const std::vector<types::DataType>& types) {
   auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
@@ -197,45 +240,42 @@ std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
   return ptr;
 }
 
-Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
-  if (rb.num_rows() > static_cast<int64_t>(build_wrappers_chunk_.size())) {
-    build_wrappers_chunk_.resize(rb.num_rows());
-  }
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (build_wrappers_chunk_[row_idx] == nullptr) {
-      build_wrappers_chunk_[row_idx] =
-          CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
-    }
-  }
-
-  // Make sure the map has constructed the necessary column wrappers for all of the tuples.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& rt = join_keys_chunk_[row_idx];
-    auto& current = build_buffer_[rt];
-    auto wrappers_ptr = current != nullptr ? current : build_wrappers_chunk_[row_idx];
-
-    // Now extract the values into the corresponding column wrappers.
-    for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
-      const auto& rb_col_idx = build_spec_.input_col_indices[i];
-      auto arr = rb.ColumnAt(rb_col_idx).get();
-      const auto& dt = build_spec_.input_col_types[i];
+void EquijoinNode::AppendBuildRow(const table_store::schema::RowBatch& rb, int64_t row_idx,
+                                  BuildEntry* entry) {
+  // Extract the values into the corresponding column wrappers.
+  for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
+    const auto& rb_col_idx = build_spec_.input_col_indices[i];
+    auto arr = rb.ColumnAt(rb_col_idx).get();
+    const auto& dt = build_spec_.input_col_types[i];
 
 #define TYPE_CASE(_dt_) \
-  types::ExtractValueToColumnWrapper<_dt_>(wrappers_ptr->at(i).get(), arr, row_idx);
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+  types::ExtractValueToColumnWrapper<_dt_>(entry->wrappers->at(i).get(), arr, row_idx);
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
-    }
-    // Keep track of the number of rows that the build buffer matches for each key.
-    build_buffer_rows_[rt]++;
-
-    if (current == nullptr) {
-      std::swap(build_wrappers_chunk_[row_idx], current);
-      // Reset the new tuples that we added
-      join_keys_chunk_[row_idx] = nullptr;
-    }
   }
+  // Keep track of the number of rows that the build buffer matches for each key.
+  entry->num_rows++;
+}
 
-  return Status::OK();
+Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
+  return VisitBuildBuffer([&](auto* build_buffer, auto get_key) -> Status {
+    for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      bool inserted;
+      auto* entry = build_buffer->FindOrInsert(key_hashes_[row_idx], get_key(row_idx), &inserted);
+      if (inserted) {
+        if (runtime_filter_ != nullptr) {
+          runtime_filter_->Insert(key_hashes_[row_idx]);
+        }
+        entry->value.wrappers = CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
+        if (key_layout_ == KeyLayout::kRowTuple) {
+          // The build buffer now owns the tuple, so don't reuse it for the next batch.
+          join_keys_chunk_[row_idx] = nullptr;
+        }
+      }
+      AppendBuildRow(rb, row_idx, &entry->value);
+    }
+    return Status::OK();
+  });
 }
 
 template <types::DataType DT>
@@ -272,7 +312,7 @@ Status EquijoinNode::NextOutputBatch(ExecState* exec_state) {
   }
   pending_output_batch_.swap(output_batch);
 
-  return InitializeColumnBuilders();
+  return InitializeColumnBuilders(exec_state->exec_mem_pool());
 }
 
 Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
@@ -351,21 +391,25 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     probe_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, true));
+  PX_RETURN_IF_ERROR(HashJoinKeys(rb, true));
 
-  if (rb.num_rows() > static_cast<int64_t>(probe_wrappers_chunk_.size())) {
-    probe_wrappers_chunk_.resize(rb.num_rows());
+  if (rb.num_rows() > static_cast<int64_t>(probe_entries_chunk_.size())) {
+    probe_entries_chunk_.resize(rb.num_rows());
   }
 
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto it = build_buffer_.find(join_keys_chunk_[row_idx]);
-    if (it != build_buffer_.end()) {
-      probe_wrappers_chunk_[row_idx] = it->second;
-      probed_keys_.insert(it->first);
-    } else {
-      probe_wrappers_chunk_[row_idx] = nullptr;
+  // The build buffer doesn't change while probing, so the entries stay valid.
+  PX_RETURN_IF_ERROR(VisitBuildBuffer([&](auto* build_buffer, auto get_key) -> Status {
+    for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      auto* entry = build_buffer->Find(key_hashes_[row_idx], get_key(row_idx));
+      if (entry != nullptr) {
+        entry->value.probed = true;
+        probe_entries_chunk_[row_idx] = &entry->value;
+      } else {
+        probe_entries_chunk_[row_idx] = nullptr;
+      }
     }
-  }
+    return Status::OK();
+  }));
 
   auto rb_ptr = std::make_shared<RowBatch>(rb);
 
@@ -374,7 +418,8 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
       PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
     }
 
-    if (probe_wrappers_chunk_[row_idx] == nullptr) {
+    const BuildEntry* entry = probe_entries_chunk_[row_idx];
+    if (entry == nullptr) {
       if (probe_spec_.emit_unmatched_rows) {
         OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
         chunks_.emplace_back(c);
@@ -383,9 +428,8 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
       continue;
     }
 
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, probe_wrappers_chunk_[row_idx], rb_ptr,
-                                                row_idx,
-                                                build_buffer_rows_[join_keys_chunk_[row_idx]]));
+    PX_RETURN_IF_ERROR(
+        MatchBuildValuesAndFlush(exec_state, entry->wrappers, rb_ptr, row_idx, entry->num_rows));
   }
 
   if (probe_eos_ && queued_rows_ > 0) {
@@ -396,13 +440,16 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
 }
 
 Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
-  for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
-    if (probed_keys_.find(it->first) != probed_keys_.end()) {
-      continue;
+  PX_RETURN_IF_ERROR(VisitBuildBuffer([&](auto* build_buffer, auto) -> Status {
+    for (const auto& entry : *build_buffer) {
+      if (entry.value.probed) {
+        continue;
+      }
+      PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, entry.value.wrappers, nullptr, 0,
+                                                  entry.value.num_rows));
     }
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, it->second, nullptr, 0,
-                                                build_buffer_rows_[it->first]));
-  }
+    return Status::OK();
+  }));
 
   if (queued_rows_ > 0) {
     PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
@@ -416,10 +463,14 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
+  PX_RETURN_IF_ERROR(HashJoinKeys(rb, false));
   PX_RETURN_IF_ERROR(HashRowBatch(rb));
 
   if (build_eos_) {
+    if (runtime_filter_ != nullptr) {
+      // Lets the probe side scan start, see ExecutionGraph::AddRuntimeJoinFilters.
+      PX_RETURN_IF_ERROR(runtime_filter_->Finalize());
+    }
     while (probe_batches_.size()) {
       PX_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
       probe_batches_.pop();
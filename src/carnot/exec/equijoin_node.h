@@ -30,7 +30,9 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/key_hash_table.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/runtime_join_filter.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -60,10 +62,41 @@ class EquijoinNode : public ProcessingNode {
     std::vector<int64_t> output_col_indices;
   };
 
+  // The build buffer value for a single set of keys.
+  struct BuildEntry {
+    // The build side values of every row with these keys.
+    std::vector<types::SharedColumnWrapper>* wrappers = nullptr;
+    // The number of rows with these keys. This is necessary to store in addition to the wrappers
+    // in the event that no columns from the build side are emitted.
+    int64_t num_rows = 0;
+    // For joins where the build buffer needs to emit any non-probed rows at the end of the join,
+    // keep track of which ones were probed.
+    bool probed = false;
+  };
+
  public:
   EquijoinNode() = default;
   virtual ~EquijoinNode() = default;
 
+  /**
+   * The index of the parent that is probed, and the indices of the key columns in that parent.
+   * Only valid after Init().
+   */
+  size_t probe_parent_index() const { return probe_table_ == JoinInputTable::kLeftTable ? 0 : 1; }
+  const std::vector<int64_t>& probe_key_indices() const { return probe_spec_.key_indices; }
+
+  /**
+   * Whether the probe rows without a match are part of the output, in which case the probe side
+   * can't be filtered by the build keys.
+   */
+  bool emits_unmatched_probe_rows() const { return probe_spec_.emit_unmatched_rows; }
+
+  /**
+   * Returns the filter of the build side keys, creating it on the first call. The filter is ready
+   * once the build side reaches eos. Must be called before the build side is consumed.
+   */
+  RuntimeJoinFilter* runtime_filter();
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -74,11 +107,18 @@ class EquijoinNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  Status InitializeColumnBuilders();
+  Status InitializeColumnBuilders(arrow::MemoryPool* mem_pool);
   bool IsProbeTable(size_t parent_index);
   Status FlushChunkedRows(ExecState* exec_state);
   Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
+  // Hashes the join keys of rb, and extracts them into RowTuples if the keys aren't fixed width.
+  Status HashJoinKeys(const table_store::schema::RowBatch& rb, bool is_probe);
   Status HashRowBatch(const table_store::schema::RowBatch& rb);
+  void AppendBuildRow(const table_store::schema::RowBatch& rb, int64_t row_idx, BuildEntry* entry);
+  // Calls fn with the build buffer for key_layout_ and a function that returns the key of a row
+  // in the batch that was last passed to HashJoinKeys.
+  template <typename TFn>
+  Status VisitBuildBuffer(TFn fn);
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status MatchBuildValuesAndFlush(ExecState* exec_state,
@@ -103,6 +143,7 @@ class EquijoinNode : public ProcessingNode {
   TableSpec probe_spec_;
 
   std::vector<types::DataType> key_data_types_;
+  KeyLayout key_layout_ = KeyLayout::kRowTuple;
 
   // Example of the above specs:
   // For input table A (build) which has [key_A_1, output_col_0, key_A_0/output_col_2]
@@ -133,27 +174,27 @@ class EquijoinNode : public ProcessingNode {
   ObjectPool key_values_pool_{"equijoin_kv_pool"};
   ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
 
-  // Chunk of data to use when extracting join keys.
+  // The key columns and key hashes of the batch that is currently being built or probed.
+  std::vector<const arrow::Array*> key_cols_;
+  std::vector<uint64_t> key_hashes_;
+  // Chunk of data to use when extracting join keys. Only used for KeyLayout::kRowTuple.
   std::vector<RowTuple*> join_keys_chunk_;
-  // Chunk of data to use when performing the build stage of the join.
-  std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
 
   // Chunk of data to use when performing the probe stage of the join.
-  // This will store build table data from `build_buffer_`.
-  std::vector<std::vector<types::SharedColumnWrapper>*> probe_wrappers_chunk_;
-  AbslRowTupleHashMap<std::vector<types::SharedColumnWrapper>*> build_buffer_;
-  // Store the number of rows that match a given set of keys for the build buffer.
-  // This is necessary to store in addition to the values in `build_buffer_` in
-  // the event that no columns from the build side are emitted.
-  AbslRowTupleHashMap<int64_t> build_buffer_rows_;
-
-  // For joins where the build_buffer_ needs to emit any non-probed rows at the end of the join,
-  // keep track of which ones they were.
-  AbslRowTupleHashSet probed_keys_;
+  // This will store the build buffer entry matching each probe row.
+  std::vector<BuildEntry*> probe_entries_chunk_;
+  // Only the build buffer for key_layout_ is used. The fixed width layouts store the keys inline,
+  // so they don't need RowTuples at all.
+  RowTupleKeyHashTable<BuildEntry> build_buffer_;
+  Int64KeyHashTable<BuildEntry> int64_build_buffer_;
+  UInt128KeyHashTable<BuildEntry> uint128_build_buffer_;
 
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
 
+  // Collects the build keys for the scan on the probe side, if there is one that can use them.
+  std::unique_ptr<RuntimeJoinFilter> runtime_filter_;
+
   std::unique_ptr<plan::JoinOperator> plan_node_;
 };
 
@@ -320,6 +320,61 @@ TEST_F(JoinNodeTest, unordered_full_outer_join) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_build_right) {
+  // The planner picked the right table as the build table.
+  // Left table input: [left_0:Int64, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:Int64]
+  // Output table: [left_1:Int64, right_1:Int64]
+  // Inner join on left_0=right_0
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  column_names: "left_1"
+  column_names: "right_1"
+  rows_per_batch: 5
+  build_side: BUILD_RIGHT
+)";
+
+  RowDescriptor input_rd_0({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+
+  tester
+      // Build table
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2})
+                       .AddColumn<types::Int64Value>({10, 20})
+                       .get(),
+                   1, 0)
+      // Probe table
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({100, 200, 300})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>({100, 200})
+                          .AddColumn<types::Int64Value>({10, 20})
+                          .get(),
+                      true)
+      .Close();
+}
+
 TEST_F(JoinNodeTest, unordered_no_left_columns) {
   // All batches from build first
   // Left table input: [left_0:String, left_1:Int64]
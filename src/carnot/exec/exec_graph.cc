@@ -22,6 +22,8 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/empty_source_node.h"
@@ -36,6 +38,7 @@
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/sort_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -62,7 +65,9 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> filter_cols;
+  absl::flat_hash_set<int64_t> batch_sources;
+  Status walk_status = plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -73,18 +78,26 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
       })
       .OnMemorySource([&](auto& node) {
+        if (!node.streaming()) {
+          batch_sources.insert(node.id());
+        }
         return OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
       })
       .OnFilter([&](auto& node) {
+        filter_cols[node.id()] = node.selected_cols();
         return OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors);
       })
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnSort([&](auto& node) {
+        return OnOperatorImpl<plan::SortOperator, SortNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
       .OnJoin([&](auto& node) {
+        joins_.push_back(node.id());
         return OnOperatorImpl<plan::JoinOperator, EquijoinNode>(node, &descriptors);
       })
       .OnGRPCSource([&](auto& node) {
@@ -109,6 +122,48 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::OTelExportSinkOperator, OTelExportSinkNode>(node, &descriptors);
       })
       .Walk(pf_);
+  PX_RETURN_IF_ERROR(walk_status);
+
+  if (FLAGS_carnot_runtime_join_filters) {
+    AddRuntimeJoinFilters(filter_cols, batch_sources);
+  }
+  return Status::OK();
+}
+
+void ExecutionGraph::AddRuntimeJoinFilters(
+    const absl::flat_hash_map<int64_t, std::vector<int64_t>>& filter_cols,
+    const absl::flat_hash_set<int64_t>& batch_sources) {
+  const auto& dag = pf_->dag();
+  for (int64_t join_id : joins_) {
+    auto join = static_cast<EquijoinNode*>(nodes_.at(join_id));
+    if (join->emits_unmatched_probe_rows()) {
+      continue;
+    }
+    auto parents = dag.ParentsOf(join_id);
+    if (parents.size() != 2 || parents[0] == parents[1]) {
+      continue;
+    }
+    // Walk up from the probe side to its memory source. Every node on the way must only feed this
+    // join, and must keep the key columns as they are, so that filtering the source can't change
+    // the output of anything but the join.
+    int64_t node_id = parents[join->probe_parent_index()];
+    std::vector<int64_t> key_indices = join->probe_key_indices();
+    bool filterable = true;
+    while (filterable && filter_cols.contains(node_id)) {
+      const auto& selected_cols = filter_cols.at(node_id);
+      for (auto& key_idx : key_indices) {
+        key_idx = selected_cols[key_idx];
+      }
+      filterable = dag.DependenciesOf(node_id).size() == 1;
+      node_id = dag.ParentsOf(node_id)[0];
+    }
+    if (!filterable || !batch_sources.contains(node_id) ||
+        dag.DependenciesOf(node_id).size() != 1) {
+      continue;
+    }
+    auto source = static_cast<MemorySourceNode*>(nodes_.at(node_id));
+    source->AddRuntimeJoinFilter(join->runtime_filter(), std::move(key_indices));
+  }
 }
 
 bool ExecutionGraph::YieldWithTimeout() {
@@ -244,6 +299,10 @@ Status ExecutionGraph::ExecuteSources() {
       }
     }
 
+    if (wait_for_more_data) {
+      // A query waiting for data, such as a streaming query, lets other queries run meanwhile.
+      exec_state_->YieldExecution(/*waiting_for_data*/ true);
+    }
     while (wait_for_more_data) {
       auto timer = ElapsedTimer();
       timer.Start();
@@ -283,6 +342,10 @@ Status ExecutionGraph::ExecuteSources() {
         return Status::OK();
       }
     }
+
+    // Between passes over the sources, the query may be descheduled so that other queries can run.
+    // A query that waited for data gets its turn back here.
+    exec_state_->YieldExecution();
   }
 
   return Status::OK();
@@ -343,7 +406,9 @@ ExecutionStats ExecutionGraph::GetStats() const {
     bytes_processed += source_node->BytesProcessed();
     rows_processed += source_node->RowsProcessed();
   }
-  return ExecutionStats({bytes_processed, rows_processed});
+  int64_t peak_memory_bytes =
+      exec_state_ != nullptr ? exec_state_->query_mem_pool()->max_memory() : 0;
+  return ExecutionStats({bytes_processed, rows_processed, peak_memory_bytes});
 }
 
 }  // namespace exec
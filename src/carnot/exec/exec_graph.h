@@ -46,6 +46,8 @@ namespace exec {
 struct ExecutionStats {
   int64_t bytes_processed;
   int64_t rows_processed;
+  // The peak bytes of arrow memory allocated by the query at once.
+  int64_t peak_memory_bytes;
 };
 
 constexpr std::chrono::milliseconds kDefaultYieldTimeoutMS{1000};
@@ -209,7 +211,17 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
-  ExecState* exec_state_;
+  /**
+   * Makes the memory sources that only feed the probe side of a join (possibly through filters)
+   * drop the rows whose keys aren't on the build side of that join.
+   * @param filter_cols The selected columns of every filter in the plan fragment.
+   * @param batch_sources The memory sources that read a fixed range of their table.
+   */
+  void AddRuntimeJoinFilters(
+      const absl::flat_hash_map<int64_t, std::vector<int64_t>>& filter_cols,
+      const absl::flat_hash_set<int64_t>& batch_sources);
+
+  ExecState* exec_state_ = nullptr;
   ObjectPool pool_{"exec_graph_pool"};
   table_store::schema::Schema* schema_;
   plan::PlanState* plan_state_;
@@ -217,6 +229,7 @@ class ExecutionGraph {
   std::vector<int64_t> sources_;
   absl::flat_hash_set<int64_t> grpc_sources_;
   absl::flat_hash_set<int64_t> grpc_sinks_;
+  std::vector<int64_t> joins_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
 
   SystemTimePoint query_start_time_;
@@ -534,6 +534,159 @@ TEST_F(ExecGraphTest, execute_with_two_limits) {
       types::ToArrow(out_in1, arrow::default_memory_pool())));
 }
 
+// Joins the rows of "left" with the keys in "right". "right" is the first parent, so the hash
+// table is built from it and "left" is probed.
+constexpr char kPlanWithJoin[] = R"proto(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 3
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+    }
+    nodes {
+      id: 3
+      sorted_children: 4
+      sorted_parents: 2
+      sorted_parents: 1
+    }
+    nodes {
+      id: 4
+      sorted_parents: 3
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "left"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "a"
+        column_idxs: 1
+        column_types: FLOAT64
+        column_names: "b"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "right"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "k"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: JOIN_OPERATOR
+      join_op {
+        type: INNER
+        equality_conditions {
+          left_column_index: 0
+          right_column_index: 0
+        }
+        output_columns {
+          parent_index: 1
+          column_index: 0
+        }
+        output_columns {
+          parent_index: 1
+          column_index: 1
+        }
+        column_names: "a"
+        column_names: "b"
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "joined"
+        column_types: INT64
+        column_types: FLOAT64
+        column_names: "a"
+        column_names: "b"
+      }
+    }
+  }
+)proto";
+
+class ExecGraphJoinFilterTest : public BaseExecGraphTest,
+                                public ::testing::WithParamInterface<bool> {
+ protected:
+  void SetUp() override {
+    SetUpExecState();
+    table_store::schema::Relation left_rel({types::DataType::INT64, types::DataType::FLOAT64},
+                                           {"a", "b"});
+    auto left = Table::Create("left", left_rel);
+    auto left_rb = RowBatch(RowDescriptor(left_rel.col_types()), 6);
+    std::vector<types::Int64Value> a = {1, 2, 3, 4, 5, 6};
+    std::vector<types::Float64Value> b = {1.1, 2.2, 3.3, 4.4, 5.5, 6.6};
+    EXPECT_OK(left_rb.AddColumn(types::ToArrow(a, arrow::default_memory_pool())));
+    EXPECT_OK(left_rb.AddColumn(types::ToArrow(b, arrow::default_memory_pool())));
+    EXPECT_OK(left->WriteRowBatch(left_rb));
+    exec_state_->table_store()->AddTable("left", left);
+
+    table_store::schema::Relation right_rel({types::DataType::INT64}, {"k"});
+    auto right = Table::Create("right", right_rel);
+    auto right_rb = RowBatch(RowDescriptor(right_rel.col_types()), 2);
+    std::vector<types::Int64Value> k = {4, 2};
+    EXPECT_OK(right_rb.AddColumn(types::ToArrow(k, arrow::default_memory_pool())));
+    EXPECT_OK(right->WriteRowBatch(right_rb));
+    exec_state_->table_store()->AddTable("right", right);
+
+    planpb::PlanFragment pf_pb;
+    ASSERT_TRUE(TextFormat::MergeFromString(kPlanWithJoin, &pf_pb));
+    ASSERT_OK(plan_fragment_->Init(pf_pb));
+  }
+};
+
+TEST_P(ExecGraphJoinFilterTest, filters_probe_side_scan) {
+  bool runtime_join_filters = GetParam();
+  PX_SET_FOR_SCOPE(FLAGS_carnot_runtime_join_filters, runtime_join_filters);
+
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  ExecutionGraph e;
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ true));
+  ASSERT_OK(e.Execute());
+
+  auto output_table = exec_state_->table_store()->GetTable("joined");
+  table_store::Table::Cursor cursor(output_table);
+  auto out_rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_TRUE(out_rb->ColumnAt(0)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{2, 4}, arrow::default_memory_pool())));
+  EXPECT_TRUE(out_rb->ColumnAt(1)->Equals(
+      types::ToArrow(std::vector<types::Float64Value>{2.2, 4.4}, arrow::default_memory_pool())));
+
+  auto probe_source = e.node(1).ConsumeValueOrDie();
+  const auto& extra_info = probe_source->stats()->extra_info;
+  if (runtime_join_filters) {
+    EXPECT_EQ(2, probe_source->stats()->rows_output);
+    ASSERT_TRUE(extra_info.contains("rows_dropped_by_join_filters"));
+    EXPECT_EQ("4", extra_info.at("rows_dropped_by_join_filters"));
+  } else {
+    EXPECT_EQ(6, probe_source->stats()->rows_output);
+    EXPECT_FALSE(extra_info.contains("rows_dropped_by_join_filters"));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ExecGraphJoinFilterTestSuite, ExecGraphJoinFilterTest,
+                         ::testing::Bool());
+
 class YieldingExecGraphTest : public BaseExecGraphTest {
  protected:
   void SetUp() { SetUpExecState(); }
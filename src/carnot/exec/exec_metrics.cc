@@ -18,6 +18,7 @@
 
 #include "src/carnot/exec/exec_metrics.h"
 #include <prometheus/counter.h>
+#include <prometheus/gauge.h>
 #include <string>
 
 ExecMetrics::ExecMetrics(prometheus::Registry* registry)
@@ -32,4 +33,39 @@ ExecMetrics::ExecMetrics(prometheus::Registry* registry)
               .Name("otlp_timeouts")
               .Help("Total number of timeouts which occurred when exporting data to an OTLP client")
               .Register(*registry)
-              .Add({{"name", "spans"}})) {}
+              .Add({{"name", "spans"}})),
+      partial_agg_input_bytes_counter(
+          prometheus::BuildCounter()
+              .Name("partial_agg_bytes")
+              .Help("Total number of bytes consumed and emitted by partial aggregates")
+              .Register(*registry)
+              .Add({{"direction", "input"}})),
+      partial_agg_output_bytes_counter(
+          prometheus::BuildCounter()
+              .Name("partial_agg_bytes")
+              .Help("Total number of bytes consumed and emitted by partial aggregates")
+              .Register(*registry)
+              .Add({{"direction", "output"}})),
+      grpc_sink_queued_requests_gauge(
+          prometheus::BuildGauge()
+              .Name("grpc_sink_queued_requests")
+              .Help("Number of result chunks queued by GRPC sinks that were not written yet")
+              .Register(*registry)
+              .Add({})),
+      grpc_sink_send_stall_ns_counter(
+          prometheus::BuildCounter()
+              .Name("grpc_sink_send_stall_ns")
+              .Help("Total time GRPC sinks were blocked because their send queue was full")
+              .Register(*registry)
+              .Add({})),
+      exec_memory_bytes_gauge(prometheus::BuildGauge()
+                                  .Name("exec_memory_bytes")
+                                  .Help("Bytes of arrow memory held by queries")
+                                  .Register(*registry)
+                                  .Add({})),
+      query_memory_limit_exceeded_counter(
+          prometheus::BuildCounter()
+              .Name("query_memory_limit_exceeded")
+              .Help("Total number of queries that failed because they exceeded a memory limit")
+              .Register(*registry)
+              .Add({})) {}
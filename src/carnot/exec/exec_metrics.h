@@ -27,4 +27,16 @@ struct ExecMetrics {
 
   prometheus::Counter& otlp_metrics_timeout_counter;
   prometheus::Counter& otlp_spans_timeout_counter;
+  // The bytes of raw rows consumed by partial aggregates, i.e. what would have been sent to the
+  // merging node without partial aggregation, and the bytes of the partial states they emitted.
+  prometheus::Counter& partial_agg_input_bytes_counter;
+  prometheus::Counter& partial_agg_output_bytes_counter;
+  // The result chunks that GRPC sinks have queued but not written yet, and the time the sinks were
+  // blocked on a full queue.
+  prometheus::Gauge& grpc_sink_queued_requests_gauge;
+  prometheus::Counter& grpc_sink_send_stall_ns_counter;
+  // The memory held by all queries, updated as queries finish, and the queries that failed because
+  // they exceeded a memory limit.
+  prometheus::Gauge& exec_memory_bytes_gauge;
+  prometheus::Counter& query_memory_limit_exceeded_counter;
 };
@@ -147,6 +147,7 @@ class ExecNode {
               std::vector<table_store::schema::RowDescriptor> input_descriptors,
               bool collect_exec_stats = false) {
     is_initialized_ = true;
+    id_ = plan_node.id();
     output_descriptor_ = std::make_unique<table_store::schema::RowDescriptor>(output_descriptor);
     input_descriptors_ = input_descriptors;
     stats_ = std::make_unique<ExecNodeStats>(collect_exec_stats);
@@ -160,6 +161,8 @@ class ExecNode {
    */
   Status Prepare(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    mem_pool_ = exec_state->CreateNodeMemoryPool(id_);
+    ExecState::ScopedMemoryPool mem_pool_scope(exec_state, mem_pool_);
     return PrepareImpl(exec_state);
   }
 
@@ -170,6 +173,7 @@ class ExecNode {
    */
   Status Open(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    ExecState::ScopedMemoryPool mem_pool_scope(exec_state, mem_pool_);
     return OpenImpl(exec_state);
   }
 
@@ -182,6 +186,7 @@ class ExecNode {
    */
   Status Close(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    ExecState::ScopedMemoryPool mem_pool_scope(exec_state, mem_pool_);
     return CloseImpl(exec_state);
   }
 
@@ -195,9 +200,12 @@ class ExecNode {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSourceNode);
     stats_->ResumeTotalTimer();
-    PX_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
+    {
+      ExecState::ScopedMemoryPool mem_pool_scope(exec_state, mem_pool_);
+      PX_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
+    }
     stats_->StopTotalTimer();
-    return Status::OK();
+    return exec_state->CheckMemoryLimits();
   }
 
   /**
@@ -220,9 +228,12 @@ class ExecNode {
     }
     stats_->AddInputStats(rb);
     stats_->ResumeTotalTimer();
-    PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    {
+      ExecState::ScopedMemoryPool mem_pool_scope(exec_state, mem_pool_);
+      PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    }
     stats_->StopTotalTimer();
-    return Status::OK();
+    return exec_state->CheckMemoryLimits();
   }
 
   /**
@@ -275,6 +286,11 @@ class ExecNode {
 
   ExecNodeStats* stats() const { return stats_.get(); }
 
+  /**
+   * @return the peak bytes of arrow memory that this node had allocated at once.
+   */
+  int64_t PeakMemoryBytes() const { return mem_pool_ != nullptr ? mem_pool_->max_memory() : 0; }
+
  protected:
   /**
    * Send data to children row batches.
@@ -323,6 +339,10 @@ class ExecNode {
  private:
   // The stats of this exec node.
   std::unique_ptr<ExecNodeStats> stats_;
+  int64_t id_ = -1;
+  // Tracks the memory allocated while this node runs. Owned by the pool of the query, and created
+  // in Prepare.
+  types::TrackingMemoryPool* mem_pool_ = nullptr;
   // Unowned reference to the children. Must remain valid for the duration of query.
   std::vector<ExecNode*> children_;
   // For each of the children (which may have multiple parents) which parent is this node?
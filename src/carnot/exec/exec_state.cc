@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/exec_state.h"
+
+DEFINE_int64(carnot_exec_memory_limit_mb,
+             gflags::Int64FromEnv("PL_CARNOT_EXEC_MEMORY_LIMIT_MB", 0),
+             "The memory that all running queries together may allocate, in MB. Queries fail once "
+             "the limit is exceeded. 0 means no limit.");
+DEFINE_int64(carnot_query_memory_limit_mb,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_LIMIT_MB", 0),
+             "The memory that a single query may allocate, in MB. The query fails once the limit "
+             "is exceeded. 0 means no limit.");
+DEFINE_int64(carnot_query_memory_soft_limit_mb,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_SOFT_LIMIT_MB", 0),
+             "The memory that a single query may allocate, in MB, before a warning is logged. 0 "
+             "means no limit.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+types::TrackingMemoryPool* ExecMemoryPool() {
+  static auto* pool = types::TrackingMemoryPool::ProcessPool()->CreateChild(
+      "carnot", FLAGS_carnot_exec_memory_limit_mb << 20);
+  return pool;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -26,6 +26,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <sole.hpp>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
@@ -35,12 +36,17 @@
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
+#include "src/shared/types/tracking_memory_pool.h"
 #include "src/table_store/table/table_store.h"
 
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
 #include "opentelemetry/proto/collector/trace/v1/trace_service.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 
+DECLARE_int64(carnot_exec_memory_limit_mb);
+DECLARE_int64(carnot_query_memory_limit_mb);
+DECLARE_int64(carnot_query_memory_soft_limit_mb);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -55,6 +61,12 @@ using TraceStubGenerator = std::function<
     std::unique_ptr<opentelemetry::proto::collector::trace::v1::TraceService::StubInterface>(
         const std::string& address, bool insecure)>;
 
+/**
+ * @return the memory pool that the pools of all queries in this process are children of. Its
+ * hard limit is --carnot_exec_memory_limit_mb.
+ */
+types::TrackingMemoryPool* ExecMemoryPool();
+
 /**
  * ExecState manages the execution state for a single query. A new one will
  * be constructed for every query executed in Carnot and it will not be reused.
@@ -82,16 +94,68 @@ class ExecState {
         model_pool_(model_pool),
         grpc_router_(grpc_router),
         add_auth_to_grpc_client_context_func_(add_auth_func),
-        exec_metrics_(exec_metrics) {}
+        exec_metrics_(exec_metrics),
+        query_mem_pool_(ExecMemoryPool()->CreateChild(
+            absl::StrCat("query_", query_id.str()), FLAGS_carnot_query_memory_limit_mb << 20,
+            FLAGS_carnot_query_memory_soft_limit_mb << 20)) {}
 
   ~ExecState() {
     if (grpc_router_ != nullptr) {
       grpc_router_->DeleteQuery(query_id_);
     }
+    ExecMemoryPool()->ReleaseChild(query_mem_pool_);
+    if (exec_metrics_ != nullptr) {
+      exec_metrics_->exec_memory_bytes_gauge.Set(ExecMemoryPool()->bytes_allocated());
+    }
   }
+
+  /**
+   * @return the pool that allocations should be made from. While an exec node is running, this is
+   * the node's pool, otherwise it is the pool of the query.
+   */
   arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
+    if (current_mem_pool_ != nullptr) {
+      return current_mem_pool_;
+    }
+    return query_mem_pool_;
+  }
+
+  types::TrackingMemoryPool* query_mem_pool() { return query_mem_pool_; }
+
+  /**
+   * Creates the pool that tracks the allocations of a single exec node. It is owned by the pool of
+   * the query.
+   */
+  types::TrackingMemoryPool* CreateNodeMemoryPool(int64_t node_id) {
+    return query_mem_pool_->CreateChild(absl::StrCat("node_", node_id));
+  }
+
+  /**
+   * ScopedMemoryPool makes exec_mem_pool() return the given pool until it goes out of scope.
+   */
+  class ScopedMemoryPool {
+   public:
+    ScopedMemoryPool(ExecState* exec_state, types::TrackingMemoryPool* pool)
+        : exec_state_(exec_state), prev_pool_(exec_state->current_mem_pool_) {
+      exec_state_->current_mem_pool_ = pool;
+    }
+    ~ScopedMemoryPool() { exec_state_->current_mem_pool_ = prev_pool_; }
+
+   private:
+    ExecState* exec_state_;
+    types::TrackingMemoryPool* prev_pool_;
+  };
+
+  /**
+   * @return ResourceUnavailable if the query, or all queries together, use more memory than their
+   * hard limit.
+   */
+  Status CheckMemoryLimits() {
+    auto s = query_mem_pool_->CheckLimits();
+    if (!s.ok() && exec_metrics_ != nullptr) {
+      exec_metrics_->query_memory_limit_exceeded_counter.Increment();
+    }
+    return s;
   }
 
   udf::Registry* func_registry() { return func_registry_; }
@@ -202,6 +266,21 @@ class ExecState {
 
   ExecMetrics* exec_metrics() { return exec_metrics_; }
 
+  /**
+   * Sets the function called by the execution graph between passes over its sources, where the
+   * query may be descheduled to let other queries run. waiting_for_data is set when the query is
+   * about to wait for its sources to have data.
+   */
+  void set_yield_func(std::function<void(bool waiting_for_data)> yield_func) {
+    yield_func_ = std::move(yield_func);
+  }
+
+  void YieldExecution(bool waiting_for_data = false) {
+    if (yield_func_) {
+      yield_func_(waiting_for_data);
+    }
+  }
+
  private:
   udf::Registry* func_registry_;
   std::shared_ptr<table_store::TableStore> table_store_;
@@ -216,6 +295,11 @@ class ExecState {
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
   ExecMetrics* exec_metrics_;
+  std::function<void(bool)> yield_func_;
+
+  // Child of ExecMemoryPool(), the parent of the pools of the exec nodes.
+  types::TrackingMemoryPool* query_mem_pool_;
+  types::TrackingMemoryPool* current_mem_pool_ = nullptr;
 
   int64_t current_source_ = 0;
   bool current_source_set_ = false;
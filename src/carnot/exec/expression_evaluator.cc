@@ -23,20 +23,27 @@
 #include <arrow/memory_pool.h>
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <ostream>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/udf/udf_definition.h"
 #include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_bool(carnot_compiled_expressions,
+            gflags::BoolFromEnv("PL_CARNOT_COMPILED_EXPRESSIONS", false),
+            "Whether map and filter nodes should evaluate expressions with compiled kernels.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -66,6 +73,8 @@ std::unique_ptr<ScalarExpressionEvaluator> ScalarExpressionEvaluator::Create(
       return std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx);
     case ScalarExpressionEvaluatorType::kArrowNative:
       return std::make_unique<ArrowNativeScalarExpressionEvaluator>(expressions, function_ctx);
+    case ScalarExpressionEvaluatorType::kCompiled:
+      return std::make_unique<CompiledScalarExpressionEvaluator>(expressions, function_ctx);
     default:
       CHECK(0) << "Unknown expression type";
   }
@@ -268,8 +277,8 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
     return Status::OK();
   }
 
-  PX_ASSIGN_OR_RETURN(auto result, VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
-                                       exec_state, input, expr));
+  // Dispatch virtually, so that derived evaluators can evaluate the expression differently.
+  PX_ASSIGN_OR_RETURN(auto result, EvaluateSingleExpression(exec_state, input, expr));
   PX_RETURN_IF_ERROR(output->AddColumn(result->ConvertToArrow(exec_state->exec_mem_pool())));
   return Status::OK();
 }
@@ -320,7 +329,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
         auto udf = id_to_udf_map_[fn.udf_id()].get();
 
-        auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
+        auto output = MakeArrowBuilder(def->exec_return_type(), exec_state->exec_mem_pool());
 
         std::vector<arrow::Array*> raw_children;
         raw_children.reserve(children.size());
@@ -341,6 +350,351 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   return Status::OK();
 }
 
+namespace {
+
+// Appends a key describing the shape of expr (the functions, their types and which arguments are
+// columns or constants, but not which columns or which constant values) and collects its leaves.
+void AppendExpressionShape(ExecState* exec_state, const plan::ScalarExpression& expr,
+                           types::DataType type, std::string* key,
+                           std::vector<const plan::ScalarExpression*>* leaves) {
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kColumn:
+      absl::StrAppend(key, "col:", static_cast<int>(type));
+      leaves->push_back(&expr);
+      return;
+    case plan::Expression::kConstant:
+      absl::StrAppend(key, "const:", static_cast<int>(type));
+      leaves->push_back(&expr);
+      return;
+    default:
+      break;
+  }
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& arg_types = exec_state->GetScalarUDFDefinition(fn.udf_id())->exec_arguments();
+  absl::StrAppend(key, fn.name(), ":", static_cast<int>(type), "(");
+  for (const auto& [i, arg] : Enumerate(fn.arg_deps())) {
+    if (i > 0) {
+      key->push_back(',');
+    }
+    AppendExpressionShape(exec_state, *arg, arg_types[i], key, leaves);
+  }
+  key->push_back(')');
+}
+
+// Emits the instructions that evaluate expr into kernel and returns the slot that holds its value.
+int64_t EmitKernelInstructions(ExecState* exec_state, const plan::ScalarExpression& expr,
+                               types::DataType type, int64_t* next_leaf, CompiledKernel* kernel) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    kernel->leaf_types[*next_leaf] = ToKernelValueType(type).value();
+    return (*next_leaf)++;
+  }
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  std::vector<int64_t> arg_slots;
+  for (const auto& [i, arg] : Enumerate(fn.arg_deps())) {
+    arg_slots.push_back(
+        EmitKernelInstructions(exec_state, *arg, def->exec_arguments()[i], next_leaf, kernel));
+  }
+  kernel->instructions.push_back(
+      {LookupKernel(fn.name(), def->exec_arguments(), def->exec_return_type()),
+       std::move(arg_slots), ToKernelValueType(def->exec_return_type()).value()});
+  return kernel->leaf_types.size() + kernel->instructions.size() - 1;
+}
+
+template <typename TBuilder, typename TValue>
+StatusOr<std::shared_ptr<arrow::Array>> KernelOutputToArrow(TBuilder* builder, const void* data,
+                                                            size_t num_rows) {
+  PX_RETURN_IF_ERROR(builder->AppendValues(static_cast<const TValue*>(data), num_rows));
+  std::shared_ptr<arrow::Array> arr;
+  PX_RETURN_IF_ERROR(builder->Finish(&arr));
+  return arr;
+}
+
+// PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+StatusOr<std::shared_ptr<arrow::Array>> KernelOutputToArrow(types::DataType type, const void* data,
+                                                            size_t num_rows,
+                                                            arrow::MemoryPool* mem_pool) {
+  switch (type) {
+    case types::BOOLEAN: {
+      arrow::BooleanBuilder builder(mem_pool);
+      return KernelOutputToArrow<arrow::BooleanBuilder, uint8_t>(&builder, data, num_rows);
+    }
+    case types::INT64: {
+      arrow::Int64Builder builder(mem_pool);
+      return KernelOutputToArrow<arrow::Int64Builder, int64_t>(&builder, data, num_rows);
+    }
+    case types::FLOAT64: {
+      arrow::DoubleBuilder builder(mem_pool);
+      return KernelOutputToArrow<arrow::DoubleBuilder, double>(&builder, data, num_rows);
+    }
+    case types::TIME64NS: {
+      arrow::Time64Builder builder(arrow::time64(arrow::TimeUnit::NANO), mem_pool);
+      return KernelOutputToArrow<arrow::Time64Builder, int64_t>(&builder, data, num_rows);
+    }
+    default:
+      return error::Internal("Compiled kernels can't output type $0", types::ToString(type));
+  }
+}
+
+template <typename TWrapper, typename TValue>
+SharedColumnWrapper KernelOutputToColumnWrapper(const void* data, size_t num_rows) {
+  auto wrapper = std::make_shared<TWrapper>(num_rows);
+  const auto* values = static_cast<const TValue*>(data);
+  for (size_t i = 0; i < num_rows; ++i) {
+    (*wrapper)[i] = values[i];
+  }
+  return wrapper;
+}
+
+// PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+StatusOr<SharedColumnWrapper> KernelOutputToColumnWrapper(types::DataType type, const void* data,
+                                                          size_t num_rows) {
+  switch (type) {
+    case types::BOOLEAN:
+      return KernelOutputToColumnWrapper<BoolValueColumnWrapper, uint8_t>(data, num_rows);
+    case types::INT64:
+      return KernelOutputToColumnWrapper<Int64ValueColumnWrapper, int64_t>(data, num_rows);
+    case types::FLOAT64:
+      return KernelOutputToColumnWrapper<Float64ValueColumnWrapper, double>(data, num_rows);
+    case types::TIME64NS:
+      return KernelOutputToColumnWrapper<Time64NSValueColumnWrapper, int64_t>(data, num_rows);
+    default:
+      return error::Internal("Compiled kernels can't output type $0", types::ToString(type));
+  }
+}
+
+}  // namespace
+
+Status CompiledScalarExpressionEvaluator::Open(ExecState* exec_state) {
+  PX_RETURN_IF_ERROR(VectorNativeScalarExpressionEvaluator::Open(exec_state));
+  for (const auto& expr : expressions_) {
+    CompileSubtrees(exec_state, *expr);
+  }
+  return Status::OK();
+}
+
+bool CompiledScalarExpressionEvaluator::CanCompile(ExecState* exec_state,
+                                                   const plan::ScalarExpression& expr) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return false;
+  }
+  auto it = can_compile_.find(&expr);
+  if (it != can_compile_.end()) {
+    return it->second;
+  }
+
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  if (def == nullptr) {
+    can_compile_[&expr] = false;
+    return false;
+  }
+  // The UDF's own argument types are what its inputs actually are, so those are what the kernels
+  // are compiled for.
+  const auto& arg_types = def->exec_arguments();
+  // Functions with init arguments are stateful, so they always go through their UDF.
+  bool can_compile = fn.init_arguments().empty() && arg_types.size() == fn.arg_deps().size() &&
+                     LookupKernel(fn.name(), arg_types, def->exec_return_type()) != nullptr;
+  for (const auto& [i, arg] : Enumerate(fn.arg_deps())) {
+    switch (arg->ExpressionType()) {
+      case plan::Expression::kColumn:
+        break;
+      case plan::Expression::kConstant: {
+        auto constant_type = static_cast<const plan::ScalarValue&>(*arg).DataType();
+        can_compile = can_compile && i < arg_types.size() &&
+                      ToKernelValueType(constant_type) == ToKernelValueType(arg_types[i]);
+        break;
+      }
+      case plan::Expression::kFunc: {
+        // Always recurse so that every node has an entry in can_compile_.
+        bool arg_can_compile = CanCompile(exec_state, *arg);
+        if (!can_compile || !arg_can_compile) {
+          can_compile = false;
+          break;
+        }
+        auto arg_fn_id = static_cast<const plan::ScalarFunc&>(*arg).udf_id();
+        auto arg_return_type = exec_state->GetScalarUDFDefinition(arg_fn_id)->exec_return_type();
+        can_compile = ToKernelValueType(arg_return_type) == ToKernelValueType(arg_types[i]);
+        break;
+      }
+      default:
+        can_compile = false;
+    }
+  }
+  can_compile_[&expr] = can_compile;
+  return can_compile;
+}
+
+void CompiledScalarExpressionEvaluator::CompileSubtrees(ExecState* exec_state,
+                                                        const plan::ScalarExpression& expr) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return;
+  }
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  if (CanCompile(exec_state, fn)) {
+    BindKernel(exec_state, fn);
+    return;
+  }
+  for (const auto& arg : fn.arg_deps()) {
+    CompileSubtrees(exec_state, *arg);
+  }
+}
+
+void CompiledScalarExpressionEvaluator::BindKernel(ExecState* exec_state,
+                                                   const plan::ScalarFunc& fn) {
+  BoundKernel bound;
+  bound.return_type = exec_state->GetScalarUDFDefinition(fn.udf_id())->exec_return_type();
+  std::string key;
+  AppendExpressionShape(exec_state, fn, bound.return_type, &key, &bound.leaves);
+  auto num_leaves = bound.leaves.size();
+  bound.kernel = CompiledKernelCache::Global()->GetOrCompile(key, [&]() {
+    auto kernel = std::make_unique<CompiledKernel>();
+    kernel->leaf_types.resize(num_leaves);
+    int64_t next_leaf = 0;
+    EmitKernelInstructions(exec_state, fn, bound.return_type, &next_leaf, kernel.get());
+    return kernel;
+  });
+  compiled_.emplace(&fn, std::move(bound));
+}
+
+StatusOr<const void*> CompiledScalarExpressionEvaluator::RunKernel(const RowBatch& input,
+                                                                   const BoundKernel& bound) {
+  const auto& kernel = *bound.kernel;
+  size_t num_rows = input.num_rows();
+  size_t num_leaves = kernel.leaf_types.size();
+  if (slot_buffers_.size() < static_cast<size_t>(kernel.num_slots())) {
+    slot_buffers_.resize(kernel.num_slots());
+  }
+  std::vector<KernelOperand> operands(kernel.num_slots());
+
+  for (size_t i = 0; i < num_leaves; ++i) {
+    const auto* leaf = bound.leaves[i];
+    auto leaf_type = kernel.leaf_types[i];
+    auto& buf = slot_buffers_[i];
+    if (leaf->ExpressionType() == plan::Expression::kConstant) {
+      const auto& val = static_cast<const plan::ScalarValue&>(*leaf);
+      buf.resize(1);
+      switch (leaf_type) {
+        case KernelValueType::kInt64:
+          buf[0] = val.DataType() == types::TIME64NS ? val.Time64NSValue() : val.Int64Value();
+          break;
+        case KernelValueType::kFloat64: {
+          double float_val = val.Float64Value();
+          std::memcpy(buf.data(), &float_val, sizeof(float_val));
+          break;
+        }
+        case KernelValueType::kBool: {
+          uint8_t bool_val = val.BoolValue();
+          std::memcpy(buf.data(), &bool_val, sizeof(bool_val));
+          break;
+        }
+      }
+      operands[i] = {buf.data(), true};
+      continue;
+    }
+
+    const auto& col = static_cast<const plan::Column&>(*leaf);
+    const auto& arr = input.ColumnAt(col.Index());
+    auto arr_type = ArrowToDataType(arr->type_id());
+    if (ToKernelValueType(arr_type) != leaf_type) {
+      return error::Internal("Column $0 has type $1, which doesn't match the compiled expression",
+                             col.Index(), types::ToString(arr_type));
+    }
+    switch (leaf_type) {
+      case KernelValueType::kInt64:
+        operands[i] = {arr->data()->GetValues<int64_t>(1), false};
+        break;
+      case KernelValueType::kFloat64:
+        operands[i] = {arr->data()->GetValues<double>(1), false};
+        break;
+      case KernelValueType::kBool: {
+        // Arrow booleans are bit packed, but kernels use a byte per value.
+        const auto* bool_arr = static_cast<const arrow::BooleanArray*>(arr.get());
+        buf.resize(std::max<size_t>(num_rows, 1));
+        auto* bytes = reinterpret_cast<uint8_t*>(buf.data());
+        for (size_t row = 0; row < num_rows; ++row) {
+          bytes[row] = bool_arr->Value(row);
+        }
+        operands[i] = {buf.data(), false};
+        break;
+      }
+    }
+  }
+
+  std::vector<KernelOperand> args;
+  for (const auto& [i, instruction] : Enumerate(kernel.instructions)) {
+    size_t slot = num_leaves + i;
+    // Every slot is sized for int64 values, which is the widest kernel value type.
+    auto& buf = slot_buffers_[slot];
+    buf.resize(std::max<size_t>(num_rows, 1));
+    args.clear();
+    for (auto arg_slot : instruction.arg_slots) {
+      args.push_back(operands[arg_slot]);
+    }
+    instruction.fn(args.data(), num_rows, buf.data());
+    operands[slot] = {buf.data(), false};
+  }
+  return operands.back().data;
+}
+
+StatusOr<SharedColumnWrapper> CompiledScalarExpressionEvaluator::EvaluateSingleExpression(
+    ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr) {
+  size_t num_rows = input.num_rows();
+  auto it = compiled_.find(&expr);
+  if (it != compiled_.end()) {
+    PX_ASSIGN_OR_RETURN(auto data, RunKernel(input, it->second));
+    return KernelOutputToColumnWrapper(it->second.return_type, data, num_rows);
+  }
+
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kConstant:
+      return EvalScalarToColumnWrapper(exec_state, static_cast<const plan::ScalarValue&>(expr),
+                                       num_rows);
+    case plan::Expression::kColumn:
+      return ColumnWrapper::FromArrow(
+          input.ColumnAt(static_cast<const plan::Column&>(expr).Index()));
+    case plan::Expression::kFunc:
+      break;
+    default:
+      return error::Internal("Unexpected expression type in scalar expression");
+  }
+
+  // This function has no compiled form, so evaluate it with its UDF. Its arguments may still have
+  // been compiled.
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  std::vector<SharedColumnWrapper> children;
+  std::vector<const ColumnWrapper*> raw_children;
+  children.reserve(fn.arg_deps().size());
+  for (const auto& arg : fn.arg_deps()) {
+    PX_ASSIGN_OR_RETURN(auto child, EvaluateSingleExpression(exec_state, input, *arg));
+    raw_children.push_back(child.get());
+    children.push_back(std::move(child));
+  }
+  auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  auto udf = id_to_udf_map_[fn.udf_id()].get();
+  auto output = ColumnWrapper::Make(def->exec_return_type(), num_rows);
+  PX_RETURN_IF_ERROR(def->ExecBatch(udf, function_ctx_, raw_children, output.get(), num_rows));
+  return output;
+}
+
+Status CompiledScalarExpressionEvaluator::EvaluateSingleExpression(ExecState* exec_state,
+                                                                   const RowBatch& input,
+                                                                   const plan::ScalarExpression& expr,
+                                                                   RowBatch* output) {
+  auto it = compiled_.find(&expr);
+  if (it == compiled_.end()) {
+    // Constants and columns are copied directly, anything else goes through column wrappers.
+    return VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(exec_state, input, expr,
+                                                                           output);
+  }
+  PX_ASSIGN_OR_RETURN(auto data, RunKernel(input, it->second));
+  PX_ASSIGN_OR_RETURN(auto arr, KernelOutputToArrow(it->second.return_type, data,
+                                                    input.num_rows(),
+                                                    exec_state->exec_mem_pool()));
+  PX_RETURN_IF_ERROR(output->AddColumn(arr));
+  return Status::OK();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -26,6 +26,9 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/exec/compiled_expression.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -34,6 +37,8 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_compiled_expressions);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -89,6 +94,7 @@ class ExpressionEvaluator {
 enum class ScalarExpressionEvaluatorType : uint8_t {
   kVectorNative = 0,
   kArrowNative = 1,
+  kCompiled = 2,
 };
 
 /**
@@ -141,7 +147,7 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
   Status Open(ExecState* exec_state) override;
   Status Close(ExecState* exec_state) override;
 
-  StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
+  virtual StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
       ExecState* exec_state, const table_store::schema::RowBatch& input,
       const plan::ScalarExpression& expr);
 
@@ -151,6 +157,54 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
                                   table_store::schema::RowBatch* output) override;
 };
 
+/**
+ * A scalar expression evaluator that compiles trees of arithmetic, comparison and boolean functions
+ * over primitive types into CompiledKernels, which evaluate the whole tree in a single pass of
+ * type specialized loops over the raw column buffers. Functions that don't have a compiled form are
+ * evaluated through their UDF wrappers, as in VectorNativeScalarExpressionEvaluator, with any
+ * compilable subtrees of their arguments still evaluated by compiled kernels.
+ */
+class CompiledScalarExpressionEvaluator : public VectorNativeScalarExpressionEvaluator {
+ public:
+  explicit CompiledScalarExpressionEvaluator(const plan::ConstScalarExpressionVector& expressions,
+                                             udf::FunctionContext* function_ctx)
+      : VectorNativeScalarExpressionEvaluator(expressions, function_ctx) {}
+
+  Status Open(ExecState* exec_state) override;
+
+  StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
+      ExecState* exec_state, const table_store::schema::RowBatch& input,
+      const plan::ScalarExpression& expr) override;
+
+  // Returns the number of (maximal) subtrees of the expressions that were compiled.
+  size_t num_compiled_subtrees() const { return compiled_.size(); }
+
+ protected:
+  Status EvaluateSingleExpression(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                                  const plan::ScalarExpression& expr,
+                                  table_store::schema::RowBatch* output) override;
+
+ private:
+  // A compiled kernel along with the leaves of the subtree it was compiled from.
+  struct BoundKernel {
+    std::shared_ptr<const CompiledKernel> kernel;
+    std::vector<const plan::ScalarExpression*> leaves;
+    types::DataType return_type;
+  };
+
+  bool CanCompile(ExecState* exec_state, const plan::ScalarExpression& expr);
+  void CompileSubtrees(ExecState* exec_state, const plan::ScalarExpression& expr);
+  void BindKernel(ExecState* exec_state, const plan::ScalarFunc& fn);
+  // Runs the kernel and returns a pointer to its output, which is valid until the next call.
+  StatusOr<const void*> RunKernel(const table_store::schema::RowBatch& input,
+                                  const BoundKernel& bound);
+
+  absl::flat_hash_map<const plan::ScalarExpression*, bool> can_compile_;
+  absl::flat_hash_map<const plan::ScalarExpression*, BoundKernel> compiled_;
+  // Scratch space for kernel slots, reused across row batches.
+  std::vector<std::vector<int64_t>> slot_buffers_;
+};
+
 /**
  * A scalar expression evaluator that uses Arrow arrays for intermediate state.
  */
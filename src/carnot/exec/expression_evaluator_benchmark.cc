@@ -141,6 +141,11 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_native,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_compiled,
+                  ScalarExpressionEvaluatorType::kCompiled, kAddScalarFuncNestedPbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_arrow,
                   ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
@@ -149,3 +154,7 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
                   ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_compiled,
+                  ScalarExpressionEvaluatorType::kCompiled, kAddScalarFuncPbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
@@ -60,6 +60,18 @@ class AddUDF : public udf::ScalarUDF {
   }
 };
 
+class GreaterThanUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val > v2.val;
+  }
+};
+
+class IntToStringUDF : public udf::ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::Int64Value v) { return std::to_string(v.val); }
+};
+
 class InitArgUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -116,6 +128,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
     EXPECT_TRUE(func_registry_->Register<AddUDF>("add").ok());
     EXPECT_TRUE(func_registry_->Register<InitArgUDF>("init_arg").ok());
+    EXPECT_TRUE(func_registry_->Register<GreaterThanUDF>("greaterThan").ok());
+    EXPECT_TRUE(func_registry_->Register<IntToStringUDF>("int_to_string").ok());
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
                                               MockResultSinkStubGenerator, MockMetricsStubGenerator,
                                               MockTraceStubGenerator, sole::uuid4(), nullptr);
@@ -123,6 +137,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
         0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
     EXPECT_OK(
         exec_state_->AddScalarUDF(1, "init_arg", {types::STRING, types::INT64, types::STRING}));
+    EXPECT_OK(exec_state_->AddScalarUDF(2, "greaterThan", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(3, "int_to_string", {types::INT64}));
 
     std::vector<types::Int64Value> in1 = {1, 2, 3};
     std::vector<types::Int64Value> in2 = {3, 4, 5};
@@ -158,7 +174,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
 INSTANTIATE_TEST_SUITE_P(TestVecAndArrow, ScalarExpressionTest,
                          ::testing::Values(ScalarExpressionEvaluatorType::kVectorNative,
-                                           ScalarExpressionEvaluatorType::kArrowNative));
+                                           ScalarExpressionEvaluatorType::kArrowNative,
+                                           ScalarExpressionEvaluatorType::kCompiled));
 
 TEST_P(ScalarExpressionTest, basic_tests) {
   RowDescriptor rd_output({types::DataType::INT64});
@@ -270,6 +287,134 @@ TEST_P(ScalarExpressionTest, eval_init_arg_udf) {
   EXPECT_EQ("init_arg, 1234, c", casted->GetString(2));
 }
 
+// greaterThan(add(col0, col1), 7)
+constexpr char kGreaterThanAddPbtxt[] = R"pb(
+func {
+  name: "greaterThan"
+  id: 2
+  args {
+    func {
+      name: "add"
+      id: 0
+      args { column { node: 0 index: 0 } }
+      args { column { node: 0 index: 1 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args {
+    constant { data_type: INT64 int64_value: 7 }
+  }
+  args_data_types: INT64
+  args_data_types: INT64
+}
+)pb";
+
+TEST_P(ScalarExpressionTest, eval_comparison_of_nested_func) {
+  RowDescriptor rd_output({types::DataType::BOOLEAN});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+
+  auto se = ScalarExpressionOf(kGreaterThanAddPbtxt);
+  RunEvaluator({se}, &output_rb);
+
+  auto out_col = output_rb.ColumnAt(0);
+  EXPECT_EQ(3, out_col->length());
+  auto casted = static_cast<arrow::BooleanArray*>(out_col.get());
+  EXPECT_FALSE(casted->Value(0));
+  EXPECT_FALSE(casted->Value(1));
+  EXPECT_TRUE(casted->Value(2));
+}
+
+// int_to_string(add(col0, col1))
+constexpr char kIntToStringOfAddPbtxt[] = R"pb(
+func {
+  name: "int_to_string"
+  id: 3
+  args {
+    func {
+      name: "add"
+      id: 0
+      args { column { node: 0 index: 0 } }
+      args { column { node: 0 index: 1 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args_data_types: INT64
+}
+)pb";
+
+TEST_P(ScalarExpressionTest, eval_udf_of_nested_func) {
+  RowDescriptor rd_output({types::DataType::STRING});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+
+  auto se = ScalarExpressionOf(kIntToStringOfAddPbtxt);
+  RunEvaluator({se}, &output_rb);
+
+  auto out_col = output_rb.ColumnAt(0);
+  EXPECT_EQ(3, out_col->length());
+  auto casted = static_cast<arrow::StringArray*>(out_col.get());
+  EXPECT_EQ("4", casted->GetString(0));
+  EXPECT_EQ("6", casted->GetString(1));
+  EXPECT_EQ("8", casted->GetString(2));
+}
+
+using CompiledScalarExpressionTest = ScalarExpressionTest;
+
+TEST_F(CompiledScalarExpressionTest, compiles_maximal_subtrees) {
+  function_ctx_ = std::make_unique<udf::FunctionContext>(nullptr, nullptr);
+
+  // The whole tree has a compiled form.
+  CompiledScalarExpressionEvaluator compiled({ScalarExpressionOf(kGreaterThanAddPbtxt)},
+                                             function_ctx_.get());
+  ASSERT_OK(compiled.Open(exec_state_.get()));
+  EXPECT_EQ(1, compiled.num_compiled_subtrees());
+
+  // Only the argument of int_to_string can be compiled.
+  CompiledScalarExpressionEvaluator fallback({ScalarExpressionOf(kIntToStringOfAddPbtxt)},
+                                             function_ctx_.get());
+  ASSERT_OK(fallback.Open(exec_state_.get()));
+  EXPECT_EQ(1, fallback.num_compiled_subtrees());
+
+  // Functions with init args are never compiled.
+  CompiledScalarExpressionEvaluator init_arg({ScalarExpressionOf(kInitArgScalarFunc)},
+                                             function_ctx_.get());
+  ASSERT_OK(init_arg.Open(exec_state_.get()));
+  EXPECT_EQ(0, init_arg.num_compiled_subtrees());
+}
+
+TEST_F(CompiledScalarExpressionTest, kernels_are_cached_by_shape) {
+  function_ctx_ = std::make_unique<udf::FunctionContext>(nullptr, nullptr);
+  auto cache = CompiledKernelCache::Global();
+  cache->Clear();
+
+  CompiledScalarExpressionEvaluator first({ScalarExpressionOf(kAddScalarFuncPbtxt)},
+                                          function_ctx_.get());
+  ASSERT_OK(first.Open(exec_state_.get()));
+  auto misses = cache->misses();
+  auto hits = cache->hits();
+
+  // Same shape, different columns: the compiled kernel is reused.
+  CompiledScalarExpressionEvaluator second({ScalarExpressionOf(R"pb(
+func {
+  name: "add"
+  args { column { node: 0 index: 1 } }
+  args { column { node: 0 index: 0 } }
+  args_data_types: INT64
+  args_data_types: INT64
+})pb")},
+                                           function_ctx_.get());
+  ASSERT_OK(second.Open(exec_state_.get()));
+  EXPECT_EQ(misses, cache->misses());
+  EXPECT_EQ(hits + 1, cache->hits());
+
+  // A constant instead of a column is a different shape.
+  CompiledScalarExpressionEvaluator third({ScalarExpressionOf(kAddScalarFuncConstPbtxt)},
+                                          function_ctx_.get());
+  ASSERT_OK(third.Open(exec_state_.get()));
+  EXPECT_EQ(misses + 1, cache->misses());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
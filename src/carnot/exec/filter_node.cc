@@ -60,8 +60,14 @@ Status FilterNode::InitImpl(const plan::Operator& plan_node) {
 
 Status FilterNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
-  evaluator_ = std::make_unique<VectorNativeScalarExpressionEvaluator>(
-      plan::ConstScalarExpressionVector{plan_node_->expression()}, function_ctx_.get());
+  plan::ConstScalarExpressionVector expressions{plan_node_->expression()};
+  if (FLAGS_carnot_compiled_expressions) {
+    evaluator_ =
+        std::make_unique<CompiledScalarExpressionEvaluator>(expressions, function_ctx_.get());
+  } else {
+    evaluator_ =
+        std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx_.get());
+  }
   return Status::OK();
 }
 
@@ -77,11 +83,11 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
 
 template <types::DataType T>
 Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
+                           arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
   DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
   size_t num_output_records = output_rb->num_rows();
   size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto output_col_builder_generic = MakeArrowBuilder(T, mem_pool);
   auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
       output_col_builder_generic.get());
   PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
@@ -98,7 +104,8 @@ Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arro
 
 template <>
 Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
+                                          const arrow::Array* input_col,
+                                          arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
   DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
   size_t num_output_records = output_rb->num_rows();
   size_t num_input_records = input_col->length();
@@ -106,7 +113,7 @@ Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& p
       100;  // This can be an arbritrary number, since we do exponential doubling below.
   size_t total_size = 0;
 
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
+  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, mem_pool);
   auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
       output_col_builder_generic.get());
 
@@ -158,8 +165,9 @@ Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, si
   for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
     auto input_col = rb.ColumnAt(input_col_idx);
     auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PX_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
+#define TYPE_CASE(_dt_)                                                                  \
+  PX_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(),        \
+                                               exec_state->exec_mem_pool(), &output_rb));
     PX_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
 #undef TYPE_CASE
   }
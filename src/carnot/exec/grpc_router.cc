@@ -21,7 +21,9 @@
 #include <algorithm>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <absl/base/internal/spinlock.h>
 #include <absl/container/flat_hash_map.h>
@@ -35,13 +37,41 @@ namespace px {
 namespace carnot {
 namespace exec {
 
-GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* query_tracker,
-                                                                int64_t source_id) {
+bool GRPCRouter::SourceNodeTracker::TryEnqueue(
+    std::unique_ptr<carnotpb::TransferResultChunkRequest>* req, Status* status) {
+  // DetachSourceNode unsets source_node before it waits for num_enqueuers to drop to 0, so the
+  // node can't be deleted while it is used here.
+  num_enqueuers.fetch_add(1);
+  GRPCSourceNode* node = source_node.load();
+  if (node != nullptr) {
+    node->set_upstream_initiated_connection();
+    *status = node->EnqueueRowBatch(std::move(*req));
+  }
+  num_enqueuers.fetch_sub(1);
+  return node != nullptr;
+}
+
+void GRPCRouter::SourceNodeTracker::DetachSourceNode() {
+  {
+    absl::base_internal::SpinLockHolder snt_lock(&node_lock);
+    source_node.store(nullptr);
+  }
+  while (num_enqueuers.load() > 0) {
+    std::this_thread::yield();
+  }
+}
+
+std::shared_ptr<GRPCRouter::SourceNodeTracker> GRPCRouter::GetSourceNodeTracker(
+    QueryTracker* query_tracker, int64_t source_id) {
   absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
-  return &query_tracker->source_node_trackers[source_id];
+  auto& snt = query_tracker->source_node_trackers[source_id];
+  if (snt == nullptr) {
+    snt = std::make_shared<SourceNodeTracker>();
+  }
+  return snt;
 }
 
-Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
+Status GRPCRouter::EnqueueRowBatch(TransferResultChunkState* state,
                                    std::unique_ptr<carnotpb::TransferResultChunkRequest> req) {
   if (!req->has_query_result() || !req->query_result().has_row_batch() ||
       req->query_result().destination_case() !=
@@ -51,35 +81,46 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
         "with a GPRC source ID.");
   }
 
-  auto snt = GetSourceNodeTracker(query_tracker, req->query_result().grpc_source_id());
-  {
+  int64_t source_id = req->query_result().grpc_source_id();
+  if (state->source_node_tracker == nullptr || state->source_node_id != source_id) {
+    state->source_node_tracker = GetSourceNodeTracker(state->query_tracker.get(), source_id);
+  }
+  state->source_node_id = source_id;
+  auto* snt = state->source_node_tracker.get();
+
+  Status s;
+  if (!snt->TryEnqueue(&req, &s)) {
     absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+    auto* source_node = snt->source_node.load();
     // It's possible that we see row batches before we have gotten information about the query. To
     // solve this race, We store a backlog of all the pending batches.
-    if (snt->source_node == nullptr) {
+    if (source_node == nullptr) {
       snt->connection_initiated_by_sink = true;
       snt->response_backlog.emplace_back(std::move(req));
       return Status::OK();
     }
-    snt->source_node->set_upstream_initiated_connection();
-    PX_RETURN_IF_ERROR(snt->source_node->EnqueueRowBatch(std::move(req)));
+    // The source node was registered after TryEnqueue.
+    source_node->set_upstream_initiated_connection();
+    s = source_node->EnqueueRowBatch(std::move(req));
   }
-  query_tracker->RestartExecution();
+  PX_RETURN_IF_ERROR(s);
+  state->query_tracker->RestartExecution();
   return Status::OK();
 }
 
 void GRPCRouter::MarkResultStreamClosed(QueryTracker* query_tracker, int64_t source_id) {
   auto snt = GetSourceNodeTracker(query_tracker, source_id);
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+  auto* source_node = snt->source_node.load();
   // It's possible that we see row batches before we have gotten information about the query. To
   // solve this race, We store a backlog of all the pending batches.
-  if (snt->source_node == nullptr) {
+  if (source_node == nullptr) {
     DCHECK(!snt->connection_closed_by_sink);
     snt->connection_closed_by_sink = true;
     return;
   }
-  DCHECK(!snt->source_node->upstream_closed_connection());
-  snt->source_node->set_upstream_closed_connection();
+  DCHECK(!source_node->upstream_closed_connection());
+  source_node->set_upstream_closed_connection();
   return;
 }
 
@@ -104,7 +145,9 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
     std::unique_ptr<carnotpb::TransferResultChunkRequest> req, ::grpc::ServerContext* context,
     TransferResultChunkState* state) {
   auto query_id = px::ParseUUID(req->query_id()).ConsumeValueOrDie();
-  {
+  bool has_query_tracker = state->query_tracker != nullptr && state->query_id == query_id &&
+                           !state->query_tracker->deleted.load();
+  if (!has_query_tracker) {
     absl::base_internal::SpinLockHolder lock(&id_to_query_tracker_map_lock_);
     if (!id_to_query_tracker_map_.contains(query_id)) {
       if (!req->has_initiate_conn()) {
@@ -114,7 +157,9 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
       }
       id_to_query_tracker_map_[query_id] = std::make_shared<QueryTracker>();
     }
+    state->query_id = query_id;
     state->query_tracker = id_to_query_tracker_map_[query_id];
+    state->source_node_tracker = nullptr;
   }
 
   if (!state->registered_server_context) {
@@ -140,8 +185,7 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
   }
   if (req->has_query_result() && req->query_result().has_row_batch()) {
     state->stream_has_query_results = true;
-    state->source_node_id = req->query_result().grpc_source_id();
-    auto s = EnqueueRowBatch(state->query_tracker.get(), std::move(req));
+    auto s = EnqueueRowBatch(state, std::move(req));
     if (!s.ok()) {
       return ::grpc::Status(grpc::StatusCode::INTERNAL, "failed to enqueue batch");
     }
@@ -223,19 +267,21 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
   auto snt = GetSourceNodeTracker(query_tracker.get(), source_id);
 
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
-  snt->source_node = source_node;
   if (snt->connection_initiated_by_sink) {
     source_node->set_upstream_initiated_connection();
   }
   if (snt->response_backlog.size() > 0) {
     for (auto& rb : snt->response_backlog) {
-      PX_RETURN_IF_ERROR(snt->source_node->EnqueueRowBatch(std::move(rb)));
+      PX_RETURN_IF_ERROR(source_node->EnqueueRowBatch(std::move(rb)));
     }
     snt->response_backlog.clear();
   }
   if (snt->connection_closed_by_sink) {
     source_node->set_upstream_closed_connection();
   }
+  // Streams only enqueue on the node without node_lock after the backlog was handed to it, which
+  // keeps the batches in order.
+  snt->source_node.store(source_node);
 
   return Status::OK();
 }
@@ -269,13 +315,19 @@ Status GRPCRouter::DeleteGRPCSourceNode(sole::uuid query_id, int64_t source_id)
     query_tracker = id_to_query_tracker_map_[query_id];
   }
 
-  absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
-  auto it = query_tracker->source_node_trackers.find(source_id);
-  if (it == query_tracker->source_node_trackers.end()) {
-    return error::Internal("Query map for query ID $0 does not contain GRPC source $1",
-                           query_id.str(), source_id);
+  std::shared_ptr<SourceNodeTracker> snt;
+  {
+    absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
+    auto it = query_tracker->source_node_trackers.find(source_id);
+    if (it == query_tracker->source_node_trackers.end()) {
+      return error::Internal("Query map for query ID $0 does not contain GRPC source $1",
+                             query_id.str(), source_id);
+    }
+    snt = std::move(it->second);
+    query_tracker->source_node_trackers.erase(it);
   }
-  query_tracker->source_node_trackers.erase(it);
+  // A stream may still hold on to the tracker, so the node must not be used past this point.
+  snt->DetachSourceNode();
   return Status::OK();
 }
 
@@ -293,11 +345,23 @@ void GRPCRouter::DeleteQuery(sole::uuid query_id) {
     query_tracker = it->second;
     id_to_query_tracker_map_.erase(it);
   }
-  absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
-  query_tracker->ResetRestartExecutionFunc();
-  // For any active input streams for this query, mark their context as cancelled.
-  for (auto ctx : query_tracker->active_agent_contexts) {
-    ctx->TryCancel();
+  query_tracker->deleted.store(true);
+  std::vector<std::shared_ptr<SourceNodeTracker>> source_node_trackers;
+  {
+    absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
+    query_tracker->ResetRestartExecutionFunc();
+    // For any active input streams for this query, mark their context as cancelled.
+    for (auto ctx : query_tracker->active_agent_contexts) {
+      ctx->TryCancel();
+    }
+    for (const auto& [source_id, snt] : query_tracker->source_node_trackers) {
+      source_node_trackers.push_back(snt);
+    }
+  }
+  // The source nodes are deleted with the query, so streams that are still running must not
+  // enqueue on them anymore.
+  for (const auto& snt : source_node_trackers) {
+    snt->DetachSourceNode();
   }
 }
 
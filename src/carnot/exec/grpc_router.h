@@ -19,6 +19,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -110,7 +111,12 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    */
   struct SourceNodeTracker {
     SourceNodeTracker() = default;
-    GRPCSourceNode* source_node GUARDED_BY(node_lock) = nullptr;
+    // Set once the source node is registered and the backlog was handed to it. From then on, row
+    // batches are enqueued on the node without taking node_lock, since the queue of the node is
+    // safe to use concurrently.
+    std::atomic<GRPCSourceNode*> source_node = nullptr;
+    // The number of streams that are enqueuing on source_node without holding node_lock.
+    std::atomic<int64_t> num_enqueuers = 0;
     // connection_initiated_by_sink and connection_closed_by_sink are true when the
     // grpc sink (aka the client) initiates the query result stream or closes a query result stream,
     // respectively.
@@ -119,6 +125,13 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     std::vector<std::unique_ptr<::px::carnotpb::TransferResultChunkRequest>> response_backlog
         GUARDED_BY(node_lock);
     absl::base_internal::SpinLock node_lock;
+
+    // Enqueues the row batch on the source node if one is registered. Returns false, and leaves
+    // req untouched, otherwise.
+    bool TryEnqueue(std::unique_ptr<::px::carnotpb::TransferResultChunkRequest>* req,
+                    Status* status);
+    // Unregisters the source node, and waits until no stream is enqueuing on it anymore.
+    void DetachSourceNode();
   };
 
   /**
@@ -126,7 +139,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    */
   struct QueryTracker {
     QueryTracker() : create_time(std::chrono::steady_clock::now()) {}
-    absl::node_hash_map<int64_t, SourceNodeTracker> source_node_trackers GUARDED_BY(query_lock);
+    absl::flat_hash_map<int64_t, std::shared_ptr<SourceNodeTracker>> source_node_trackers
+        GUARDED_BY(query_lock);
     const std::chrono::steady_clock::time_point create_time GUARDED_BY(query_lock);
     std::function<void()> restart_execution_func_ GUARDED_BY(query_lock);
     // The set of agents we've seen for the query.
@@ -138,6 +152,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     // Errors that occur during execution from parent_agents.
     std::vector<statuspb::Status> upstream_exec_errors GUARDED_BY(query_lock);
     absl::base_internal::SpinLock query_lock;
+    // Set when the query is deleted, for the streams that still hold on to the tracker.
+    std::atomic<bool> deleted = false;
 
     void ResetRestartExecutionFunc() ABSL_EXCLUSIVE_LOCKS_REQUIRED(query_lock) {
       restart_execution_func_ = std::function<void()>();
@@ -156,17 +172,21 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     }
   };
 
-  Status EnqueueRowBatch(QueryTracker* query_tracker,
-                         std::unique_ptr<carnotpb::TransferResultChunkRequest> req);
-
   struct TransferResultChunkState {
     int64_t source_node_id = 0;
     bool registered_server_context = false;
     // stream_has_query_results informs downstream source nodes about the health of the stream.
     // When true, the particular TransferResultChunk call has initiated the query stream.
     bool stream_has_query_results = false;
+    // The trackers are kept for the whole stream, so that the messages after the first one don't
+    // go through id_to_query_tracker_map_lock_ and query_lock.
+    sole::uuid query_id;
     std::shared_ptr<QueryTracker> query_tracker = nullptr;
+    std::shared_ptr<SourceNodeTracker> source_node_tracker = nullptr;
   };
+
+  Status EnqueueRowBatch(TransferResultChunkState* state,
+                         std::unique_ptr<carnotpb::TransferResultChunkRequest> req);
   ::grpc::Status HandleTransferResultChunkMessage(
       std::unique_ptr<::px::carnotpb::TransferResultChunkRequest> req,
       ::grpc::ServerContext* context, TransferResultChunkState* state);
@@ -175,7 +195,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   void RegisterResultStreamContext(QueryTracker* query_tracker, ::grpc::ServerContext* context);
   void MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
                                          ::grpc::ServerContext* context);
-  SourceNodeTracker* GetSourceNodeTracker(QueryTracker* query_tracker, int64_t source_id);
+  std::shared_ptr<SourceNodeTracker> GetSourceNodeTracker(QueryTracker* query_tracker,
+                                                          int64_t source_id);
 
   absl::node_hash_map<sole::uuid, std::shared_ptr<QueryTracker>> id_to_query_tracker_map_
       GUARDED_BY(id_to_query_tracker_map_lock_);
@@ -18,9 +18,11 @@
 
 #include "src/carnot/exec/grpc_sink_node.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
@@ -31,6 +33,25 @@
 #include "src/common/uuid/uuid_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_grpc_sink_max_inflight_requests,
+             gflags::Int32FromEnv("PL_CARNOT_GRPC_SINK_MAX_INFLIGHT_REQUESTS", 4),
+             "The number of serialized result chunks that a GRPC sink queues while an earlier chunk "
+             "is being written. The sink blocks when the queue is full. 0 writes every chunk "
+             "synchronously.");
+DEFINE_bool(carnot_grpc_sink_encode_batches,
+            gflags::BoolFromEnv("PL_CARNOT_GRPC_SINK_ENCODE_BATCHES", false),
+            "Whether GRPC sinks that send row batches to the GRPC sources of other agents "
+            "dictionary encode string columns and delta encode time columns.");
+DEFINE_bool(carnot_grpc_sink_encode_results,
+            gflags::BoolFromEnv("PL_CARNOT_GRPC_SINK_ENCODE_RESULTS", false),
+            "Whether GRPC sinks that send results to the query broker dictionary encode string "
+            "columns and delta encode time columns. The query broker decodes them before results "
+            "are sent to clients, so it must be upgraded before this is turned on.");
+DEFINE_bool(carnot_grpc_sink_compress_results,
+            gflags::BoolFromEnv("PL_CARNOT_GRPC_SINK_COMPRESS_RESULTS", false),
+            "Whether GRPC sinks that send results to the query broker gzip compress the result "
+            "chunks.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -83,10 +104,12 @@ Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(
+      rb->ToProto(req.mutable_query_result()->mutable_row_batch(), encode_columns()));
 
-  PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
-  return Status::OK();
+  // The caller wants to know whether the connection is still alive.
+  PX_RETURN_IF_ERROR(SendRequest(exec_state, std::move(req)));
+  return WaitForSends();
 }
 
 Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
@@ -125,6 +148,9 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_
   if (plan_node_->has_table_name()) {
     // Adding auth to GRPC client.
     exec_state->AddAuthToGRPCClientContext(context_.get());
+    if (FLAGS_carnot_grpc_sink_compress_results) {
+      context_->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+    }
   }
 
   response_.Clear();
@@ -135,13 +161,12 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_
   // initiate_result_stream request.
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(
+      rb->ToProto(req.mutable_query_result()->mutable_row_batch(), encode_columns()));
 
   if (!writer_->Write(req)) {
     return StartConnectionWithRetries(exec_state, n_retries - 1);
   }
-
-  last_send_time_ = std::chrono::system_clock::now();
   return Status::OK();
 }
 
@@ -156,7 +181,6 @@ Status GRPCSinkNode::CancelledByServer(ExecState* exec_state) {
 Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
                                      const carnotpb::TransferResultChunkRequest& req) {
   if (writer_->Write(req)) {
-    last_send_time_ = std::chrono::system_clock::now();
     return Status::OK();
   }
 
@@ -179,11 +203,107 @@ Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
   if (!writer_->Write(req)) {
     return CancelledByServer(exec_state);
   }
+  return Status::OK();
+}
+
+Status GRPCSinkNode::SendRequest(ExecState* exec_state, carnotpb::TransferResultChunkRequest req) {
   last_send_time_ = std::chrono::system_clock::now();
+  if (FLAGS_carnot_grpc_sink_max_inflight_requests <= 0) {
+    return TryWriteRequest(exec_state, req);
+  }
+  auto max_queue_depth = static_cast<size_t>(FLAGS_carnot_grpc_sink_max_inflight_requests);
+  auto* metrics = exec_state->exec_metrics();
+
+  absl::MutexLock lock(&send_mu_);
+  PX_RETURN_IF_ERROR(send_status_);
+  if (!sender_.joinable()) {
+    stop_sender_ = false;
+    sender_ = std::thread(&GRPCSinkNode::SendLoop, this, exec_state);
+  }
+  if (send_queue_.size() >= max_queue_depth) {
+    auto stall_start = std::chrono::steady_clock::now();
+    while (send_status_.ok() && send_queue_.size() >= max_queue_depth) {
+      send_cv_.Wait(&send_mu_);
+    }
+    auto stall_time = std::chrono::steady_clock::now() - stall_start;
+    send_stall_time_ += stall_time;
+    if (metrics != nullptr) {
+      metrics->grpc_sink_send_stall_ns_counter.Increment(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(stall_time).count());
+    }
+    PX_RETURN_IF_ERROR(send_status_);
+  }
+  send_queue_.push_back(std::move(req));
+  max_send_queue_depth_ = std::max(max_send_queue_depth_, send_queue_.size());
+  if (metrics != nullptr) {
+    metrics->grpc_sink_queued_requests_gauge.Increment();
+  }
+  send_cv_.SignalAll();
   return Status::OK();
 }
 
-Status GRPCSinkNode::OpenImpl(ExecState* exec_state) { return StartConnection(exec_state); }
+Status GRPCSinkNode::WaitForSends() {
+  absl::MutexLock lock(&send_mu_);
+  while (send_status_.ok() && (!send_queue_.empty() || sending_)) {
+    send_cv_.Wait(&send_mu_);
+  }
+  return send_status_;
+}
+
+void GRPCSinkNode::SendLoop(ExecState* exec_state) {
+  auto* metrics = exec_state->exec_metrics();
+  send_mu_.Lock();
+  while (true) {
+    while (!stop_sender_ && send_queue_.empty()) {
+      send_cv_.Wait(&send_mu_);
+    }
+    if (send_queue_.empty()) {
+      break;
+    }
+    auto req = std::move(send_queue_.front());
+    send_queue_.pop_front();
+    sending_ = true;
+    // There is room in the queue again.
+    send_cv_.SignalAll();
+    send_mu_.Unlock();
+
+    if (metrics != nullptr) {
+      metrics->grpc_sink_queued_requests_gauge.Decrement();
+    }
+    Status s = TryWriteRequest(exec_state, req);
+
+    send_mu_.Lock();
+    sending_ = false;
+    if (!s.ok()) {
+      // The stream is gone, so the requests that are still queued can't be sent either.
+      send_status_ = s;
+      if (metrics != nullptr) {
+        metrics->grpc_sink_queued_requests_gauge.Decrement(send_queue_.size());
+      }
+      send_queue_.clear();
+    }
+    send_cv_.SignalAll();
+  }
+  send_mu_.Unlock();
+}
+
+void GRPCSinkNode::StopSender() {
+  if (!sender_.joinable()) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&send_mu_);
+    stop_sender_ = true;
+    send_cv_.SignalAll();
+  }
+  sender_.join();
+}
+
+Status GRPCSinkNode::OpenImpl(ExecState* exec_state) {
+  PX_RETURN_IF_ERROR(StartConnection(exec_state));
+  last_send_time_ = std::chrono::system_clock::now();
+  return Status::OK();
+}
 
 Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
   if (writer_ == nullptr) {
@@ -200,9 +320,23 @@ Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
 }
 
 Status GRPCSinkNode::CloseImpl(ExecState* exec_state) {
+  // Let the requests that are already queued go out before the stream is closed.
+  auto send_status = WaitForSends();
+  StopSender();
+  {
+    absl::MutexLock lock(&send_mu_);
+    stats()->AddExtraInfo("max_send_queue_depth", absl::StrCat(max_send_queue_depth_));
+    auto stall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(send_stall_time_);
+    stats()->AddExtraInfo("send_stall_ms", absl::StrCat(stall_ms.count()));
+  }
   if (sent_eos_ || cancelled_) {
     return Status::OK();
   }
+  if (!send_status.ok()) {
+    LOG(ERROR) << absl::Substitute("GRPCSinkNode $0 in query $1: Error sending results: $2",
+                                   plan_node_->id(), exec_state->query_id().str(),
+                                   send_status.msg());
+  }
 
   if (writer_ != nullptr) {
     LOG(INFO) << absl::Substitute("Closing GRPCSinkNode $0 in query $1 before receiving EOS",
@@ -312,14 +446,18 @@ Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
 Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
   PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   // Serialize the RowBatch.
-  PX_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(
+      rb.ToProto(req.mutable_query_result()->mutable_row_batch(), encode_columns()));
 
-  PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
+  PX_RETURN_IF_ERROR(SendRequest(exec_state, std::move(req)));
 
   if (!rb.eos()) {
     return Status::OK();
   }
 
+  PX_RETURN_IF_ERROR(WaitForSends());
+  // The stream is closed from this thread.
+  StopSender();
   PX_RETURN_IF_ERROR(CloseWriter(exec_state));
   sent_eos_ = true;
 
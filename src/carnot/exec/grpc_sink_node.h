@@ -19,11 +19,15 @@
 #pragma once
 
 #include <stddef.h>
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
 #include <grpcpp/grpcpp.h>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
@@ -35,6 +39,11 @@
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 
+DECLARE_int32(carnot_grpc_sink_max_inflight_requests);
+DECLARE_bool(carnot_grpc_sink_encode_batches);
+DECLARE_bool(carnot_grpc_sink_encode_results);
+DECLARE_bool(carnot_grpc_sink_compress_results);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -56,7 +65,7 @@ class GRPCSinkNode : public SinkNode {
   GRPCSinkNode(size_t max_batch_size, float batch_size_factor)
       : max_batch_size_(max_batch_size), batch_size_factor_(batch_size_factor) {}
   GRPCSinkNode() : GRPCSinkNode(kMaxBatchSize, kBatchSizeFactor) {}
-  virtual ~GRPCSinkNode() = default;
+  virtual ~GRPCSinkNode() { StopSender(); }
 
   // Used to check the downstream connection after connection_check_timeout_ has elapsed.
   Status OptionallyCheckConnection(ExecState* exec_state);
@@ -85,13 +94,30 @@ class GRPCSinkNode : public SinkNode {
                                        int64_t other_col_row_size) const;
 
  private:
+  // Batches sent to other agents and results sent to the query broker are encoded separately, so
+  // that results are only encoded once the query broker can decode them.
+  bool encode_columns() const {
+    return plan_node_->has_grpc_source_id() ? FLAGS_carnot_grpc_sink_encode_batches
+                                            : FLAGS_carnot_grpc_sink_encode_results;
+  }
+
   Status CloseWriter(ExecState* exec_state);
   Status StartConnection(ExecState* exec_state);
   Status StartConnectionWithRetries(ExecState* exec_state, size_t n_retries);
   Status CancelledByServer(ExecState* exec_state);
   Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
 
-  bool cancelled_ = false;
+  // Hands the request to the sender thread, so the caller can produce the next one while it is
+  // written. Blocks while FLAGS_carnot_grpc_sink_max_inflight_requests requests are queued, and
+  // returns the error of any earlier write that failed. Writes synchronously if the flag is 0.
+  Status SendRequest(ExecState* exec_state, carnotpb::TransferResultChunkRequest req);
+  // Blocks until every queued request was written, and returns the first error of the writes.
+  Status WaitForSends();
+  void SendLoop(ExecState* exec_state);
+  void StopSender();
+
+  // Written by the sender thread when the server closes the stream.
+  std::atomic<bool> cancelled_ = false;
 
   std::unique_ptr<grpc::ClientContext> context_;
   carnotpb::TransferResultChunkResponse response_;
@@ -107,6 +133,19 @@ class GRPCSinkNode : public SinkNode {
 
   size_t max_batch_size_;
   float batch_size_factor_;
+
+  // Writes the queued requests on writer_. Between Open and eos, writer_, context_ and response_
+  // belong to this thread, since it reconnects the stream when a write fails.
+  std::thread sender_;
+  absl::Mutex send_mu_;
+  absl::CondVar send_cv_;
+  std::deque<carnotpb::TransferResultChunkRequest> send_queue_ ABSL_GUARDED_BY(send_mu_);
+  // Whether the sender thread is writing a request that was already taken off the queue.
+  bool sending_ ABSL_GUARDED_BY(send_mu_) = false;
+  bool stop_sender_ ABSL_GUARDED_BY(send_mu_) = false;
+  Status send_status_ ABSL_GUARDED_BY(send_mu_);
+  size_t max_send_queue_depth_ ABSL_GUARDED_BY(send_mu_) = 0;
+  std::chrono::nanoseconds send_stall_time_ ABSL_GUARDED_BY(send_mu_){0};
 };
 
 }  // namespace exec
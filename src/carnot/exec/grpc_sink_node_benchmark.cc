@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -47,6 +49,7 @@ using px::table_store::schema::RowDescriptor;
 using px::types::DataType;
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 // NOLINTNEXTLINE : runtime/references.
@@ -104,3 +107,72 @@ void BM_GRPCSinkNodeSplitting(benchmark::State& state) {
 }
 
 BENCHMARK(BM_GRPCSinkNodeSplitting)->Unit(benchmark::kMillisecond);
+
+// Sends batches that are split into many chunks over a stream with the given write latency in
+// microseconds, with the given number of inflight requests (0 writes synchronously).
+// NOLINTNEXTLINE : runtime/references.
+void BM_GRPCSinkNodeWriteLatency(benchmark::State& state) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_sink_max_inflight_requests, state.range(1));
+  auto write_latency = std::chrono::microseconds(state.range(0));
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+
+  auto mock_unique = std::make_unique<::testing::NiceMock<MockResultSinkServiceStub>>();
+  auto mock = mock_unique.get();
+
+  auto exec_state = std::make_unique<px::carnot::exec::ExecState>(
+      func_registry.get(), table_store,
+      [&](const std::string&, const std::string&)
+          -> std::unique_ptr<ResultSinkService::StubInterface> { return std::move(mock_unique); },
+      MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+      [&](grpc::ClientContext*) {});
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+  auto writer =
+      new ::testing::NiceMock<grpc::testing::MockClientWriter<TransferResultChunkRequest>>();
+  ON_CALL(*writer, Write(_, _))
+      .WillByDefault(Invoke([&](const TransferResultChunkRequest&, grpc::WriteOptions) {
+        // Stands in for the time the request spends on the network.
+        std::this_thread::sleep_for(write_latency);
+        return true;
+      }));
+  ON_CALL(*writer, WritesDone()).WillByDefault(Return(true));
+  ON_CALL(*writer, Finish()).WillByDefault(Return(grpc::Status::OK));
+  ON_CALL(*mock, TransferResultChunkRaw(_, _))
+      .WillByDefault(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  px::carnot::exec::GRPCSinkNode node;
+  auto op_proto = px::carnot::planpb::testutils::CreateTestGRPCSink2PB();
+  auto plan_node = std::make_unique<px::carnot::plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+
+  auto num_rows = 1024;
+  auto num_columns = 4;
+  auto string_size = 4 * 1024;
+
+  RowDescriptor input_rd(std::vector<DataType>(num_columns, DataType::STRING));
+  RowDescriptor output_rd(std::vector<DataType>(num_columns, DataType::STRING));
+  PX_CHECK_OK(node.Init(*plan_node, output_rd, {input_rd}));
+  PX_CHECK_OK(node.Prepare(exec_state.get()));
+  PX_CHECK_OK(node.Open(exec_state.get()));
+
+  std::string big_string(string_size, 'X');
+  std::vector<px::types::StringValue> data(num_rows, big_string);
+  auto row_batch_builder =
+      px::carnot::exec::RowBatchBuilder(output_rd, num_rows, /*eow*/ true, /*eos*/ true);
+  for (int i = 0; i < num_columns; ++i) {
+    row_batch_builder.AddColumn<px::types::StringValue>(data);
+  }
+  auto rb = row_batch_builder.get();
+
+  for (auto _ : state) {
+    PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+    state.SetBytesProcessed(num_rows * num_columns * string_size);
+  }
+  PX_CHECK_OK(node.Close(exec_state.get()));
+}
+
+BENCHMARK(BM_GRPCSinkNodeWriteLatency)
+    ->ArgNames({"latency_us", "inflight"})
+    ->ArgsProduct({{100, 1000}, {0, 1, 4}})
+    ->Unit(benchmark::kMillisecond);
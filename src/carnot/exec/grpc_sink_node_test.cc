@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/synchronization/notification.h>
 #include <grpcpp/test/mock_stream.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -350,6 +351,117 @@ TEST_F(GRPCSinkNodeTest, external_result) {
   EXPECT_TRUE(add_metadata_called_);
 }
 
+TEST_F(GRPCSinkNodeTest, internal_result_encoded) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_sink_encode_batches, true);
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor rd({types::DataType::TIME64NS, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(*plan_node, rd, {rd},
+                                                                            exec_state_.get());
+  auto rb = RowBatchBuilder(rd, 4, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Time64NSValue>({10, 20, 30, 40})
+                .AddColumn<types::StringValue>({"svc", "svc", "svc", "other_svc"})
+                .get();
+  tester.ConsumeNext(rb, 0, 0);
+  tester.Close();
+
+  const auto& row_batch = actual_protos[1].query_result().row_batch();
+  ASSERT_EQ(2, row_batch.cols_size());
+  EXPECT_TRUE(row_batch.cols(0).has_delta_time64ns_data());
+  EXPECT_TRUE(row_batch.cols(1).has_dictionary_string_data());
+  ASSERT_OK_AND_ASSIGN(auto decoded_rb, RowBatch::FromProto(row_batch));
+  EXPECT_EQ(rb.DebugString(), decoded_rb->DebugString());
+}
+
+TEST_F(GRPCSinkNodeTest, external_result_encoded) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_sink_encode_results, true);
+  auto op_proto = planpb::testutils::CreateTestGRPCSink2PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor rd({types::DataType::TIME64NS, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(*plan_node, rd, {rd},
+                                                                            exec_state_.get());
+  auto rb = RowBatchBuilder(rd, 4, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Time64NSValue>({10, 20, 30, 40})
+                .AddColumn<types::StringValue>({"svc", "svc", "svc", "other_svc"})
+                .get();
+  tester.ConsumeNext(rb, 0, 0);
+  tester.Close();
+
+  const auto& row_batch = actual_protos[1].query_result().row_batch();
+  ASSERT_EQ(2, row_batch.cols_size());
+  EXPECT_TRUE(row_batch.cols(0).has_delta_time64ns_data());
+  EXPECT_TRUE(row_batch.cols(1).has_dictionary_string_data());
+}
+
+TEST_F(GRPCSinkNodeTest, external_result_not_encoded) {
+  // Results are encoded by their own flag.
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_sink_encode_batches, true);
+  auto op_proto = planpb::testutils::CreateTestGRPCSink2PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor rd({types::DataType::TIME64NS, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(*plan_node, rd, {rd},
+                                                                            exec_state_.get());
+  auto rb = RowBatchBuilder(rd, 4, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Time64NSValue>({10, 20, 30, 40})
+                .AddColumn<types::StringValue>({"svc", "svc", "svc", "other_svc"})
+                .get();
+  tester.ConsumeNext(rb, 0, 0);
+  tester.Close();
+
+  const auto& row_batch = actual_protos[1].query_result().row_batch();
+  ASSERT_EQ(2, row_batch.cols_size());
+  EXPECT_TRUE(row_batch.cols(0).has_time64ns_data());
+  EXPECT_TRUE(row_batch.cols(1).has_string_data());
+}
+
 TEST_F(GRPCSinkNodeTest, check_connection) {
   auto op_proto = planpb::testutils::CreateTestGRPCSink2PB();
   auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
@@ -763,6 +875,90 @@ TEST_F(GRPCSinkNodeTest, check_connection_after_eos) {
   tester.Close();
 }
 
+TEST_F(GRPCSinkNodeTest, pipelines_writes) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_sink_max_inflight_requests, 1);
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  absl::Notification release_write;
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(4)
+      .WillOnce(Return(true))  // Initiate result sink
+      .WillOnce(Invoke([&](const TransferResultChunkRequest&, grpc::WriteOptions) {
+        release_write.WaitForNotification();
+        return true;
+      }))
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // The first batch is being written and the second one is queued, neither blocks the caller.
+  for (auto i = 0; i < 2; ++i) {
+    auto rb = RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                  .AddColumn<types::Int64Value>({i})
+                  .get();
+    tester.ConsumeNext(rb, 5, 0);
+  }
+  EXPECT_FALSE(release_write.HasBeenNotified());
+  release_write.Notify();
+
+  auto rb = RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({2})
+                .get();
+  tester.ConsumeNext(rb, 5, 0);
+  tester.Close();
+}
+
+TEST_F(GRPCSinkNodeTest, failed_write_fails_later_batch) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(Return(true))    // Initiate result sink
+      .WillOnce(Return(false));  // The server closed the stream.
+  EXPECT_CALL(*writer, WritesDone()).WillOnce(Return(true));
+  EXPECT_CALL(*writer, Finish())
+      .WillOnce(Return(grpc::Status(grpc::StatusCode::CANCELLED, "query cancelled")));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // The failed write happens on the sender thread, so it is reported by the next batch at the
+  // latest, and by eos in any case.
+  auto rb = RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                .AddColumn<types::Int64Value>({1})
+                .get();
+  tester.ConsumeNext(rb, 5, 0);
+  auto eos_rb = RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                    .AddColumn<types::Int64Value>({2})
+                    .get();
+  EXPECT_NOT_OK(tester.node()->ConsumeNext(exec_state_.get(), eos_rb, 5));
+
+  tester.Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
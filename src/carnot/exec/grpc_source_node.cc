@@ -22,9 +22,17 @@
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
+#include "src/common/metrics/metrics.h"
+
+DEFINE_int32(carnot_grpc_source_coalesce_rows,
+             gflags::Int32FromEnv("PL_CARNOT_GRPC_SOURCE_COALESCE_ROWS", 1024),
+             "Row batches that a GRPC source receives with fewer rows than this are merged with "
+             "the batches queued after them, up to this many rows, before they are processed. 0 "
+             "disables merging.");
 
 namespace px {
 namespace carnot {
@@ -32,6 +40,65 @@ namespace exec {
 
 using table_store::schema::RowBatch;
 
+namespace {
+
+prometheus::Gauge& QueuedRowBatchesGauge() {
+  static auto& gauge = BuildGauge("grpc_router_queued_row_batches",
+                                  "Number of received row batches queued on GRPC sources");
+  return gauge;
+}
+
+prometheus::Counter& QueueLatencyCounter() {
+  static auto& counter =
+      BuildCounter("grpc_router_row_batch_queue_ns",
+                   "Total time received row batches spent queued on GRPC sources before they were "
+                   "processed");
+  return counter;
+}
+
+prometheus::Counter& ConsumedRowBatchesCounter() {
+  static auto& counter = BuildCounter("grpc_router_consumed_row_batches",
+                                      "Total number of received row batches processed by GRPC "
+                                      "sources, before they were merged");
+  return counter;
+}
+
+// Encoded columns can't be merged, since their values depend on the rest of their batch.
+bool HasEncodedColumns(const table_store::schemapb::RowBatchData& rb) {
+  for (const auto& col : rb.cols()) {
+    if (col.has_dictionary_string_data() || col.has_delta_time64ns_data()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Appends the rows of next to rb. Both batches must have the same columns.
+Status AppendRowBatchData(const table_store::schemapb::RowBatchData& next,
+                          table_store::schemapb::RowBatchData* rb) {
+  if (next.cols_size() != rb->cols_size()) {
+    return error::Internal("Can't merge row batches with $0 and $1 columns", rb->cols_size(),
+                           next.cols_size());
+  }
+  for (int i = 0; i < next.cols_size(); ++i) {
+    if (next.cols(i).col_data_case() != rb->cols(i).col_data_case()) {
+      return error::Internal("Can't merge row batches with different types in column $0", i);
+    }
+    // Merging the columns appends their repeated data.
+    rb->mutable_cols(i)->MergeFrom(next.cols(i));
+  }
+  rb->set_num_rows(rb->num_rows() + next.num_rows());
+  rb->set_eow(next.eow());
+  rb->set_eos(next.eos());
+  return Status::OK();
+}
+
+}  // namespace
+
+GRPCSourceNode::~GRPCSourceNode() {
+  QueuedRowBatchesGauge().Decrement(static_cast<double>(row_batch_queue_.size_approx()));
+}
+
 std::string GRPCSourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::GRPCSourceNode: <id: $0, output: $1>", plan_node_->id(),
                           output_descriptor_->DebugString());
@@ -47,7 +114,10 @@ Status GRPCSourceNode::PrepareImpl(ExecState*) { return Status::OK(); }
 
 Status GRPCSourceNode::OpenImpl(ExecState*) { return Status::OK(); }
 
-Status GRPCSourceNode::CloseImpl(ExecState*) { return Status::OK(); }
+Status GRPCSourceNode::CloseImpl(ExecState*) {
+  stats()->AddExtraInfo("coalesced_batches", absl::StrCat(num_coalesced_batches_));
+  return Status::OK();
+}
 
 Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
   PX_RETURN_IF_ERROR(PopRowBatch());
@@ -57,33 +127,70 @@ Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
 
 Status GRPCSourceNode::EnqueueRowBatch(
     std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch) {
-  if (!row_batch_queue_.enqueue(std::move(row_batch))) {
+  if (!row_batch_queue_.enqueue(
+          QueuedRowBatch{std::move(row_batch), std::chrono::steady_clock::now()})) {
     return error::Internal("Failed to enqueue RowBatch");
   }
+  QueuedRowBatchesGauge().Increment();
   return Status::OK();
 }
 
-Status GRPCSourceNode::PopRowBatch() {
-  DCHECK(NextBatchReady());
-  std::unique_ptr<carnotpb::TransferResultChunkRequest> rb_request;
-  bool got_one = row_batch_queue_.try_dequeue(rb_request);
-  if (!got_one) {
+Status GRPCSourceNode::PopRequest(
+    std::unique_ptr<carnotpb::TransferResultChunkRequest>* request) {
+  if (held_request_ != nullptr) {
+    *request = std::move(held_request_);
+    return Status::OK();
+  }
+  QueuedRowBatch queued;
+  if (!row_batch_queue_.try_dequeue(queued)) {
     return error::Internal(
-        "Called GRPCSourceNode::OptionallyPopRowBatch but there was no available row batch in the "
-        "queue.");
+        "Called GRPCSourceNode::PopRowBatch but there was no available row batch in the queue.");
   }
-  if (!rb_request->has_query_result() || !rb_request->query_result().has_row_batch()) {
+  auto queue_time = std::chrono::steady_clock::now() - queued.enqueue_time;
+  QueuedRowBatchesGauge().Decrement();
+  QueueLatencyCounter().Increment(static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(queue_time).count()));
+  ConsumedRowBatchesCounter().Increment();
+
+  if (!queued.request->has_query_result() || !queued.request->query_result().has_row_batch()) {
     return error::Internal(
         "GRPCSourceNode::PopRowBatch expected TransferResultChunkRequest to have RowBatch "
         "message.");
   }
+  *request = std::move(queued.request);
+  return Status::OK();
+}
+
+Status GRPCSourceNode::PopRowBatch() {
+  DCHECK(NextBatchReady());
+  std::unique_ptr<carnotpb::TransferResultChunkRequest> rb_request;
+  PX_RETURN_IF_ERROR(PopRequest(&rb_request));
+  auto* rb_data = rb_request->mutable_query_result()->mutable_row_batch();
+
+  // Only batches that are already queued are merged, so that a slow upstream doesn't delay the
+  // ones that were received. Batches are never merged past the end of a window or the row limit,
+  // and batches with encoded columns are never merged at all. A dequeued batch that can't be
+  // merged is held back for the next call.
+  while (rb_data->num_rows() < FLAGS_carnot_grpc_source_coalesce_rows && !rb_data->eow() &&
+         !rb_data->eos() && !HasEncodedColumns(*rb_data) && row_batch_queue_.size_approx() > 0) {
+    std::unique_ptr<carnotpb::TransferResultChunkRequest> next_request;
+    PX_RETURN_IF_ERROR(PopRequest(&next_request));
+    const auto& next_rb_data = next_request->query_result().row_batch();
+    if (HasEncodedColumns(next_rb_data) ||
+        rb_data->num_rows() + next_rb_data.num_rows() > FLAGS_carnot_grpc_source_coalesce_rows) {
+      held_request_ = std::move(next_request);
+      break;
+    }
+    PX_RETURN_IF_ERROR(AppendRowBatchData(next_rb_data, rb_data));
+    ++num_coalesced_batches_;
+  }
 
-  PX_ASSIGN_OR_RETURN(rb_, RowBatch::FromProto(rb_request->query_result().row_batch()));
+  PX_ASSIGN_OR_RETURN(rb_, RowBatch::FromProto(*rb_data));
   return Status::OK();
 }
 
 bool GRPCSourceNode::NextBatchReady() {
-  return HasBatchesRemaining() && row_batch_queue_.size_approx() > 0;
+  return HasBatchesRemaining() && (held_request_ != nullptr || row_batch_queue_.size_approx() > 0);
 }
 
 }  // namespace exec
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -32,6 +33,8 @@
 
 #include "blockingconcurrentqueue.h"
 
+DECLARE_int32(carnot_grpc_source_coalesce_rows);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -39,22 +42,34 @@ namespace exec {
 class GRPCSourceNode : public SourceNode {
  public:
   GRPCSourceNode() = default;
-  virtual ~GRPCSourceNode() = default;
+  virtual ~GRPCSourceNode();
 
   bool NextBatchReady() override;
+  /**
+   * Queues a row batch received by the GRPCRouter. This is safe to call concurrently with the
+   * execution of the node.
+   */
   virtual Status EnqueueRowBatch(std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch);
 
   // Tracks whether the upstream sink node has successfully initiated the connection to
   // this remote source. Used by the exec graph to determine whether or not any sources have
   // taken too long for their connection to be established with the sinks.
-  void set_upstream_initiated_connection() { upstream_initiated_connection_ = true; }
-  bool upstream_initiated_connection() const { return upstream_initiated_connection_; }
+  void set_upstream_initiated_connection() {
+    upstream_initiated_connection_.store(true, std::memory_order_relaxed);
+  }
+  bool upstream_initiated_connection() const {
+    return upstream_initiated_connection_.load(std::memory_order_relaxed);
+  }
 
   // Tracks whether the upstream sink node has closed or cancelled the connection to
   // this remote source. Used by the exec graph to determine whether or not any sources have
   // unexpectedly had their connections closed with their remote sinks.
-  void set_upstream_closed_connection() { upstream_closed_connection_ = true; }
-  bool upstream_closed_connection() const { return upstream_closed_connection_; }
+  void set_upstream_closed_connection() {
+    upstream_closed_connection_.store(true, std::memory_order_relaxed);
+  }
+  bool upstream_closed_connection() const {
+    return upstream_closed_connection_.load(std::memory_order_relaxed);
+  }
 
  protected:
   std::string DebugStringImpl() override;
@@ -65,15 +80,27 @@ class GRPCSourceNode : public SourceNode {
   Status GenerateNextImpl(ExecState* exec_state) override;
 
  private:
+  struct QueuedRowBatch {
+    std::unique_ptr<carnotpb::TransferResultChunkRequest> request;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  // Pops the next row batch. Small batches are merged with the ones queued after them, up to
+  // FLAGS_carnot_grpc_source_coalesce_rows rows, so that fewer batches go through the graph.
   Status PopRowBatch();
+  Status PopRequest(std::unique_ptr<carnotpb::TransferResultChunkRequest>* request);
 
   std::unique_ptr<table_store::schema::RowBatch> rb_;
-  moodycamel::BlockingConcurrentQueue<std::unique_ptr<carnotpb::TransferResultChunkRequest>>
-      row_batch_queue_;
+  // Written by the GRPCRouter threads, read by the execution of the node.
+  moodycamel::BlockingConcurrentQueue<QueuedRowBatch> row_batch_queue_;
+  // A request that was dequeued to be merged into the previous batch, but couldn't be. It is the
+  // next one to be processed.
+  std::unique_ptr<carnotpb::TransferResultChunkRequest> held_request_;
 
   std::unique_ptr<plan::GRPCSourceOperator> plan_node_;
-  bool upstream_initiated_connection_ = false;
-  bool upstream_closed_connection_ = false;
+  std::atomic<bool> upstream_initiated_connection_ = false;
+  std::atomic<bool> upstream_closed_connection_ = false;
+  int64_t num_coalesced_batches_ = 0;
 };
 
 }  // namespace exec
@@ -87,6 +87,85 @@ TEST_F(GRPCSourceNodeTest, basic) {
   EXPECT_FALSE(tester.node()->HasBatchesRemaining());
 }
 
+TEST_F(GRPCSourceNodeTest, coalesce_queued_batches) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_source_coalesce_rows, 4);
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::GRPCSourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<GRPCSourceNode, plan::GRPCSourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+
+  auto enqueue = [&](const RowBatch& rb) {
+    auto rb_wrapper = std::make_unique<carnotpb::TransferResultChunkRequest>();
+    EXPECT_OK(rb.ToProto(rb_wrapper->mutable_query_result()->mutable_row_batch()));
+    EXPECT_OK(tester.node()->EnqueueRowBatch(std::move(rb_wrapper)));
+  };
+  enqueue(RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+              .AddColumn<types::Int64Value>({1})
+              .get());
+  enqueue(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+              .AddColumn<types::Int64Value>({2, 3})
+              .get());
+  enqueue(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+              .AddColumn<types::Int64Value>({4, 5})
+              .get());
+  // Merging stops at the end of a window.
+  enqueue(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ false)
+              .AddColumn<types::Int64Value>({6})
+              .get());
+  enqueue(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+              .AddColumn<types::Int64Value>({7})
+              .get());
+
+  // Merging stops before the batch would go over 4 rows.
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 3, false, false).AddColumn<types::Int64Value>({1, 2, 3}).get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 3, true, false).AddColumn<types::Int64Value>({4, 5, 6}).get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 1, true, true).AddColumn<types::Int64Value>({7}).get());
+  EXPECT_FALSE(tester.node()->NextBatchReady());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+}
+
+TEST_F(GRPCSourceNodeTest, encoded_batches_are_not_merged) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_grpc_source_coalesce_rows, 4);
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::GRPCSourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<GRPCSourceNode, plan::GRPCSourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+
+  auto enqueue = [&](const RowBatch& rb, bool encode_columns) {
+    auto rb_wrapper = std::make_unique<carnotpb::TransferResultChunkRequest>();
+    EXPECT_OK(
+        rb.ToProto(rb_wrapper->mutable_query_result()->mutable_row_batch(), encode_columns));
+    EXPECT_OK(tester.node()->EnqueueRowBatch(std::move(rb_wrapper)));
+  };
+  auto plain = RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                   .AddColumn<types::StringValue>({"a"})
+                   .get();
+  auto encoded = RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+                     .AddColumn<types::StringValue>({"b", "b"})
+                     .get();
+  auto last = RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                  .AddColumn<types::StringValue>({"c"})
+                  .get();
+  enqueue(plain, false);
+  enqueue(encoded, true);
+  enqueue(last, false);
+
+  tester.GenerateNextResult().ExpectRowBatch(plain);
+  // The encoded batch was dequeued while trying to merge it, and is still processed on its own.
+  EXPECT_TRUE(tester.node()->NextBatchReady());
+  tester.GenerateNextResult().ExpectRowBatch(encoded);
+  tester.GenerateNextResult().ExpectRowBatch(last);
+  EXPECT_FALSE(tester.node()->NextBatchReady());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/key_hash_table.h"
+
+#include <farmhash.h>
+
+#include <cstring>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+constexpr uint64_t kKeyHashSeed = 0x9e3779b97f4a7c15ULL;
+
+// The murmur3 64 bit finalizer. It's a handful of multiplies and shifts, so the loops below
+// vectorize, and it mixes well enough that the low bits can be used directly as a slot index.
+inline uint64_t MixKey(uint64_t v) {
+  v ^= v >> 33;
+  v *= 0xff51afd7ed558ccdULL;
+  v ^= v >> 33;
+  v *= 0xc4ceb9fe1a85ec53ULL;
+  v ^= v >> 33;
+  return v;
+}
+
+template <typename T>
+void HashFixedColumn(const arrow::Array* col, int64_t num_rows, uint64_t* hashes) {
+  static_assert(sizeof(T) == sizeof(uint64_t));
+  const T* values = col->data()->GetValues<T>(1);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    uint64_t bits;
+    memcpy(&bits, &values[i], sizeof(bits));
+    hashes[i] = HashCombine(hashes[i], MixKey(bits));
+  }
+}
+
+void HashBooleanColumn(const arrow::Array* col, int64_t num_rows, uint64_t* hashes) {
+  const auto* arr = static_cast<const arrow::BooleanArray*>(col);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    hashes[i] = HashCombine(hashes[i], MixKey(arr->Value(i)));
+  }
+}
+
+void HashUInt128Column(const arrow::Array* col, int64_t num_rows, uint64_t* hashes) {
+  for (int64_t i = 0; i < num_rows; ++i) {
+    absl::uint128 key = GetUInt128Key(col, i);
+    hashes[i] = HashCombine(HashCombine(hashes[i], MixKey(absl::Uint128High64(key))),
+                            MixKey(absl::Uint128Low64(key)));
+  }
+}
+
+void HashStringColumn(const arrow::Array* col, int64_t num_rows, uint64_t* hashes) {
+  for (int64_t i = 0; i < num_rows; ++i) {
+    std::string_view val = types::GetStringViewFromArrowArray(col, i);
+    hashes[i] = HashCombine(hashes[i], ::util::Hash64(val.data(), val.size()));
+  }
+}
+
+}  // namespace
+
+KeyLayout SelectKeyLayout(const std::vector<types::DataType>& key_types) {
+  if (key_types.size() != 1) {
+    return KeyLayout::kRowTuple;
+  }
+  switch (key_types[0]) {
+    case types::INT64:
+    case types::TIME64NS:
+      return KeyLayout::kInt64;
+    case types::UINT128:
+      return KeyLayout::kUInt128;
+    default:
+      return KeyLayout::kRowTuple;
+  }
+}
+
+uint64_t HashInt64Key(int64_t key) {
+  uint64_t bits;
+  memcpy(&bits, &key, sizeof(bits));
+  return HashCombine(kKeyHashSeed, MixKey(bits));
+}
+
+uint64_t HashRowTupleKey(const RowTuple& rt) {
+  uint64_t hash = kKeyHashSeed;
+  for (size_t col_idx = 0; col_idx < rt.types->size(); ++col_idx) {
+    // PX_CARNOT_UPDATE_FOR_NEW_TYPES
+    switch (rt.types->at(col_idx)) {
+      case types::BOOLEAN:
+        hash = HashCombine(hash, MixKey(rt.GetValue<types::BoolValue>(col_idx).val));
+        break;
+      case types::INT64:
+        hash = HashCombine(hash, MixKey(rt.GetValue<types::Int64Value>(col_idx).val));
+        break;
+      case types::TIME64NS:
+        hash = HashCombine(hash, MixKey(rt.GetValue<types::Time64NSValue>(col_idx).val));
+        break;
+      case types::FLOAT64: {
+        double val = rt.GetValue<types::Float64Value>(col_idx).val;
+        uint64_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        hash = HashCombine(hash, MixKey(bits));
+        break;
+      }
+      case types::UINT128: {
+        const auto& val = rt.GetValue<types::UInt128Value>(col_idx);
+        hash = HashCombine(HashCombine(hash, MixKey(val.High64())), MixKey(val.Low64()));
+        break;
+      }
+      case types::STRING: {
+        const auto& val = rt.GetValue<types::StringValue>(col_idx);
+        hash = HashCombine(hash, ::util::Hash64(val.data(), val.size()));
+        break;
+      }
+      default:
+        LOG(DFATAL) << "Unsupported key type: " << types::ToString(rt.types->at(col_idx));
+        break;
+    }
+  }
+  return hash;
+}
+
+void HashKeyColumns(const std::vector<const arrow::Array*>& key_cols,
+                    const std::vector<types::DataType>& key_types, int64_t num_rows,
+                    std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(key_cols.size(), key_types.size());
+  hashes->assign(num_rows, kKeyHashSeed);
+  uint64_t* out = hashes->data();
+  for (size_t col_idx = 0; col_idx < key_cols.size(); ++col_idx) {
+    const arrow::Array* col = key_cols[col_idx];
+    DCHECK_GE(col->length(), num_rows);
+    // PX_CARNOT_UPDATE_FOR_NEW_TYPES
+    switch (key_types[col_idx]) {
+      case types::BOOLEAN:
+        HashBooleanColumn(col, num_rows, out);
+        break;
+      case types::INT64:
+      case types::TIME64NS:
+        HashFixedColumn<int64_t>(col, num_rows, out);
+        break;
+      case types::FLOAT64:
+        // RowTuple compares values bitwise, so hashing the bits is consistent with it.
+        HashFixedColumn<double>(col, num_rows, out);
+        break;
+      case types::UINT128:
+        HashUInt128Column(col, num_rows, out);
+        break;
+      case types::STRING:
+        HashStringColumn(col, num_rows, out);
+        break;
+      default:
+        LOG(DFATAL) << "Unsupported key type: " << types::ToString(key_types[col_idx]);
+        break;
+    }
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
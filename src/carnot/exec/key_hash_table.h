@@ -0,0 +1,216 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <absl/numeric/int128.h>
+
+#include "src/carnot/exec/row_tuple.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * The in-memory layout used for the keys of a hash table over the given key columns. Single
+ * INT64/TIME64NS and UINT128 (e.g. UPID) keys are stored inline, everything else is stored as a
+ * RowTuple.
+ */
+enum class KeyLayout {
+  kRowTuple,
+  kInt64,
+  kUInt128,
+};
+
+KeyLayout SelectKeyLayout(const std::vector<types::DataType>& key_types);
+
+/**
+ * Hashes the first num_rows rows of the key columns into hashes, one column at a time. Each
+ * column is hashed with a loop specialized on its type, so the fixed size columns are hashed
+ * straight out of their arrow buffers.
+ *
+ * These hashes are not the same as RowTuple::Hash(), so a table must only ever be fed hashes that
+ * were computed by this function.
+ */
+void HashKeyColumns(const std::vector<const arrow::Array*>& key_cols,
+                    const std::vector<types::DataType>& key_types, int64_t num_rows,
+                    std::vector<uint64_t>* hashes);
+
+/**
+ * Returns the hash that HashKeyColumns computes for a key made of a single INT64/TIME64NS column.
+ */
+uint64_t HashInt64Key(int64_t key);
+
+/**
+ * Returns the hash that HashKeyColumns computes for the row that rt was extracted from.
+ */
+uint64_t HashRowTupleKey(const RowTuple& rt);
+
+/**
+ * Reads the key at row idx of a column with KeyLayout::kInt64 (INT64 or TIME64NS).
+ */
+inline int64_t GetInt64Key(const arrow::Array* col, int64_t idx) {
+  return col->data()->GetValues<int64_t>(1)[idx];
+}
+
+/**
+ * Reads the key at row idx of a column with KeyLayout::kUInt128.
+ */
+inline absl::uint128 GetUInt128Key(const arrow::Array* col, int64_t idx) {
+  return types::UInt128Value(types::GetValueFromArrowArray<types::UINT128>(col, idx)).val;
+}
+
+/**
+ * KeyHashTable is an open addressing (linear probing) hash table for keys that were hashed with
+ * HashKeyColumns. The full hash of every key is stored inline in the probe sequence, so keys are
+ * only compared when their hashes match, and growing the table never rehashes a key.
+ *
+ * Entries are stored densely in insertion order and never move between slots, which keeps
+ * iteration cheap and deterministic. Pointers to entries are invalidated by the next insert.
+ */
+template <typename TKey, typename TValue, typename TKeyEq = std::equal_to<TKey>>
+class KeyHashTable {
+ public:
+  struct Entry {
+    TKey key;
+    TValue value;
+  };
+
+  /**
+   * Returns the entry for key, or nullptr if it is not in the table.
+   */
+  Entry* Find(uint64_t hash, const TKey& key) {
+    if (entries_.empty()) {
+      return nullptr;
+    }
+    const uint64_t tag = Tag(hash);
+    for (size_t slot = hash & mask_;; slot = (slot + 1) & mask_) {
+      const Slot& s = slots_[slot];
+      if (s.tag == kEmptyTag) {
+        return nullptr;
+      }
+      if (s.tag == tag && eq_(entries_[s.entry_idx].key, key)) {
+        return &entries_[s.entry_idx];
+      }
+    }
+  }
+
+  /**
+   * Returns the entry for key, inserting an entry with a default constructed value if the key is
+   * not in the table yet. inserted is set if a new entry was created.
+   */
+  Entry* FindOrInsert(uint64_t hash, const TKey& key, bool* inserted) {
+    if ((entries_.size() + 1) * kMaxLoadDenominator > slots_.size() * kMaxLoadNumerator) {
+      Grow();
+    }
+    const uint64_t tag = Tag(hash);
+    size_t slot = hash & mask_;
+    for (;; slot = (slot + 1) & mask_) {
+      const Slot& s = slots_[slot];
+      if (s.tag == kEmptyTag) {
+        break;
+      }
+      if (s.tag == tag && eq_(entries_[s.entry_idx].key, key)) {
+        *inserted = false;
+        return &entries_[s.entry_idx];
+      }
+    }
+    slots_[slot] = Slot{tag, static_cast<uint32_t>(entries_.size())};
+    entries_.push_back(Entry{key, TValue{}});
+    *inserted = true;
+    return &entries_.back();
+  }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  void clear() {
+    slots_.clear();
+    entries_.clear();
+    mask_ = 0;
+  }
+
+  auto begin() { return entries_.begin(); }
+  auto end() { return entries_.end(); }
+  auto begin() const { return entries_.begin(); }
+  auto end() const { return entries_.end(); }
+
+ private:
+  struct Slot {
+    // The hash of the entry's key with the top bit set, or kEmptyTag for an empty slot.
+    uint64_t tag;
+    uint32_t entry_idx;
+  };
+
+  static constexpr uint64_t kEmptyTag = 0;
+  static constexpr uint64_t kOccupiedBit = 1ULL << 63;
+  static constexpr size_t kInitialSlots = 16;
+  // Linear probing degrades quickly past this load factor.
+  static constexpr size_t kMaxLoadNumerator = 1;
+  static constexpr size_t kMaxLoadDenominator = 2;
+
+  // The slot index only uses the low bits of the hash, so steal the top bit to mark the slot as
+  // occupied.
+  static uint64_t Tag(uint64_t hash) { return hash | kOccupiedBit; }
+
+  void Grow() {
+    std::vector<Slot> old_slots(slots_.empty() ? kInitialSlots : slots_.size() * 2,
+                                Slot{kEmptyTag, 0});
+    std::swap(slots_, old_slots);
+    mask_ = slots_.size() - 1;
+    // The tags hold the full hashes, so the keys don't have to be hashed (or compared) again.
+    for (const auto& s : old_slots) {
+      if (s.tag == kEmptyTag) {
+        continue;
+      }
+      size_t slot = s.tag & mask_;
+      while (slots_[slot].tag != kEmptyTag) {
+        slot = (slot + 1) & mask_;
+      }
+      slots_[slot] = s;
+    }
+  }
+
+  std::vector<Slot> slots_;
+  std::vector<Entry> entries_;
+  size_t mask_ = 0;
+  TKeyEq eq_;
+};
+
+template <typename TValue>
+using RowTupleKeyHashTable = KeyHashTable<RowTuple*, TValue, RowTuplePtrEq>;
+
+template <typename TValue>
+using Int64KeyHashTable = KeyHashTable<int64_t, TValue>;
+
+template <typename TValue>
+using UInt128KeyHashTable = KeyHashTable<absl::uint128, TValue>;
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
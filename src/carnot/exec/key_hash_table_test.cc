@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/key_hash_table.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(SelectKeyLayoutTest, fixed_width_keys) {
+  EXPECT_EQ(KeyLayout::kInt64, SelectKeyLayout({types::INT64}));
+  EXPECT_EQ(KeyLayout::kInt64, SelectKeyLayout({types::TIME64NS}));
+  EXPECT_EQ(KeyLayout::kUInt128, SelectKeyLayout({types::UINT128}));
+  EXPECT_EQ(KeyLayout::kRowTuple, SelectKeyLayout({types::STRING}));
+  EXPECT_EQ(KeyLayout::kRowTuple, SelectKeyLayout({types::INT64, types::INT64}));
+}
+
+TEST(HashKeyColumnsTest, equal_keys_have_equal_hashes) {
+  auto ints = types::ToArrow(std::vector<types::Int64Value>{1, 2, 1, 3},
+                             arrow::default_memory_pool());
+  auto strs = types::ToArrow(std::vector<types::StringValue>{"a", "b", "a", "a"},
+                             arrow::default_memory_pool());
+  std::vector<types::DataType> key_types{types::INT64, types::STRING};
+
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({ints.get(), strs.get()}, key_types, 4, &hashes);
+  ASSERT_EQ(4, hashes.size());
+  EXPECT_EQ(hashes[0], hashes[2]);
+  EXPECT_NE(hashes[0], hashes[1]);
+  EXPECT_NE(hashes[0], hashes[3]);
+
+  // Hashes only depend on the key values, not on the batch they are in.
+  auto other_ints = types::ToArrow(std::vector<types::Int64Value>{3, 1},
+                                   arrow::default_memory_pool());
+  auto other_strs = types::ToArrow(std::vector<types::StringValue>{"a", "a"},
+                                   arrow::default_memory_pool());
+  std::vector<uint64_t> other_hashes;
+  HashKeyColumns({other_ints.get(), other_strs.get()}, key_types, 2, &other_hashes);
+  EXPECT_EQ(hashes[3], other_hashes[0]);
+  EXPECT_EQ(hashes[0], other_hashes[1]);
+}
+
+TEST(HashKeyColumnsTest, scalar_hashes_match_column_hashes) {
+  auto ints = types::ToArrow(std::vector<types::Int64Value>{7, -3}, arrow::default_memory_pool());
+  auto strs = types::ToArrow(std::vector<types::StringValue>{"abc", ""},
+                             arrow::default_memory_pool());
+  std::vector<types::DataType> key_types{types::INT64, types::STRING};
+
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({ints.get(), strs.get()}, key_types, 2, &hashes);
+  for (int64_t row_idx = 0; row_idx < 2; ++row_idx) {
+    RowTuple rt(&key_types);
+    ExtractIntoRowTuple<types::INT64>(&rt, ints.get(), 0, row_idx);
+    ExtractIntoRowTuple<types::STRING>(&rt, strs.get(), 1, row_idx);
+    EXPECT_EQ(hashes[row_idx], HashRowTupleKey(rt));
+  }
+
+  std::vector<uint64_t> int_hashes;
+  HashKeyColumns({ints.get()}, {types::INT64}, 2, &int_hashes);
+  EXPECT_EQ(int_hashes[0], HashInt64Key(7));
+  EXPECT_EQ(int_hashes[1], HashInt64Key(-3));
+}
+
+TEST(HashKeyColumnsTest, uint128_keys) {
+  auto upids = types::ToArrow(
+      std::vector<types::UInt128Value>{types::UInt128Value(1, 2), types::UInt128Value(2, 1),
+                                       types::UInt128Value(1, 2)},
+      arrow::default_memory_pool());
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({upids.get()}, {types::UINT128}, 3, &hashes);
+  EXPECT_EQ(hashes[0], hashes[2]);
+  EXPECT_NE(hashes[0], hashes[1]);
+  EXPECT_EQ(absl::MakeUint128(2, 1), GetUInt128Key(upids.get(), 1));
+}
+
+TEST(KeyHashTableTest, find_or_insert) {
+  Int64KeyHashTable<int64_t> table;
+  // Use a deliberately bad hash so that every key collides.
+  constexpr uint64_t kHash = 42;
+  for (int64_t i = 0; i < 100; ++i) {
+    bool inserted;
+    auto* entry = table.FindOrInsert(kHash, i, &inserted);
+    EXPECT_TRUE(inserted);
+    entry->value = i * 10;
+  }
+  EXPECT_EQ(100, table.size());
+
+  bool inserted;
+  auto* entry = table.FindOrInsert(kHash, 7, &inserted);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(70, entry->value);
+
+  ASSERT_NE(nullptr, table.Find(kHash, 99));
+  EXPECT_EQ(990, table.Find(kHash, 99)->value);
+  EXPECT_EQ(nullptr, table.Find(kHash, 100));
+  EXPECT_EQ(nullptr, table.Find(kHash + 1, 7));
+
+  // Entries are iterated in insertion order.
+  int64_t expected_key = 0;
+  for (const auto& e : table) {
+    EXPECT_EQ(expected_key, e.key);
+    ++expected_key;
+  }
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, table.Find(kHash, 7));
+}
+
+TEST(KeyHashTableTest, row_tuple_keys) {
+  std::vector<types::DataType> types{types::INT64, types::STRING};
+  RowTuple rt1(&types);
+  rt1.SetValue(0, types::Int64Value(1));
+  rt1.SetValue(1, types::StringValue("abc"));
+  RowTuple rt2(&types);
+  rt2.SetValue(0, types::Int64Value(1));
+  rt2.SetValue(1, types::StringValue("abc"));
+  RowTuple rt3(&types);
+  rt3.SetValue(0, types::Int64Value(1));
+  rt3.SetValue(1, types::StringValue("abd"));
+
+  RowTupleKeyHashTable<int64_t> table;
+  bool inserted;
+  table.FindOrInsert(1, &rt1, &inserted)->value = 1;
+  EXPECT_TRUE(inserted);
+  // Keys are compared by value, not by pointer.
+  auto* entry = table.FindOrInsert(1, &rt2, &inserted);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(&rt1, entry->key);
+  // Keys with equal hashes still have to compare equal.
+  table.FindOrInsert(1, &rt3, &inserted)->value = 3;
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(2, table.size());
+  EXPECT_EQ(3, table.Find(1, &rt3)->value);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -46,8 +46,11 @@ Status MapNode::InitImpl(const plan::Operator& plan_node) {
 }
 Status MapNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
-  evaluator_ = ScalarExpressionEvaluator::Create(
-      plan_node_->expressions(), ScalarExpressionEvaluatorType::kArrowNative, function_ctx_.get());
+  auto evaluator_type = FLAGS_carnot_compiled_expressions
+                            ? ScalarExpressionEvaluatorType::kCompiled
+                            : ScalarExpressionEvaluatorType::kArrowNative;
+  evaluator_ = ScalarExpressionEvaluator::Create(plan_node_->expressions(), evaluator_type,
+                                                 function_ctx_.get());
   return Status::OK();
 }
 
@@ -144,6 +144,32 @@ TEST_F(MapNodeTest, child_fail) {
                                0, error::InvalidArgument("args"));
 }
 
+TEST_F(MapNodeTest, query_memory_limit) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_query_memory_limit_mb, 1);
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry_.get(), std::make_shared<table_store::TableStore>(),
+      MockResultSinkStubGenerator, MockMetricsStubGenerator, MockTraceStubGenerator,
+      sole::uuid4(), nullptr);
+  EXPECT_OK(exec_state->AddScalarUDF(
+      0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+  // The output column alone is over 2MB.
+  constexpr int64_t kNumRows = 300 * 1000;
+  std::vector<types::Int64Value> col(kNumRows, 1);
+
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node_, output_rd, {},
+                                                                 exec_state.get());
+  tester.ConsumeNextShouldFailWithCode(
+      RowBatchBuilder(input_rd, kNumRows, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Int64Value>(col)
+          .AddColumn<types::Int64Value>(col)
+          .get(),
+      0, statuspb::RESOURCE_UNAVAILABLE);
+  EXPECT_GT(exec_state->query_mem_pool()->max_memory(), 1 << 20);
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
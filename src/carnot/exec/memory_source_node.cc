@@ -21,13 +21,19 @@
 
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 
+DEFINE_bool(carnot_shared_scans, gflags::BoolFromEnv("PL_CARNOT_SHARED_SCANS", true),
+            "Whether infinite streaming queries reading the same table should share a single scan "
+            "of the table instead of each reading it with their own cursor.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -69,6 +75,12 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
     start_spec.type = StartSpec::StartType::CurrentStartOfTable;
   }
 
+  if (streaming_ && !plan_node_->HasStopTime() && FLAGS_carnot_shared_scans) {
+    shared_scan_reader_ = exec_state->table_store()->shared_scans()->CreateReader(
+        table_, start_spec, plan_node_->Columns());
+    return Status::OK();
+  }
+
   StopSpec stop_spec;
   if (streaming_) {
     if (plan_node_->HasStopTime()) {
@@ -92,12 +104,27 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
 
 Status MemorySourceNode::CloseImpl(ExecState*) {
   stats()->AddExtraInfo("streaming", streaming_ ? "true" : "false");
+  stats()->AddExtraInfo("shared_scan", shared_scan_reader_ != nullptr ? "true" : "false");
+  if (!runtime_join_filters_.empty()) {
+    stats()->AddExtraInfo("rows_dropped_by_join_filters",
+                          absl::StrCat(rows_dropped_by_join_filters_));
+  }
+  // Leave the shared scan, so that it doesn't queue batches for this query anymore.
+  shared_scan_reader_.reset();
   return Status::OK();
 }
 
 StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
   DCHECK(table_ != nullptr);
 
+  if (shared_scan_reader_ != nullptr) {
+    // Infinite streams never send eow or eos, see below.
+    PX_ASSIGN_OR_RETURN(auto row_batch, shared_scan_reader_->GetNextRowBatch());
+    rows_processed_ += row_batch->num_rows();
+    bytes_processed_ += row_batch->NumBytes();
+    return row_batch;
+  }
+
   if (!cursor_->NextBatchReady()) {
     // If the NextBatch is not ready, but the cursor is not yet exhausted, then we need to output
     // 0-row row batches, while we wait for more data to be added. This currently only occurs in the
@@ -123,15 +150,50 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
   return row_batch;
 }
 
+void MemorySourceNode::AddRuntimeJoinFilter(const RuntimeJoinFilter* filter,
+                                            std::vector<int64_t> key_indices) {
+  runtime_join_filters_.push_back(JoinFilterSpec{filter, std::move(key_indices)});
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::ApplyRuntimeJoinFilters(
+    std::unique_ptr<RowBatch> row_batch) {
+  for (const auto& spec : runtime_join_filters_) {
+    if (row_batch->num_rows() == 0) {
+      break;
+    }
+    PX_ASSIGN_OR_RETURN(auto filtered, spec.filter->Apply(spec.key_indices, *row_batch));
+    if (filtered != nullptr) {
+      rows_dropped_by_join_filters_ += row_batch->num_rows() - filtered->num_rows();
+      row_batch = std::move(filtered);
+    }
+  }
+  return row_batch;
+}
+
 Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
   PX_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
+  if (!runtime_join_filters_.empty()) {
+    PX_ASSIGN_OR_RETURN(row_batch, ApplyRuntimeJoinFilters(std::move(row_batch)));
+  }
   PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *row_batch));
   return Status::OK();
 }
 
-bool MemorySourceNode::InfiniteStreamNextBatchReady() { return cursor_->NextBatchReady(); }
+bool MemorySourceNode::InfiniteStreamNextBatchReady() {
+  if (shared_scan_reader_ != nullptr) {
+    return shared_scan_reader_->NextBatchReady();
+  }
+  return cursor_->NextBatchReady();
+}
 
 bool MemorySourceNode::NextBatchReady() {
+  // Hold the scan back until the build sides of the joins it feeds are done, otherwise its rows
+  // can't be filtered yet.
+  for (const auto& spec : runtime_join_filters_) {
+    if (!spec.filter->ready()) {
+      return false;
+    }
+  }
   // Next batch is ready if we haven't seen an eow and if it's an infinite_stream that has batches
   // to push.
   return HasBatchesRemaining() && (!streaming_ || InfiniteStreamNextBatchReady());
@@ -25,13 +25,17 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/runtime_join_filter.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
 #include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/shared_scan.h"
 #include "src/table_store/table/table.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_shared_scans);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -46,6 +50,12 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  /**
+   * Only sends the rows whose keys may be in filter, where key_indices are the output columns
+   * that hold the keys. No batches are sent until the filter is ready.
+   */
+  void AddRuntimeJoinFilter(const RuntimeJoinFilter* filter, std::vector<int64_t> key_indices);
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -57,10 +67,20 @@ class MemorySourceNode : public SourceNode {
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
   bool InfiniteStreamNextBatchReady();
+  StatusOr<std::unique_ptr<RowBatch>> ApplyRuntimeJoinFilters(std::unique_ptr<RowBatch> row_batch);
   // Whether this memory source will stream future results.
   bool streaming_ = false;
 
   std::unique_ptr<Table::Cursor> cursor_;
+  // Set instead of cursor_ for infinite streams, which read the table through its shared scan.
+  std::unique_ptr<table_store::SharedScan::Reader> shared_scan_reader_;
+
+  struct JoinFilterSpec {
+    const RuntimeJoinFilter* filter;
+    std::vector<int64_t> key_indices;
+  };
+  std::vector<JoinFilterSpec> runtime_join_filters_;
+  int64_t rows_dropped_by_join_filters_ = 0;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
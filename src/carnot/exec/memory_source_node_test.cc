@@ -397,7 +397,7 @@ TEST_F(MemorySourceNodeTest, table_compact_between_open_and_exec) {
   EXPECT_TRUE(tester.node()->HasBatchesRemaining());
 
   // Force a table compaction between MemorySource::Open and MemorySource::Exec.
-  EXPECT_OK(cpu_table_->CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(cpu_table_->CompactHotToCold());
 
   tester.GenerateNextResult().ExpectRowBatch(
       RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
@@ -406,7 +406,7 @@ TEST_F(MemorySourceNodeTest, table_compact_between_open_and_exec) {
   EXPECT_TRUE(tester.node()->HasBatchesRemaining());
 
   // Force a second compaction to check between Exec and a subsequent Exec.
-  EXPECT_OK(cpu_table_->CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(cpu_table_->CompactHotToCold());
 
   tester.GenerateNextResult().ExpectRowBatch(
       RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
@@ -527,7 +527,7 @@ TEST_P(ParamMemorySourceNodeTest, param_test) {
         break;
       }
       case ActionType::CompactTable: {
-        EXPECT_OK(cpu_table_->CompactHotToCold(arrow::default_memory_pool()));
+        EXPECT_OK(cpu_table_->CompactHotToCold());
         break;
       }
     }
@@ -20,6 +20,7 @@
 
 #include <rapidjson/document.h>
 #include <simdutf.h>
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <queue>
@@ -28,6 +29,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "glog/logging.h"
@@ -38,6 +40,22 @@
 #include "src/shared/types/typespb/types.pb.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_otel_export_batch_size,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_BATCH_SIZE", 8192),
+             "The number of metric data points or spans that an OTel export sink accumulates, "
+             "across row batches, before it sends them in a single request.");
+DEFINE_int32(carnot_otel_export_flush_interval_ms,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_FLUSH_INTERVAL_MS", 1000),
+             "The time after which an OTel export sink sends the data it accumulated, even if the "
+             "batch size wasn't reached. Pending data is always sent at the end of the stream.");
+DEFINE_int32(carnot_otel_export_max_inflight_requests,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_MAX_INFLIGHT_REQUESTS", 4),
+             "The number of requests that an OTel export sink sends to the collector concurrently. "
+             "The sink blocks when as many requests are queued. 0 sends every request "
+             "synchronously.");
+DEFINE_bool(carnot_otel_export_gzip, gflags::BoolFromEnv("PL_CARNOT_OTEL_EXPORT_GZIP", true),
+            "Whether OTel export requests are compressed with gzip.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -81,6 +99,26 @@ Status OTelExportSinkNode::OpenImpl(ExecState* exec_state) {
 }
 
 Status OTelExportSinkNode::CloseImpl(ExecState* exec_state) {
+  // Data that was consumed before the node is closed early is still exported.
+  auto send_status = Flush(exec_state, &pending_metrics_);
+  if (send_status.ok()) {
+    send_status = Flush(exec_state, &pending_spans_);
+  }
+  if (send_status.ok()) {
+    send_status = WaitForSends();
+  }
+  StopSenders();
+  {
+    absl::MutexLock lock(&send_mu_);
+    stats()->AddExtraInfo("export_requests", absl::StrCat(num_requests_));
+    auto stall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(send_stall_time_);
+    stats()->AddExtraInfo("send_stall_ms", absl::StrCat(stall_ms.count()));
+  }
+  if (!send_status.ok()) {
+    LOG(ERROR) << absl::Substitute("OTelExportSinkNode $0 in query $1: Error exporting data: $2",
+                                   plan_node_->id(), exec_state->query_id().str(),
+                                   send_status.msg());
+  }
   if (sent_eos_) {
     return Status::OK();
   }
@@ -154,16 +192,18 @@ inline std::vector<std::string> ParseStringOrArray(const std::string& input) {
   return out;
 }
 
-template <typename ResourceData>
-void ReplicateData(const std::vector<planpb::OTelAttribute>& attributes_spec,
-                   std::function<void(ResourceData)> add_data, ResourceData resource_data,
-                   const RowBatch& rb, int64_t row_idx) {
+using ::opentelemetry::proto::resource::v1::Resource;
+// Returns a copy of the resource for each permutation of the values of the JSON encoded
+// attributes in the row.
+std::vector<Resource> ReplicateResource(const std::vector<planpb::OTelAttribute>& attributes_spec,
+                                        Resource resource, const RowBatch& rb, int64_t row_idx) {
+  std::vector<Resource> resources;
   if (attributes_spec.empty()) {
-    add_data(std::move(resource_data));
-    return;
+    resources.push_back(std::move(resource));
+    return resources;
   }
   // We need to calculate the cross-product of all the attribute values across each other.
-  // We first create a vector of all permutations then we set the ResourceData attributes to
+  // We first create a vector of all permutations then we set the Resource attributes to
   // point to those permutations.
   std::vector<std::vector<std::string>> values;
   std::vector<std::vector<size_t>> permutation_sets;
@@ -198,14 +238,14 @@ void ReplicateData(const std::vector<planpb::OTelAttribute>& attributes_spec,
   }
 
   for (const auto& permutation : permutation_sets) {
-    ResourceData data = resource_data;
+    Resource& replica = resources.emplace_back(resource);
     for (const auto& [attribute_idx, value_idx] : Enumerate(permutation)) {
-      auto attribute = data.mutable_resource()->add_attributes();
+      auto attribute = replica.add_attributes();
       attribute->set_key(attributes_spec[attribute_idx].name());
       SetStringOrBytes(values[attribute_idx][value_idx], attribute);
     }
-    add_data(std::move(data));
   }
+  return resources;
 }
 
 Status FormatOTelStatus(int64_t id, const grpc::Status& status) {
@@ -214,96 +254,97 @@ Status FormatOTelStatus(int64_t id, const grpc::Status& status) {
       magic_enum::enum_name(status.error_code()), status.error_message(), status.error_details()));
 }
 
+using ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest;
 using ::opentelemetry::proto::metrics::v1::ResourceMetrics;
-Status OTelExportSinkNode::ConsumeMetrics(ExecState* exec_state, const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
+ResourceMetrics* OTelExportSinkNode::PendingResourceMetrics(const Resource& resource) {
+  if (pending_metrics_ == nullptr) {
+    pending_metrics_ = std::make_unique<ExportRequest>();
+    pending_metrics_->arena = std::make_unique<google::protobuf::Arena>();
+    pending_metrics_->metrics =
+        google::protobuf::Arena::CreateMessage<ExportMetricsServiceRequest>(
+            pending_metrics_->arena.get());
+    pending_metrics_->start_time = std::chrono::steady_clock::now();
   }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest request;
+  auto* request = pending_metrics_->metrics;
+  auto [it, inserted] = pending_metrics_->resource_indices.try_emplace(
+      resource.SerializeAsString(), request->resource_metrics_size());
+  if (!inserted) {
+    return request->mutable_resource_metrics(it->second);
+  }
+  auto* resource_metrics = request->add_resource_metrics();
+  *resource_metrics->mutable_resource() = resource;
+  // Every row adds a data point to each of the metrics of the plan, in the order of the plan.
+  auto* library_metrics = resource_metrics->add_instrumentation_library_metrics();
+  for (const auto& metric_pb : plan_node_->metrics()) {
+    auto* metric = library_metrics->add_metrics();
+    metric->set_name(metric_pb.name());
+    metric->set_description(metric_pb.description());
+    metric->set_unit(metric_pb.unit());
+  }
+  return resource_metrics;
+}
 
+Status OTelExportSinkNode::ConsumeMetrics(ExecState* exec_state, const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
-    ::opentelemetry::proto::metrics::v1::ResourceMetrics resource_metrics;
-    auto resource = resource_metrics.mutable_resource();
-    AddAttributes(resource->mutable_attributes(), plan_node_->resource_attributes_normal_encoding(),
-                  rb, row_idx);
-    // TODO(philkuz) optimize by pooling metrics by resource within a batch.
-    // TODO(philkuz) optimize by pooling data per metric per resource.
-
-    auto library_metrics = resource_metrics.add_instrumentation_library_metrics();
-    for (const auto& metric_pb : plan_node_->metrics()) {
-      auto metric = library_metrics->add_metrics();
-      metric->set_name(metric_pb.name());
-      metric->set_description(metric_pb.description());
-      metric->set_unit(metric_pb.unit());
-
-      if (metric_pb.has_summary()) {
-        auto summary = metric->mutable_summary();
-        auto data_point = summary->add_data_points();
-        AddAttributes(data_point->mutable_attributes(), metric_pb.attributes(), rb, row_idx);
-
-        auto time_col = rb.ColumnAt(metric_pb.time_column_index()).get();
-        data_point->set_time_unix_nano(
-            types::GetValueFromArrowArray<types::TIME64NS>(time_col, row_idx));
-
-        auto count_col = rb.ColumnAt(metric_pb.summary().count_column_index()).get();
-        data_point->set_count(types::GetValueFromArrowArray<types::INT64>(count_col, row_idx));
-
-        // The summary column is optional. It's not set if index < 0.
-        if (metric_pb.summary().sum_column_index() >= 0) {
-          auto sum_col = rb.ColumnAt(metric_pb.summary().sum_column_index()).get();
-          data_point->set_sum(types::GetValueFromArrowArray<types::FLOAT64>(sum_col, row_idx));
-        }
-
-        for (const auto& px_qv : metric_pb.summary().quantile_values()) {
-          auto qv = data_point->add_quantile_values();
-          qv->set_quantile(px_qv.quantile());
-          auto qv_col = rb.ColumnAt(px_qv.value_column_index()).get();
-          qv->set_value(types::GetValueFromArrowArray<types::FLOAT64>(qv_col, row_idx));
-        }
-      } else if (metric_pb.has_gauge()) {
-        auto gauge = metric->mutable_gauge();
-        auto data_point = gauge->add_data_points();
-        AddAttributes(data_point->mutable_attributes(), metric_pb.attributes(), rb, row_idx);
-
-        auto time_col = rb.ColumnAt(metric_pb.time_column_index()).get();
-        data_point->set_time_unix_nano(
-            types::GetValueFromArrowArray<types::TIME64NS>(time_col, row_idx));
-        if (metric_pb.gauge().has_float_column_index()) {
-          auto double_col = rb.ColumnAt(metric_pb.gauge().float_column_index()).get();
-          data_point->set_as_double(
-              types::GetValueFromArrowArray<types::FLOAT64>(double_col, row_idx));
-        } else {
-          auto int_col = rb.ColumnAt(metric_pb.gauge().int_column_index()).get();
-          data_point->set_as_int(types::GetValueFromArrowArray<types::INT64>(int_col, row_idx));
+    Resource row_resource;
+    AddAttributes(row_resource.mutable_attributes(),
+                  plan_node_->resource_attributes_normal_encoding(), rb, row_idx);
+    auto resources = ReplicateResource(plan_node_->resource_attributes_optional_json_encoded(),
+                                       std::move(row_resource), rb, row_idx);
+
+    for (const auto& resource : resources) {
+      auto* library_metrics =
+          PendingResourceMetrics(resource)->mutable_instrumentation_library_metrics(0);
+      for (const auto& [metric_idx, metric_pb] : Enumerate(plan_node_->metrics())) {
+        auto metric = library_metrics->mutable_metrics(metric_idx);
+        if (metric_pb.has_summary()) {
+          auto summary = metric->mutable_summary();
+          auto data_point = summary->add_data_points();
+          AddAttributes(data_point->mutable_attributes(), metric_pb.attributes(), rb, row_idx);
+
+          auto time_col = rb.ColumnAt(metric_pb.time_column_index()).get();
+          data_point->set_time_unix_nano(
+              types::GetValueFromArrowArray<types::TIME64NS>(time_col, row_idx));
+
+          auto count_col = rb.ColumnAt(metric_pb.summary().count_column_index()).get();
+          data_point->set_count(types::GetValueFromArrowArray<types::INT64>(count_col, row_idx));
+
+          // The summary column is optional. It's not set if index < 0.
+          if (metric_pb.summary().sum_column_index() >= 0) {
+            auto sum_col = rb.ColumnAt(metric_pb.summary().sum_column_index()).get();
+            data_point->set_sum(types::GetValueFromArrowArray<types::FLOAT64>(sum_col, row_idx));
+          }
+
+          for (const auto& px_qv : metric_pb.summary().quantile_values()) {
+            auto qv = data_point->add_quantile_values();
+            qv->set_quantile(px_qv.quantile());
+            auto qv_col = rb.ColumnAt(px_qv.value_column_index()).get();
+            qv->set_value(types::GetValueFromArrowArray<types::FLOAT64>(qv_col, row_idx));
+          }
+        } else if (metric_pb.has_gauge()) {
+          auto gauge = metric->mutable_gauge();
+          auto data_point = gauge->add_data_points();
+          AddAttributes(data_point->mutable_attributes(), metric_pb.attributes(), rb, row_idx);
+
+          auto time_col = rb.ColumnAt(metric_pb.time_column_index()).get();
+          data_point->set_time_unix_nano(
+              types::GetValueFromArrowArray<types::TIME64NS>(time_col, row_idx));
+          if (metric_pb.gauge().has_float_column_index()) {
+            auto double_col = rb.ColumnAt(metric_pb.gauge().float_column_index()).get();
+            data_point->set_as_double(
+                types::GetValueFromArrowArray<types::FLOAT64>(double_col, row_idx));
+          } else {
+            auto int_col = rb.ColumnAt(metric_pb.gauge().int_column_index()).get();
+            data_point->set_as_int(types::GetValueFromArrowArray<types::INT64>(int_col, row_idx));
+          }
         }
       }
+      pending_metrics_->size += plan_node_->metrics().size();
     }
-    ReplicateData<ResourceMetrics>(
-        plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceMetrics metrics) {
-          *request.add_resource_metrics() = std::move(metrics);
-        },
-        std::move(resource_metrics), rb, row_idx);
-  }
-
-  // Set timeout, to avoid blocking on query.
-  if (plan_node_->timeout() > 0) {
-    std::chrono::system_clock::time_point deadline =
-        std::chrono::system_clock::now() + std::chrono::seconds{plan_node_->timeout()};
-    context.set_deadline(deadline);
-  }
-
-  grpc::Status status = metrics_service_stub_->Export(&context, request, &metrics_response_);
-  if (!status.ok()) {
-    if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
-      exec_state->exec_metrics()->otlp_metrics_timeout_counter.Increment();
+    if (pending_metrics_ != nullptr &&
+        pending_metrics_->size >= FLAGS_carnot_otel_export_batch_size) {
+      PX_RETURN_IF_ERROR(Flush(exec_state, &pending_metrics_));
     }
-
-    return FormatOTelStatus(plan_node_->id(), status);
   }
   return Status::OK();
 }
@@ -332,26 +373,37 @@ std::string GenerateID(uint64_t num_bytes) {
   return random_string;
 }
 
+using ::opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest;
 using ::opentelemetry::proto::trace::v1::ResourceSpans;
-Status OTelExportSinkNode::ConsumeSpans(ExecState* exec_state, const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
+ResourceSpans* OTelExportSinkNode::PendingResourceSpans(const Resource& resource) {
+  if (pending_spans_ == nullptr) {
+    pending_spans_ = std::make_unique<ExportRequest>();
+    pending_spans_->arena = std::make_unique<google::protobuf::Arena>();
+    pending_spans_->spans = google::protobuf::Arena::CreateMessage<ExportTraceServiceRequest>(
+        pending_spans_->arena.get());
+    pending_spans_->start_time = std::chrono::steady_clock::now();
   }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest request;
+  auto* request = pending_spans_->spans;
+  auto [it, inserted] = pending_spans_->resource_indices.try_emplace(
+      resource.SerializeAsString(), request->resource_spans_size());
+  if (!inserted) {
+    return request->mutable_resource_spans(it->second);
+  }
+  auto* resource_spans = request->add_resource_spans();
+  *resource_spans->mutable_resource() = resource;
+  resource_spans->add_instrumentation_library_spans();
+  return resource_spans;
+}
 
+Status OTelExportSinkNode::ConsumeSpans(ExecState* exec_state, const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
-    // TODO(philkuz) aggregate spans by resource.
-    ::opentelemetry::proto::trace::v1::ResourceSpans resource_spans;
-    auto resource = resource_spans.mutable_resource();
-    AddAttributes(resource->mutable_attributes(), plan_node_->resource_attributes_normal_encoding(),
-                  rb, row_idx);
-    auto library_spans = resource_spans.add_instrumentation_library_spans();
+    Resource row_resource;
+    AddAttributes(row_resource.mutable_attributes(),
+                  plan_node_->resource_attributes_normal_encoding(), rb, row_idx);
+    // The spans of the row are built once, and copied to each replica of the resource.
+    ::opentelemetry::proto::trace::v1::InstrumentationLibrarySpans row_spans;
     for (const auto& span_pb : plan_node_->spans()) {
-      auto span = library_spans->add_spans();
+      auto span = row_spans.add_spans();
       if (span_pb.has_name_string()) {
         span->set_name(span_pb.name_string());
       } else {
@@ -415,10 +467,48 @@ Status OTelExportSinkNode::ConsumeSpans(ExecState* exec_state, const RowBatch& r
       }
     }
 
-    ReplicateData<ResourceSpans>(
-        plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceSpans span) { *request.add_resource_spans() = std::move(span); },
-        std::move(resource_spans), rb, row_idx);
+    auto resources = ReplicateResource(plan_node_->resource_attributes_optional_json_encoded(),
+                                       std::move(row_resource), rb, row_idx);
+    for (const auto& resource : resources) {
+      PendingResourceSpans(resource)->mutable_instrumentation_library_spans(0)->MergeFrom(
+          row_spans);
+      pending_spans_->size += row_spans.spans_size();
+    }
+    if (pending_spans_ != nullptr &&
+        pending_spans_->size >= FLAGS_carnot_otel_export_batch_size) {
+      PX_RETURN_IF_ERROR(Flush(exec_state, &pending_spans_));
+    }
+  }
+  return Status::OK();
+}
+
+Status OTelExportSinkNode::MaybeFlush(ExecState* exec_state,
+                                      std::unique_ptr<ExportRequest>* pending) {
+  if (*pending == nullptr) {
+    return Status::OK();
+  }
+  auto age = std::chrono::steady_clock::now() - (*pending)->start_time;
+  if ((*pending)->size < FLAGS_carnot_otel_export_batch_size &&
+      age < std::chrono::milliseconds(FLAGS_carnot_otel_export_flush_interval_ms)) {
+    return Status::OK();
+  }
+  return Flush(exec_state, pending);
+}
+
+Status OTelExportSinkNode::Flush(ExecState* exec_state, std::unique_ptr<ExportRequest>* pending) {
+  if (*pending == nullptr) {
+    return Status::OK();
+  }
+  return SendRequest(exec_state, std::move(*pending));
+}
+
+Status OTelExportSinkNode::Export(ExecState* exec_state, const ExportRequest& req) {
+  grpc::ClientContext context;
+  for (const auto& header : plan_node_->endpoint_headers()) {
+    context.AddMetadata(header.first, header.second);
+  }
+  if (FLAGS_carnot_otel_export_gzip) {
+    context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
   }
   // Set timeout, to avoid blocking on query.
   if (plan_node_->timeout() > 0) {
@@ -427,18 +517,118 @@ Status OTelExportSinkNode::ConsumeSpans(ExecState* exec_state, const RowBatch& r
     context.set_deadline(deadline);
   }
 
-  grpc::Status status = trace_service_stub_->Export(&context, request, &trace_response_);
-  if (!status.ok()) {
+  grpc::Status status;
+  if (req.metrics != nullptr) {
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse response;
+    status = metrics_service_stub_->Export(&context, *req.metrics, &response);
+    if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+      exec_state->exec_metrics()->otlp_metrics_timeout_counter.Increment();
+    }
+  } else {
+    opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse response;
+    status = trace_service_stub_->Export(&context, *req.spans, &response);
     if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
       exec_state->exec_metrics()->otlp_spans_timeout_counter.Increment();
     }
-
+  }
+  if (!status.ok()) {
     return FormatOTelStatus(plan_node_->id(), status);
   }
   return Status::OK();
 }
 
+Status OTelExportSinkNode::SendRequest(ExecState* exec_state, std::unique_ptr<ExportRequest> req) {
+  if (FLAGS_carnot_otel_export_max_inflight_requests <= 0) {
+    {
+      absl::MutexLock lock(&send_mu_);
+      ++num_requests_;
+    }
+    return Export(exec_state, *req);
+  }
+  auto max_inflight = static_cast<size_t>(FLAGS_carnot_otel_export_max_inflight_requests);
+
+  absl::MutexLock lock(&send_mu_);
+  PX_RETURN_IF_ERROR(send_status_);
+  if (senders_.empty()) {
+    stop_senders_ = false;
+    for (size_t i = 0; i < max_inflight; ++i) {
+      senders_.emplace_back(&OTelExportSinkNode::SendLoop, this, exec_state);
+    }
+  }
+  if (send_queue_.size() >= max_inflight) {
+    auto stall_start = std::chrono::steady_clock::now();
+    while (send_status_.ok() && send_queue_.size() >= max_inflight) {
+      send_cv_.Wait(&send_mu_);
+    }
+    send_stall_time_ += std::chrono::steady_clock::now() - stall_start;
+    PX_RETURN_IF_ERROR(send_status_);
+  }
+  send_queue_.push_back(std::move(req));
+  ++num_requests_;
+  send_cv_.SignalAll();
+  return Status::OK();
+}
+
+Status OTelExportSinkNode::WaitForSends() {
+  absl::MutexLock lock(&send_mu_);
+  while (send_status_.ok() && (!send_queue_.empty() || num_sending_ > 0)) {
+    send_cv_.Wait(&send_mu_);
+  }
+  return send_status_;
+}
+
+void OTelExportSinkNode::SendLoop(ExecState* exec_state) {
+  send_mu_.Lock();
+  while (true) {
+    while (!stop_senders_ && send_queue_.empty()) {
+      send_cv_.Wait(&send_mu_);
+    }
+    if (send_queue_.empty()) {
+      break;
+    }
+    auto req = std::move(send_queue_.front());
+    send_queue_.pop_front();
+    ++num_sending_;
+    // There is room in the queue again.
+    send_cv_.SignalAll();
+    send_mu_.Unlock();
+
+    Status s = Export(exec_state, *req);
+    // Frees the arena of the request outside of the lock.
+    req.reset();
+
+    send_mu_.Lock();
+    --num_sending_;
+    if (!s.ok() && send_status_.ok()) {
+      // Later requests are dropped once an export failed, since the query fails with the error.
+      send_status_ = s;
+      send_queue_.clear();
+    }
+    send_cv_.SignalAll();
+  }
+  send_mu_.Unlock();
+}
+
+void OTelExportSinkNode::StopSenders() {
+  if (senders_.empty()) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&send_mu_);
+    stop_senders_ = true;
+    send_cv_.SignalAll();
+  }
+  for (auto& sender : senders_) {
+    sender.join();
+  }
+  senders_.clear();
+}
+
 Status OTelExportSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  {
+    absl::MutexLock lock(&send_mu_);
+    PX_RETURN_IF_ERROR(send_status_);
+  }
   if (plan_node_->metrics().size()) {
     PX_RETURN_IF_ERROR(ConsumeMetrics(exec_state, rb));
   }
@@ -446,9 +636,14 @@ Status OTelExportSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch
     PX_RETURN_IF_ERROR(ConsumeSpans(exec_state, rb));
   }
   if (rb.eos()) {
+    PX_RETURN_IF_ERROR(Flush(exec_state, &pending_metrics_));
+    PX_RETURN_IF_ERROR(Flush(exec_state, &pending_spans_));
+    PX_RETURN_IF_ERROR(WaitForSends());
     sent_eos_ = true;
+    return Status::OK();
   }
-  return Status::OK();
+  PX_RETURN_IF_ERROR(MaybeFlush(exec_state, &pending_metrics_));
+  return MaybeFlush(exec_state, &pending_spans_);
 }
 
 }  // namespace exec
@@ -17,9 +17,17 @@
  */
 #pragma once
 
+#include <google/protobuf/arena.h>
 #include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
 
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
@@ -29,6 +37,11 @@
 #include "src/common/base/base.h"
 #include "src/shared/types/types.h"
 
+DECLARE_int32(carnot_otel_export_batch_size);
+DECLARE_int32(carnot_otel_export_flush_interval_ms);
+DECLARE_int32(carnot_otel_export_max_inflight_requests);
+DECLARE_bool(carnot_otel_export_gzip);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -39,7 +52,7 @@ struct SpanConfig {
 
 class OTelExportSinkNode : public SinkNode {
  public:
-  virtual ~OTelExportSinkNode() = default;
+  virtual ~OTelExportSinkNode() { StopSenders(); }
 
  protected:
   std::string DebugStringImpl() override;
@@ -51,18 +64,68 @@ class OTelExportSinkNode : public SinkNode {
                          size_t parent_index) override;
 
  private:
+  // An export request that is accumulated across row batches. Its messages are allocated on their
+  // own arena, so that they are freed at once after the request was sent.
+  struct ExportRequest {
+    std::unique_ptr<google::protobuf::Arena> arena;
+    // Exactly one of metrics and spans is set.
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest* metrics = nullptr;
+    opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest* spans = nullptr;
+    // The index of the ResourceMetrics or ResourceSpans of each serialized Resource, so that rows
+    // that share a resource are sent under a single one.
+    absl::flat_hash_map<std::string, int> resource_indices;
+    // The number of data points or spans in the request.
+    int64_t size = 0;
+    std::chrono::steady_clock::time_point start_time;
+  };
+
   Status ConsumeMetrics(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeSpans(ExecState* exec_state, const table_store::schema::RowBatch& rb);
 
+  // Returns the ResourceMetrics (ResourceSpans) of the resource in the pending request, adding it
+  // with a single scope if the resource wasn't seen since the last flush.
+  opentelemetry::proto::metrics::v1::ResourceMetrics* PendingResourceMetrics(
+      const opentelemetry::proto::resource::v1::Resource& resource);
+  opentelemetry::proto::trace::v1::ResourceSpans* PendingResourceSpans(
+      const opentelemetry::proto::resource::v1::Resource& resource);
+
+  // Sends the pending request if it holds FLAGS_carnot_otel_export_batch_size items or if it
+  // started more than FLAGS_carnot_otel_export_flush_interval_ms ago.
+  Status MaybeFlush(ExecState* exec_state, std::unique_ptr<ExportRequest>* pending);
+  Status Flush(ExecState* exec_state, std::unique_ptr<ExportRequest>* pending);
+  Status Export(ExecState* exec_state, const ExportRequest& req);
+
+  // Hands the request to the sender threads, so that the next one can be built while it is sent.
+  // Blocks while FLAGS_carnot_otel_export_max_inflight_requests requests are queued, and returns
+  // the error of any earlier export that failed. Exports synchronously if the flag is 0.
+  Status SendRequest(ExecState* exec_state, std::unique_ptr<ExportRequest> req);
+  // Blocks until every queued request was exported, and returns the first error of the exports.
+  Status WaitForSends();
+  void SendLoop(ExecState* exec_state);
+  void StopSenders();
+
   std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse metrics_response_;
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface*
       metrics_service_stub_;
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse trace_response_;
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* trace_service_stub_;
   std::unique_ptr<plan::OTelExportSinkOperator> plan_node_;
 
   std::unique_ptr<SpanConfig> span_config_;
+
+  std::unique_ptr<ExportRequest> pending_metrics_;
+  std::unique_ptr<ExportRequest> pending_spans_;
+
+  // Each sender thread exports one request at a time from send_queue_.
+  std::vector<std::thread> senders_;
+  absl::Mutex send_mu_;
+  absl::CondVar send_cv_;
+  std::deque<std::unique_ptr<ExportRequest>> send_queue_ ABSL_GUARDED_BY(send_mu_);
+  // The number of requests that were taken off the queue and are being exported.
+  int64_t num_sending_ ABSL_GUARDED_BY(send_mu_) = 0;
+  bool stop_senders_ ABSL_GUARDED_BY(send_mu_) = false;
+  Status send_status_ ABSL_GUARDED_BY(send_mu_);
+  int64_t num_requests_ ABSL_GUARDED_BY(send_mu_) = 0;
+  std::chrono::nanoseconds send_stall_time_ ABSL_GUARDED_BY(send_mu_){0};
 };
 
 }  // namespace exec
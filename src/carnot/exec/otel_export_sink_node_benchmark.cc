@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <benchmark/benchmark.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "opentelemetry/proto/collector/metrics/v1/metrics_service_mock.grpc.pb.h"
+
+#include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+using opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest;
+using opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse;
+using opentelemetry::proto::collector::metrics::v1::MetricsService;
+using opentelemetry::proto::collector::metrics::v1::MockMetricsServiceStub;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using ::testing::_;
+using ::testing::Invoke;
+
+constexpr char kOperatorProto[] = R"pb(
+resource {
+  attributes {
+    name: "k8s.pod.name"
+    column {
+      column_type: STRING
+      column_index: 1
+    }
+  }
+}
+metrics {
+  name: "http.resp.latency"
+  time_column_index: 0
+  attributes {
+    name: "http.method"
+    column {
+      column_type: STRING
+      column_index: 2
+    }
+  }
+  gauge { int_column_index: 3 }
+})pb";
+
+// Exports gauges of num_pods pods to a mock collector with the given latency in microseconds, with
+// the given number of inflight requests (0 exports synchronously).
+// NOLINTNEXTLINE : runtime/references.
+void BM_OTelExportSinkNode(benchmark::State& state) {
+  auto collector_latency = std::chrono::microseconds(state.range(0));
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_max_inflight_requests, state.range(1));
+  int64_t num_pods = state.range(2);
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+
+  // Stands in for a collector on the local host.
+  auto mock_unique = std::make_unique<::testing::NiceMock<MockMetricsServiceStub>>();
+  ON_CALL(*mock_unique, Export(_, _, _))
+      .WillByDefault(Invoke([&](grpc::ClientContext*, const ExportMetricsServiceRequest& req,
+                                ExportMetricsServiceResponse*) {
+        // The collector has to parse the request it receives.
+        benchmark::DoNotOptimize(req.SerializeAsString());
+        std::this_thread::sleep_for(collector_latency);
+        return grpc::Status::OK;
+      }));
+
+  auto exec_state = std::make_unique<px::carnot::exec::ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator,
+      [&](const std::string&, bool) -> std::unique_ptr<MetricsService::StubInterface> {
+        return std::move(mock_unique);
+      },
+      MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr, [&](grpc::ClientContext*) {});
+
+  px::carnot::planpb::OTelExportSinkOperator otel_sink_op;
+  CHECK(google::protobuf::TextFormat::ParseFromString(kOperatorProto, &otel_sink_op));
+  auto plan_node = std::make_unique<px::carnot::plan::OTelExportSinkOperator>(1);
+  PX_CHECK_OK(plan_node->Init(otel_sink_op));
+
+  int64_t num_rows = 1024;
+  std::vector<px::types::Time64NSValue> times;
+  std::vector<px::types::StringValue> pods;
+  std::vector<px::types::StringValue> methods;
+  std::vector<px::types::Int64Value> values;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.emplace_back(i);
+    pods.emplace_back(absl::StrCat("pl/pod-", i % num_pods));
+    methods.emplace_back(i % 2 ? "GET" : "POST");
+    values.emplace_back(i);
+  }
+  RowDescriptor input_rd(
+      {DataType::TIME64NS, DataType::STRING, DataType::STRING, DataType::INT64});
+  RowDescriptor output_rd({});
+  auto rb = px::carnot::exec::RowBatchBuilder(input_rd, num_rows, /*eow*/ false, /*eos*/ false)
+                .AddColumn<px::types::Time64NSValue>(times)
+                .AddColumn<px::types::StringValue>(pods)
+                .AddColumn<px::types::StringValue>(methods)
+                .AddColumn<px::types::Int64Value>(values)
+                .get();
+
+  px::carnot::exec::OTelExportSinkNode node;
+  PX_CHECK_OK(node.Init(*plan_node, output_rd, {input_rd}));
+  PX_CHECK_OK(node.Prepare(exec_state.get()));
+  PX_CHECK_OK(node.Open(exec_state.get()));
+  for (auto _ : state) {
+    PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+  }
+  PX_CHECK_OK(node.Close(exec_state.get()));
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+
+BENCHMARK(BM_OTelExportSinkNode)
+    ->ArgNames({"latency_us", "inflight", "pods"})
+    ->ArgsProduct({{100, 1000}, {0, 4}, {16, 1024}})
+    ->Unit(benchmark::kMillisecond);
@@ -137,7 +137,7 @@ metrics {
 
   auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
       *plan_node, output_rd, {input_rd}, exec_state_.get());
-  auto rb1 = RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+  auto rb1 = RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
                  .AddColumn<types::Time64NSValue>({10})
                  .AddColumn<types::Float64Value>({1.0})
                  .get();
@@ -192,7 +192,7 @@ metrics {
   auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
       *plan_node, output_rd, {input_rd}, exec_state_.get());
   std::string non_utf_8_bytes(1, 0xC0);
-  auto rb1 = RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+  auto rb1 = RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
                  .AddColumn<types::Time64NSValue>({10})
                  .AddColumn<types::Float64Value>({1.0})
                  .AddColumn<types::StringValue>({non_utf_8_bytes})
@@ -323,16 +323,6 @@ resource_metrics {
             }
           }
         }
-      }
-    }
-  }
-}
-resource_metrics {
-  resource {}
-  instrumentation_library_metrics {
-    metrics {
-      name: "http.resp.latency"
-      summary {
         data_points {
           time_unix_nano: 11
           count: 100
@@ -468,16 +458,6 @@ resource_metrics {
           time_unix_nano: 10
           as_int: 15
         }
-      }
-    }
-  }
-}
-resource_metrics {
-  resource {}
-  instrumentation_library_metrics {
-    metrics {
-      name: "http.resp.latency"
-      gauge {
         data_points {
           time_unix_nano: 11
           as_int: 150
@@ -511,16 +491,6 @@ resource_metrics {
           time_unix_nano: 10
           as_int: 15
         }
-      }
-    }
-  }
-}
-resource_metrics {
-  resource {}
-  instrumentation_library_metrics {
-    metrics {
-      name: "http.resp.latency"
-      gauge {
         data_points {
           time_unix_nano: 11
           as_int: 150
@@ -589,17 +559,6 @@ resource_metrics {
           time_unix_nano: 10
           as_int: 15
         }
-      }
-    }
-  }
-})pb",
-                               R"pb(
-resource_metrics {
-  resource {}
-  instrumentation_library_metrics {
-    metrics {
-      name: "http.resp.latency"
-      gauge {
         data_points {
           time_unix_nano: 11
           as_int: 150
@@ -964,23 +923,6 @@ resource_metrics {
           time_unix_nano: 10
           as_int: 15
         }
-      }
-    }
-  }
-}
-resource_metrics {
-  resource {
-    attributes {
-      key: "pixie_cloud_addr"
-      value {
-        string_value: "dev.withpixie.dev"
-      }
-    }
-  }
-  instrumentation_library_metrics {
-    metrics {
-      name: "http.resp.latency"
-      gauge {
         data_points {
           attributes {
             key: "req_path"
@@ -1184,11 +1126,6 @@ resource_spans {
       kind: SPAN_KIND_SERVER
       status {}
     }
-  }
-}
-resource_spans {
-  resource {}
-  instrumentation_library_spans {
     spans {
       name: "span2"
       start_time_unix_nano: 20
@@ -1529,8 +1466,9 @@ TEST_P(SpanIDTests, generate_ids) {
   auto rb = RowBatch::FromProto(row_batch_proto).ConsumeValueOrDie();
   tester.ConsumeNext(*rb.get(), 1, 0);
 
-  for (const auto& [s_idx, span] : Enumerate(actual_proto.resource_spans())) {
-    for (const auto& ilm : span.instrumentation_library_spans()) {
+  size_t s_idx = 0;
+  for (const auto& resource_spans : actual_proto.resource_spans()) {
+    for (const auto& ilm : resource_spans.instrumentation_library_spans()) {
       for (const auto& span : ilm.spans()) {
         SCOPED_TRACE(absl::Substitute("span $0", s_idx));
         {
@@ -1545,6 +1483,7 @@ TEST_P(SpanIDTests, generate_ids) {
           SCOPED_TRACE("parent_span_id");
           tc.expected_parent_span_ids[s_idx].Compare(span.parent_span_id());
         }
+        ++s_idx;
       }
     }
   }
@@ -1732,6 +1671,105 @@ eos: true)pb";
   EXPECT_THAT(retval.ToString(), ::testing::MatchesRegex(".*INTERNAL.*"));
 }
 
+TEST_F(OTelExportSinkNodeTest, batch_size_splits_requests) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_batch_size, 3);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_max_inflight_requests, 1);
+  std::vector<otelmetricscollector::ExportMetricsServiceRequest> actual_protos;
+  EXPECT_CALL(*metrics_mock_, Export(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&actual_protos](const auto&, const auto& proto, const auto&) {
+        actual_protos.push_back(proto);
+        return grpc::Status::OK;
+      }));
+
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(R"pb(
+metrics {
+  name: "http.resp.latency"
+  time_column_index: 0
+  gauge { int_column_index: 1 }
+})pb",
+                                                            &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::INT64});
+  RowDescriptor output_rd({});
+
+  auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  // Rows accumulate across batches until the batch size is reached, and the rest is sent at eos.
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Time64NSValue>({10, 11})
+                         .AddColumn<types::Int64Value>({1, 2})
+                         .get(),
+                     1, 0);
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Time64NSValue>({12, 13})
+                         .AddColumn<types::Int64Value>({3, 4})
+                         .get(),
+                     1, 0);
+
+  ASSERT_EQ(2, actual_protos.size());
+  ASSERT_EQ(1, actual_protos[0].resource_metrics_size());
+  const auto& first_points =
+      actual_protos[0].resource_metrics(0).instrumentation_library_metrics(0).metrics(0).gauge();
+  ASSERT_EQ(3, first_points.data_points_size());
+  EXPECT_EQ(12, first_points.data_points(2).time_unix_nano());
+  const auto& second_points =
+      actual_protos[1].resource_metrics(0).instrumentation_library_metrics(0).metrics(0).gauge();
+  ASSERT_EQ(1, second_points.data_points_size());
+  EXPECT_EQ(13, second_points.data_points(0).time_unix_nano());
+}
+
+TEST_F(OTelExportSinkNodeTest, flush_interval_sends_pending_batches) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_flush_interval_ms, 0);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_max_inflight_requests, 0);
+  std::vector<oteltracecollector::ExportTraceServiceRequest> actual_protos;
+  EXPECT_CALL(*trace_mock_, Export(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&actual_protos](const auto&, const auto& proto, const auto&) {
+        actual_protos.push_back(proto);
+        return grpc::Status::OK;
+      }));
+
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(R"pb(
+spans {
+  name_string: "span"
+  start_time_column_index: 0
+  end_time_column_index: 1
+  trace_id_column_index: -1
+  span_id_column_index: -1
+  parent_span_id_column_index: -1
+})pb",
+                                                            &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::TIME64NS});
+  RowDescriptor output_rd({});
+
+  auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Time64NSValue>({10})
+                         .AddColumn<types::Time64NSValue>({12})
+                         .get(),
+                     1, 0);
+  // The first batch is sent once the flush interval passed, before the end of the stream.
+  ASSERT_EQ(1, actual_protos.size());
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Time64NSValue>({20})
+                         .AddColumn<types::Time64NSValue>({22})
+                         .get(),
+                     1, 0);
+  ASSERT_EQ(2, actual_protos.size());
+  EXPECT_EQ(20, actual_protos[1]
+                    .resource_spans(0)
+                    .instrumentation_library_spans(0)
+                    .spans(0)
+                    .start_time_unix_nano());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/runtime_join_filter.h"
+
+#include <arrow/memory_pool.h>
+
+#include <string_view>
+
+#include "src/carnot/exec/key_hash_table.h"
+#include "src/shared/types/arrow_adapter.h"
+
+DEFINE_bool(carnot_runtime_join_filters,
+            gflags::BoolFromEnv("PL_CARNOT_RUNTIME_JOIN_FILTERS", true),
+            "Whether the scans that feed the probe side of a join should drop the rows whose keys "
+            "are not on the build side of the join. Only applies to scans in the same plan fragment as "
+            "the join; the filters are not sent to remote agents.");
+DEFINE_int64(carnot_runtime_join_filter_max_exact_keys,
+             gflags::Int64FromEnv("PL_CARNOT_RUNTIME_JOIN_FILTER_MAX_EXACT_KEYS", 1 << 16),
+             "The maximum number of build side keys that a runtime join filter stores exactly. "
+             "Larger build sides are stored in a bloom filter.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+constexpr double kBloomFilterErrorRate = 0.01;
+
+std::string_view HashBytes(const uint64_t& hash) {
+  return std::string_view(reinterpret_cast<const char*>(&hash), sizeof(hash));
+}
+
+template <types::DataType DT>
+Status TakeRows(const arrow::Array* input_col, const std::vector<int64_t>& rows,
+                table_store::schema::RowBatch* output_rb) {
+  auto builder = types::MakeArrowBuilder(DT, arrow::default_memory_pool());
+  PX_RETURN_IF_ERROR(builder->Reserve(rows.size()));
+  for (int64_t row_idx : rows) {
+    PX_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+        builder.get(), types::GetValueFromArrowArray<DT>(input_col, row_idx)));
+  }
+  std::shared_ptr<arrow::Array> output_col;
+  PX_RETURN_IF_ERROR(builder->Finish(&output_col));
+  return output_rb->AddColumn(output_col);
+}
+
+}  // namespace
+
+Status RuntimeJoinFilter::Finalize() {
+  DCHECK(!ready_);
+  num_keys_ = hashes_.size();
+  if (num_keys_ > FLAGS_carnot_runtime_join_filter_max_exact_keys) {
+    PX_ASSIGN_OR_RETURN(bloom_filter_,
+                        bloomfilter::XXHash64BloomFilter::Create(num_keys_, kBloomFilterErrorRate));
+    for (const uint64_t& hash : hashes_) {
+      bloom_filter_->Insert(HashBytes(hash));
+    }
+    hashes_ = absl::flat_hash_set<uint64_t>();
+  }
+  ready_ = true;
+  return Status::OK();
+}
+
+bool RuntimeJoinFilter::MayContain(uint64_t hash) const {
+  DCHECK(ready_);
+  if (bloom_filter_ != nullptr) {
+    return bloom_filter_->Contains(HashBytes(hash));
+  }
+  return hashes_.contains(hash);
+}
+
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> RuntimeJoinFilter::Apply(
+    const std::vector<int64_t>& key_indices, const table_store::schema::RowBatch& rb) const {
+  DCHECK_EQ(key_indices.size(), key_types_.size());
+  std::vector<const arrow::Array*> key_cols;
+  for (int64_t col_idx : key_indices) {
+    key_cols.push_back(rb.ColumnAt(col_idx).get());
+  }
+  std::vector<uint64_t> hashes;
+  HashKeyColumns(key_cols, key_types_, rb.num_rows(), &hashes);
+
+  std::vector<int64_t> rows;
+  rows.reserve(rb.num_rows());
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    if (MayContain(hashes[row_idx])) {
+      rows.push_back(row_idx);
+    }
+  }
+  if (static_cast<int64_t>(rows.size()) == rb.num_rows()) {
+    return std::unique_ptr<table_store::schema::RowBatch>();
+  }
+
+  auto output_rb = std::make_unique<table_store::schema::RowBatch>(rb.desc(), rows.size());
+  for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+    auto input_col = rb.ColumnAt(col_idx).get();
+#define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(TakeRows<_dt_>(input_col, rows, output_rb.get()));
+    PX_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  output_rb->set_eow(rb.eow());
+  output_rb->set_eos(rb.eos());
+  return output_rb;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
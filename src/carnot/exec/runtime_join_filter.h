@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_bool(carnot_runtime_join_filters);
+DECLARE_int64(carnot_runtime_join_filter_max_exact_keys);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * RuntimeJoinFilter holds the keys of the build side of an EquijoinNode, so that the scan which
+ * feeds the probe side can drop rows that can't match anything before they are sent through the
+ * rest of the plan.
+ *
+ * Keys are tracked by the hashes computed by HashKeyColumns. Small build sides keep the exact set
+ * of hashes, larger ones are folded into a bloom filter once the build side is done. Either way
+ * the filter can have false positives but never false negatives, so the join still compares the
+ * keys of every probed row.
+ *
+ * The filter only lives in the Carnot instance that runs the join. It is applied to memory sources
+ * in the same plan fragment, and is never sent to the agents behind a GRPC source.
+ */
+class RuntimeJoinFilter {
+ public:
+  explicit RuntimeJoinFilter(std::vector<types::DataType> key_types)
+      : key_types_(std::move(key_types)) {}
+
+  /**
+   * Adds the hash of a build side key. Must not be called after Finalize().
+   */
+  void Insert(uint64_t hash) {
+    DCHECK(!ready_);
+    hashes_.insert(hash);
+  }
+
+  /**
+   * Marks the build side as done, after which the filter can be applied.
+   */
+  Status Finalize();
+
+  /**
+   * Returns false if no build side key has the given hash.
+   */
+  bool MayContain(uint64_t hash) const;
+
+  /**
+   * Returns the rows of rb whose keys, i.e. the columns at key_indices, may be in the filter.
+   * Returns nullptr if every row may be in the filter, in which case rb should be used as is.
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> Apply(
+      const std::vector<int64_t>& key_indices, const table_store::schema::RowBatch& rb) const;
+
+  bool ready() const { return ready_; }
+  bool exact() const { return bloom_filter_ == nullptr; }
+  int64_t num_keys() const { return num_keys_; }
+  const std::vector<types::DataType>& key_types() const { return key_types_; }
+
+ private:
+  const std::vector<types::DataType> key_types_;
+  bool ready_ = false;
+  int64_t num_keys_ = 0;
+  absl::flat_hash_set<uint64_t> hashes_;
+  // Replaces hashes_ when the build side has more than
+  // FLAGS_carnot_runtime_join_filter_max_exact_keys keys.
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
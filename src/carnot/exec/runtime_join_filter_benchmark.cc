@@ -0,0 +1,228 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <arrow/memory_pool.h>
+#include <benchmark/benchmark.h>
+#include <google/protobuf/text_format.h>
+#include <memory>
+#include <vector>
+
+#include <sole.hpp>
+
+#include "src/carnot/exec/exec_graph.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/runtime_join_filter.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/plan/plan_fragment.h"
+#include "src/carnot/plan/plan_state.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+using px::carnot::exec::ExecState;
+using px::carnot::exec::ExecutionGraph;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::udf::Registry;
+using px::table_store::Table;
+using px::table_store::schema::Relation;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using px::types::Float64Value;
+using px::types::Int64Value;
+using px::types::ToArrow;
+
+constexpr int64_t kBatchSize = 1024;
+constexpr int64_t kProbeRows = 256 * 1024;
+constexpr int64_t kNumProbeKeys = 16 * 1024;
+
+// Joins the rows of "probe" with the keys in "build". Both sources are in the same plan fragment
+// as the join, which is the only case where the runtime join filter is applied.
+constexpr char kJoinPlan[] = R"proto(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 3
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+    }
+    nodes {
+      id: 3
+      sorted_children: 4
+      sorted_parents: 2
+      sorted_parents: 1
+    }
+    nodes {
+      id: 4
+      sorted_parents: 3
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "probe"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "a"
+        column_idxs: 1
+        column_types: FLOAT64
+        column_names: "b"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "build"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "k"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: JOIN_OPERATOR
+      join_op {
+        type: INNER
+        equality_conditions {
+          left_column_index: 0
+          right_column_index: 0
+        }
+        output_columns {
+          parent_index: 1
+          column_index: 0
+        }
+        output_columns {
+          parent_index: 1
+          column_index: 1
+        }
+        column_names: "a"
+        column_names: "b"
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "joined"
+        column_types: INT64
+        column_types: FLOAT64
+        column_names: "a"
+        column_names: "b"
+      }
+    }
+  }
+)proto";
+
+std::shared_ptr<Table> MakeProbeTable() {
+  Relation rel({DataType::INT64, DataType::FLOAT64}, {"a", "b"});
+  auto table = Table::Create("probe", rel);
+  for (int64_t offset = 0; offset < kProbeRows; offset += kBatchSize) {
+    std::vector<Int64Value> keys;
+    std::vector<Float64Value> values;
+    for (int64_t row = offset; row < offset + kBatchSize; ++row) {
+      keys.emplace_back(row % kNumProbeKeys);
+      values.emplace_back(static_cast<double>(row));
+    }
+    RowBatch rb(RowDescriptor(rel.col_types()), kBatchSize);
+    PX_CHECK_OK(rb.AddColumn(ToArrow(keys, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(ToArrow(values, arrow::default_memory_pool())));
+    PX_CHECK_OK(table->WriteRowBatch(rb));
+  }
+  return table;
+}
+
+std::shared_ptr<Table> MakeBuildTable(int64_t num_keys) {
+  Relation rel({DataType::INT64}, {"k"});
+  auto table = Table::Create("build", rel);
+  std::vector<Int64Value> keys;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    keys.emplace_back(key);
+  }
+  RowBatch rb(RowDescriptor(rel.col_types()), num_keys);
+  PX_CHECK_OK(rb.AddColumn(ToArrow(keys, arrow::default_memory_pool())));
+  PX_CHECK_OK(table->WriteRowBatch(rb));
+  return table;
+}
+
+// Runs a join whose build side holds state.range(0) of the kNumProbeKeys keys of the probe side,
+// with the runtime join filter turned on or off by state.range(1).
+// NOLINTNEXTLINE : runtime/references.
+static void BM_JoinProbeScan(benchmark::State& state) {
+  int64_t num_build_keys = state.range(0);
+  bool runtime_join_filters = state.range(1);
+  auto saved_flag = FLAGS_carnot_runtime_join_filters;
+  FLAGS_carnot_runtime_join_filters = runtime_join_filters;
+
+  auto registry = std::make_unique<Registry>("test_registry");
+  auto probe = MakeProbeTable();
+  auto build = MakeBuildTable(num_build_keys);
+  px::carnot::planpb::PlanFragment pf_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(kJoinPlan, &pf_pb));
+
+  int64_t probe_rows_output = 0;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto table_store = std::make_shared<px::table_store::TableStore>();
+    table_store->AddTable("probe", probe);
+    table_store->AddTable("build", build);
+    auto exec_state = std::make_unique<ExecState>(
+        registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+        MockTraceStubGenerator, sole::uuid4(), nullptr);
+    auto plan_fragment = std::make_shared<px::carnot::plan::PlanFragment>(1);
+    PX_CHECK_OK(plan_fragment->Init(pf_pb));
+    auto plan_state = std::make_unique<px::carnot::plan::PlanState>(registry.get());
+    auto schema = std::make_shared<px::table_store::schema::Schema>();
+    ExecutionGraph graph;
+    PX_CHECK_OK(graph.Init(schema.get(), plan_state.get(), exec_state.get(), plan_fragment.get(),
+                           /* collect_exec_node_stats */ true));
+    state.ResumeTiming();
+
+    PX_CHECK_OK(graph.Execute());
+
+    state.PauseTiming();
+    probe_rows_output += graph.node(1).ConsumeValueOrDie()->stats()->rows_output;
+    state.ResumeTiming();
+  }
+  FLAGS_carnot_runtime_join_filters = saved_flag;
+
+  state.SetItemsProcessed(state.iterations() * kProbeRows);
+  state.counters["probe_rows_output"] =
+      benchmark::Counter(probe_rows_output, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_JoinProbeScan)
+    ->ArgNames({"build_keys", "filter"})
+    ->ArgsProduct({{16, 1024, kNumProbeKeys}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
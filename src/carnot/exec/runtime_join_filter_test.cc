@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/key_hash_table.h"
+#include "src/carnot/exec/runtime_join_filter.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+// Builds a filter over the INT64 keys in build_keys.
+std::unique_ptr<RuntimeJoinFilter> MakeFilter(const std::vector<types::Int64Value>& build_keys) {
+  auto filter = std::make_unique<RuntimeJoinFilter>(std::vector<types::DataType>{types::INT64});
+  auto col = types::ToArrow(build_keys, arrow::default_memory_pool());
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({col.get()}, filter->key_types(), build_keys.size(), &hashes);
+  for (uint64_t hash : hashes) {
+    filter->Insert(hash);
+  }
+  return filter;
+}
+
+RowBatch MakeProbeBatch(const std::vector<types::StringValue>& names,
+                        const std::vector<types::Int64Value>& keys) {
+  RowBatch rb(RowDescriptor({types::STRING, types::INT64}), keys.size());
+  EXPECT_OK(rb.AddColumn(types::ToArrow(names, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(keys, arrow::default_memory_pool())));
+  rb.set_eow(true);
+  rb.set_eos(true);
+  return rb;
+}
+
+TEST(RuntimeJoinFilterTest, drops_rows_without_build_keys) {
+  auto filter = MakeFilter({1, 3, 5, 3});
+  EXPECT_FALSE(filter->ready());
+  ASSERT_OK(filter->Finalize());
+  EXPECT_TRUE(filter->ready());
+  EXPECT_TRUE(filter->exact());
+  EXPECT_EQ(3, filter->num_keys());
+
+  auto rb = MakeProbeBatch({"a", "b", "c", "d", "e"}, {1, 2, 3, 4, 5});
+  ASSERT_OK_AND_ASSIGN(auto filtered, filter->Apply({1}, rb));
+  ASSERT_NE(nullptr, filtered);
+  EXPECT_EQ(3, filtered->num_rows());
+  EXPECT_TRUE(filtered->eow());
+  EXPECT_TRUE(filtered->eos());
+  EXPECT_TRUE(filtered->ColumnAt(0)->Equals(types::ToArrow(
+      std::vector<types::StringValue>{"a", "c", "e"}, arrow::default_memory_pool())));
+  EXPECT_TRUE(filtered->ColumnAt(1)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{1, 3, 5}, arrow::default_memory_pool())));
+}
+
+TEST(RuntimeJoinFilterTest, keeps_batch_when_every_row_matches) {
+  auto filter = MakeFilter({1, 2});
+  ASSERT_OK(filter->Finalize());
+
+  auto rb = MakeProbeBatch({"a", "b", "c"}, {2, 1, 2});
+  ASSERT_OK_AND_ASSIGN(auto filtered, filter->Apply({1}, rb));
+  EXPECT_EQ(nullptr, filtered);
+}
+
+TEST(RuntimeJoinFilterTest, large_build_side_uses_bloom_filter) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_runtime_join_filter_max_exact_keys, 16);
+  std::vector<types::Int64Value> build_keys;
+  for (int64_t i = 0; i < 1000; ++i) {
+    build_keys.emplace_back(2 * i);
+  }
+  auto filter = MakeFilter(build_keys);
+  ASSERT_OK(filter->Finalize());
+  EXPECT_FALSE(filter->exact());
+  EXPECT_EQ(1000, filter->num_keys());
+
+  std::vector<types::StringValue> names(2000, "x");
+  std::vector<types::Int64Value> keys;
+  for (int64_t i = 0; i < 2000; ++i) {
+    keys.emplace_back(i);
+  }
+  auto rb = MakeProbeBatch(names, keys);
+  ASSERT_OK_AND_ASSIGN(auto filtered, filter->Apply({1}, rb));
+  ASSERT_NE(nullptr, filtered);
+  // No build key may be dropped, and most of the other keys should be.
+  EXPECT_GE(filtered->num_rows(), 1000);
+  EXPECT_LT(filtered->num_rows(), 1100);
+  auto filtered_keys = filtered->ColumnAt(1);
+  int64_t num_even = 0;
+  for (int64_t i = 0; i < filtered->num_rows(); ++i) {
+    num_even += types::GetValueFromArrowArray<types::INT64>(filtered_keys.get(), i) % 2 == 0;
+  }
+  EXPECT_EQ(1000, num_even);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <arrow/memory_pool.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+template <types::DataType T>
+class TypedSortKey : public SortKey {
+ public:
+  // Strings are compared in place, the buffered arrays outlive the key.
+  using ValueType = std::conditional_t<T == types::DataType::STRING, std::string_view,
+                                       typename types::DataTypeTraits<T>::native_type>;
+
+  explicit TypedSortKey(bool ascending) : ascending_(ascending) {}
+
+  void Append(const arrow::Array* arr) override {
+    values_.reserve(values_.size() + arr->length());
+    for (int64_t i = 0; i < arr->length(); ++i) {
+      if constexpr (T == types::DataType::STRING) {
+        values_.push_back(types::GetStringViewFromArrowArray(arr, i));
+      } else {
+        values_.push_back(types::GetValueFromArrowArray<T>(arr, i));
+      }
+    }
+  }
+
+  void Clear() override { values_.clear(); }
+
+  int Compare(int64_t a, int64_t b) const override {
+    const ValueType& value_a = values_[a];
+    const ValueType& value_b = values_[b];
+    int cmp = value_a < value_b ? -1 : (value_b < value_a ? 1 : 0);
+    return ascending_ ? cmp : -cmp;
+  }
+
+  void Sort(int64_t* begin, int64_t* end) const override {
+    if (ascending_) {
+      std::stable_sort(begin, end, [this](int64_t a, int64_t b) { return values_[a] < values_[b]; });
+    } else {
+      std::stable_sort(begin, end, [this](int64_t a, int64_t b) { return values_[b] < values_[a]; });
+    }
+  }
+
+  int64_t* TieEnd(int64_t* begin, int64_t* end) const override {
+    const ValueType& value = values_[*begin];
+    int64_t* it = begin + 1;
+    while (it != end && !(value < values_[*it]) && !(values_[*it] < value)) {
+      ++it;
+    }
+    return it;
+  }
+
+ private:
+  const bool ascending_;
+  std::vector<ValueType> values_;
+};
+
+std::unique_ptr<SortKey> MakeSortKey(types::DataType data_type, bool ascending) {
+#define TYPE_CASE(_dt_) return std::make_unique<TypedSortKey<_dt_>>(ascending);
+  PX_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+  return nullptr;
+}
+
+}  // namespace
+
+std::string SortNode::DebugStringImpl() {
+  return absl::Substitute("Exec::SortNode<$0>", plan_node_->DebugString());
+}
+
+Status SortNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::SORT_OPERATOR);
+  const auto* sort_plan_node = static_cast<const plan::SortOperator*>(&plan_node);
+  // copy the plan node to local object;
+  plan_node_ = std::make_unique<plan::SortOperator>(*sort_plan_node);
+
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Sort operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  const RowDescriptor& input_desc = input_descriptors_[0];
+  for (size_t i = 0; i < plan_node_->sort_cols().size(); ++i) {
+    int64_t col_idx = plan_node_->sort_cols()[i];
+    if (col_idx < 0 || col_idx >= static_cast<int64_t>(input_desc.size())) {
+      return error::InvalidArgument("Sort column $0 is out of range of the input relation",
+                                    col_idx);
+    }
+    sort_keys_.push_back(MakeSortKey(input_desc.type(col_idx), plan_node_->ascending()[i]));
+  }
+  return Status::OK();
+}
+
+Status SortNode::PrepareImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status SortNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status SortNode::CloseImpl(ExecState* /*exec_state*/) {
+  ClearBuffer();
+  return Status::OK();
+}
+
+bool SortNode::RowLess(int64_t a, int64_t b) const {
+  for (const auto& key : sort_keys_) {
+    int cmp = key->Compare(a, b);
+    if (cmp != 0) {
+      return cmp < 0;
+    }
+  }
+  return a < b;
+}
+
+void SortNode::BufferRowBatch(const RowBatch& rb) {
+  batch_offsets_.push_back(num_buffered_rows_);
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  columns.reserve(rb.num_columns());
+  for (int64_t i = 0; i < rb.num_columns(); ++i) {
+    columns.push_back(rb.ColumnAt(i));
+  }
+  buffered_columns_.push_back(std::move(columns));
+  for (size_t i = 0; i < sort_keys_.size(); ++i) {
+    sort_keys_[i]->Append(rb.ColumnAt(plan_node_->sort_cols()[i]).get());
+  }
+  num_buffered_rows_ += rb.num_rows();
+}
+
+void SortNode::PushToHeap() {
+  auto less = [this](int64_t a, int64_t b) { return RowLess(a, b); };
+  size_t limit = plan_node_->limit();
+  for (int64_t row = batch_offsets_.back(); row < num_buffered_rows_; ++row) {
+    if (heap_.size() < limit) {
+      heap_.push_back(row);
+      std::push_heap(heap_.begin(), heap_.end(), less);
+      continue;
+    }
+    // Most rows of a large input can't make it into the top-k, so check the worst row first.
+    if (!RowLess(row, heap_.front())) {
+      continue;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), less);
+    heap_.back() = row;
+    std::push_heap(heap_.begin(), heap_.end(), less);
+  }
+}
+
+Status SortNode::CompactBuffer(arrow::MemoryPool* mem_pool) {
+  // Copy the rows in the heap into a single batch, in sorted order so that ties keep their order.
+  std::vector<int64_t> rows = SortedRows();
+  std::vector<int64_t> all_cols(input_descriptors_[0].size());
+  std::iota(all_cols.begin(), all_cols.end(), 0);
+  PX_ASSIGN_OR_RETURN(auto batches,
+                      Materialize(rows, all_cols, input_descriptors_[0], rows.size(), mem_pool));
+  ClearBuffer();
+  for (const auto& rb : batches) {
+    BufferRowBatch(*rb);
+  }
+  heap_.resize(num_buffered_rows_);
+  std::iota(heap_.begin(), heap_.end(), 0);
+  std::make_heap(heap_.begin(), heap_.end(), [this](int64_t a, int64_t b) { return RowLess(a, b); });
+  return Status::OK();
+}
+
+void SortNode::ClearBuffer() {
+  for (auto& key : sort_keys_) {
+    key->Clear();
+  }
+  buffered_columns_.clear();
+  batch_offsets_.clear();
+  num_buffered_rows_ = 0;
+  heap_.clear();
+}
+
+void SortNode::SortRange(int64_t* begin, int64_t* end, size_t key_idx) const {
+  const SortKey* key = sort_keys_[key_idx].get();
+  key->Sort(begin, end);
+  if (key_idx + 1 == sort_keys_.size()) {
+    return;
+  }
+  // Only the rows that are tied on this key need to be compared on the next one.
+  for (int64_t* run_begin = begin; run_begin != end;) {
+    int64_t* run_end = key->TieEnd(run_begin, end);
+    if (run_end - run_begin > 1) {
+      SortRange(run_begin, run_end, key_idx + 1);
+    }
+    run_begin = run_end;
+  }
+}
+
+std::vector<int64_t> SortNode::SortedRows() {
+  if (HasLimit()) {
+    std::vector<int64_t> rows = heap_;
+    std::sort(rows.begin(), rows.end(), [this](int64_t a, int64_t b) { return RowLess(a, b); });
+    return rows;
+  }
+  std::vector<int64_t> rows(num_buffered_rows_);
+  std::iota(rows.begin(), rows.end(), 0);
+  if (!sort_keys_.empty() && !rows.empty()) {
+    SortRange(rows.data(), rows.data() + rows.size(), 0);
+  }
+  return rows;
+}
+
+StatusOr<std::vector<std::unique_ptr<RowBatch>>> SortNode::Materialize(
+    const std::vector<int64_t>& rows, const std::vector<int64_t>& col_idxs,
+    const RowDescriptor& desc, size_t max_rows_per_batch, arrow::MemoryPool* mem_pool) const {
+  std::vector<std::unique_ptr<RowBatch>> batches;
+  std::vector<std::pair<int64_t, int64_t>> locations;
+  for (size_t start = 0; start < rows.size(); start += max_rows_per_batch) {
+    size_t end = std::min(rows.size(), start + max_rows_per_batch);
+    locations.clear();
+    for (size_t i = start; i < end; ++i) {
+      auto it = std::upper_bound(batch_offsets_.begin(), batch_offsets_.end(), rows[i]);
+      int64_t batch_idx = std::distance(batch_offsets_.begin(), it) - 1;
+      locations.emplace_back(batch_idx, rows[i] - batch_offsets_[batch_idx]);
+    }
+
+    // Copy one column at a time so that the type is only dispatched once per column.
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders(col_idxs.size());
+    for (size_t i = 0; i < col_idxs.size(); ++i) {
+      builders[i] = types::MakeArrowBuilder(desc.type(i), mem_pool);
+      PX_RETURN_IF_ERROR(builders[i]->Reserve(end - start));
+#define TYPE_CASE(_dt_)                                                                 \
+  for (const auto& [batch_idx, row] : locations) {                                      \
+    auto col = buffered_columns_[batch_idx][col_idxs[i]].get();                         \
+    PX_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>(                            \
+        builders[i].get(), types::GetValueFromArrowArray<_dt_>(col, row)));             \
+  }
+      PX_SWITCH_FOREACH_DATATYPE(desc.type(i), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::FromColumnBuilders(desc, /*eow*/ false,
+                                                              /*eos*/ false, &builders));
+    batches.push_back(std::move(rb));
+  }
+  return batches;
+}
+
+Status SortNode::SendSortedRows(ExecState* exec_state, bool eos) {
+  std::vector<int64_t> rows = SortedRows();
+  PX_ASSIGN_OR_RETURN(auto batches,
+                      Materialize(rows, plan_node_->selected_cols(), *output_descriptor_,
+                                  kSortRowBatchSize, exec_state->exec_mem_pool()));
+  ClearBuffer();
+  if (batches.empty()) {
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*output_descriptor_, /*eow*/ true, eos));
+    return SendRowBatchToChildren(exec_state, *rb);
+  }
+  batches.back()->set_eow(true);
+  batches.back()->set_eos(eos);
+  for (const auto& rb : batches) {
+    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *rb));
+  }
+  return Status::OK();
+}
+
+Status SortNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    BufferRowBatch(rb);
+    if (HasLimit()) {
+      PushToHeap();
+      // Rows that fell out of the heap still pin their row batches, so drop them once they take
+      // up more space than the heap.
+      if (num_buffered_rows_ >
+          std::max<int64_t>(2 * plan_node_->limit(), static_cast<int64_t>(kSortRowBatchSize))) {
+        PX_RETURN_IF_ERROR(CompactBuffer(exec_state->exec_mem_pool()));
+      }
+    }
+  }
+  if (!rb.eow() && !rb.eos()) {
+    return Status::OK();
+  }
+  return SendSortedRows(exec_state, rb.eos());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
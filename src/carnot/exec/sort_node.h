@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/array.h>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+constexpr size_t kSortRowBatchSize = 1024;
+
+/**
+ * @brief SortKey holds the values of one sort column for every buffered row, gathered into a
+ * contiguous vector of the native type so that sorting compares plain values instead of going
+ * through the arrow arrays.
+ */
+class SortKey {
+ public:
+  virtual ~SortKey() = default;
+
+  // Appends the values of the array, the rows are numbered in the order they are appended.
+  virtual void Append(const arrow::Array* arr) = 0;
+  virtual void Clear() = 0;
+  // Returns a negative value if row a sorts before row b, 0 if they are tied and a positive
+  // value otherwise.
+  virtual int Compare(int64_t a, int64_t b) const = 0;
+  // Stable sorts the rows in [begin, end) by this key.
+  virtual void Sort(int64_t* begin, int64_t* end) const = 0;
+  // Returns the end of the run of rows starting at begin that are tied with begin on this key.
+  virtual int64_t* TieEnd(int64_t* begin, int64_t* end) const = 0;
+};
+
+/**
+ * @brief SortNode sorts its input by one or more columns.
+ *
+ * A full sort buffers the input and sorts it one key at a time: the rows are sorted by the first
+ * key, then every run of rows tied on that key is sorted by the next key, and so on. With a limit,
+ * only the best rows are kept in a bounded heap, and the buffered row batches are compacted
+ * whenever the rows that fell out of the heap take up more space than the heap itself.
+ *
+ * The sorted rows are sent at the end of every window.
+ */
+class SortNode : public ProcessingNode {
+ public:
+  SortNode() = default;
+  virtual ~SortNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  bool HasLimit() const { return plan_node_->limit() > 0; }
+  // Returns true if row a sorts before row b. Tied rows are kept in input order.
+  bool RowLess(int64_t a, int64_t b) const;
+
+  void BufferRowBatch(const table_store::schema::RowBatch& rb);
+  // Offers the rows of the last buffered batch to the top-k heap.
+  void PushToHeap();
+  Status CompactBuffer(arrow::MemoryPool* mem_pool);
+  void ClearBuffer();
+  void SortRange(int64_t* begin, int64_t* end, size_t key_idx) const;
+  std::vector<int64_t> SortedRows();
+
+  // Copies the given rows of the buffered batches into row batches that have the given columns.
+  StatusOr<std::vector<std::unique_ptr<table_store::schema::RowBatch>>> Materialize(
+      const std::vector<int64_t>& rows, const std::vector<int64_t>& col_idxs,
+      const table_store::schema::RowDescriptor& desc, size_t max_rows_per_batch,
+      arrow::MemoryPool* mem_pool) const;
+  Status SendSortedRows(ExecState* exec_state, bool eos);
+
+  std::unique_ptr<plan::SortOperator> plan_node_;
+  std::vector<std::unique_ptr<SortKey>> sort_keys_;
+  // The columns of every buffered row batch, and the number of rows buffered before each batch.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> buffered_columns_;
+  std::vector<int64_t> batch_offsets_;
+  int64_t num_buffered_rows_ = 0;
+  // Max-heap of the best rows seen so far when there is a limit, the worst of them is on top.
+  std::vector<int64_t> heap_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
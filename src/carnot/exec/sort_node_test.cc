@@ -0,0 +1,203 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+using types::StringValue;
+
+class SortNodeTest : public ::testing::Test {
+ public:
+  SortNodeTest() {
+    // Sorts by column 1 descending, then by column 0 ascending.
+    op_proto_ = planpb::testutils::CreateTestSort1PB();
+    plan_node_ = plan::SortOperator::FromProto(op_proto_, 1);
+
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  void SetLimit(int64_t limit) {
+    op_proto_.mutable_sort_op()->set_limit(limit);
+    plan_node_ = plan::SortOperator::FromProto(op_proto_, 1);
+  }
+
+  planpb::Operator op_proto_;
+  std::unique_ptr<plan::Operator> plan_node_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(SortNodeTest, full_sort_multiple_batches) {
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd, {rd},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({3, 1, 2})
+                       .AddColumn<Int64Value>({5, 7, 5})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({0, 4})
+                       .AddColumn<Int64Value>({5, 9})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd, 5, true, true)
+                          .AddColumn<Int64Value>({4, 1, 0, 2, 3})
+                          .AddColumn<Int64Value>({9, 7, 5, 5, 5})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, top_k) {
+  SetLimit(2);
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd, {rd},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({3, 1, 2})
+                       .AddColumn<Int64Value>({5, 7, 5})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({0, 4})
+                       .AddColumn<Int64Value>({5, 9})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd, 2, true, true)
+                          .AddColumn<Int64Value>({4, 1})
+                          .AddColumn<Int64Value>({9, 7})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, top_k_compacts_buffered_batches) {
+  SetLimit(3);
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd, {rd},
+                                                                   exec_state_.get());
+  // Enough rows to compact the buffer a few times, with many ties on the first sort column.
+  constexpr int64_t kBatchSize = 1000;
+  constexpr int64_t kNumBatches = 4;
+  std::vector<std::pair<int64_t, int64_t>> all_rows;
+  for (int64_t batch = 0; batch < kNumBatches; ++batch) {
+    std::vector<Int64Value> col0;
+    std::vector<Int64Value> col1;
+    for (int64_t i = 0; i < kBatchSize; ++i) {
+      int64_t row = batch * kBatchSize + i;
+      col0.push_back((row * 7919) % 4001);
+      col1.push_back(row % 97);
+      all_rows.emplace_back(-(row % 97), (row * 7919) % 4001);
+    }
+    bool last = batch == kNumBatches - 1;
+    tester.ConsumeNext(RowBatchBuilder(rd, kBatchSize, last, last)
+                           .AddColumn<Int64Value>(col0)
+                           .AddColumn<Int64Value>(col1)
+                           .get(),
+                       0, last ? 1 : 0);
+  }
+
+  std::sort(all_rows.begin(), all_rows.end());
+  std::vector<Int64Value> expected_col0;
+  std::vector<Int64Value> expected_col1;
+  for (int64_t i = 0; i < 3; ++i) {
+    expected_col0.push_back(all_rows[i].second);
+    expected_col1.push_back(-all_rows[i].first);
+  }
+  tester
+      .ExpectRowBatch(RowBatchBuilder(rd, 3, true, true)
+                          .AddColumn<Int64Value>(expected_col0)
+                          .AddColumn<Int64Value>(expected_col1)
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, string_keys) {
+  op_proto_.mutable_sort_op()->clear_sort_columns();
+  auto sort_col = op_proto_.mutable_sort_op()->add_sort_columns();
+  sort_col->mutable_column()->set_index(0);
+  sort_col->set_ascending(true);
+  plan_node_ = plan::SortOperator::FromProto(op_proto_, 1);
+  RowDescriptor rd({types::DataType::STRING, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd, {rd},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<StringValue>({"b", "a", "c", "a"})
+                       .AddColumn<Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd, 4, true, true)
+                          .AddColumn<StringValue>({"a", "a", "b", "c"})
+                          .AddColumn<Int64Value>({2, 4, 1, 3})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, empty_input) {
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd, {rd},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({})
+                       .AddColumn<Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd, 0, true, true)
+                          .AddColumn<Int64Value>({})
+                          .AddColumn<Int64Value>({})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -405,6 +405,25 @@ class ExecNodeTester {
     return *this;
   }
 
+  /**
+   * Calls ConsumeNext on the execution node, whose child consumes the output successfully, and
+   * checks that ConsumeNext fails with the given code.
+   * @param rb The input rowbatch to ConsumeNext.
+   * @param code The expected code of the error that ConsumeNext should fail with.
+   * @return the ExecNodeTester, to allow for chaining.
+   */
+  ExecNodeTester& ConsumeNextShouldFailWithCode(const table_store::schema::RowBatch& rb,
+                                                int64_t parent_id, statuspb::Code code) {
+    EXPECT_CALL(mock_child_, ConsumeNextImpl(::testing::_, ::testing::_, ::testing::_))
+        .Times(1)
+        .WillRepeatedly(::testing::Return(Status::OK()));
+
+    auto retval = exec_node_->ConsumeNext(exec_state_, rb, parent_id);
+    EXPECT_EQ(code, retval.code()) << retval.ToString();
+
+    return *this;
+  }
+
   /**
    * Calls ConsumeNext on the execution node.
    * @param rb The input rowbatch to ConsumeNext.
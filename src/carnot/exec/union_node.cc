@@ -18,11 +18,14 @@
 
 #include "src/carnot/exec/union_node.h"
 
+#include <arrow/array/concatenate.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstddef>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/str_join.h>
@@ -56,16 +59,15 @@ Status UnionNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
-Status UnionNode::InitializeColumnBuilders() {
+Status UnionNode::InitializeColumnBuilders(arrow::MemoryPool* mem_pool) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
-    column_builders_[i] =
-        MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+    column_builders_[i] = MakeArrowBuilder(output_descriptor_->type(i), mem_pool);
     PX_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
   }
   return Status::OK();
 }
 
-Status UnionNode::PrepareImpl(ExecState*) {
+Status UnionNode::PrepareImpl(ExecState* exec_state) {
   size_t num_output_cols = output_descriptor_->size();
 
   flushed_parent_eoses_.resize(num_parents_);
@@ -78,7 +80,9 @@ Status UnionNode::PrepareImpl(ExecState*) {
     data_columns_.resize(num_parents_, std::vector<arrow::Array*>(num_output_cols));
 
     column_builders_.resize(num_output_cols);
-    PX_RETURN_IF_ERROR(InitializeColumnBuilders());
+    output_slices_.resize(num_output_cols);
+    loser_tree_.resize(num_parents_);
+    PX_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state->exec_mem_pool()));
   }
 
   return Status::OK();
@@ -107,20 +111,128 @@ std::shared_ptr<arrow::Array> UnionNode::GetInputColumn(const RowBatch& rb, size
 types::Time64NSValue UnionNode::GetTimeAtParentCursor(size_t parent_index) const {
   DCHECK(!flushed_parent_eoses_[parent_index]);
   DCHECK(time_columns_[parent_index] != nullptr);
-  return types::GetValueFromArrowArray<types::TIME64NS>(time_columns_[parent_index],
-                                                        row_cursors_[parent_index]);
+  return GetTimeAtRow(parent_index, row_cursors_[parent_index]);
 }
 
-Status UnionNode::AppendRow(size_t parent) {
-  auto row = row_cursors_[parent];
+types::Time64NSValue UnionNode::GetTimeAtRow(size_t parent_index, size_t row) const {
+  return types::GetValueFromArrowArray<types::TIME64NS>(time_columns_[parent_index], row);
+}
+
+bool UnionNode::ParentCursorLess(size_t parent_a, size_t parent_b) const {
+  if (flushed_parent_eoses_[parent_a] || flushed_parent_eoses_[parent_b]) {
+    return !flushed_parent_eoses_[parent_a] && flushed_parent_eoses_[parent_b];
+  }
+  auto time_a = GetTimeAtParentCursor(parent_a);
+  auto time_b = GetTimeAtParentCursor(parent_b);
+  // Ties go to the lower parent index, so rows are always stable with respect to the parents.
+  return time_a < time_b || (time_a == time_b && parent_a < parent_b);
+}
+
+// The leaf of parent p is node num_parents_ + p, and node n is the parent of nodes 2n and 2n + 1.
+void UnionNode::BuildLoserTree() {
+  std::vector<size_t> winners(2 * num_parents_);
+  for (size_t parent = 0; parent < num_parents_; ++parent) {
+    winners[num_parents_ + parent] = parent;
+  }
+  for (size_t node = num_parents_ - 1; node > 0; --node) {
+    size_t left = winners[2 * node];
+    size_t right = winners[2 * node + 1];
+    bool left_wins = ParentCursorLess(left, right);
+    winners[node] = left_wins ? left : right;
+    loser_tree_[node] = left_wins ? right : left;
+  }
+  loser_tree_[0] = winners[1];
+}
+
+void UnionNode::ReplayLoserTree(size_t parent) {
+  size_t winner = parent;
+  for (size_t node = (num_parents_ + parent) / 2; node > 0; node /= 2) {
+    if (ParentCursorLess(loser_tree_[node], winner)) {
+      std::swap(loser_tree_[node], winner);
+    }
+  }
+  loser_tree_[0] = winner;
+}
+
+std::optional<size_t> UnionNode::LoserTreeRunnerUp(size_t parent) const {
+  // The runner up lost to the winner directly, so it is on the path of the winner.
+  std::optional<size_t> runner_up;
+  for (size_t node = (num_parents_ + parent) / 2; node > 0; node /= 2) {
+    if (!runner_up.has_value() || ParentCursorLess(loser_tree_[node], *runner_up)) {
+      runner_up = loser_tree_[node];
+    }
+  }
+  return runner_up;
+}
+
+size_t UnionNode::RunEnd(size_t parent, std::optional<size_t> runner_up) const {
+  size_t num_rows = parent_row_batches_[parent][0].num_rows();
+  if (!runner_up.has_value() || flushed_parent_eoses_[*runner_up]) {
+    return num_rows;
+  }
+  auto limit = GetTimeAtParentCursor(*runner_up);
+  bool wins_ties = parent < *runner_up;
+  auto in_run = [&](size_t row) {
+    auto time = GetTimeAtRow(parent, row);
+    return time < limit || (wins_ties && time == limit);
+  };
+  // The row at the cursor is in the run. Gallop to find a row that isn't, so short runs stay
+  // cheap, then binary search between the two.
+  size_t in = row_cursors_[parent];
+  size_t step = 1;
+  size_t out = in + step;
+  while (out < num_rows && in_run(out)) {
+    in = out;
+    step *= 2;
+    out = in + step;
+  }
+  out = std::min(out, num_rows);
+  while (in + 1 < out) {
+    size_t mid = in + (out - in) / 2;
+    if (in_run(mid)) {
+      in = mid;
+    } else {
+      out = mid;
+    }
+  }
+  return out;
+}
+
+Status UnionNode::AppendRun(size_t parent, size_t num_rows) {
+  auto start = row_cursors_[parent];
+  if (num_rows >= kMinUnionRunLengthToSlice) {
+    PX_RETURN_IF_ERROR(FinishColumnBuilders());
+    const auto& rb = parent_row_batches_[parent][0];
+    for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+      output_slices_[i].push_back(GetInputColumn(rb, parent, i)->Slice(start, num_rows));
+    }
+    output_rows_ += num_rows;
+    return Status::OK();
+  }
+
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     auto input_col = data_columns_[parent][i];
-#define TYPE_CASE(_dt_)                                    \
-  PX_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
-      column_builders_[i].get(), types::GetValueFromArrowArray<_dt_>(input_col, row)));
+#define TYPE_CASE(_dt_)                                                                  \
+  for (size_t row = start; row < start + num_rows; ++row) {                              \
+    PX_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>(                             \
+        column_builders_[i].get(), types::GetValueFromArrowArray<_dt_>(input_col, row))); \
+  }
     PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(i), TYPE_CASE);
 #undef TYPE_CASE
   }
+  output_rows_ += num_rows;
+  return Status::OK();
+}
+
+Status UnionNode::FinishColumnBuilders() {
+  if (column_builders_[0]->length() == 0) {
+    return Status::OK();
+  }
+  for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+    std::shared_ptr<arrow::Array> col;
+    PX_RETURN_IF_ERROR(column_builders_[i]->Finish(&col));
+    output_slices_[i].push_back(col);
+  }
   return Status::OK();
 }
 
@@ -139,8 +251,7 @@ Status UnionNode::OptionallyFlushRowBatchIfTimeout(ExecState* exec_state) {
     return Status::OK();
   }
 
-  DCHECK_GT(column_builders_.size(), 0U);
-  if (column_builders_[0]->length()) {
+  if (output_rows_ > 0) {
     return FlushBatch(exec_state);
   }
   return Status::OK();
@@ -149,9 +260,7 @@ Status UnionNode::OptionallyFlushRowBatchIfTimeout(ExecState* exec_state) {
 // Flush the row batch if we have reached a certain number of records.
 Status UnionNode::OptionallyFlushRowBatchIfMaxRowsOrEOS(ExecState* exec_state) {
   bool eos = InputsComplete();
-  int64_t output_rows = column_builders_[0]->length();
-
-  if (output_rows < static_cast<int64_t>(output_rows_per_batch_) && !eos) {
+  if (output_rows_ < output_rows_per_batch_ && !eos) {
     return Status::OK();
   }
 
@@ -162,78 +271,80 @@ Status UnionNode::FlushBatch(ExecState* exec_state) {
   DCHECK(!sent_eos_);
 
   bool eos = InputsComplete();
-  PX_ASSIGN_OR_RETURN(auto rb, RowBatch::FromColumnBuilders(*output_descriptor_, /*eow*/ eos,
-                                                            /*eos*/ eos, &column_builders_));
-  PX_RETURN_IF_ERROR(InitializeColumnBuilders());
+  if (output_rows_ == 0) {
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*output_descriptor_, eos, eos));
+    last_data_flush_time_ = std::chrono::system_clock::now();
+    return SendRowBatchToChildren(exec_state, *rb);
+  }
+
+  PX_RETURN_IF_ERROR(FinishColumnBuilders());
+  RowBatch rb(*output_descriptor_, output_rows_);
+  for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+    auto& slices = output_slices_[i];
+    // A batch made of a single run doesn't need to be copied at all.
+    if (slices.size() == 1) {
+      PX_RETURN_IF_ERROR(rb.AddColumn(slices[0]));
+    } else {
+      auto col = arrow::Concatenate(slices, exec_state->exec_mem_pool());
+      PX_RETURN_IF_ERROR(col.status());
+      PX_RETURN_IF_ERROR(rb.AddColumn(col.ValueOrDie()));
+    }
+    slices.clear();
+  }
+  output_rows_ = 0;
+  rb.set_eow(eos);
+  rb.set_eos(eos);
   last_data_flush_time_ = std::chrono::system_clock::now();
-  return SendRowBatchToChildren(exec_state, *rb);
+  return SendRowBatchToChildren(exec_state, rb);
 }
 
 Status UnionNode::MergeData(ExecState* exec_state) {
-  while (!sent_eos_) {
-    // Get the smallest time out of all of the current streams.
-    std::vector<size_t> parent_streams;
-    parent_streams.reserve(row_cursors_.size());
-
-    for (size_t parent = 0; parent < row_cursors_.size(); ++parent) {
-      if (flushed_parent_eoses_[parent]) {
-        continue;
-      }
-      // If we lack necessary data, we can't merge anymore.
-      if (!parent_row_batches_[parent].size()) {
-        return Status::OK();
-      }
-      parent_streams.push_back(parent);
+  if (sent_eos_) {
+    return Status::OK();
+  }
+  // If we lack data for a stream that hasn't ended, we can't merge anymore, as its next row could
+  // be the smallest.
+  for (size_t parent = 0; parent < num_parents_; ++parent) {
+    if (!flushed_parent_eoses_[parent] && parent_row_batches_[parent].empty()) {
+      return Status::OK();
     }
+  }
 
+  BuildLoserTree();
+  while (!sent_eos_) {
+    size_t parent = loser_tree_[0];
     // If we have reached end of stream for all of our inputs, flush the queue.
-    if (!parent_streams.size()) {
+    if (flushed_parent_eoses_[parent]) {
       return OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state);
     }
 
-    std::sort(parent_streams.begin(), parent_streams.end(),
-              [this](size_t parent_a, size_t parent_b) {
-                auto time_a = GetTimeAtParentCursor(parent_a);
-                auto time_b = GetTimeAtParentCursor(parent_b);
-                return time_a < time_b || (time_a == time_b && parent_a < parent_b);
-              });
-
-    bool has_limit = parent_streams.size() > 1;
-    size_t parent = parent_streams[0];
-
-    while (parent_row_batches_[parent].size()) {
-      if (has_limit) {
-        size_t next_parent = parent_streams[1];
-        // If this time is greater than another parent stream's earliest time,
-        // or if they are the same but the first parent is at a smaller index, stop merging.
-        // This way rows are always stable with respect to input parent index.
-        if (GetTimeAtParentCursor(parent) > GetTimeAtParentCursor(next_parent) ||
-            (GetTimeAtParentCursor(parent) == GetTimeAtParentCursor(next_parent) &&
-             parent > next_parent)) {
-          break;
-        }
-      }
-
-      PX_RETURN_IF_ERROR(AppendRow(parent));
-
-      // Mark whether or not we hit the eos for this stream, and whether the row batch needs to be
-      // popped.
-      const auto& rb = parent_row_batches_[parent][0];
-      bool pop_row_batch = ++row_cursors_[parent] == static_cast<size_t>(rb.num_rows());
-      if (pop_row_batch && rb.eos()) {
-        flushed_parent_eoses_[parent] = true;
-      }
-
-      if (pop_row_batch) {
-        // Delete the top row batch from our buffer and update the cursor.
-        parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
-        row_cursors_[parent] = 0;
-        CacheNextRowBatch(parent);
-      }
-
-      // Flush the current RowBatch if necessary.
-      PX_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
+    // Copy every row of the parent that comes before the next row of any other parent, as long
+    // as it fits in the output batch.
+    size_t run_end = RunEnd(parent, LoserTreeRunnerUp(parent));
+    run_end = std::min(run_end, row_cursors_[parent] + output_rows_per_batch_ - output_rows_);
+    PX_RETURN_IF_ERROR(AppendRun(parent, run_end - row_cursors_[parent]));
+    row_cursors_[parent] = run_end;
+
+    // Mark whether or not we hit the eos for this stream, and whether the row batch needs to be
+    // popped.
+    const auto& rb = parent_row_batches_[parent][0];
+    bool pop_row_batch = run_end == static_cast<size_t>(rb.num_rows());
+    if (pop_row_batch && rb.eos()) {
+      flushed_parent_eoses_[parent] = true;
+    }
+    if (pop_row_batch) {
+      // Delete the top row batch from our buffer and update the cursor.
+      parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
+      row_cursors_[parent] = 0;
+      CacheNextRowBatch(parent);
+    }
+
+    // Flush the current RowBatch if necessary.
+    PX_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
+    if (!flushed_parent_eoses_[parent] && parent_row_batches_[parent].empty()) {
+      return Status::OK();
     }
+    ReplayLoserTree(parent);
   }
   return Status::OK();
 }
@@ -22,6 +22,7 @@
 #include <arrow/array/builder_base.h>
 #include <stddef.h>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -40,6 +41,9 @@ namespace exec {
 
 constexpr size_t kDefaultUnionRowBatchSize = 1024;
 constexpr size_t kDefaultDataFlushTimeoutMillis = 1000;
+// Runs of at least this many rows from one parent are sliced out of the input columns instead of
+// being copied row by row.
+constexpr size_t kMinUnionRunLengthToSlice = 16;
 
 // This node presumes that input streams will always come in ordered by time
 // when there is a time column.
@@ -89,9 +93,20 @@ class UnionNode : public ProcessingNode {
   // The items below are all for the time-ordered case.
 
   void CacheNextRowBatch(size_t parent);
-  Status InitializeColumnBuilders();
+  Status InitializeColumnBuilders(arrow::MemoryPool* mem_pool);
   types::Time64NSValue GetTimeAtParentCursor(size_t parent_index) const;
-  Status AppendRow(size_t parent);
+  types::Time64NSValue GetTimeAtRow(size_t parent_index, size_t row) const;
+  // Whether the next row of parent_a comes before the next row of parent_b. Parents that reached
+  // eos come last.
+  bool ParentCursorLess(size_t parent_a, size_t parent_b) const;
+  void BuildLoserTree();
+  void ReplayLoserTree(size_t parent);
+  // The parent with the next row after the rows of the winning parent, if any.
+  std::optional<size_t> LoserTreeRunnerUp(size_t parent) const;
+  // The end of the rows of parent that come before the next row of runner_up.
+  size_t RunEnd(size_t parent, std::optional<size_t> runner_up) const;
+  Status AppendRun(size_t parent, size_t num_rows);
+  Status FinishColumnBuilders();
   Status OptionallyFlushRowBatchIfMaxRowsOrEOS(ExecState* exec_state);
   Status OptionallyFlushRowBatchIfTimeout(ExecState* exec_state);
   Status FlushBatch(ExecState* exec_state);
@@ -101,8 +116,16 @@ class UnionNode : public ProcessingNode {
   // we just maintain the original row count to avoid copying the data.
   size_t output_rows_per_batch_;
 
-  // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
+  // The output batch is flushed once it has output_rows_per_batch_ rows. Its columns are kept as
+  // the slices of the input columns that make them up. Short runs are copied into
+  // column_builders_, which are finished into one more slice when a long run follows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> output_slices_;
+  size_t output_rows_ = 0;
+
+  // A tournament tree over the parents, where loser_tree_[0] is the parent with the next row and
+  // the other nodes hold the parent that lost the match at that node.
+  std::vector<size_t> loser_tree_;
 
   // Hold onto the input row batches for every parent until we copy all of their data.
   std::vector<std::vector<table_store::schema::RowBatch>> parent_row_batches_;
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <arrow/memory_pool.h>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/exec/union_node.h"
+#include "src/carnot/plan/operators.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+using px::carnot::exec::ExecState;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::exec::UnionNode;
+using px::carnot::udf::Registry;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using px::types::Int64Value;
+using px::types::StringValue;
+using px::types::Time64NSValue;
+using px::types::ToArrow;
+
+constexpr int64_t kBatchSize = 1024;
+constexpr int64_t kTotalRows = 256 * 1024;
+
+std::unique_ptr<px::carnot::plan::Operator> MakeUnionPlan(int64_t num_parents) {
+  px::carnot::planpb::Operator op_pb;
+  op_pb.set_op_type(px::carnot::planpb::UNION_OPERATOR);
+  auto union_pb = op_pb.mutable_union_op();
+  union_pb->set_rows_per_batch(kBatchSize);
+  union_pb->add_column_names("time_");
+  union_pb->add_column_names("value");
+  union_pb->add_column_names("name");
+  for (int64_t parent = 0; parent < num_parents; ++parent) {
+    auto mapping = union_pb->add_column_mappings();
+    for (int64_t col = 0; col < 3; ++col) {
+      mapping->add_column_indexes(col);
+    }
+  }
+  return px::carnot::plan::UnionOperator::FromProto(op_pb, 1);
+}
+
+// Returns the batches of every parent, in the order they are consumed. The streams take turns
+// in runs of run_length rows, so the merged stream switches parents every run_length rows.
+std::vector<std::pair<int64_t, std::unique_ptr<RowBatch>>> MakeInputBatches(
+    const RowDescriptor& rd, int64_t num_parents, int64_t run_length) {
+  int64_t rows_per_parent = kTotalRows / num_parents;
+  std::vector<std::pair<int64_t, std::unique_ptr<RowBatch>>> batches;
+  for (int64_t offset = 0; offset < rows_per_parent; offset += kBatchSize) {
+    int64_t size = std::min(kBatchSize, rows_per_parent - offset);
+    for (int64_t parent = 0; parent < num_parents; ++parent) {
+      std::vector<Time64NSValue> times;
+      std::vector<Int64Value> values;
+      std::vector<StringValue> names;
+      for (int64_t row = offset; row < offset + size; ++row) {
+        times.emplace_back(((row / run_length) * num_parents + parent) * run_length +
+                           row % run_length);
+        values.emplace_back(row);
+        names.emplace_back(absl::StrCat("parent_", parent));
+      }
+      auto rb = std::make_unique<RowBatch>(rd, size);
+      PX_CHECK_OK(rb->AddColumn(ToArrow(times, arrow::default_memory_pool())));
+      PX_CHECK_OK(rb->AddColumn(ToArrow(values, arrow::default_memory_pool())));
+      PX_CHECK_OK(rb->AddColumn(ToArrow(names, arrow::default_memory_pool())));
+      rb->set_eow(offset + size >= rows_per_parent);
+      rb->set_eos(offset + size >= rows_per_parent);
+      batches.emplace_back(parent, std::move(rb));
+    }
+  }
+  return batches;
+}
+
+// Merges kTotalRows rows spread over state.range(0) time ordered parents, whose streams
+// interleave in runs of state.range(1) rows.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_OrderedUnion(benchmark::State& state) {
+  int64_t num_parents = state.range(0);
+  int64_t run_length = state.range(1);
+  auto registry = std::make_unique<Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(registry.get(), table_store,
+                                                MockResultSinkStubGenerator,
+                                                MockMetricsStubGenerator, MockTraceStubGenerator,
+                                                sole::uuid4(), nullptr);
+
+  RowDescriptor rd({DataType::TIME64NS, DataType::INT64, DataType::STRING});
+  std::vector<RowDescriptor> input_rds(num_parents, rd);
+  auto batches = MakeInputBatches(rd, num_parents, run_length);
+  auto plan = MakeUnionPlan(num_parents);
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    UnionNode node;
+    node.disable_data_flush_timeout();
+    PX_CHECK_OK(node.Init(*plan, rd, input_rds));
+    PX_CHECK_OK(node.Prepare(exec_state.get()));
+    PX_CHECK_OK(node.Open(exec_state.get()));
+    for (const auto& [parent, rb] : batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), *rb, parent));
+    }
+    PX_CHECK_OK(node.Close(exec_state.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * kTotalRows);
+}
+
+BENCHMARK(BM_OrderedUnion)
+    ->ArgNames({"parents", "run_length"})
+    ->ArgsProduct({{2, 16, 256}, {1, 64, 1024}})
+    ->Unit(benchmark::kMillisecond);
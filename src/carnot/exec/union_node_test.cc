@@ -18,6 +18,10 @@
 
 #include "src/carnot/exec/union_node.h"
 
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -624,6 +628,68 @@ TEST_F(UnionNodeTest, ordered_timeout_hit) {
       .Close();
 }
 
+TEST_F(UnionNodeTest, ordered_long_runs) {
+  auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
+  op_proto.mutable_union_op()->set_rows_per_batch(64);
+  plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::TIME64NS});
+  RowDescriptor input_rd_1({types::DataType::TIME64NS, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::STRING, types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<UnionNode, plan::UnionOperator>(
+      *plan_node_, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  tester.node()->disable_data_flush_timeout();
+
+  // Each parent contributes runs that are long enough to be sliced, with a few rows that are
+  // interleaved with the other parent in between.
+  auto make_strings = [](const std::string& prefix, int64_t begin, int64_t end) {
+    std::vector<types::StringValue> strings;
+    for (int64_t i = begin; i < end; ++i) {
+      strings.push_back(absl::StrCat(prefix, i));
+    }
+    return strings;
+  };
+  auto make_times = [](int64_t begin, int64_t end) {
+    std::vector<types::Time64NSValue> times;
+    for (int64_t i = begin; i < end; ++i) {
+      times.emplace_back(i);
+    }
+    return times;
+  };
+
+  std::vector<types::StringValue> expected_strings = make_strings("a", 0, 20);
+  std::vector<types::Time64NSValue> expected_times = make_times(0, 20);
+  for (int64_t i = 20; i < 22; ++i) {
+    expected_strings.push_back(absl::StrCat("a", i));
+    expected_strings.push_back(absl::StrCat("b", i));
+    expected_times.emplace_back(i);
+    expected_times.emplace_back(i);
+  }
+  auto b_run = make_strings("b", 22, 42);
+  expected_strings.insert(expected_strings.end(), b_run.begin(), b_run.end());
+  auto b_times = make_times(22, 42);
+  expected_times.insert(expected_times.end(), b_times.begin(), b_times.end());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 22, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::StringValue>(make_strings("a", 0, 22))
+                       .AddColumn<types::Time64NSValue>(make_times(0, 22))
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 22, true, true)
+                       .AddColumn<types::Time64NSValue>(make_times(20, 42))
+                       .AddColumn<types::StringValue>(make_strings("b", 20, 42))
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 44, true, true)
+                          .AddColumn<types::StringValue>(expected_strings)
+                          .AddColumn<types::Time64NSValue>(expected_times)
+                          .get())
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -32,6 +32,27 @@ void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckAsFloat64UDF>("pluck_float64");
   registry->RegisterOrDie<PluckArrayUDF>("pluck_array");
 
+  // The compiler combines up to 8 plucks of the same column into one call to
+  // _pluck_multi (see CombinePluckCallsRule), so we register a version for each number of keys.
+  registry->RegisterOrDie<PluckMultiUDF<StringValue, StringValue>>("_pluck_multi");
+  registry->RegisterOrDie<PluckMultiUDF<StringValue, StringValue, StringValue>>("_pluck_multi");
+  registry->RegisterOrDie<PluckMultiUDF<StringValue, StringValue, StringValue, StringValue>>(
+      "_pluck_multi");
+  registry->RegisterOrDie<
+      PluckMultiUDF<StringValue, StringValue, StringValue, StringValue, StringValue>>(
+      "_pluck_multi");
+  registry->RegisterOrDie<
+      PluckMultiUDF<StringValue, StringValue, StringValue, StringValue, StringValue, StringValue>>(
+      "_pluck_multi");
+  registry->RegisterOrDie<PluckMultiUDF<StringValue, StringValue, StringValue, StringValue,
+                                        StringValue, StringValue, StringValue>>("_pluck_multi");
+  registry->RegisterOrDie<PluckMultiUDF<StringValue, StringValue, StringValue, StringValue,
+                                        StringValue, StringValue, StringValue, StringValue>>(
+      "_pluck_multi");
+  registry->RegisterOrDie<PluckMultiAtUDF>("_pluck_multi_at");
+  registry->RegisterOrDie<PluckMultiAtInt64UDF>("_pluck_multi_at_int64");
+  registry->RegisterOrDie<PluckMultiAtFloat64UDF>("_pluck_multi_at_float64");
+
   // Up to 8 script args are supported for the _script_reference UDF, due to the lack of support for
   // variadic UDF arguments in the UDF registry today. We should clean this up if/when variadic UDF
   // arguments are supported, which will probably be done as a part of adding support for object
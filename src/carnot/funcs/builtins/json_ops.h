@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -26,6 +28,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include "src/carnot/funcs/builtins/json_scanner.h"
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf.h"
 
@@ -38,31 +41,12 @@ namespace builtins {
 class PluckUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    std::string_view value;
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
-    }
-    if (!d.IsObject()) {
-      return "";
-    }
-    if (!d.HasMember(key.data())) {
+    if (JSONScanner(in).FindMember(key, &value) != JSONScanner::Result::kFound) {
       return "";
     }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return "";
-    }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
-
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+    return JSONValueAsString(value);
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -71,7 +55,9 @@ class PluckUDF : public udf::ScalarUDF {
         .Details(
             "Convenience method to handle grabbing keys from a serialized JSON string. The "
             "function parses the JSON string and attempts to find the key. If the key is not "
-            "found, an empty string is returned.\n"
+            "found, an empty string is returned. If the JSON string is malformed, the value is "
+            "still returned when the key appears before the parse error, otherwise an empty "
+            "string is returned.\n"
             "This function returns the value as a string. If you want an int, use "
             "`px.pluck_int64`. If you want a float, use `px.pluck_float64`.")
         .Example(R"doc(
@@ -87,26 +73,12 @@ class PluckUDF : public udf::ScalarUDF {
 class PluckAsInt64UDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    std::string_view value;
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0;
-    }
-    if (!d.IsObject()) {
-      return 0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (JSONScanner(in).FindMember(key, &value) != JSONScanner::Result::kFound) {
       return 0;
     }
-    if (plucked_value.IsInt64()) {
-      return plucked_value.GetInt64();
-    }
-    return 0;
+    return JSONValueAsInt64(value);
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -115,7 +87,8 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
             "Convenience method to handle grabbing keys from a serialized JSON string. The "
             "function parses the JSON string and attempts to find the key. If the key is not "
             "found, 0 is returned. If the key is found, but the value cannot be parsed as an int, "
-            "returns a 0.\n"
+            "returns a 0. If the JSON string is malformed, the value is still returned when the "
+            "key appears before the parse error, otherwise 0 is returned.\n"
             "This function returns the value as an int. If you want a string, use `px.pluck`. If "
             "you want a float, use `px.pluck_float64`.")
         .Example(R"doc(
@@ -131,26 +104,12 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
 class PluckAsFloat64UDF : public udf::ScalarUDF {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    std::string_view value;
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0.0;
-    }
-    if (!d.IsObject()) {
-      return 0.0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0.0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (JSONScanner(in).FindMember(key, &value) != JSONScanner::Result::kFound) {
       return 0.0;
     }
-    if (plucked_value.IsDouble()) {
-      return plucked_value.GetDouble();
-    }
-    return 0.0;
+    return JSONValueAsFloat64(value);
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -160,8 +119,8 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
             "Convenience method to handle grabbing keys from a serialized JSON string. The "
             "function parses the JSON string and attempts to find the key. If the key is not "
             "found, 0.0 is returned. If the key is found, but the value cannot be parsed as an "
-            "int, "
-            "returns a 0.0.\n"
+            "float, returns a 0.0. If the JSON string is malformed, the value is still returned "
+            "when the key appears before the parse error, otherwise 0.0 is returned.\n"
             "This function returns the value as a float. If you want a string, use `px.pluck`. "
             "If "
             "you want an int, use `px.pluck_int64`.")
@@ -178,33 +137,12 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
 class PluckArrayUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, Int64Value index) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    std::string_view value;
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (JSONScanner(in).FindElement(index.val, &value) != JSONScanner::Result::kFound) {
       return "";
     }
-    if (!d.IsArray()) {
-      return "";
-    }
-    const auto& plucked_array = d.GetArray();
-    if (index < 0 || index >= plucked_array.Size()) {
-      return "";
-    }
-
-    const auto& plucked_value = plucked_array[index.val];
-    if (plucked_value.IsNull()) {
-      return "";
-    }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
-
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+    return JSONValueAsString(value);
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -228,6 +166,69 @@ class PluckArrayUDF : public udf::ScalarUDF {
   }
 };
 
+/**
+  DocString intentionally omitted, this is a non-public function.
+  The compiler rewrites several px.pluck* calls on the same column into a single call to this UDF,
+  which extracts all of the keys in one pass over the JSON string. The raw values are packed into
+  a string (see PackJSONValues) which the _pluck_multi_at* UDFs below index into.
+ */
+template <typename... T>
+class PluckMultiUDF : public udf::ScalarUDF {
+ public:
+  StringValue Exec(FunctionContext*, StringValue in, T... keys) {
+    std::vector<std::string_view> key_views{std::string_view(keys)...};
+    std::vector<std::optional<std::string_view>> values;
+    // Malformed input still yields the keys found before the error, same as px.pluck.
+    JSONScanner(in).FindMembers(key_views, &values);
+    return PackJSONValues(values);
+  }
+};
+
+/**
+  DocString intentionally omitted, this is a non-public function.
+  Returns the index-th value packed by _pluck_multi, with the same semantics as px.pluck.
+ */
+class PluckMultiAtUDF : public udf::ScalarUDF {
+ public:
+  StringValue Exec(FunctionContext*, StringValue packed, Int64Value index) {
+    auto value = UnpackJSONValue(packed, index.val);
+    if (!value.has_value()) {
+      return "";
+    }
+    return JSONValueAsString(*value);
+  }
+};
+
+/**
+  DocString intentionally omitted, this is a non-public function.
+  Returns the index-th value packed by _pluck_multi, with the same semantics as px.pluck_int64.
+ */
+class PluckMultiAtInt64UDF : public udf::ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, StringValue packed, Int64Value index) {
+    auto value = UnpackJSONValue(packed, index.val);
+    if (!value.has_value()) {
+      return 0;
+    }
+    return JSONValueAsInt64(*value);
+  }
+};
+
+/**
+  DocString intentionally omitted, this is a non-public function.
+  Returns the index-th value packed by _pluck_multi, with the same semantics as px.pluck_float64.
+ */
+class PluckMultiAtFloat64UDF : public udf::ScalarUDF {
+ public:
+  Float64Value Exec(FunctionContext*, StringValue packed, Int64Value index) {
+    auto value = UnpackJSONValue(packed, index.val);
+    if (!value.has_value()) {
+      return 0.0;
+    }
+    return JSONValueAsFloat64(*value);
+  }
+};
+
 /**
   DocString intentionally omitted, this is a non-public function.
   This function creates a custom deep link by creating a "script reference" from a label,
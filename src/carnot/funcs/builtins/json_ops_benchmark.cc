@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_join.h>
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/json_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using types::StringValue;
+
+// Builds a request body shaped like a typical REST API payload: a few scalar fields, a nested
+// object and an array of line items whose length is controlled by `num_items`.
+std::string MakeAPIPayload(int num_items) {
+  std::vector<std::string> items;
+  for (int i = 0; i < num_items; ++i) {
+    items.push_back(absl::Substitute(
+        R"({"sku": "SKU-$0", "name": "Item \"$0\"", "quantity": $1, "price": $2.99, )"
+        R"("tags": ["sale", "warehouse-$1"], "attributes": {"color": "blue", "size": "M"}})",
+        i, i % 7, i % 100));
+  }
+  return absl::Substitute(
+      R"({"request_id": "9f8e7d6c-5b4a-3210-fedc-ba9876543210", "method": "POST", )"
+      R"("user": {"id": 123456, "email": "jane@example.com", "roles": ["admin", "dev"]}, )"
+      R"("items": [$0], "status": "confirmed", "status_code": 201, "latency_ms": 12.75, )"
+      R"("region": "us-west-2"})",
+      absl::StrJoin(items, ", "));
+}
+
+const std::vector<std::string> kPluckedKeys = {"request_id", "user", "status", "status_code",
+                                               "region"};
+
+// The pre-scanner implementation of px.pluck, which builds a full DOM for every call.
+std::string PluckWithDocument(const std::string& in, const std::string& key) {
+  rapidjson::Document d;
+  rapidjson::ParseResult ok = d.Parse(in.data());
+  if (ok == nullptr || !d.IsObject() || !d.HasMember(key.data())) {
+    return "";
+  }
+  const auto& plucked_value = d[key.data()];
+  if (plucked_value.IsNull()) {
+    return "";
+  }
+  if (plucked_value.IsString()) {
+    return plucked_value.GetString();
+  }
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  plucked_value.Accept(writer);
+  return sb.GetString();
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckDocument(benchmark::State& state) {
+  std::string payload = MakeAPIPayload(state.range(0));
+  for (auto _ : state) {
+    for (const auto& key : kPluckedKeys) {
+      benchmark::DoNotOptimize(PluckWithDocument(payload, key));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(payload.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckScanner(benchmark::State& state) {
+  PluckUDF udf;
+  StringValue payload = MakeAPIPayload(state.range(0));
+  for (auto _ : state) {
+    for (const auto& key : kPluckedKeys) {
+      benchmark::DoNotOptimize(udf.Exec(nullptr, payload, key));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(payload.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckMulti(benchmark::State& state) {
+  PluckMultiUDF<StringValue, StringValue, StringValue, StringValue, StringValue> multi_udf;
+  PluckMultiAtUDF at_udf;
+  StringValue payload = MakeAPIPayload(state.range(0));
+  for (auto _ : state) {
+    StringValue packed = multi_udf.Exec(nullptr, payload, kPluckedKeys[0], kPluckedKeys[1],
+                                        kPluckedKeys[2], kPluckedKeys[3], kPluckedKeys[4]);
+    for (size_t i = 0; i < kPluckedKeys.size(); ++i) {
+      benchmark::DoNotOptimize(at_udf.Exec(nullptr, packed, static_cast<int64_t>(i)));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(payload.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_PluckDocument)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_PluckScanner)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_PluckMulti)->RangeMultiplier(4)->Range(1, 256);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -111,6 +111,66 @@ TEST(JSONOps, PluckArrayUDF_index_out_of_bound) {
   udf_tester.ForInput(kTestJSONArray, 3).Expect("");
 }
 
+TEST(JSONOps, PluckUDF_escaped_values_and_keys) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  constexpr char kEscapedJSONStr[] = R"({"a\"b": "c\"d", "e": "f\u0041", "g": null})";
+  udf_tester.ForInput(kEscapedJSONStr, "a\"b").Expect("c\"d");
+  udf_tester.ForInput(kEscapedJSONStr, "e").Expect("fA");
+  udf_tester.ForInput(kEscapedJSONStr, "g").Expect("");
+}
+
+TEST(JSONOps, PluckUDF_skips_nested_values) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  constexpr char kNestedJSONStr[] = R"({"a": {"b": "}", "c": [1, {"d": "]"}]}, "b": [true, false]})";
+  udf_tester.ForInput(kNestedJSONStr, "b").Expect("[true,false]");
+  udf_tester.ForInput(kNestedJSONStr, "d").Expect("");
+}
+
+TEST(JSONOps, PluckMultiUDF) {
+  auto udf_tester = udf::UDFTester<PluckMultiUDF<StringValue, StringValue, StringValue>>();
+  auto packed = udf_tester.ForInput(kTestJSONStr, "str_plain", "blah", "int64_key").Result();
+
+  auto at_tester = udf::UDFTester<PluckMultiAtUDF>();
+  at_tester.ForInput(packed, 0).Expect("abc");
+  at_tester.ForInput(packed, 1).Expect("");
+  at_tester.ForInput(packed, 2).Expect("34243242341");
+  at_tester.ForInput(packed, 3).Expect("");
+
+  auto int_tester = udf::UDFTester<PluckMultiAtInt64UDF>();
+  int_tester.ForInput(packed, 0).Expect(0);
+  int_tester.ForInput(packed, 2).Expect(34243242341);
+}
+
+TEST(JSONOps, PluckMultiUDF_matches_pluck) {
+  auto udf_tester = udf::UDFTester<PluckMultiUDF<StringValue, StringValue, StringValue>>();
+  auto packed = udf_tester.ForInput(kTestJSONStr, "str_key", "float64_key", "int64_key").Result();
+
+  udf::UDFTester<PluckMultiAtUDF>().ForInput(packed, 0).Expect(R"({"abc":"def"})");
+  udf::UDFTester<PluckMultiAtFloat64UDF>().ForInput(packed, 1).Expect(123423.5234);
+  udf::UDFTester<PluckMultiAtFloat64UDF>().ForInput(packed, 2).Expect(0.0);
+}
+
+TEST(JSONOps, PluckMultiUDF_bad_input_return_empty) {
+  auto udf_tester = udf::UDFTester<PluckMultiUDF<StringValue, StringValue>>();
+  auto packed = udf_tester.ForInput("sdasdsa", "str_key", "int64_key").Result();
+  udf::UDFTester<PluckMultiAtUDF>().ForInput(packed, 0).Expect("");
+  udf::UDFTester<PluckMultiAtInt64UDF>().ForInput(packed, 1).Expect(0);
+}
+
+TEST(JSONOps, PluckMultiUDF_truncated_input_matches_pluck) {
+  constexpr char kTruncatedJSONStr[] = R"({"str_key": "abc", "int64_key": 12, "float64_key": 1.)";
+  auto packed = udf::UDFTester<PluckMultiUDF<StringValue, StringValue, StringValue>>()
+                    .ForInput(kTruncatedJSONStr, "str_key", "int64_key", "float64_key")
+                    .Result();
+
+  udf::UDFTester<PluckUDF>().ForInput(kTruncatedJSONStr, "str_key").Expect("abc");
+  udf::UDFTester<PluckMultiAtUDF>().ForInput(packed, 0).Expect("abc");
+  udf::UDFTester<PluckAsInt64UDF>().ForInput(kTruncatedJSONStr, "int64_key").Expect(12);
+  udf::UDFTester<PluckMultiAtInt64UDF>().ForInput(packed, 1).Expect(12);
+  udf::UDFTester<PluckAsFloat64UDF>().ForInput(kTruncatedJSONStr, "float64_key").Expect(0.0);
+  udf::UDFTester<PluckMultiAtFloat64UDF>().ForInput(packed, 2).Expect(0.0);
+}
+
 TEST(JSONOps, ScriptReferenceUDF_no_args) {
   auto udf_tester = udf::UDFTester<ScriptReferenceUDF<>>();
   auto res = udf_tester.ForInput("text", "px/script").Result();
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/json_scanner.h"
+
+#include <cstring>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+namespace {
+
+bool IsJSONWhitespace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+bool IsNumberChar(char c) {
+  return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+bool IsIntegerLiteral(std::string_view raw_value) {
+  return !raw_value.empty() && raw_value.find_first_not_of("-0123456789") == std::string_view::npos;
+}
+
+// Parses a single raw value with rapidjson. The values handed to this are small spans cut out of
+// the original document, so this is much cheaper than parsing the whole document.
+bool ParseRawValue(std::string_view raw_value, rapidjson::Document* d) {
+  rapidjson::ParseResult ok = d->Parse(raw_value.data(), raw_value.size());
+  return ok != nullptr;
+}
+
+// Returns whether a raw key span scanned out of a JSON object matches `key`.
+bool JSONKeyEquals(std::string_view raw_key, bool has_escapes, std::string_view key) {
+  if (!has_escapes) {
+    return raw_key == key;
+  }
+  // Escaped keys are rare, so just let rapidjson unescape them. The span includes the quotes.
+  std::string_view quoted(raw_key.data() - 1, raw_key.size() + 2);
+  rapidjson::Document d;
+  if (!ParseRawValue(quoted, &d) || !d.IsString()) {
+    return false;
+  }
+  return std::string_view(d.GetString(), d.GetStringLength()) == key;
+}
+
+}  // namespace
+
+void JSONScanner::SkipWhitespace() {
+  while (!AtEnd() && IsJSONWhitespace(Peek())) {
+    ++pos_;
+  }
+}
+
+bool JSONScanner::Consume(char c) {
+  SkipWhitespace();
+  if (AtEnd() || Peek() != c) {
+    return false;
+  }
+  ++pos_;
+  return true;
+}
+
+bool JSONScanner::ScanString(std::string_view* contents, bool* has_escapes) {
+  DCHECK_EQ(Peek(), '"');
+  size_t start = ++pos_;
+  *has_escapes = false;
+  while (true) {
+    // Jump straight to the next character that could end the string.
+    const void* quote = memchr(json_.data() + pos_, '"', json_.size() - pos_);
+    if (quote == nullptr) {
+      return false;
+    }
+    size_t quote_pos = static_cast<const char*>(quote) - json_.data();
+    const void* backslash = memchr(json_.data() + pos_, '\\', quote_pos - pos_);
+    if (backslash == nullptr) {
+      *contents = json_.substr(start, quote_pos - start);
+      pos_ = quote_pos + 1;
+      return true;
+    }
+    *has_escapes = true;
+    // Skip over the backslash and the escaped character.
+    pos_ = static_cast<const char*>(backslash) - json_.data() + 2;
+    if (pos_ > json_.size()) {
+      return false;
+    }
+  }
+}
+
+bool JSONScanner::SkipLiteral(std::string_view literal) {
+  if (json_.substr(pos_, literal.size()) != literal) {
+    return false;
+  }
+  pos_ += literal.size();
+  return true;
+}
+
+bool JSONScanner::SkipNumber() {
+  size_t start = pos_;
+  while (!AtEnd() && IsNumberChar(Peek())) {
+    ++pos_;
+  }
+  return pos_ > start;
+}
+
+bool JSONScanner::SkipContainer() {
+  // Only brackets and strings matter while skipping a nested container, so we don't validate the
+  // contents any further than bracket balance.
+  int64_t depth = 0;
+  while (!AtEnd()) {
+    char c = Peek();
+    switch (c) {
+      case '"': {
+        std::string_view unused;
+        bool unused_escapes;
+        if (!ScanString(&unused, &unused_escapes)) {
+          return false;
+        }
+        continue;
+      }
+      case '{':
+      case '[':
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        --depth;
+        break;
+      default:
+        break;
+    }
+    ++pos_;
+    if (depth == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool JSONScanner::ScanValue(std::string_view* value) {
+  SkipWhitespace();
+  if (AtEnd()) {
+    return false;
+  }
+  size_t start = pos_;
+  bool ok = false;
+  switch (Peek()) {
+    case '"': {
+      std::string_view unused;
+      bool unused_escapes;
+      ok = ScanString(&unused, &unused_escapes);
+      break;
+    }
+    case '{':
+    case '[':
+      ok = SkipContainer();
+      break;
+    case 't':
+      ok = SkipLiteral("true");
+      break;
+    case 'f':
+      ok = SkipLiteral("false");
+      break;
+    case 'n':
+      ok = SkipLiteral("null");
+      break;
+    default:
+      ok = SkipNumber();
+      break;
+  }
+  if (!ok) {
+    return false;
+  }
+  *value = json_.substr(start, pos_ - start);
+  return true;
+}
+
+bool JSONScanner::EnterObject(bool* empty) {
+  pos_ = 0;
+  if (!Consume('{')) {
+    return false;
+  }
+  SkipWhitespace();
+  *empty = !AtEnd() && Peek() == '}';
+  return true;
+}
+
+bool JSONScanner::NextMember(std::string_view* raw_key, bool* key_has_escapes,
+                             std::string_view* value, bool* last) {
+  SkipWhitespace();
+  if (AtEnd() || Peek() != '"') {
+    return false;
+  }
+  if (!ScanString(raw_key, key_has_escapes)) {
+    return false;
+  }
+  if (!Consume(':')) {
+    return false;
+  }
+  if (!ScanValue(value)) {
+    return false;
+  }
+  if (Consume(',')) {
+    *last = false;
+    return true;
+  }
+  *last = true;
+  return Consume('}');
+}
+
+JSONScanner::Result JSONScanner::FindMember(std::string_view key, std::string_view* value) {
+  bool empty;
+  if (!EnterObject(&empty)) {
+    return Result::kInvalid;
+  }
+  if (empty) {
+    return Result::kNotFound;
+  }
+  bool last = false;
+  while (!last) {
+    std::string_view raw_key;
+    bool key_has_escapes;
+    if (!NextMember(&raw_key, &key_has_escapes, value, &last)) {
+      return Result::kInvalid;
+    }
+    if (JSONKeyEquals(raw_key, key_has_escapes, key)) {
+      return Result::kFound;
+    }
+  }
+  return Result::kNotFound;
+}
+
+JSONScanner::Result JSONScanner::FindMembers(
+    const std::vector<std::string_view>& keys,
+    std::vector<std::optional<std::string_view>>* values) {
+  values->assign(keys.size(), std::nullopt);
+  bool empty;
+  if (!EnterObject(&empty)) {
+    return Result::kInvalid;
+  }
+  if (empty) {
+    return Result::kNotFound;
+  }
+  size_t num_found = 0;
+  bool last = false;
+  while (!last && num_found < keys.size()) {
+    std::string_view raw_key;
+    bool key_has_escapes;
+    std::string_view value;
+    if (!NextMember(&raw_key, &key_has_escapes, &value, &last)) {
+      return Result::kInvalid;
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+      // Only the first occurrence of a key counts, same as rapidjson's FindMember.
+      if ((*values)[i].has_value() || !JSONKeyEquals(raw_key, key_has_escapes, keys[i])) {
+        continue;
+      }
+      (*values)[i] = value;
+      ++num_found;
+    }
+  }
+  return num_found > 0 ? Result::kFound : Result::kNotFound;
+}
+
+JSONScanner::Result JSONScanner::FindElement(int64_t index, std::string_view* value) {
+  pos_ = 0;
+  if (!Consume('[')) {
+    return Result::kInvalid;
+  }
+  if (index < 0) {
+    return Result::kNotFound;
+  }
+  SkipWhitespace();
+  if (!AtEnd() && Peek() == ']') {
+    return Result::kNotFound;
+  }
+  for (int64_t i = 0;; ++i) {
+    if (!ScanValue(value)) {
+      return Result::kInvalid;
+    }
+    if (i == index) {
+      return Result::kFound;
+    }
+    if (Consume(',')) {
+      continue;
+    }
+    return Consume(']') ? Result::kNotFound : Result::kInvalid;
+  }
+}
+
+std::string JSONValueAsString(std::string_view raw_value) {
+  // Fast path for plain strings which don't need any unescaping.
+  if (raw_value.size() >= 2 && raw_value.front() == '"' &&
+      raw_value.find('\\') == std::string_view::npos) {
+    return std::string(raw_value.substr(1, raw_value.size() - 2));
+  }
+  rapidjson::Document d;
+  if (!ParseRawValue(raw_value, &d) || d.IsNull()) {
+    return "";
+  }
+  if (d.IsString()) {
+    return std::string(d.GetString(), d.GetStringLength());
+  }
+  // This is robust to nested JSON.
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  d.Accept(writer);
+  return sb.GetString();
+}
+
+int64_t JSONValueAsInt64(std::string_view raw_value) {
+  int64_t val;
+  // Plain integers don't need rapidjson. Anything else (floats, out of range values, non-numbers)
+  // is not an int64 and plucks as 0.
+  if (IsIntegerLiteral(raw_value) && absl::SimpleAtoi(raw_value, &val)) {
+    return val;
+  }
+  return 0;
+}
+
+double JSONValueAsFloat64(std::string_view raw_value) {
+  // Integers are not doubles in rapidjson's view, so they pluck as 0.0. The exception is integers
+  // that don't fit in 64 bits, which rapidjson stores as doubles.
+  int64_t int_val;
+  uint64_t uint_val;
+  if (IsIntegerLiteral(raw_value) &&
+      (absl::SimpleAtoi(raw_value, &int_val) || absl::SimpleAtoi(raw_value, &uint_val))) {
+    return 0.0;
+  }
+  rapidjson::Document d;
+  if (!ParseRawValue(raw_value, &d) || !d.IsDouble()) {
+    return 0.0;
+  }
+  return d.GetDouble();
+}
+
+std::string PackJSONValues(const std::vector<std::optional<std::string_view>>& values) {
+  std::string packed;
+  for (const auto& value : values) {
+    if (!value.has_value()) {
+      packed.push_back('-');
+      continue;
+    }
+    absl::StrAppend(&packed, value->size(), ":", *value);
+  }
+  return packed;
+}
+
+std::optional<std::string_view> UnpackJSONValue(std::string_view packed, int64_t index) {
+  size_t pos = 0;
+  for (int64_t i = 0; pos < packed.size(); ++i) {
+    if (packed[pos] == '-') {
+      if (i == index) {
+        return std::nullopt;
+      }
+      ++pos;
+      continue;
+    }
+    size_t colon = packed.find(':', pos);
+    size_t len;
+    if (colon == std::string_view::npos ||
+        !absl::SimpleAtoi(packed.substr(pos, colon - pos), &len) ||
+        colon + 1 + len > packed.size()) {
+      return std::nullopt;
+    }
+    if (i == index) {
+      return packed.substr(colon + 1, len);
+    }
+    pos = colon + 1 + len;
+  }
+  return std::nullopt;
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
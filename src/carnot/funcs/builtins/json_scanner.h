@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * JSONScanner is an on-demand scanner over a serialized JSON value. Unlike rapidjson::Document,
+ * it does not build a DOM: it walks the top-level container, skipping over values it does not
+ * need, and stops as soon as the requested members have been found. Values are returned as raw
+ * byte spans into the input, which can be converted with the JSONValueAs* helpers below.
+ *
+ * Since scanning stops early, syntax errors located after the requested member are not
+ * detected. Errors encountered before (or while skipping to) the member are.
+ */
+class JSONScanner {
+ public:
+  enum class Result {
+    kFound,
+    kNotFound,
+    kInvalid,
+  };
+
+  explicit JSONScanner(std::string_view json) : json_(json) {}
+
+  /**
+   * @brief Finds the first member named `key` in the top-level object.
+   * Returns kInvalid if the input is not an object or is malformed before the member is found.
+   */
+  Result FindMember(std::string_view key, std::string_view* value);
+
+  /**
+   * @brief Finds several members of the top-level object in a single pass.
+   * `values` is resized to keys.size(); keys that are not found are left as std::nullopt.
+   * Returns kInvalid if the input is not an object or is malformed before all keys are found,
+   * kFound if at least one key was found and kNotFound otherwise. The keys found before the input
+   * turned out to be malformed keep their values, so every key gets the value that FindMember
+   * would find for it on its own.
+   */
+  Result FindMembers(const std::vector<std::string_view>& keys,
+                     std::vector<std::optional<std::string_view>>* values);
+
+  /**
+   * @brief Finds the element at `index` in the top-level array.
+   * Returns kInvalid if the input is not an array or is malformed before the element is found.
+   */
+  Result FindElement(int64_t index, std::string_view* value);
+
+ private:
+  bool AtEnd() const { return pos_ >= json_.size(); }
+  char Peek() const { return json_[pos_]; }
+  void SkipWhitespace();
+  bool Consume(char c);
+
+  // Scans the string starting at pos_ (which must point at the opening quote). `contents` is set
+  // to the raw bytes between the quotes, and `has_escapes` to whether those contain a backslash.
+  bool ScanString(std::string_view* contents, bool* has_escapes);
+  bool SkipLiteral(std::string_view literal);
+  bool SkipNumber();
+  bool SkipContainer();
+  // Skips the value starting at pos_ and sets `value` to its raw span.
+  bool ScanValue(std::string_view* value);
+
+  // Positions the scanner at the first member key of the top-level object. Returns false if the
+  // input is not an object. `empty` is set if the object has no members.
+  bool EnterObject(bool* empty);
+  // Scans the next "key": value pair. `last` is set if it was the final member.
+  bool NextMember(std::string_view* raw_key, bool* key_has_escapes, std::string_view* value,
+                  bool* last);
+
+  std::string_view json_;
+  size_t pos_ = 0;
+};
+
+// The JSONValueAs* helpers convert a raw value span into the same result px.pluck,
+// px.pluck_int64 and px.pluck_float64 produce for it: nested values are re-serialized compactly,
+// nulls and type mismatches return the empty value.
+std::string JSONValueAsString(std::string_view raw_value);
+int64_t JSONValueAsInt64(std::string_view raw_value);
+double JSONValueAsFloat64(std::string_view raw_value);
+
+/**
+ * Helpers for the packed representation produced by px._pluck_multi. Each requested key is
+ * encoded in order as either "<len>:<raw json value>" or "-" when the key is absent, e.g.
+ * {"a": 1, "c": "x"} plucked for keys [a, b, c] is packed as `1:1-3:"x"`.
+ */
+std::string PackJSONValues(const std::vector<std::optional<std::string_view>>& values);
+std::optional<std::string_view> UnpackJSONValue(std::string_view packed, int64_t index);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
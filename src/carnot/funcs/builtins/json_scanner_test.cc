@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/funcs/builtins/json_scanner.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using Result = JSONScanner::Result;
+
+constexpr char kTestJSONStr[] = R"(
+{
+  "obj": {"a": "}", "b": [1, 2, {"c": "]"}]},
+  "str": "x\"y",
+  "int": -42,
+  "float": 1.5e3,
+  "bool": true,
+  "null": null,
+  "int": 7
+})";
+
+TEST(JSONScanner, FindMember) {
+  std::string_view value;
+  EXPECT_EQ(Result::kFound, JSONScanner(kTestJSONStr).FindMember("obj", &value));
+  EXPECT_EQ(R"({"a": "}", "b": [1, 2, {"c": "]"}]})", value);
+  EXPECT_EQ(Result::kFound, JSONScanner(kTestJSONStr).FindMember("str", &value));
+  EXPECT_EQ(R"("x\"y")", value);
+  EXPECT_EQ(Result::kFound, JSONScanner(kTestJSONStr).FindMember("float", &value));
+  EXPECT_EQ("1.5e3", value);
+  EXPECT_EQ(Result::kFound, JSONScanner(kTestJSONStr).FindMember("bool", &value));
+  EXPECT_EQ("true", value);
+  EXPECT_EQ(Result::kFound, JSONScanner(kTestJSONStr).FindMember("null", &value));
+  EXPECT_EQ("null", value);
+  EXPECT_EQ(Result::kNotFound, JSONScanner(kTestJSONStr).FindMember("a", &value));
+}
+
+TEST(JSONScanner, FindMemberReturnsFirstDuplicate) {
+  std::string_view value;
+  EXPECT_EQ(Result::kFound, JSONScanner(kTestJSONStr).FindMember("int", &value));
+  EXPECT_EQ("-42", value);
+}
+
+TEST(JSONScanner, FindMemberInvalid) {
+  std::string_view value;
+  EXPECT_EQ(Result::kInvalid, JSONScanner("").FindMember("a", &value));
+  EXPECT_EQ(Result::kInvalid, JSONScanner("[1]").FindMember("a", &value));
+  EXPECT_EQ(Result::kInvalid, JSONScanner(R"({"a": 1,})").FindMember("b", &value));
+  EXPECT_EQ(Result::kInvalid, JSONScanner(R"({"a": "unterminated)").FindMember("b", &value));
+  EXPECT_EQ(Result::kInvalid, JSONScanner(R"({"a": nul})").FindMember("b", &value));
+  EXPECT_EQ(Result::kNotFound, JSONScanner("{ }").FindMember("a", &value));
+}
+
+TEST(JSONScanner, FindMembers) {
+  std::vector<std::optional<std::string_view>> values;
+  EXPECT_EQ(Result::kFound,
+            JSONScanner(kTestJSONStr).FindMembers({"int", "missing", "bool"}, &values));
+  ASSERT_EQ(3UL, values.size());
+  EXPECT_EQ("-42", values[0]);
+  EXPECT_EQ(std::nullopt, values[1]);
+  EXPECT_EQ("true", values[2]);
+
+  EXPECT_EQ(Result::kNotFound, JSONScanner(kTestJSONStr).FindMembers({"missing"}, &values));
+  EXPECT_EQ(Result::kInvalid, JSONScanner("asdf").FindMembers({"int"}, &values));
+
+  // The keys found before the input is cut off keep their values.
+  EXPECT_EQ(Result::kInvalid,
+            JSONScanner(R"({"a": 1, "b": "trunc)").FindMembers({"b", "a", "c"}, &values));
+  ASSERT_EQ(3UL, values.size());
+  EXPECT_EQ(std::nullopt, values[0]);
+  EXPECT_EQ("1", values[1]);
+  EXPECT_EQ(std::nullopt, values[2]);
+}
+
+TEST(JSONScanner, FindElement) {
+  constexpr char kArray[] = R"(["foo", {"a": [1]}, 3])";
+  std::string_view value;
+  EXPECT_EQ(Result::kFound, JSONScanner(kArray).FindElement(1, &value));
+  EXPECT_EQ(R"({"a": [1]})", value);
+  EXPECT_EQ(Result::kFound, JSONScanner(kArray).FindElement(2, &value));
+  EXPECT_EQ("3", value);
+  EXPECT_EQ(Result::kNotFound, JSONScanner(kArray).FindElement(3, &value));
+  EXPECT_EQ(Result::kNotFound, JSONScanner(kArray).FindElement(-1, &value));
+  EXPECT_EQ(Result::kInvalid, JSONScanner(kTestJSONStr).FindElement(0, &value));
+}
+
+TEST(JSONScanner, ValueConversions) {
+  EXPECT_EQ("abc", JSONValueAsString(R"("abc")"));
+  EXPECT_EQ("a\"b", JSONValueAsString(R"("a\"b")"));
+  EXPECT_EQ(R"({"a":[1,2]})", JSONValueAsString(R"({"a": [1, 2]})"));
+  EXPECT_EQ("", JSONValueAsString("null"));
+
+  EXPECT_EQ(-42, JSONValueAsInt64("-42"));
+  EXPECT_EQ(0, JSONValueAsInt64("1.5"));
+  EXPECT_EQ(0, JSONValueAsInt64(R"("42")"));
+
+  EXPECT_DOUBLE_EQ(1500.0, JSONValueAsFloat64("1.5e3"));
+  EXPECT_DOUBLE_EQ(0.0, JSONValueAsFloat64("42"));
+  EXPECT_DOUBLE_EQ(0.0, JSONValueAsFloat64("true"));
+}
+
+TEST(JSONScanner, PackUnpack) {
+  std::string packed = PackJSONValues({"1", std::nullopt, R"("x:y")"});
+  EXPECT_EQ(R"(1:1-5:"x:y")", packed);
+  EXPECT_EQ("1", UnpackJSONValue(packed, 0));
+  EXPECT_EQ(std::nullopt, UnpackJSONValue(packed, 1));
+  EXPECT_EQ(R"("x:y")", UnpackJSONValue(packed, 2));
+  EXPECT_EQ(std::nullopt, UnpackJSONValue(packed, 3));
+  EXPECT_EQ(std::nullopt, UnpackJSONValue("", 0));
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
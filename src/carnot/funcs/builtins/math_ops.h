@@ -605,6 +605,10 @@ class MeanUDA : public udf::UDA {
   }
 
   Status Deserialize(FunctionContext*, const StringValue& data) {
+    if (data.size() != sizeof(info_)) {
+      return error::InvalidArgument("invalid serialized mean, expected $0 bytes got $1",
+                                    sizeof(info_), data.size());
+    }
     std::memcpy(&info_, data.data(), sizeof(info_));
     return Status::OK();
   }
@@ -523,6 +523,13 @@ TEST(MathOps, merge_mean_uda_test) {
   uda_tester.Merge(&other_uda_tester).Expect(expected_mean);
 }
 
+TEST(MathOps, mean_uda_deserialize_invalid) {
+  auto uda_tester = udf::UDATester<MeanUDA<types::Int64Value>>();
+  EXPECT_NOT_OK(uda_tester.Deserialize("short"));
+  auto sum_tester = udf::UDATester<SumUDA<types::Int64Value>>();
+  EXPECT_NOT_OK(sum_tester.Deserialize("short"));
+}
+
 TEST(MathOps, basic_float64_sum_uda_test) {
   auto inputs = std::vector<double>({1.234, 2.442, 1.04, 5.322, 6.333});
   double expected_sum = std::accumulate(std::begin(inputs), std::end(inputs), 0.0,
@@ -41,6 +41,19 @@ void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
   writer->EndArray();
 }
 
+bool IsCentroidArray(const rapidjson::Value& val) {
+  if (!val.IsArray()) {
+    return false;
+  }
+  for (const auto& centroid : val.GetArray()) {
+    if (!centroid.IsArray() || centroid.Size() != 2 || !centroid[0].IsNumber() ||
+        !centroid[1].IsNumber()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val) {
   std::vector<tdigest::Centroid> centroids;
   for (rapidjson::Value::ConstValueIterator centroid = val.Begin(); centroid != val.End();
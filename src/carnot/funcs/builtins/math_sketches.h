@@ -36,6 +36,8 @@ void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
                         const std::vector<tdigest::Centroid>& centroids);
 
 std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val);
+// Returns true if val is an array of [mean, weight] pairs, as written by WriteCentroidArray.
+bool IsCentroidArray(const rapidjson::Value& val);
 
 // TODO(zasgar): PL-419 Replace this when we add support for structs.
 template <typename TArg>
@@ -88,9 +90,19 @@ class QuantilesUDA : public udf::UDA {
   Status Deserialize(FunctionContext*, const StringValue& json) {
     rapidjson::Document d;
     rapidjson::ParseResult ok = d.Parse(json.data());
-    if (ok == nullptr) {
+    if (ok == nullptr || !d.IsObject()) {
       return error::InvalidArgument("invalid serialized tdigest");
     }
+    for (const char* key : {kProcessedKey, kUnprocessedKey}) {
+      if (!d.HasMember(key) || !IsCentroidArray(d[key])) {
+        return error::InvalidArgument("invalid serialized tdigest, bad centroids for key $0", key);
+      }
+    }
+    if (!d.HasMember(kCompressionKey) || !d[kCompressionKey].IsNumber() ||
+        !d.HasMember(kMaxUnprocessedKey) || !d[kMaxUnprocessedKey].IsUint64() ||
+        !d.HasMember(kMaxProcessedKey) || !d[kMaxProcessedKey].IsUint64()) {
+      return error::InvalidArgument("invalid serialized tdigest, missing parameters");
+    }
     auto processed = CentroidArrayFromJSON(d[kProcessedKey]);
     auto unprocessed = CentroidArrayFromJSON(d[kUnprocessedKey]);
     auto compression = d[kCompressionKey].GetDouble();
@@ -108,6 +108,15 @@ TEST(MathSketches, quantiles_serde) {
   EXPECT_EQ(res_before_serde, res_after_serde);
 }
 
+TEST(MathSketches, quantiles_deserialize_invalid) {
+  auto uda_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  EXPECT_NOT_OK(uda_tester.Deserialize("not json"));
+  EXPECT_NOT_OK(uda_tester.Deserialize("[]"));
+  EXPECT_NOT_OK(uda_tester.Deserialize(R"({"0": [[1.0, 1.0]], "1": []})"));
+  EXPECT_NOT_OK(
+      uda_tester.Deserialize(R"({"0": [[1.0]], "1": [], "2": 1000.0, "3": 100, "4": 100})"));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
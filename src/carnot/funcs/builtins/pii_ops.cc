@@ -17,9 +17,11 @@
  */
 #include <algorithm>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/numbers.h>
+#include <absl/strings/substitute.h>
 #include "src/carnot/funcs/builtins/pii_ops.h"
 
 namespace px {
@@ -334,6 +336,29 @@ Status RedactPIIUDF::Init(FunctionContext*) {
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::SSN>>());
+  return BuildPrefilter();
+}
+
+Status RedactPIIUDF::BuildPrefilter() {
+  auto prefilter = std::make_unique<re2::RE2::Set>(RE2::DefaultOptions, RE2::UNANCHORED);
+  for (const auto& [tagger_idx, tagger] : Enumerate(taggers_)) {
+    std::string error;
+    int idx = prefilter->Add(tagger->Pattern(), &error);
+    if (idx < 0) {
+      // Since the regex patterns are defined at compile time, this should never happen. Running
+      // without the prefilter is still correct, just slower.
+      LOG(DFATAL) << absl::Substitute("Failed to add PII pattern to prefilter: $0", error);
+      return Status::OK();
+    }
+    DCHECK_EQ(static_cast<size_t>(idx), prefilter_idx_to_tagger_idx_.size());
+    prefilter_idx_to_tagger_idx_.push_back(tagger_idx);
+  }
+  if (!prefilter->Compile()) {
+    LOG(DFATAL) << "Failed to compile PII prefilter.";
+    prefilter_idx_to_tagger_idx_.clear();
+    return Status::OK();
+  }
+  prefilter_ = std::move(prefilter);
   return Status::OK();
 }
 
@@ -393,8 +418,28 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
 }
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
+  std::vector<bool> run_tagger(taggers_.size(), true);
+  if (prefilter_ != nullptr) {
+    std::vector<int> matched;
+    re2::RE2::Set::ErrorInfo error_info;
+    bool any_match = prefilter_->Match(input, &matched, &error_info);
+    // If the prefilter's DFA runs out of memory, fall back to running every tagger.
+    if (error_info.kind == re2::RE2::Set::kNoError) {
+      if (!any_match) {
+        return input;
+      }
+      std::fill(run_tagger.begin(), run_tagger.end(), false);
+      for (int idx : matched) {
+        run_tagger[prefilter_idx_to_tagger_idx_[idx]] = true;
+      }
+    }
+  }
+
   std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
+  for (const auto& [tagger_idx, tagger] : Enumerate(taggers_)) {
+    if (!run_tagger[tagger_idx]) {
+      continue;
+    }
     auto s = tagger->AddTags(&input, &tags);
     if (!s.ok()) {
       return "Invalid regex: " + s.msg();
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -70,6 +71,9 @@ class Tagger {
  public:
   virtual ~Tagger() = default;
   virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  // The regex pattern that any tagged sequence must match. Used to build the prefilter that
+  // decides which taggers need to run on a given input.
+  virtual std::string_view Pattern() const = 0;
 };
 
 class RedactPIIUDF : public udf::ScalarUDF {
@@ -93,7 +97,15 @@ class RedactPIIUDF : public udf::ScalarUDF {
   }
 
  private:
+  Status BuildPrefilter();
+
   std::vector<std::unique_ptr<Tagger>> taggers_;
+  // A single automaton over the patterns of all the taggers. Matching it once tells us which
+  // taggers can find anything in the input, so that the (much more expensive) per-tagger search
+  // and validation only runs for those. Most inputs contain no PII at all and take a single pass.
+  std::unique_ptr<re2::RE2::Set> prefilter_;
+  // Maps the prefilter's pattern indices to indices into taggers_.
+  std::vector<size_t> prefilter_idx_to_tagger_idx_;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -106,7 +118,7 @@ class RegexTagger : public Tagger {
     DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
   }
 
-  Status AddTags(std::string* input, std::vector<Tag>* tags) {
+  Status AddTags(std::string* input, std::vector<Tag>* tags) override {
     re2::StringPiece input_piece(input->data(), input->length());
     auto prev_length = input_piece.length();
     int curr_idx = 0;
@@ -132,6 +144,8 @@ class RegexTagger : public Tagger {
     return Status::OK();
   }
 
+  std::string_view Pattern() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
  private:
   re2::RE2 regex_;
 };
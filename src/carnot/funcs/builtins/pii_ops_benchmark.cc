@@ -51,7 +51,31 @@ static void BM_RedactPII(benchmark::State& state) {
                           static_cast<int64_t>(state.iterations()));
 }
 
+// A typical API body that contains no PII, which the prefilter should reject in a single pass.
+static constexpr std::string_view no_pii_input_chunk = R"input(
+        {"order_id": "A1B2C3", "items": [{"sku": "widget-42", "qty": 3, "price": 19.99}],
+         "status": "shipped", "carrier": "ground", "notes": "leave at front desk"},
+)input";
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RedactPII_NoPII(benchmark::State& state) {
+  RedactPIIUDF udf;
+  PX_UNUSED(udf.Init(nullptr));
+
+  std::string text_chunk(no_pii_input_chunk);
+  std::string text;
+  for (int i = 0; i < state.range(0); i++) {
+    text += text_chunk;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.Exec(nullptr, text));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(text.length()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
 BENCHMARK(BM_RedactPII)->RangeMultiplier(2)->Range(1, 12);
+BENCHMARK(BM_RedactPII_NoPII)->RangeMultiplier(2)->Range(1, 12);
 
 }  // namespace builtins
 }  // namespace carnot
@@ -262,6 +262,27 @@ TEST_P(RedactionTest, basic) {
   udf::UDFTester<RedactPIIUDF>().Init().ForInput(test_case.first).Expect(test_case.second);
 }
 
+// Inputs that match none of the tagger patterns are returned after the prefilter pass alone.
+TEST(RedactPIIUDF, prefilter_skips_inputs_without_pii) {
+  udf::UDFTester<RedactPIIUDF> udf_tester;
+  udf_tester.Init();
+  udf_tester.ForInput("").Expect("");
+  udf_tester.ForInput("GET /api/v1/users?limit=10 HTTP/1.1").Expect(
+      "GET /api/v1/users?limit=10 HTTP/1.1");
+  udf_tester.ForInput(R"({"status": "ok", "count": 12})")
+      .Expect(R"({"status": "ok", "count": 12})");
+}
+
+// Only the taggers whose pattern the prefilter matched run, and they still validate their matches.
+TEST(RedactPIIUDF, prefilter_runs_matching_taggers) {
+  udf::UDFTester<RedactPIIUDF> udf_tester;
+  udf_tester.Init();
+  udf_tester.ForInput("test@pixie.io, 10.0.0.1, 5555 0000 0000 0000")
+      .Expect("<REDACTED_EMAIL>, <REDACTED_IPV4>, 5555 0000 0000 0000");
+  // Looks like a credit card number to the prefilter, but fails the Luhn check.
+  udf_tester.ForInput("5555 0000 0000 0000").Expect("5555 0000 0000 0000");
+}
+
 INSTANTIATE_TEST_SUITE_P(TemplatedRedactionTest, RedactionTest,
                          ::testing::ValuesIn(TestCaseGen({IBANGen(), IPv4Gen(), IPv6Gen(),
                                                           EmailGen(), CCGen(), IMEIGen(), SSNGen(),
@@ -29,6 +29,7 @@
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -126,6 +127,15 @@ class MatchRegexRule : public udf::ScalarUDF {
     if (!parse_result) {
       return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
     }
+    regex_rules.clear();
+    regex_rules_length = 0;
+    rule_set_.reset();
+    set_idx_to_rule_idx_.clear();
+
+    re2::RE2::Options opts;
+    opts.set_dot_nl(true);
+    opts.set_log_errors(false);
+    auto rule_set = std::make_unique<re2::RE2::Set>(opts, RE2::ANCHOR_BOTH);
     // Populate the parse regular expressions into self::regex_rules.
     for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
          itr != regex_rules_json.MemberEnd(); ++itr) {
@@ -133,13 +143,36 @@ class MatchRegexRule : public udf::ScalarUDF {
       std::string name = itr->name.GetString();
       std::string regex_pattern = itr->value.GetString();
       PX_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
+      // Invalid patterns never match, so they are simply left out of the set.
+      std::string error;
+      if (rule_set->Add(regex_pattern, &error) >= 0) {
+        set_idx_to_rule_idx_.push_back(regex_rules_length);
+      }
       regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
       regex_rules_length++;
     }
+    // All of the rules are matched in a single pass with the set. If it can't be compiled (eg. the
+    // combined program is too large), we fall back to trying each rule in turn.
+    if (!set_idx_to_rule_idx_.empty() && rule_set->Compile()) {
+      rule_set_ = std::move(rule_set);
+    }
     return Status::OK();
   }
 
   types::StringValue Exec(FunctionContext* ctx, StringValue value) {
+    if (rule_set_ != nullptr) {
+      std::vector<int> matched;
+      re2::RE2::Set::ErrorInfo error_info;
+      bool any_match = rule_set_->Match(value, &matched, &error_info);
+      if (error_info.kind == re2::RE2::Set::kNoError) {
+        if (!any_match) {
+          return "";
+        }
+        // The rules are added in order, so the first rule that matched has the lowest index.
+        int first_match = *std::min_element(matched.begin(), matched.end());
+        return regex_rules[set_idx_to_rule_idx_[first_match]].first;
+      }
+    }
     for (int i = 0; i < regex_rules_length; i++) {
       if (regex_rules[i].second.Exec(ctx, value).val) {
         return regex_rules[i].first;
@@ -172,6 +205,9 @@ class MatchRegexRule : public udf::ScalarUDF {
  private:
   int regex_rules_length = 0;
   std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::unique_ptr<re2::RE2::Set> rule_set_;
+  // Maps the indices of the patterns in rule_set_ to indices into regex_rules.
+  std::vector<int> set_idx_to_rule_idx_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
@@ -96,6 +96,18 @@ TEST(RegexOps, regex_match_rules) {
   EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, "(?i).*onpointerenter.*"));
 }
 
+TEST(RegexOps, MatchRegexRuleReturnsFirstMatchingRule) {
+  auto udf_tester = udf::UDFTester<MatchRegexRule>();
+  udf_tester.Init(
+      R"({"select": "(?i)select.*", "invalid": "(", "any_sql": ".*(?i)(select|update).*"})");
+  // Both rules match, but select comes first.
+  udf_tester.ForInput("SELECT * FROM courses").Expect("select");
+  udf_tester.ForInput("UPDATE courses SET name = 'foo'").Expect("any_sql");
+  udf_tester.ForInput("DELETE FROM courses").Expect("");
+  // Rules can span multiple lines.
+  udf_tester.ForInput("SELECT *\nFROM courses").Expect("select");
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -17,6 +17,8 @@
  */
 
 #include "src/carnot/funcs/builtins/request_path_ops.h"
+#include <algorithm>
+#include <cmath>
 #include <string_view>
 #include <vector>
 #include "src/carnot/udf/registry.h"
@@ -96,6 +98,12 @@ StatusOr<RequestPath> RequestPath::FromJSON(const rapidjson::Document::ValueType
   return request_path;
 }
 
+RequestPath RequestPath::FromPathComponents(std::vector<std::string> path_components) {
+  RequestPath request_path;
+  request_path.path_components_ = std::move(path_components);
+  return request_path;
+}
+
 std::string RequestPath::ToJSON() const {
   rapidjson::StringBuffer sb;
   rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
@@ -209,36 +217,165 @@ void RequestPathCluster::ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writ
   writer->EndObject();
 }
 
-double RequestPathClustering::MaxSimilarity(const RequestPath& request_path,
-                                            int64_t* max_index) const {
-  auto it = depth_to_centroid_indices_.find(request_path.depth());
-  *max_index = -1;
-  if (it == depth_to_centroid_indices_.end()) {
-    return 0.0;
+void RequestPathClusterIndex::Insert(const RequestPath& centroid, int64_t cluster_index) {
+  auto it = depth_to_root_.find(centroid.depth());
+  int32_t node_id;
+  if (it == depth_to_root_.end()) {
+    node_id = nodes_.size();
+    nodes_.emplace_back();
+    depth_to_root_.emplace(centroid.depth(), node_id);
+  } else {
+    node_id = it->second;
+  }
+  nodes_[node_id].min_cluster_index = std::min(nodes_[node_id].min_cluster_index, cluster_index);
+  for (const auto& path_component : centroid.path_components()) {
+    node_id = FindOrAddChild(node_id, path_component);
+    nodes_[node_id].min_cluster_index = std::min(nodes_[node_id].min_cluster_index, cluster_index);
+  }
+  nodes_[node_id].cluster_indices.push_back(cluster_index);
+}
+
+void RequestPathClusterIndex::Remove(const RequestPath& centroid, int64_t cluster_index) {
+  auto it = depth_to_root_.find(centroid.depth());
+  if (it == depth_to_root_.end()) {
+    return;
+  }
+  int32_t node_id = it->second;
+  for (const auto& path_component : centroid.path_components()) {
+    node_id = FindChild(node_id, path_component);
+    if (node_id == -1) {
+      return;
+    }
+  }
+  auto& cluster_indices = nodes_[node_id].cluster_indices;
+  cluster_indices.erase(std::remove(cluster_indices.begin(), cluster_indices.end(), cluster_index),
+                        cluster_indices.end());
+}
+
+void RequestPathClusterIndex::Clear() {
+  depth_to_root_.clear();
+  nodes_.clear();
+}
+
+int32_t RequestPathClusterIndex::FindChild(int32_t node_id,
+                                           const std::string& path_component) const {
+  const auto& node = nodes_[node_id];
+  if (path_component == RequestPath::kAnyToken) {
+    return node.wildcard_child;
+  }
+  auto it = node.children.find(path_component);
+  if (it == node.children.end()) {
+    return -1;
+  }
+  return it->second;
+}
+
+int32_t RequestPathClusterIndex::FindOrAddChild(int32_t node_id,
+                                                const std::string& path_component) {
+  auto child_id = FindChild(node_id, path_component);
+  if (child_id != -1) {
+    return child_id;
+  }
+  child_id = nodes_.size();
+  // Take care not to hold a reference to nodes_[node_id] across the emplace_back.
+  nodes_.emplace_back();
+  if (path_component == RequestPath::kAnyToken) {
+    nodes_[node_id].wildcard_child = child_id;
+  } else {
+    nodes_[node_id].children.emplace(path_component, child_id);
+  }
+  return child_id;
+}
+
+bool RequestPathClusterIndex::CanImprove(const Node& node, int64_t max_matches,
+                                         const SearchState& state) const {
+  if (max_matches != state.best_matches) {
+    return max_matches > state.best_matches;
+  }
+  // A tie can only win if it comes from a lower cluster index.
+  return state.best_index == -1 || node.min_cluster_index < state.best_index;
+}
+
+void RequestPathClusterIndex::Search(int32_t node_id, size_t level, int64_t matches,
+                                     SearchState* state) const {
+  const auto& node = nodes_[node_id];
+  const auto& path_components = state->path_components;
+  int64_t remaining = path_components.size() - level;
+  if (!CanImprove(node, matches + remaining, *state)) {
+    return;
   }
-  auto max_similarity = 0.0;
-  for (auto index : it->second) {
-    auto similarity = clusters_[index].Similarity(request_path);
-    if (similarity > max_similarity) {
-      *max_index = index;
-      max_similarity = similarity;
+  if (remaining == 0) {
+    // CanImprove guarantees matches >= best_matches here.
+    for (auto cluster_index : node.cluster_indices) {
+      if (matches > state->best_matches || state->best_index == -1 ||
+          cluster_index < state->best_index) {
+        state->best_matches = matches;
+        state->best_index = cluster_index;
+      }
     }
+    return;
+  }
+
+  // Visit the most promising children first, so that the rest of the trie is pruned early.
+  const auto& path_component = path_components[level];
+  bool is_any = path_component == RequestPath::kAnyToken;
+  auto exact_it = is_any ? node.children.end() : node.children.find(path_component);
+  if (exact_it != node.children.end()) {
+    Search(exact_it->second, level + 1, matches + 1, state);
+  }
+  if (node.wildcard_child != -1) {
+    Search(node.wildcard_child, level + 1, matches, state);
+  }
+  // Children that disagree with this path component don't add a match, so none of them can do
+  // better than one less than the bound for this node.
+  if (!CanImprove(node, matches + remaining - 1, *state)) {
+    return;
+  }
+  for (const auto& [child_component, child_id] : node.children) {
+    if (exact_it != node.children.end() && child_id == exact_it->second) {
+      continue;
+    }
+    Search(child_id, level + 1, matches, state);
   }
-  return max_similarity;
 }
 
-void RequestPathClustering::AddNewCluster(const RequestPathCluster& cluster) {
-  auto centroid = cluster.centroid();
-  if (depth_to_centroid_indices_.find(centroid.depth()) == depth_to_centroid_indices_.end()) {
-    depth_to_centroid_indices_.emplace(centroid.depth(), std::vector<int64_t>());
+int64_t RequestPathClusterIndex::FindClosest(const RequestPath& request_path,
+                                             int64_t min_matches) const {
+  auto it = depth_to_root_.find(request_path.depth());
+  if (it == depth_to_root_.end()) {
+    return -1;
   }
-  depth_to_centroid_indices_[centroid.depth()].push_back(clusters_.size());
-  clusters_.push_back(cluster);
+  SearchState state{request_path.path_components(), min_matches, -1};
+  Search(it->second, 0, 0, &state);
+  return state.best_index;
+}
+
+int64_t RequestPathClustering::MinMatches(int64_t depth) const {
+  // A cluster needs a similarity of at least thresh_, and always at least one matching component.
+  return std::max<int64_t>(1, static_cast<int64_t>(std::ceil(thresh_ * depth)));
+}
+
+void RequestPathClustering::AddNewCluster(RequestPathCluster cluster) {
+  index_.Insert(cluster.centroid(), clusters_.size());
+  clusters_.push_back(std::move(cluster));
 }
 
 void RequestPathClustering::MergeCluster(int64_t cluster_index,
                                          const RequestPathCluster& other_cluster) {
-  clusters_[cluster_index].Merge(other_cluster);
+  auto& cluster = clusters_[cluster_index];
+  auto old_centroid = cluster.centroid();
+  cluster.Merge(other_cluster);
+  if (!(cluster.centroid() == old_centroid)) {
+    index_.Remove(old_centroid, cluster_index);
+    index_.Insert(cluster.centroid(), cluster_index);
+  }
+}
+
+void RequestPathClustering::Reindex() {
+  index_.Clear();
+  for (const auto& [cluster_idx, cluster] : Enumerate(clusters_)) {
+    index_.Insert(cluster.centroid(), cluster_idx);
+  }
 }
 
 StatusOr<RequestPathClustering> RequestPathClustering::FromJSON(const std::string& json) {
@@ -255,7 +392,7 @@ StatusOr<RequestPathClustering> RequestPathClustering::FromJSON(const std::strin
   for (rapidjson::Value::ConstValueIterator itr = d.Begin(); itr != d.End(); ++itr) {
     const rapidjson::Value& val = *itr;
     PX_ASSIGN_OR_RETURN(auto cluster, RequestPathCluster::FromJSON(val));
-    clustering.AddNewCluster(cluster);
+    clustering.AddNewCluster(std::move(cluster));
   }
   return clustering;
 }
@@ -271,9 +408,171 @@ std::string RequestPathClustering::ToJSON() const {
   return sb.GetString();
 }
 
+namespace {
+
+/**
+ * The binary format of a serialized RequestPathClustering is:
+ *   version byte
+ *   varint number of distinct path components, followed by each one as varint length + bytes
+ *   varint number of clusters, followed by each cluster as its centroid, a varint number of
+ *   members and then each member.
+ * Each request path is written as a varint depth followed by that many varint path component ids,
+ * which index into the path component dictionary at the start.
+ */
+void AppendVarint(uint64_t val, std::string* out) {
+  while (val >= 0x80) {
+    out->push_back(static_cast<char>((val & 0x7f) | 0x80));
+    val >>= 7;
+  }
+  out->push_back(static_cast<char>(val));
+}
+
+class PathComponentEncoder {
+ public:
+  void AppendRequestPath(const RequestPath& request_path, std::string* out) {
+    AppendVarint(request_path.depth(), out);
+    for (const auto& path_component : request_path.path_components()) {
+      auto [it, inserted] = ids_.try_emplace(path_component, dictionary_.size());
+      if (inserted) {
+        dictionary_.push_back(path_component);
+      }
+      AppendVarint(it->second, out);
+    }
+  }
+
+  void AppendDictionary(std::string* out) const {
+    AppendVarint(dictionary_.size(), out);
+    for (const auto& path_component : dictionary_) {
+      AppendVarint(path_component.size(), out);
+      out->append(path_component);
+    }
+  }
+
+ private:
+  absl::flat_hash_map<std::string_view, uint64_t> ids_;
+  std::vector<std::string_view> dictionary_;
+};
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(std::string_view buf) : buf_(buf) {}
+
+  StatusOr<uint64_t> ReadVarint() {
+    uint64_t val = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= buf_.size()) {
+        return error::InvalidArgument("RequestPathClustering::Deserialize: truncated varint");
+      }
+      uint8_t byte = buf_[pos_++];
+      val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return val;
+      }
+    }
+    return error::InvalidArgument("RequestPathClustering::Deserialize: varint too long");
+  }
+
+  // Reads a count of items that each take at least one more byte, so that corrupted counts are
+  // caught before anything is allocated for them.
+  StatusOr<uint64_t> ReadCount() {
+    PX_ASSIGN_OR_RETURN(uint64_t count, ReadVarint());
+    if (count > remaining()) {
+      return error::InvalidArgument("RequestPathClustering::Deserialize: invalid count $0", count);
+    }
+    return count;
+  }
+
+  StatusOr<std::string_view> ReadBytes(uint64_t len) {
+    if (len > remaining()) {
+      return error::InvalidArgument("RequestPathClustering::Deserialize: truncated string");
+    }
+    auto bytes = buf_.substr(pos_, len);
+    pos_ += len;
+    return bytes;
+  }
+
+  StatusOr<RequestPath> ReadRequestPath(const std::vector<std::string_view>& dictionary) {
+    PX_ASSIGN_OR_RETURN(uint64_t depth, ReadCount());
+    std::vector<std::string> path_components;
+    path_components.reserve(depth);
+    for (uint64_t i = 0; i < depth; ++i) {
+      PX_ASSIGN_OR_RETURN(uint64_t id, ReadVarint());
+      if (id >= dictionary.size()) {
+        return error::InvalidArgument(
+            "RequestPathClustering::Deserialize: path component id $0 out of range", id);
+      }
+      path_components.emplace_back(dictionary[id]);
+    }
+    return RequestPath::FromPathComponents(std::move(path_components));
+  }
+
+  size_t remaining() const { return buf_.size() - pos_; }
+
+ private:
+  std::string_view buf_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+std::string RequestPathClustering::Serialize() const {
+  PathComponentEncoder encoder;
+  std::string clusters_buf;
+  AppendVarint(clusters_.size(), &clusters_buf);
+  for (const auto& cluster : clusters_) {
+    encoder.AppendRequestPath(cluster.centroid(), &clusters_buf);
+    AppendVarint(cluster.members().size(), &clusters_buf);
+    for (const auto& member : cluster.members()) {
+      encoder.AppendRequestPath(member, &clusters_buf);
+    }
+  }
+
+  std::string out(1, kBinaryFormatVersion);
+  encoder.AppendDictionary(&out);
+  out.append(clusters_buf);
+  return out;
+}
+
+StatusOr<RequestPathClustering> RequestPathClustering::Deserialize(std::string_view data) {
+  if (!data.empty() && data.front() == '[') {
+    // Clusterings serialized before the binary format was introduced.
+    return FromJSON(std::string(data));
+  }
+  if (data.empty() || data.front() != kBinaryFormatVersion) {
+    return error::InvalidArgument("RequestPathClustering::Deserialize: unknown format");
+  }
+
+  BinaryReader reader(data.substr(1));
+  PX_ASSIGN_OR_RETURN(uint64_t dictionary_size, reader.ReadCount());
+  std::vector<std::string_view> dictionary;
+  dictionary.reserve(dictionary_size);
+  for (uint64_t i = 0; i < dictionary_size; ++i) {
+    PX_ASSIGN_OR_RETURN(uint64_t len, reader.ReadVarint());
+    PX_ASSIGN_OR_RETURN(auto path_component, reader.ReadBytes(len));
+    dictionary.push_back(path_component);
+  }
+
+  RequestPathClustering clustering;
+  PX_ASSIGN_OR_RETURN(uint64_t num_clusters, reader.ReadCount());
+  clustering.clusters_.reserve(num_clusters);
+  for (uint64_t i = 0; i < num_clusters; ++i) {
+    RequestPathCluster cluster;
+    PX_ASSIGN_OR_RETURN(cluster.centroid_, reader.ReadRequestPath(dictionary));
+    PX_ASSIGN_OR_RETURN(uint64_t num_members, reader.ReadCount());
+    for (uint64_t j = 0; j < num_members; ++j) {
+      PX_ASSIGN_OR_RETURN(auto member, reader.ReadRequestPath(dictionary));
+      cluster.members_.insert(std::move(member));
+    }
+    clustering.AddNewCluster(std::move(cluster));
+  }
+  if (reader.remaining() != 0) {
+    return error::InvalidArgument("RequestPathClustering::Deserialize: trailing bytes");
+  }
+  return clustering;
+}
+
 const RequestPath& RequestPathClustering::Predict(const RequestPath& request_path) {
-  int64_t closest_cluster_index;
-  MaxSimilarity(request_path, &closest_cluster_index);
+  auto closest_cluster_index = index_.FindClosest(request_path, 1);
   if (closest_cluster_index == -1) {
     DCHECK(false) << absl::Substitute("Failed to find cluster close to request path $0",
                                       request_path.ToString());
@@ -283,9 +582,9 @@ const RequestPath& RequestPathClustering::Predict(const RequestPath& request_pat
 }
 
 void RequestPathClustering::Update(const RequestPathCluster& new_cluster) {
-  int64_t closest_cluster_index;
-  auto similarity = MaxSimilarity(new_cluster.centroid(), &closest_cluster_index);
-  if (closest_cluster_index == -1 || similarity < thresh_) {
+  auto closest_cluster_index =
+      index_.FindClosest(new_cluster.centroid(), MinMatches(new_cluster.centroid().depth()));
+  if (closest_cluster_index == -1) {
     AddNewCluster(new_cluster);
   } else {
     MergeCluster(closest_cluster_index, new_cluster);
@@ -293,34 +592,32 @@ void RequestPathClustering::Update(const RequestPathCluster& new_cluster) {
 }
 
 void RequestPathClustering::Merge(const RequestPathClustering& other_clustering) {
-  std::vector<RequestPathCluster> new_clusters;
+  // Keep the fully formed clusters in place and split the rest into their members. The index only
+  // needs to be rebuilt if any cluster was split, since that shifts the remaining cluster indices.
   std::vector<RequestPathCluster> singleton_clusters;
-  for (const auto& cluster : clusters_) {
+  size_t num_formed = 0;
+  for (auto& cluster : clusters_) {
     if (cluster.members().size() == 0) {
-      new_clusters.push_back(cluster);
-    } else {
-      for (auto request_path : cluster.members()) {
-        singleton_clusters.push_back(RequestPathCluster(request_path));
+      if (&clusters_[num_formed] != &cluster) {
+        clusters_[num_formed] = std::move(cluster);
       }
+      ++num_formed;
+      continue;
     }
-  }
-
-  clusters_ = new_clusters;
-  // Rebuild depth_to_cluster_indices mapping.
-  depth_to_centroid_indices_.clear();
-  for (const auto& [cluster_idx, cluster] : Enumerate(clusters_)) {
-    auto depth = cluster.centroid().depth();
-    if (depth_to_centroid_indices_.find(depth) == depth_to_centroid_indices_.end()) {
-      depth_to_centroid_indices_.emplace(depth, std::vector<int64_t>());
+    for (const auto& request_path : cluster.members()) {
+      singleton_clusters.push_back(RequestPathCluster(request_path));
     }
-    depth_to_centroid_indices_[depth].push_back(cluster_idx);
+  }
+  if (num_formed != clusters_.size()) {
+    clusters_.erase(clusters_.begin() + num_formed, clusters_.end());
+    Reindex();
   }
 
   for (const auto& cluster : other_clustering.clusters_) {
     if (cluster.members().size() == 0) {
       Update(cluster);
     } else {
-      for (auto request_path : cluster.members()) {
+      for (const auto& request_path : cluster.members()) {
         singleton_clusters.push_back(RequestPathCluster(request_path));
       }
     }
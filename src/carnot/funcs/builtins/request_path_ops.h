@@ -20,6 +20,7 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -93,6 +94,7 @@ class RequestPath {
   void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const;
   static StatusOr<RequestPath> FromJSON(std::string serialized_request_path);
   static StatusOr<RequestPath> FromJSON(const rapidjson::Document::ValueType& doc);
+  static RequestPath FromPathComponents(std::vector<std::string> path_components);
 
   int64_t depth() const { return path_components_.size(); }
   const std::vector<std::string>& path_components() const { return path_components_; }
@@ -164,6 +166,7 @@ class RequestPathCluster {
   const absl::flat_hash_set<RequestPath>& members() const { return members_; }
 
  private:
+  friend class RequestPathClustering;
   void MergeCentroids(const RequestPath& other_centroid);
   void MergeMembers(const absl::flat_hash_set<RequestPath>& other_members);
 
@@ -174,12 +177,76 @@ class RequestPathCluster {
   absl::flat_hash_set<RequestPath> members_;
 };
 
+/**
+ * Index over cluster centroids, used to find the closest cluster to a request path without
+ * comparing against every cluster. Centroids are stored in a trie of path components, with one trie
+ * per depth since only request paths of the same depth are compared. Centroid components equal to
+ * RequestPath::kAnyToken live under a dedicated wildcard child of each node.
+ *
+ * A lookup follows the request path's own component and the wildcard child at each level, which
+ * finds any centroid the request path matches in O(depth). Children that disagree with the request
+ * path are only visited while they could still beat the best match found so far, so the result is
+ * the same as taking the max of RequestPath::Similarity over all centroids.
+ */
+class RequestPathClusterIndex {
+ public:
+  void Insert(const RequestPath& centroid, int64_t cluster_index);
+  void Remove(const RequestPath& centroid, int64_t cluster_index);
+  void Clear();
+
+  /**
+   * Finds the cluster whose centroid agrees with the request path on the most path components.
+   * Ties are broken towards the lowest cluster index.
+   * @param request_path the request path to look up.
+   * @param min_matches the minimum number of agreeing path components for a cluster to be returned.
+   * @return the index of the closest cluster, or -1 if no cluster agrees on at least min_matches
+   * path components.
+   */
+  int64_t FindClosest(const RequestPath& request_path, int64_t min_matches) const;
+
+ private:
+  struct Node {
+    absl::flat_hash_map<std::string, int32_t> children;
+    int32_t wildcard_child = -1;
+    // Only set on leaves, ie. at depth equal to the centroid depth.
+    std::vector<int64_t> cluster_indices;
+    // Lower bound on the cluster indices stored under this node. It is not raised on Remove, which
+    // only makes it a looser bound.
+    int64_t min_cluster_index = std::numeric_limits<int64_t>::max();
+  };
+
+  struct SearchState {
+    const std::vector<std::string>& path_components;
+    int64_t best_matches;
+    int64_t best_index;
+  };
+
+  int32_t FindChild(int32_t node_id, const std::string& path_component) const;
+  int32_t FindOrAddChild(int32_t node_id, const std::string& path_component);
+  bool CanImprove(const Node& node, int64_t max_matches, const SearchState& state) const;
+  void Search(int32_t node_id, size_t level, int64_t matches, SearchState* state) const;
+
+  absl::flat_hash_map<int64_t, int32_t> depth_to_root_;
+  std::vector<Node> nodes_;
+};
+
 class RequestPathClustering {
  public:
   static StatusOr<RequestPathClustering> FromJSON(const std::string& json);
 
   std::string ToJSON() const;
 
+  /**
+   * Serializes the clustering into a compact binary format. Path components are dictionary
+   * encoded, since they are heavily repeated across centroids and members.
+   */
+  std::string Serialize() const;
+
+  /**
+   * Deserializes a clustering produced by either Serialize or ToJSON.
+   */
+  static StatusOr<RequestPathClustering> Deserialize(std::string_view data);
+
   /**
    * @param request_path request path to get prediction for.
    * @return the centroid of the cluster closest to the given request path.
@@ -193,16 +260,24 @@ class RequestPathClustering {
    */
   void Update(const RequestPathCluster& new_cluster);
 
+  /**
+   * Merges another clustering into this one. Clusters of either clustering that haven't reached
+   * their minimum cardinality are split back into their members, which are refit once the fully
+   * formed clusters have been merged.
+   */
   void Merge(const RequestPathClustering& other_clustering);
 
   const std::vector<RequestPathCluster>& clusters() const { return clusters_; }
 
  private:
-  double MaxSimilarity(const RequestPath& request_path, int64_t* max_index) const;
-  void AddNewCluster(const RequestPathCluster& cluster);
+  int64_t MinMatches(int64_t depth) const;
+  void AddNewCluster(RequestPathCluster cluster);
   void MergeCluster(int64_t cluster_index, const RequestPathCluster& other_cluster);
+  void Reindex();
+
+  inline static constexpr char kBinaryFormatVersion = 0x01;
   // We currently only allow request path's with the same depth to be clustered together.
-  absl::flat_hash_map<int64_t, std::vector<int64_t>> depth_to_centroid_indices_;
+  RequestPathClusterIndex index_;
   std::vector<RequestPathCluster> clusters_;
   double thresh_ = 0.5;
 };
@@ -212,7 +287,7 @@ class RequestPathClusteringPredictUDF : public udf::ScalarUDF {
   StringValue Exec(FunctionContext*, StringValue request_path_str,
                    StringValue serialized_clustering) {
     if (!clustering_init_) {
-      auto clustering_or_s = RequestPathClustering::FromJSON(serialized_clustering);
+      auto clustering_or_s = RequestPathClustering::Deserialize(serialized_clustering);
       if (!clustering_or_s.ok()) {
         return clustering_or_s.msg();
       }
@@ -236,12 +311,12 @@ class RequestPathClusteringFitUDA : public udf::UDA {
   void Merge(FunctionContext*, const RequestPathClusteringFitUDA& other) {
     clustering_.Merge(other.clustering_);
   }
-  StringValue Finalize(FunctionContext*) { return clustering_.ToJSON(); }
+  StringValue Finalize(FunctionContext*) { return clustering_.Serialize(); }
 
-  StringValue Serialize(FunctionContext*) { return clustering_.ToJSON(); }
+  StringValue Serialize(FunctionContext*) { return clustering_.Serialize(); }
 
   Status Deserialize(FunctionContext*, const StringValue& data) {
-    PX_ASSIGN_OR_RETURN(clustering_, RequestPathClustering::FromJSON(data));
+    PX_ASSIGN_OR_RETURN(clustering_, RequestPathClustering::Deserialize(data));
     return Status::OK();
   }
 
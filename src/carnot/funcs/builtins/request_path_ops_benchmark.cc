@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <benchmark/benchmark.h>
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/request_path_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Request paths for a service with `num_endpoints` distinct endpoints, each of which is hit with a
+// handful of different ids.
+static std::vector<RequestPath> MakeRequestPaths(int64_t num_endpoints) {
+  std::vector<RequestPath> request_paths;
+  for (int64_t i = 0; i < num_endpoints; ++i) {
+    for (int64_t j = 0; j < 8; ++j) {
+      request_paths.emplace_back(absl::Substitute("/api/v1/resource$0/$1/details", i, j));
+    }
+  }
+  return request_paths;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringFit(benchmark::State& state) {
+  auto request_paths = MakeRequestPaths(state.range(0));
+  for (auto _ : state) {
+    RequestPathClustering clustering;
+    for (const auto& request_path : request_paths) {
+      clustering.Update(RequestPathCluster(request_path));
+    }
+    benchmark::DoNotOptimize(clustering);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(request_paths.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringPredict(benchmark::State& state) {
+  auto request_paths = MakeRequestPaths(state.range(0));
+  RequestPathClustering clustering;
+  for (const auto& request_path : request_paths) {
+    clustering.Update(RequestPathCluster(request_path));
+  }
+  for (auto _ : state) {
+    for (const auto& request_path : request_paths) {
+      benchmark::DoNotOptimize(clustering.Predict(request_path));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(request_paths.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringDeserialize(benchmark::State& state) {
+  RequestPathClustering clustering;
+  for (const auto& request_path : MakeRequestPaths(state.range(0))) {
+    clustering.Update(RequestPathCluster(request_path));
+  }
+  auto serialized = clustering.Serialize();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(RequestPathClustering::Deserialize(serialized));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(serialized.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RequestPathClusteringFit)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_RequestPathClusteringPredict)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_RequestPathClusteringDeserialize)->RangeMultiplier(8)->Range(8, 4096);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "src/carnot/funcs/builtins/request_path_ops.h"
@@ -49,7 +50,7 @@ TEST(RequestPathClusteringFit, basic) {
                                    .ForInput("/a/b/e")
                                    .ForInput("a/b/f")
                                    .Result();
-  auto clustering_or_s = RequestPathClustering::FromJSON(serialized_clustering);
+  auto clustering_or_s = RequestPathClustering::Deserialize(serialized_clustering);
   ASSERT_OK(clustering_or_s);
   auto clustering = clustering_or_s.ConsumeValueOrDie();
   ASSERT_EQ(1, clustering.clusters().size());
@@ -61,7 +62,7 @@ TEST(RequestPathClusteringFit, basic_low_cardinality) {
   auto uda_tester = udf::UDATester<RequestPathClusteringFitUDA>();
 
   auto serialized_clustering = uda_tester.ForInput("/a/b/d").ForInput("/a/b/c").Result();
-  auto clustering_or_s = RequestPathClustering::FromJSON(serialized_clustering);
+  auto clustering_or_s = RequestPathClustering::Deserialize(serialized_clustering);
   ASSERT_OK(clustering_or_s);
   auto clustering = clustering_or_s.ConsumeValueOrDie();
   ASSERT_EQ(1, clustering.clusters().size());
@@ -90,6 +91,67 @@ TEST(RequestPathClusteringPredict, basic_low_cardinality) {
   udf_tester.ForInput("/a/b/c", serialized_clustering).Expect("/a/b/c");
 }
 
+TEST(RequestPathClusteringPredict, many_endpoints) {
+  RequestPathClustering clustering;
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 6; ++j) {
+      clustering.Update(RequestPathCluster(RequestPath(absl::Substitute("/svc$0/items/$1", i, j))));
+    }
+  }
+  ASSERT_EQ(100, clustering.clusters().size());
+  EXPECT_EQ("/svc42/items/*", clustering.Predict(RequestPath("/svc42/items/3")).ToString());
+  EXPECT_EQ("/svc42/items/*", clustering.Predict(RequestPath("/svc42/items/abc")).ToString());
+  EXPECT_EQ("/svc7/items/*", clustering.Predict(RequestPath("/svc7/other/1")).ToString());
+}
+
+TEST(RequestPathClusterIndex, find_closest_matches_similarity) {
+  std::vector<RequestPath> centroids({RequestPath("/a/b/c"), RequestPath("/a/*/*"),
+                                      RequestPath("/a/b/x"), RequestPath("/*/b/c"),
+                                      RequestPath("/x/y/z"), RequestPath("/a/b")});
+  RequestPathClusterIndex index;
+  for (const auto& [i, centroid] : Enumerate(centroids)) {
+    index.Insert(centroid, i);
+  }
+  // Exact match.
+  EXPECT_EQ(0, index.FindClosest(RequestPath("/a/b/c"), 1));
+  // /a/b/x agrees on more components than /a/*/*, even though only the latter matches.
+  EXPECT_EQ(2, index.FindClosest(RequestPath("/a/c/x"), 1));
+  // Ties go to the lowest cluster index.
+  EXPECT_EQ(0, index.FindClosest(RequestPath("/z/b/c"), 1));
+  EXPECT_EQ(-1, index.FindClosest(RequestPath("/q/r/s"), 1));
+  EXPECT_EQ(-1, index.FindClosest(RequestPath("/x/r/s"), 2));
+  EXPECT_EQ(5, index.FindClosest(RequestPath("/a/c"), 1));
+
+  index.Remove(centroids[0], 0);
+  EXPECT_EQ(2, index.FindClosest(RequestPath("/a/b/c"), 1));
+  centroids[0] = RequestPath("/a/b/*");
+  index.Insert(centroids[0], 0);
+  EXPECT_EQ(0, index.FindClosest(RequestPath("/a/b/d"), 1));
+}
+
+TEST(RequestPathClustering, serialization) {
+  RequestPathClustering clustering;
+  for (const auto& request_path :
+       {"/a/b/a", "/a/b/b", "/a/b/c", "/a/b/d", "/a/b/e", "/a/b/f", "/x/y", "/x/z"}) {
+    clustering.Update(RequestPathCluster(RequestPath(request_path)));
+  }
+  auto serialized = clustering.Serialize();
+  EXPECT_LT(serialized.size(), clustering.ToJSON().size());
+
+  ASSERT_OK_AND_ASSIGN(auto deserialized, RequestPathClustering::Deserialize(serialized));
+  EXPECT_THAT(deserialized, HasCentroids(std::vector<std::string>({"/a/b/*", "/x/y", "/x/z"})));
+  EXPECT_EQ("/a/b/*", deserialized.Predict(RequestPath("/a/b/g")).ToString());
+  EXPECT_EQ("/x/z", deserialized.Predict(RequestPath("/x/z")).ToString());
+
+  // Clusterings serialized as JSON are still accepted.
+  ASSERT_OK_AND_ASSIGN(auto from_json, RequestPathClustering::Deserialize(clustering.ToJSON()));
+  EXPECT_THAT(from_json, HasCentroids(std::vector<std::string>({"/a/b/*", "/x/y", "/x/z"})));
+
+  EXPECT_NOT_OK(RequestPathClustering::Deserialize(""));
+  EXPECT_NOT_OK(RequestPathClustering::Deserialize("not a clustering"));
+  EXPECT_NOT_OK(RequestPathClustering::Deserialize(serialized.substr(0, serialized.size() - 1)));
+}
+
 TEST(RequestPathEndpointMatcher, basic) {
   auto udf_tester = udf::UDFTester<RequestPathEndpointMatcherUDF>();
   udf_tester.ForInput("/a/b/c", "/a/b/*").Expect(true);
@@ -121,10 +183,10 @@ TEST(RequestPathClusteringFit, merging_clusters) {
   // Check that merging works in either order.
   auto serialized_clustering1 = uda_tester1.Merge(&uda_tester2).Result();
   auto serialized_clustering2 = uda_tester2.Merge(&uda_tester1).Result();
-  auto clustering1_or_s = RequestPathClustering::FromJSON(serialized_clustering1);
+  auto clustering1_or_s = RequestPathClustering::Deserialize(serialized_clustering1);
   ASSERT_OK(clustering1_or_s);
   auto clustering1 = clustering1_or_s.ConsumeValueOrDie();
-  auto clustering2_or_s = RequestPathClustering::FromJSON(serialized_clustering2);
+  auto clustering2_or_s = RequestPathClustering::Deserialize(serialized_clustering2);
   ASSERT_OK(clustering2_or_s);
   auto clustering2 = clustering2_or_s.ConsumeValueOrDie();
 
@@ -185,7 +247,7 @@ TEST(RequestPathClusteringFit, merging_clusters_complicated) {
       merged.Merge(&pems[idx]);
     }
     auto serialized_clustering = merged.Result();
-    auto clustering_or_s = RequestPathClustering::FromJSON(serialized_clustering);
+    auto clustering_or_s = RequestPathClustering::Deserialize(serialized_clustering);
     ASSERT_OK(clustering_or_s);
     auto clustering = clustering_or_s.ConsumeValueOrDie();
     EXPECT_THAT(clustering, HasCentroids(expected_centroids));
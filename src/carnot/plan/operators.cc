@@ -75,6 +75,8 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<FilterOperator>(id, pb.filter_op());
     case planpb::LIMIT_OPERATOR:
       return CreateOperator<LimitOperator>(id, pb.limit_op());
+    case planpb::SORT_OPERATOR:
+      return CreateOperator<SortOperator>(id, pb.sort_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
@@ -454,6 +456,73 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * Sort Operator Implementation.
+ */
+std::string SortOperator::DebugString() const {
+  std::vector<std::string> sort_cols;
+  for (size_t i = 0; i < sort_cols_.size(); ++i) {
+    sort_cols.push_back(absl::Substitute("$0 $1", sort_cols_[i], ascending_[i] ? "asc" : "desc"));
+  }
+  return absl::Substitute("Op:Sort(by: [$0], limit: $1, cols: [$2])",
+                          absl::StrJoin(sort_cols, ","), limit_,
+                          absl::StrJoin(selected_cols_, ","));
+}
+
+Status SortOperator::Init(const planpb::SortOperator& pb) {
+  pb_ = pb;
+  limit_ = pb_.limit();
+
+  sort_cols_.reserve(pb_.sort_columns_size());
+  ascending_.reserve(pb_.sort_columns_size());
+  for (const auto& sort_col : pb_.sort_columns()) {
+    sort_cols_.push_back(sort_col.column().index());
+    ascending_.push_back(sort_col.ascending());
+  }
+
+  selected_cols_.reserve(pb_.columns_size());
+  for (auto i = 0; i < pb_.columns_size(); ++i) {
+    selected_cols_.push_back(pb_.columns(i).index());
+  }
+
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> SortOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("Sort operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of SortOperator", input_ids[0]);
+  }
+
+  PX_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  for (auto sort_col_idx : sort_cols_) {
+    if (sort_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument("Sort column index $0 is out of bounds, number of columns is $1",
+                                    sort_col_idx, input_relation.NumColumns());
+    }
+  }
+
+  table_store::schema::Relation output_relation;
+  for (auto selected_col_idx : selected_cols_) {
+    if (selected_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument("Column index $0 is out of bounds, number of columns is $1",
+                                    selected_col_idx, input_relation.NumColumns());
+    }
+    output_relation.AddColumn(input_relation.GetColumnType(selected_col_idx),
+                              input_relation.GetColumnName(selected_col_idx),
+                              input_relation.GetColumnDesc(selected_col_idx));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
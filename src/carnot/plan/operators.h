@@ -146,6 +146,10 @@ class AggregateOperator : public Operator {
   bool windowed() const { return pb_.windowed(); }
   bool partial_agg() const { return pb_.partial_agg(); }
   bool finalize_results() const { return pb_.finalize_results(); }
+  bool has_streaming_window() const { return pb_.has_streaming_window(); }
+  const planpb::AggregateOperator::StreamingWindow& streaming_window() const {
+    return pb_.streaming_window();
+  }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -231,7 +235,7 @@ class FilterOperator : public Operator {
       const std::vector<int64_t>& input_ids) const override;
   Status Init(const planpb::FilterOperator& pb);
   std::string DebugString() const override;
-  std::vector<int64_t> selected_cols() { return selected_cols_; }
+  std::vector<int64_t> selected_cols() const { return selected_cols_; }
 
   const std::shared_ptr<const ScalarExpression>& expression() const { return expression_; }
 
@@ -264,6 +268,32 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class SortOperator : public Operator {
+ public:
+  explicit SortOperator(int64_t id) : Operator(id, planpb::SORT_OPERATOR) {}
+  ~SortOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::SortOperator& pb);
+  std::string DebugString() const override;
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+
+  // The input column indexes to sort by, from most to least significant.
+  const std::vector<int64_t>& sort_cols() const { return sort_cols_; }
+  const std::vector<bool>& ascending() const { return ascending_; }
+  // The number of rows to produce, or 0 if every row should be produced.
+  int64_t limit() const { return limit_; }
+
+ private:
+  std::vector<int64_t> sort_cols_;
+  std::vector<bool> ascending_;
+  std::vector<int64_t> selected_cols_;
+  int64_t limit_ = 0;
+  planpb::SortOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
@@ -315,6 +345,7 @@ class JoinOperator : public Operator {
   }
   std::vector<planpb::JoinOperator::ParentColumn> output_columns() const { return output_columns_; }
   size_t rows_per_batch() const { return pb_.rows_per_batch(); }
+  planpb::JoinOperator::BuildSide build_side() const { return pb_.build_side(); }
 
   bool order_by_time() const;
   planpb::JoinOperator::ParentColumn time_column() const;
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/convert_rolling_agg_rule.h"
+#include "src/carnot/planner/ir/func_ir.h"
+#include "src/carnot/planner/ir/int_ir.h"
+#include "src/carnot/planner/ir/map_ir.h"
+
+DEFINE_int64(planner_rolling_allowed_lateness_ms,
+             gflags::Int64FromEnv("PL_PLANNER_ROLLING_ALLOWED_LATENESS_MS", 5000),
+             "How long a rolling window aggregate waits for out of order rows after it has seen "
+             "a row past the end of a window, before it emits that window.");
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<bool> ConvertRollingAggRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, OperatorWithParent(BlockingAgg(), Rolling()))) {
+    return false;
+  }
+  auto agg = static_cast<BlockingAggIR*>(ir_node);
+  return ConvertRollingAgg(static_cast<RollingIR*>(agg->parents()[0]), agg);
+}
+
+StatusOr<bool> ConvertRollingAggRule::ConvertRollingAgg(RollingIR* rolling, BlockingAggIR* agg) {
+  IR* graph = agg->graph();
+  DCHECK_EQ(rolling->parents().size(), 1UL);
+  OperatorIR* rolling_parent = rolling->parents()[0];
+  std::string window_col_name = rolling->window_col()->col_name();
+
+  // Replace the window column with the start of the window of each row.
+  PX_ASSIGN_OR_RETURN(ColumnIR * window_col,
+                      graph->CreateNode<ColumnIR>(rolling->ast(), window_col_name,
+                                                  /* parent_op_idx */ 0));
+  PX_ASSIGN_OR_RETURN(IntIR * window_size,
+                      graph->CreateNode<IntIR>(rolling->ast(), rolling->window_size()));
+  FuncIR::Op bin_op{FuncIR::Opcode::non_op, "", "bin"};
+  PX_ASSIGN_OR_RETURN(FuncIR * bin,
+                      graph->CreateNode<FuncIR>(rolling->ast(), bin_op,
+                                                std::vector<ExpressionIR*>{window_col, window_size}));
+  PX_ASSIGN_OR_RETURN(MapIR * map,
+                      graph->CreateNode<MapIR>(rolling->ast(), rolling_parent,
+                                               ColExpressionVector{{window_col_name, bin}},
+                                               /* keep_input_columns */ true));
+
+  // The window goes first, then the groups of the rolling and those of the aggregate.
+  PX_ASSIGN_OR_RETURN(ColumnIR * window_group,
+                      graph->CreateNode<ColumnIR>(rolling->ast(), window_col_name,
+                                                  /* parent_op_idx */ 0));
+  std::vector<ColumnIR*> groups{window_group};
+  for (const std::vector<ColumnIR*>& acceptor_groups : {rolling->groups(), agg->groups()}) {
+    for (ColumnIR* group : acceptor_groups) {
+      if (group->col_name() == window_col_name) {
+        continue;
+      }
+      PX_ASSIGN_OR_RETURN(ColumnIR * new_group,
+                          graph->CreateNode<ColumnIR>(group->ast(), group->col_name(),
+                                                      /* parent_op_idx */ 0));
+      groups.push_back(new_group);
+    }
+  }
+  PX_RETURN_IF_ERROR(agg->SetGroups(groups));
+  PX_RETURN_IF_ERROR(agg->ReplaceParent(rolling, map));
+  agg->SetStreamingWindow(window_col_name, rolling->window_size(),
+                          FLAGS_planner_rolling_allowed_lateness_ms * 1000 * 1000);
+
+  // A groupby after the rolling was merged into the aggregate, and has nothing left to feed.
+  for (OperatorIR* child : rolling->Children()) {
+    if (Match(child, GroupBy()) && child->Children().empty()) {
+      PX_RETURN_IF_ERROR(child->RemoveParent(rolling));
+      PX_RETURN_IF_ERROR(graph->DeleteSubtree(child->id()));
+    }
+  }
+  if (rolling->Children().empty()) {
+    PX_RETURN_IF_ERROR(rolling->RemoveParent(rolling_parent));
+    PX_RETURN_IF_ERROR(graph->DeleteSubtree(rolling->id()));
+  }
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
+#include "src/carnot/planner/ir/rolling_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+DECLARE_int64(planner_rolling_allowed_lateness_ms);
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief Converts every aggregate that follows a rolling() into a streaming window aggregate.
+ *
+ * A map in front of the aggregate bins the window column to the start of its window, and the
+ * aggregate groups by that column along with the groups of the rolling and of the aggregate.
+ * The rolling node is removed once it has no children left, along with any groupby after it that
+ * was merged into the aggregates.
+ */
+class ConvertRollingAggRule : public Rule {
+ public:
+  ConvertRollingAggRule()
+      : Rule(/*compiler_state*/ nullptr, /*use_topo*/ false,
+             /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  StatusOr<bool> ConvertRollingAgg(RollingIR* rolling, BlockingAggIR* agg);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
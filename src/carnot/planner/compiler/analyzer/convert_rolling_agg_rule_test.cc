@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/analyzer/convert_rolling_agg_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+#include "src/carnot/planner/ir/map_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using ::testing::ElementsAre;
+
+TEST_F(RulesTest, convert_rolling_agg) {
+  PX_SET_FOR_SCOPE(FLAGS_planner_rolling_allowed_lateness_ms, 2);
+  MemorySourceIR* mem_src = MakeMemSource();
+  RollingIR* rolling = MakeRolling(mem_src, MakeColumn("time_", 0), 1000);
+  BlockingAggIR* agg = MakeBlockingAgg(rolling, {MakeColumn("col1", 0)},
+                                       {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MemorySinkIR* sink = MakeMemSink(agg, "");
+  auto rolling_id = rolling->id();
+
+  ConvertRollingAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(graph->dag().HasNode(rolling_id));
+
+  // The window column is binned to the window size before the aggregate.
+  ASSERT_EQ(mem_src->Children().size(), 1);
+  ASSERT_MATCH(mem_src->Children()[0], Map());
+  auto map = static_cast<MapIR*>(mem_src->Children()[0]);
+  EXPECT_TRUE(map->keep_input_columns());
+  ASSERT_EQ(map->col_exprs().size(), 1);
+  EXPECT_EQ(map->col_exprs()[0].name, "time_");
+  ASSERT_MATCH(map->col_exprs()[0].node, Func());
+  auto bin = static_cast<FuncIR*>(map->col_exprs()[0].node);
+  EXPECT_EQ(bin->func_name(), "bin");
+  ASSERT_EQ(bin->all_args().size(), 2);
+  EXPECT_MATCH(bin->all_args()[0], ColumnNode("time_"));
+  EXPECT_MATCH(bin->all_args()[1], Int(1000));
+
+  EXPECT_THAT(agg->parents(), ElementsAre(map));
+  EXPECT_THAT(sink->parents(), ElementsAre(agg));
+  ASSERT_EQ(agg->groups().size(), 2);
+  EXPECT_MATCH(agg->groups()[0], ColumnNode("time_"));
+  EXPECT_MATCH(agg->groups()[1], ColumnNode("col1"));
+  EXPECT_TRUE(agg->has_streaming_window());
+  EXPECT_EQ(agg->window_col(), "time_");
+  EXPECT_EQ(agg->window_size_ns(), 1000);
+  EXPECT_EQ(agg->allowed_lateness_ns(), 2 * 1000 * 1000);
+}
+
+TEST_F(RulesTest, convert_rolling_agg_with_rolling_groups) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  RollingIR* rolling = MakeRolling(mem_src, MakeColumn("time_", 0), 1000);
+  ASSERT_OK(rolling->SetGroups({MakeColumn("col1", 0)}));
+  BlockingAggIR* agg = MakeBlockingAgg(rolling, {MakeColumn("col2", 0)},
+                                       {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MakeMemSink(agg, "");
+
+  ConvertRollingAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  ASSERT_EQ(agg->groups().size(), 3);
+  EXPECT_MATCH(agg->groups()[0], ColumnNode("time_"));
+  EXPECT_MATCH(agg->groups()[1], ColumnNode("col1"));
+  EXPECT_MATCH(agg->groups()[2], ColumnNode("col2"));
+}
+
+TEST_F(RulesTest, convert_rolling_agg_removes_merged_group_by) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  RollingIR* rolling = MakeRolling(mem_src, MakeColumn("time_", 0), 1000);
+  // What is left of rolling().groupby().agg() once the groupby is merged into the aggregate.
+  GroupByIR* group_by = MakeGroupBy(rolling, {MakeColumn("col1", 0)});
+  BlockingAggIR* agg = MakeBlockingAgg(rolling, {MakeColumn("col1", 0)},
+                                       {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MakeMemSink(agg, "");
+  auto rolling_id = rolling->id();
+  auto group_by_id = group_by->id();
+
+  ConvertRollingAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(graph->dag().HasNode(group_by_id));
+  EXPECT_FALSE(graph->dag().HasNode(rolling_id));
+  ASSERT_EQ(mem_src->Children().size(), 1);
+  EXPECT_MATCH(mem_src->Children()[0], Map());
+}
+
+TEST_F(RulesTest, convert_rolling_agg_no_rolling) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  BlockingAggIR* agg = MakeBlockingAgg(mem_src, {MakeColumn("col1", 0)},
+                                       {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MakeMemSink(agg, "");
+
+  ConvertRollingAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_streaming_window());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -19,6 +19,7 @@
 #include <queue>
 
 #include "src/carnot/planner/compiler/analyzer/resolve_stream_rule.h"
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
 #include "src/carnot/planner/ir/stream_ir.h"
 
 namespace px {
@@ -44,7 +45,10 @@ StatusOr<bool> ResolveStreamRule::Apply(IRNode* ir_node) {
     auto node = nodes.front();
     nodes.pop();
 
-    if (node->IsBlocking()) {
+    // Streaming window aggregates emit every window once it is complete, so they can stream.
+    bool streaming_window_agg = Match(node, BlockingAgg()) &&
+                                static_cast<BlockingAggIR*>(node)->has_streaming_window();
+    if (node->IsBlocking() && !streaming_window_agg) {
       return error::Unimplemented("df.stream() not yet supported with the operator $0",
                                   node->DebugString());
     }
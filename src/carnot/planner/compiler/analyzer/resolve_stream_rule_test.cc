@@ -72,6 +72,23 @@ TEST_F(RulesTest, resolve_stream_blocking_ancestor) {
   ASSERT_NOT_OK(rule.Execute(graph.get()));
 }
 
+TEST_F(RulesTest, resolve_stream_streaming_window_agg_ancestor) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  BlockingAggIR* agg =
+      MakeBlockingAgg(mem_source, {MakeColumn("time_", 0), MakeColumn("col1", 0)},
+                      {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  agg->SetStreamingWindow("time_", 1000, 0);
+  StreamIR* stream = graph->CreateNode<StreamIR>(ast, agg).ValueOrDie();
+  MemorySinkIR* sink = MakeMemSink(stream, "");
+
+  ResolveStreamRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_TRUE(mem_source->streaming());
+  EXPECT_THAT(sink->parents(), ElementsAre(agg));
+}
+
 TEST_F(RulesTest, resolve_stream_non_mem_sink_child) {
   MemorySourceIR* mem_source = MakeMemSource();
   GroupByIR* group_by = MakeGroupBy(mem_source, {MakeColumn("col1", 0), MakeColumn("col2", 0)});
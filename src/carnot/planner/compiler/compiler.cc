@@ -72,12 +72,16 @@ StatusOr<std::shared_ptr<IR>> Compiler::CompileToIR(const std::string& query,
 
 Status Compiler::Analyze(IR* ir, CompilerState* compiler_state) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Analyzer> analyzer, Analyzer::Create(compiler_state));
-  return analyzer->Execute(ir);
+  Status s = analyzer->Execute(ir);
+  compiler_state->rule_executor_stats()->MergeFrom(analyzer->stats());
+  return s;
 }
 
 Status Compiler::Optimize(IR* ir, CompilerState* compiler_state) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Optimizer> optimizer, Optimizer::Create(compiler_state));
-  return optimizer->Execute(ir);
+  Status s = optimizer->Execute(ir);
+  compiler_state->rule_executor_stats()->MergeFrom(optimizer->stats());
+  return s;
 }
 
 StatusOr<std::shared_ptr<IR>> Compiler::QueryToIR(const std::string& query,
@@ -2729,6 +2729,37 @@ TEST_F(CompilerTest, RollingNonTimeUnsupported) {
               HasCompilerError("Windowing is only supported on time_ at the moment"));
 }
 
+constexpr char kRollingAggQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_', 'remote_port'])
+t1 = t1.rolling('3s').groupby('remote_port').agg(count=('time_', px.count))
+px.display(t1.stream())
+)pxl";
+TEST_F(CompilerTest, RollingAggQuery) {
+  auto graph_or_s = compiler_.CompileToIR(kRollingAggQuery, compiler_state_.get());
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+
+  EXPECT_EQ(graph->FindNodesOfType(IRNodeType::kRolling).size(), 0);
+  std::vector<IRNode*> agg_nodes = graph->FindNodesOfType(IRNodeType::kBlockingAgg);
+  ASSERT_EQ(agg_nodes.size(), 1);
+  auto agg = static_cast<BlockingAggIR*>(agg_nodes[0]);
+  EXPECT_TRUE(agg->has_streaming_window());
+  EXPECT_EQ(agg->window_size_ns(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds(3)).count());
+  ASSERT_EQ(agg->groups().size(), 2);
+  EXPECT_MATCH(agg->groups()[0], ColumnNode("time_"));
+  EXPECT_MATCH(agg->groups()[1], ColumnNode("remote_port"));
+  ASSERT_MATCH(agg->parents()[0], Map());
+  Relation agg_relation({types::TIME64NS, types::INT64, types::INT64},
+                        {"time_", "remote_port", "count"});
+  EXPECT_THAT(*agg->resolved_table_type(), IsTableType(agg_relation));
+
+  planpb::Operator pb;
+  ASSERT_OK(agg->ToProto(&pb));
+  EXPECT_EQ(pb.agg_op().streaming_window().group_index(), 0);
+}
+
 const char* kFunctionOptimizationQuery = R"pxl(
 import px
 bytes_per_mb = 1024.0 * 1024.0
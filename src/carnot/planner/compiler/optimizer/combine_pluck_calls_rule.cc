@@ -0,0 +1,181 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/combine_pluck_calls_rule.h"
+
+#include <map>
+#include <utility>
+
+#include "src/carnot/planner/ir/column_ir.h"
+#include "src/carnot/planner/ir/int_ir.h"
+#include "src/carnot/planner/ir/string_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+namespace {
+
+// Maps each combinable pluck UDF to the _pluck_multi_at UDF with the same return semantics.
+const absl::flat_hash_map<std::string, std::string>& PluckAtFuncNames() {
+  static const auto* names = new absl::flat_hash_map<std::string, std::string>{
+      {"pluck", "_pluck_multi_at"},
+      {"pluck_int64", "_pluck_multi_at_int64"},
+      {"pluck_float64", "_pluck_multi_at_float64"},
+  };
+  return *names;
+}
+
+bool IsCombinablePluck(ExpressionIR* expr) {
+  if (!Match(expr, Func())) {
+    return false;
+  }
+  auto func = static_cast<FuncIR*>(expr);
+  if (!PluckAtFuncNames().contains(func->func_name()) || func->all_args().size() != 2) {
+    return false;
+  }
+  return Match(func->all_args()[0], ColumnNode()) && Match(func->all_args()[1], String());
+}
+
+}  // namespace
+
+StatusOr<FuncIR*> CombinePluckCallsRule::CreatePluckAtFunc(const PluckCall& pluck,
+                                                           const std::string& packed_col_name,
+                                                           int64_t index) {
+  auto graph = pluck.func->graph();
+  PX_ASSIGN_OR_RETURN(ColumnIR * packed_col,
+                      graph->CreateNode<ColumnIR>(pluck.func->ast(), packed_col_name,
+                                                  /*parent_op_idx*/ 0));
+  PX_ASSIGN_OR_RETURN(IntIR * index_ir, graph->CreateNode<IntIR>(pluck.func->ast(), index));
+  return graph->CreateNode<FuncIR>(
+      pluck.func->ast(),
+      FuncIR::Op{FuncIR::Opcode::non_op, "", PluckAtFuncNames().at(pluck.func->func_name())},
+      std::vector<ExpressionIR*>{packed_col, index_ir});
+}
+
+std::string CombinePluckCallsRule::PackedColumnName(MapIR* map, const std::string& col_name,
+                                                    int64_t chunk_idx) {
+  return absl::Substitute("_pluck_multi_$0_$1_$2", map->id(), col_name, chunk_idx);
+}
+
+StatusOr<bool> CombinePluckCallsRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Map())) {
+    return false;
+  }
+  auto map = static_cast<MapIR*>(ir_node);
+  if (!map->is_type_resolved()) {
+    return false;
+  }
+  DCHECK_EQ(map->parents().size(), 1UL);
+  auto parent = map->parents()[0];
+  auto graph = map->graph();
+
+  // Group the plucks by the column they read, ordered by column name so that the generated plan is
+  // deterministic.
+  std::map<std::string, std::vector<PluckCall>> plucks_by_column;
+  for (const auto& col_expr : map->col_exprs()) {
+    if (!IsCombinablePluck(col_expr.node)) {
+      continue;
+    }
+    auto func = static_cast<FuncIR*>(col_expr.node);
+    auto column = static_cast<ColumnIR*>(func->all_args()[0]);
+    auto key = static_cast<StringIR*>(func->all_args()[1]);
+    plucks_by_column[column->col_name()].push_back({col_expr.name, func, key->str()});
+  }
+
+  ColExpressionVector packed_exprs;
+  std::vector<std::pair<std::string, FuncIR*>> pluck_replacements;
+  for (const auto& [col_name, plucks] : plucks_by_column) {
+    // Deduplicate the keys and split them into chunks of at most kMaxPluckMultiKeys, each of which
+    // becomes one _pluck_multi call.
+    absl::flat_hash_map<std::string, std::pair<int64_t, int64_t>> key_locations;
+    std::vector<std::vector<std::string>> chunks;
+    for (const auto& pluck : plucks) {
+      if (key_locations.contains(pluck.key)) {
+        continue;
+      }
+      if (chunks.empty() || static_cast<int64_t>(chunks.back().size()) == kMaxPluckMultiKeys) {
+        chunks.emplace_back();
+      }
+      key_locations[pluck.key] = {static_cast<int64_t>(chunks.size()) - 1,
+                                  static_cast<int64_t>(chunks.back().size())};
+      chunks.back().push_back(pluck.key);
+    }
+
+    for (const auto& [chunk_idx, keys] : Enumerate(chunks)) {
+      // A chunk with a single key doesn't save any work.
+      if (keys.size() < 2) {
+        continue;
+      }
+      PX_ASSIGN_OR_RETURN(ColumnIR * input_col,
+                          graph->CreateNode<ColumnIR>(map->ast(), col_name, /*parent_op_idx*/ 0));
+      std::vector<ExpressionIR*> args{input_col};
+      for (const auto& key : keys) {
+        PX_ASSIGN_OR_RETURN(StringIR * key_ir, graph->CreateNode<StringIR>(map->ast(), key));
+        args.push_back(key_ir);
+      }
+      PX_ASSIGN_OR_RETURN(
+          FuncIR * pluck_multi,
+          graph->CreateNode<FuncIR>(map->ast(),
+                                    FuncIR::Op{FuncIR::Opcode::non_op, "", "_pluck_multi"}, args));
+      packed_exprs.emplace_back(PackedColumnName(map, col_name, chunk_idx), pluck_multi);
+    }
+
+    for (const auto& pluck : plucks) {
+      auto [chunk_idx, index] = key_locations[pluck.key];
+      if (chunks[chunk_idx].size() < 2) {
+        continue;
+      }
+      PX_ASSIGN_OR_RETURN(FuncIR * pluck_at,
+                          CreatePluckAtFunc(pluck, PackedColumnName(map, col_name, chunk_idx),
+                                            index));
+      pluck_replacements.emplace_back(pluck.output_name, pluck_at);
+    }
+  }
+
+  if (packed_exprs.empty()) {
+    return false;
+  }
+
+  // The new Map passes through all of the parent's columns and adds the packed columns.
+  ColExpressionVector new_map_exprs;
+  for (const auto& parent_col_name : parent->resolved_table_type()->ColumnNames()) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * parent_col, graph->CreateNode<ColumnIR>(
+                                                   map->ast(), parent_col_name,
+                                                   /*parent_op_idx*/ 0));
+    new_map_exprs.emplace_back(parent_col_name, parent_col);
+  }
+  new_map_exprs.insert(new_map_exprs.end(), packed_exprs.begin(), packed_exprs.end());
+  PX_ASSIGN_OR_RETURN(MapIR * pluck_multi_map,
+                      graph->CreateNode<MapIR>(map->ast(), parent, new_map_exprs,
+                                               /* keep_input_columns */ false));
+  PX_RETURN_IF_ERROR(map->ReplaceParent(parent, pluck_multi_map));
+
+  for (const auto& [output_name, pluck_at] : pluck_replacements) {
+    PX_RETURN_IF_ERROR(map->UpdateColExpr(output_name, pluck_at));
+  }
+
+  PX_RETURN_IF_ERROR(PropagateTypeChangesFromNode(graph, pluck_multi_map, compiler_state_));
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/func_ir.h"
+#include "src/carnot/planner/ir/map_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief CombinePluckCallsRule rewrites several px.pluck, px.pluck_int64 or px.pluck_float64 calls
+ * on the same column of a Map into a single px._pluck_multi call, so that the JSON string is only
+ * scanned once per row instead of once per key.
+ *
+ * df.a = px.pluck(df.req_body, 'a')
+ * df.b = px.pluck_int64(df.req_body, 'b')
+ *
+ * becomes a new parent Map computing
+ *
+ * _pluck_multi_<id>_req_body_0 = px._pluck_multi(df.req_body, 'a', 'b')
+ *
+ * and the original Map then extracts each value with px._pluck_multi_at(_pluck_multi..., 0), etc.
+ * Only plucks that are top-level Map expressions with a column input and a constant key are
+ * combined.
+ */
+class CombinePluckCallsRule : public Rule {
+ public:
+  explicit CombinePluckCallsRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
+
+  // The maximum number of keys combined into a single _pluck_multi call. Must match the number of
+  // keys _pluck_multi is registered with.
+  static constexpr int64_t kMaxPluckMultiKeys = 8;
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  struct PluckCall {
+    std::string output_name;
+    FuncIR* func;
+    std::string key;
+  };
+
+  static std::string PackedColumnName(MapIR* map, const std::string& col_name,
+                                      int64_t chunk_idx);
+  StatusOr<FuncIR*> CreatePluckAtFunc(const PluckCall& pluck, const std::string& packed_col_name,
+                                      int64_t index);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/analyzer/resolve_types_rule.h"
+#include "src/carnot/planner/compiler/optimizer/combine_pluck_calls_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using table_store::schema::Relation;
+
+class CombinePluckCallsRuleTest : public RulesTest {
+ protected:
+  void SetUpImpl() override {
+    RulesTest::SetUpImpl();
+    relation_ = Relation({types::STRING, types::STRING}, {"req_body", "resp_body"});
+    compiler_state_->relation_map()->emplace("http", relation_);
+  }
+
+  FuncIR* MakePluck(const std::string& func_name, const std::string& col,
+                    const std::string& key) {
+    return MakeFunc(func_name, {MakeColumn(col, 0), MakeString(key)});
+  }
+
+  Relation relation_;
+};
+
+TEST_F(CombinePluckCallsRuleTest, combines_plucks_of_same_column) {
+  MemorySourceIR* mem_src = MakeMemSource("http", relation_);
+  auto map = MakeMap(mem_src, {{"a", MakePluck("pluck", "req_body", "a")},
+                               {"b", MakePluck("pluck_int64", "req_body", "b")},
+                               {"c", MakePluck("pluck_float64", "req_body", "c")},
+                               {"d", MakePluck("pluck", "resp_body", "d")}});
+  MakeMemSink(map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  CombinePluckCallsRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  ASSERT_TRUE(result.ConsumeValueOrDie());
+
+  ASSERT_EQ(1, map->parents().size());
+  ASSERT_MATCH(map->parents()[0], Map());
+  auto pluck_multi_map = static_cast<MapIR*>(map->parents()[0]);
+  EXPECT_EQ(mem_src, pluck_multi_map->parents()[0]);
+
+  // The pass-through columns followed by the packed column.
+  ASSERT_EQ(3, pluck_multi_map->col_exprs().size());
+  EXPECT_MATCH(pluck_multi_map->col_exprs()[0].node, ColumnNode("req_body"));
+  EXPECT_MATCH(pluck_multi_map->col_exprs()[1].node, ColumnNode("resp_body"));
+  const auto& packed_expr = pluck_multi_map->col_exprs()[2];
+  ASSERT_MATCH(packed_expr.node, Func("_pluck_multi"));
+  auto pluck_multi = static_cast<FuncIR*>(packed_expr.node);
+  ASSERT_EQ(4, pluck_multi->all_args().size());
+  EXPECT_MATCH(pluck_multi->all_args()[0], ColumnNode("req_body"));
+  EXPECT_MATCH(pluck_multi->all_args()[1], String("a"));
+  EXPECT_MATCH(pluck_multi->all_args()[2], String("b"));
+  EXPECT_MATCH(pluck_multi->all_args()[3], String("c"));
+
+  ASSERT_EQ(4, map->col_exprs().size());
+  EXPECT_MATCH(map->col_exprs()[0].node, Func("_pluck_multi_at"));
+  EXPECT_MATCH(map->col_exprs()[1].node, Func("_pluck_multi_at_int64"));
+  EXPECT_MATCH(map->col_exprs()[2].node, Func("_pluck_multi_at_float64"));
+  // Only one pluck of resp_body, so it stays as is.
+  EXPECT_MATCH(map->col_exprs()[3].node, Func("pluck"));
+
+  auto pluck_at = static_cast<FuncIR*>(map->col_exprs()[1].node);
+  EXPECT_MATCH(pluck_at->all_args()[0], ColumnNode(packed_expr.name));
+  EXPECT_MATCH(pluck_at->all_args()[1], Int(1));
+
+  // The output types are unchanged.
+  EXPECT_THAT(*map->resolved_table_type(),
+              IsTableType(Relation({types::STRING, types::INT64, types::FLOAT64, types::STRING},
+                                   {"a", "b", "c", "d"})));
+}
+
+TEST_F(CombinePluckCallsRuleTest, dedups_keys) {
+  MemorySourceIR* mem_src = MakeMemSource("http", relation_);
+  auto map = MakeMap(mem_src, {{"a", MakePluck("pluck", "req_body", "a")},
+                               {"a_int", MakePluck("pluck_int64", "req_body", "a")},
+                               {"b", MakePluck("pluck", "req_body", "b")}});
+  MakeMemSink(map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  CombinePluckCallsRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  ASSERT_TRUE(result.ConsumeValueOrDie());
+
+  auto pluck_multi_map = static_cast<MapIR*>(map->parents()[0]);
+  auto pluck_multi = static_cast<FuncIR*>(pluck_multi_map->col_exprs().back().node);
+  ASSERT_EQ(3, pluck_multi->all_args().size());
+
+  auto a_int = static_cast<FuncIR*>(map->col_exprs()[1].node);
+  EXPECT_MATCH(a_int, Func("_pluck_multi_at_int64"));
+  EXPECT_MATCH(a_int->all_args()[1], Int(0));
+  auto b = static_cast<FuncIR*>(map->col_exprs()[2].node);
+  EXPECT_MATCH(b->all_args()[1], Int(1));
+}
+
+TEST_F(CombinePluckCallsRuleTest, single_pluck_unchanged) {
+  MemorySourceIR* mem_src = MakeMemSource("http", relation_);
+  auto map = MakeMap(mem_src, {{"a", MakePluck("pluck", "req_body", "a")},
+                               {"b", MakePluck("pluck", "resp_body", "b")}});
+  MakeMemSink(map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  CombinePluckCallsRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(mem_src, map->parents()[0]);
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -23,10 +23,12 @@
 #include <unordered_set>
 #include <vector>
 
+#include "src/carnot/planner/compiler/optimizer/combine_pluck_calls_rule.h"
 #include "src/carnot/planner/compiler/optimizer/merge_nodes_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unconnected_operators_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unused_columns_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unused_contains_rule.h"
+#include "src/carnot/planner/compiler/optimizer/select_join_build_side_rule.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
 #include "src/carnot/planner/ir/ir.h"
@@ -58,6 +60,11 @@ class Optimizer : public RuleExecutor<IR> {
     merge_nodes_batch->AddRule<MergeNodesRule>(compiler_state_);
   }
 
+  void CreateCombinePluckCallsBatch() {
+    RuleBatch* combine_pluck_calls = CreateRuleBatch<DoOnce>("CombinePluckCalls");
+    combine_pluck_calls->AddRule<CombinePluckCallsRule>(compiler_state_);
+  }
+
   void CreatePruneUnusedColumnsBatch() {
     RuleBatch* prune_unused_columns = CreateRuleBatch<FailOnMax>("PruneUnusedColumns", 2);
     prune_unused_columns->AddRule<PruneUnusedColumnsRule>();
@@ -68,11 +75,18 @@ class Optimizer : public RuleExecutor<IR> {
     prune_unused_columns->AddRule<PruneUnusedContainsRule>();
   }
 
+  void CreateSelectJoinBuildSideBatch() {
+    RuleBatch* select_join_build_side = CreateRuleBatch<DoOnce>("SelectJoinBuildSide");
+    select_join_build_side->AddRule<SelectJoinBuildSideRule>(compiler_state_);
+  }
+
   Status Init() {
     CreatePruneUnconnectedOpsBatch();
     CreateMergeNodesBatch();
+    CreateCombinePluckCallsBatch();
     CreatePruneUnusedColumnsBatch();
     CreatePruneUnusedContainsBatch();
+    CreateSelectJoinBuildSideBatch();
     return Status::OK();
   }
 
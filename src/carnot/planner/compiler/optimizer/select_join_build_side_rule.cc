@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/select_join_build_side_rule.h"
+
+#include <algorithm>
+#include <string>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+namespace {
+// The planner doesn't know how many rows the tables hold, so every table is assumed to hold the
+// same number of rows. The estimates are only compared with each other.
+constexpr double kTableRows = 1000 * 1000;
+// The fraction of the rows that a filter is assumed to keep.
+constexpr double kFilterSelectivity = 0.5;
+// The fraction of the rows that a grouped aggregate is assumed to output.
+constexpr double kGroupedAggSelectivity = 0.1;
+}  // namespace
+
+double SelectJoinBuildSideRule::EstimateOutputRows(OperatorIR* op) const {
+  if (op->parents().empty()) {
+    return kTableRows;
+  }
+
+  // Joins and unions output roughly what they read from all of their parents.
+  double parent_rows = 0;
+  for (OperatorIR* parent : op->parents()) {
+    parent_rows += EstimateOutputRows(parent);
+  }
+
+  if (Match(op, Filter())) {
+    return parent_rows * kFilterSelectivity;
+  }
+  if (Match(op, BlockingAgg())) {
+    if (static_cast<BlockingAggIR*>(op)->groups().empty()) {
+      return 1;
+    }
+    return parent_rows * kGroupedAggSelectivity;
+  }
+  if (Match(op, Limit())) {
+    return std::min(parent_rows, static_cast<double>(static_cast<LimitIR*>(op)->limit_value()));
+  }
+  return parent_rows;
+}
+
+StatusOr<bool> SelectJoinBuildSideRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(ir_node);
+  if (join->parents().size() != 2 || join->build_side() != planpb::JoinOperator::BUILD_DEFAULT) {
+    return false;
+  }
+  // Time ordered joins have to probe the parent that time_ comes from.
+  const auto& column_names = join->column_names();
+  if (std::find(column_names.begin(), column_names.end(), "time_") != column_names.end()) {
+    return false;
+  }
+
+  double left_rows = EstimateOutputRows(join->parents()[0]);
+  double right_rows = EstimateOutputRows(join->parents()[1]);
+  if (left_rows == right_rows) {
+    return false;
+  }
+  join->SetBuildSide(right_rows < left_rows ? planpb::JoinOperator::BUILD_RIGHT
+                                            : planpb::JoinOperator::BUILD_LEFT);
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief Builds the hash table of each join from the parent that is estimated to output fewer
+ * rows, and probes it with the other parent.
+ *
+ * The planner doesn't receive the sizes of the tables, so the estimates assume that every table
+ * holds the same number of rows and apply fixed factors for the filters, aggregates and limits in
+ * between. This is enough to build from an aggregate or a filtered table rather than from a whole
+ * table. The build side is left to the execution engine when both estimates are equal, or when the
+ * join is ordered by time, which fixes the side to probe.
+ */
+class SelectJoinBuildSideRule : public Rule {
+ public:
+  explicit SelectJoinBuildSideRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+  /**
+   * @brief Returns the estimated number of rows that the operator outputs, relative to the rows
+   * assumed for a whole table.
+   */
+  double EstimateOutputRows(OperatorIR* op) const;
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
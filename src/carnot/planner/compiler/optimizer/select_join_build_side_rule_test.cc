@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/optimizer/select_join_build_side_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+class SelectJoinBuildSideRuleTest : public RulesTest {
+ protected:
+  void SetUpImpl() override {
+    RulesTest::SetUpImpl();
+    compiler_state_->relation_map()->emplace("processes", MakeRelation());
+    compiler_state_->relation_map()->emplace("events", MakeRelation());
+  }
+
+  JoinIR* MakeInnerJoin(OperatorIR* left, OperatorIR* right) {
+    return MakeJoin({left, right}, "inner", MakeRelation(), MakeRelation(), {"count"}, {"count"});
+  }
+
+  BlockingAggIR* MakeGroupedAgg(OperatorIR* parent) {
+    return MakeBlockingAgg(parent, {MakeColumn("count", 0)},
+                           {{"cpu0", MakeMeanFunc(MakeColumn("cpu0", 0))}});
+  }
+};
+
+TEST_F(SelectJoinBuildSideRuleTest, build_aggregate_right) {
+  JoinIR* join = MakeInnerJoin(MakeMemSource("events", MakeRelation()),
+                               MakeGroupedAgg(MakeMemSource("processes", MakeRelation())));
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  EXPECT_EQ(planpb::JoinOperator::BUILD_RIGHT, join->build_side());
+
+  planpb::Operator op;
+  ASSERT_OK(join->ToProto(&op));
+  EXPECT_EQ(planpb::JoinOperator::BUILD_RIGHT, op.join_op().build_side());
+}
+
+TEST_F(SelectJoinBuildSideRuleTest, build_aggregate_left) {
+  JoinIR* join = MakeInnerJoin(MakeGroupedAgg(MakeMemSource("processes", MakeRelation())),
+                               MakeMemSource("events", MakeRelation()));
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  EXPECT_EQ(planpb::JoinOperator::BUILD_LEFT, join->build_side());
+}
+
+TEST_F(SelectJoinBuildSideRuleTest, estimates) {
+  MemorySourceIR* src = MakeMemSource("events", MakeRelation());
+  FilterIR* filter = MakeFilter(src, MakeEqualsFunc(MakeColumn("count", 0), MakeInt(10)));
+  BlockingAggIR* agg = MakeGroupedAgg(filter);
+  BlockingAggIR* ungrouped_agg =
+      MakeBlockingAgg(src, {}, {{"count", MakeMeanFunc(MakeColumn("count", 0))}});
+  LimitIR* limit = MakeLimit(src, 10);
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  double table_rows = rule.EstimateOutputRows(src);
+  EXPECT_DOUBLE_EQ(table_rows / 2, rule.EstimateOutputRows(filter));
+  EXPECT_DOUBLE_EQ(table_rows / 20, rule.EstimateOutputRows(agg));
+  EXPECT_DOUBLE_EQ(1, rule.EstimateOutputRows(ungrouped_agg));
+  EXPECT_DOUBLE_EQ(10, rule.EstimateOutputRows(limit));
+}
+
+TEST_F(SelectJoinBuildSideRuleTest, equal_estimates) {
+  JoinIR* join = MakeInnerJoin(MakeMemSource("events", MakeRelation()),
+                               MakeMemSource("processes", MakeRelation()));
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(planpb::JoinOperator::BUILD_DEFAULT, join->build_side());
+}
+
+TEST_F(SelectJoinBuildSideRuleTest, time_ordered_join) {
+  JoinIR* join = MakeInnerJoin(MakeMemSource("events", MakeRelation()),
+                               MakeGroupedAgg(MakeMemSource("processes", MakeRelation())));
+  ASSERT_OK(join->SetOutputColumns({"time_"}, {MakeColumn("time_", 0)}));
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(planpb::JoinOperator::BUILD_DEFAULT, join->build_side());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
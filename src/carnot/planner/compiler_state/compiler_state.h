@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "src/carnot/planner/compiler_state/registry_info.h"
+#include "src/carnot/planner/compilerpb/compiler_status.pb.h"
 
 #include "src/common/base/base.h"
 #include "src/shared/types/types.h"
@@ -140,6 +141,10 @@ class CompilerState : public NotCopyable {
   }
   RegistryInfo* registry_info() const { return registry_info_; }
   types::Time64NSValue time_now() const { return time_now_; }
+  // Marks that the compiled plan holds values derived from time_now() that can't be rebound to a
+  // later time, e.g. the result of px.now(). Plans like this can't be reused by the plan cache.
+  void MarkTimeNowBakedIn() { time_now_baked_in_ = true; }
+  bool time_now_baked_in() const { return time_now_baked_in_; }
   const std::string& result_address() const { return result_address_; }
   const std::string& result_ssl_targetname() const { return result_ssl_targetname_; }
 
@@ -176,11 +181,15 @@ class CompilerState : public NotCopyable {
   PluginConfig* plugin_config() { return plugin_config_.get(); }
   const DebugInfo& debug_info() { return debug_info_; }
 
+  // Statistics of the rule batches run on the plan so far.
+  compilerpb::RuleExecutorStats* rule_executor_stats() { return &rule_executor_stats_; }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
   SensitiveColumnMap table_names_to_sensitive_columns_;
   RegistryInfo* registry_info_;
   types::Time64NSValue time_now_;
+  bool time_now_baked_in_ = false;
   std::map<IDRegistryKey, int64_t> udf_to_id_map_;
   std::map<IDRegistryKey, int64_t> uda_to_id_map_;
 
@@ -191,6 +200,7 @@ class CompilerState : public NotCopyable {
   std::unique_ptr<planpb::OTelEndpointConfig> endpoint_config_ = nullptr;
   std::unique_ptr<PluginConfig> plugin_config_ = nullptr;
   DebugInfo debug_info_;
+  compilerpb::RuleExecutorStats rule_executor_stats_;
 };
 
 }  // namespace planner
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/carnot/planner/distributed/coordinator/coordinator.h"
+#include "src/carnot/planner/distributed/coordinator/merge_tree.h"
 #include "src/carnot/planner/distributed/coordinator/plan_clusters.h"
 #include "src/carnot/planner/distributed/coordinator/prune_unavailable_sources_rule.h"
 #include "src/carnot/planner/distributed/coordinator/removable_ops_rule.h"
@@ -34,6 +35,15 @@
 #include "src/common/uuid/uuid.h"
 #include "src/shared/upid/upid.h"
 
+DEFINE_bool(planner_partial_agg, gflags::BoolFromEnv("PL_PLANNER_PARTIAL_AGG", true),
+            "Whether blocking aggregates whose UDAs all support partial aggregation should be "
+            "split into a partial aggregate on the PEMs and a merge on the Kelvin.");
+DEFINE_double(planner_merge_tree_hop_cost,
+              gflags::DoubleFromEnv("PL_PLANNER_MERGE_TREE_HOP_COST", 128),
+              "The estimated cost of sending results through an intermediate Kelvin, relative to "
+              "the cost of merging the results of one agent. Decides whether the results of the "
+              "agents are merged through a tree of Kelvins.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -99,6 +109,54 @@ bool CoordinatorImpl::HasExecutableNodes(const IR* plan) {
   return plan->FindNodesThatMatch(Operator()).size() > 0;
 }
 
+Status CoordinatorImpl::BuildMergeTree(DistributedPlan* plan, CarnotInstance* kelvin,
+                                       const std::vector<int64_t>& source_node_ids) {
+  // A Carnot instance runs a single plan, so only the remote processors that don't have a PEM
+  // plan can be used as intermediate nodes.
+  std::vector<const CarnotInfo*> merger_candidates;
+  for (const auto& carnot_info : remote_processor_nodes_) {
+    if (carnot_info.has_data_store() ||
+        carnot_info.query_broker_address() == kelvin->QueryBrokerAddress()) {
+      continue;
+    }
+    merger_candidates.push_back(&carnot_info);
+  }
+  std::vector<int64_t> sources;
+  for (int64_t source_id : source_node_ids) {
+    if (plan->HasNode(source_id)) {
+      sources.push_back(source_id);
+    }
+  }
+
+  int64_t num_mergers =
+      NumIntermediateMergers(sources.size(), merger_candidates.size(),
+                             FLAGS_planner_merge_tree_hop_cost);
+  if (num_mergers == 0 || !HasIntermediateMergeOps(kelvin->plan())) {
+    return Status::OK();
+  }
+
+  // Split the sources into contiguous ranges of (nearly) equal size.
+  for (int64_t i = 0; i < num_mergers; ++i) {
+    PX_ASSIGN_OR_RETURN(int64_t merger_id, plan->AddCarnot(*merger_candidates[i]));
+    CarnotInstance* merger = plan->Get(merger_id);
+    PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> merger_plan,
+                        CreateIntermediateMergePlan(kelvin->plan()));
+    merger->AddPlan(merger_plan.get());
+    plan->AddPlan(std::move(merger_plan));
+
+    absl::flat_hash_set<int64_t> merger_sources;
+    size_t begin = i * sources.size() / num_mergers;
+    size_t end = (i + 1) * sources.size() / num_mergers;
+    for (size_t j = begin; j < end; ++j) {
+      plan->ReplaceChildEdge(sources[j], kelvin->id(), merger_id);
+      merger_sources.insert(sources[j]);
+    }
+    plan->AddEdge(merger_id, kelvin->id());
+    plan->AddIntermediateMerger(merger, std::move(merger_sources));
+  }
+  return Status::OK();
+}
+
 const distributedpb::CarnotInfo& CoordinatorImpl::GetRemoteProcessor() const {
   // TODO(philkuz) update this with a more sophisticated strategy in the future.
   DCHECK_GT(remote_processor_nodes_.size(), 0UL);
@@ -178,14 +236,15 @@ StatusOr<SchemaToAgentsMap> LoadSchemaMap(
 }
 
 StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const IR* logical_plan) {
+  // The splitter only splits aggregates whose UDAs all support partial aggregation, the rest are
+  // still run on the Kelvin over the raw rows.
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Splitter> splitter,
-                      Splitter::Create(compiler_state_, /* support_partial_agg */ false));
+                      Splitter::Create(compiler_state_, FLAGS_planner_partial_agg));
   PX_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
                       splitter->SplitKelvinAndAgents(logical_plan));
   auto distributed_plan = std::make_unique<DistributedPlan>();
   PX_ASSIGN_OR_RETURN(int64_t remote_node_id, distributed_plan->AddCarnot(GetRemoteProcessor()));
   // TODO(philkuz) Need to update the Blocking Split Plan to better represent what we expect.
-  // TODO(philkuz) (PL-1469) Future support for grabbing data from multiple Kelvin nodes.
 
   PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> remote_plan_uptr, split_plan->original_plan->Clone());
   CarnotInstance* remote_carnot = distributed_plan->Get(remote_node_id);
@@ -225,6 +284,9 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   DistributedPruneUnavailableSourcesRule prune_sources_rule(agent_schema_map);
   PX_RETURN_IF_ERROR(prune_sources_rule.Apply(remote_carnot));
 
+  // On large clusters, merge the results of the PEMs through other Kelvins first.
+  PX_RETURN_IF_ERROR(BuildMergeTree(distributed_plan.get(), remote_carnot, source_node_ids));
+
   distributed_plan->SetKelvin(remote_carnot);
   distributed_plan->AddPlanToAgentMap(std::move(agent_to_plan_map.plan_to_agents));
 
@@ -27,6 +27,9 @@
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/ir/pattern_match.h"
 
+DECLARE_bool(planner_partial_agg);
+DECLARE_double(planner_merge_tree_hop_cost);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -93,6 +96,10 @@ class CoordinatorImpl : public Coordinator {
  private:
   const distributedpb::CarnotInfo& GetRemoteProcessor() const;
   bool HasExecutableNodes(const IR* plan);
+  // Puts intermediate merge nodes between the data sources and the Kelvin, if there are enough
+  // sources for the extra hop to pay off.
+  Status BuildMergeTree(DistributedPlan* plan, CarnotInstance* kelvin,
+                        const std::vector<int64_t>& source_node_ids);
 
   // Nodes that have a source of data.
   std::vector<CarnotInfo> data_store_nodes_;
@@ -32,6 +32,7 @@
 #include "src/carnot/planner/test_utils.h"
 #include "src/carnot/udf_exporter/udf_exporter.h"
 #include "src/common/testing/protobuf.h"
+#include "src/common/testing/test_environment.h"
 #include "src/shared/metadata/metadata_filter.h"
 
 namespace px {
@@ -602,6 +603,95 @@ TEST_F(CoordinatorTest, prune_agent_on_pem_udtf) {
   EXPECT_EQ(1, kelvin_sources.size());
 }
 
+constexpr char kPartialAggQuery[] = R"pxl(
+import px
+
+df = px.DataFrame(table='http_events', start_time='-120s', select=['upid', 'remote_port'])
+df = df.groupby('upid').agg(count=('remote_port', px.count))
+px.display(df, 't1')
+)pxl";
+
+TEST_F(CoordinatorTest, partial_agg_on_pems) {
+  auto physical_plan = ThreeAgentOneKelvinCoordinateQuery(kPartialAggQuery);
+
+  for (int64_t carnot_id : physical_plan->dag().nodes()) {
+    auto carnot = physical_plan->Get(carnot_id);
+    SCOPED_TRACE(carnot->QueryBrokerAddress());
+    auto aggs = carnot->plan()->FindNodesThatMatch(BlockingAgg());
+    ASSERT_EQ(1, aggs.size());
+    if (carnot->QueryBrokerAddress() == "kelvin") {
+      EXPECT_MATCH(aggs[0], FinalizeAgg());
+    } else {
+      EXPECT_MATCH(aggs[0], PartialAgg());
+      auto sinks = carnot->plan()->FindNodesThatMatch(GRPCSink());
+      ASSERT_EQ(1, sinks.size());
+      EXPECT_EQ(aggs[0], static_cast<OperatorIR*>(sinks[0])->parents()[0]);
+    }
+  }
+}
+
+TEST_F(CoordinatorTest, partial_agg_disabled) {
+  PX_SET_FOR_SCOPE(FLAGS_planner_partial_agg, false);
+  auto physical_plan = ThreeAgentOneKelvinCoordinateQuery(kPartialAggQuery);
+
+  for (int64_t carnot_id : physical_plan->dag().nodes()) {
+    auto carnot = physical_plan->Get(carnot_id);
+    SCOPED_TRACE(carnot->QueryBrokerAddress());
+    auto aggs = carnot->plan()->FindNodesThatMatch(BlockingAgg());
+    if (carnot->QueryBrokerAddress() == "kelvin") {
+      ASSERT_EQ(1, aggs.size());
+      EXPECT_MATCH(aggs[0], FullAgg());
+    } else {
+      EXPECT_EQ(0, aggs.size());
+    }
+  }
+}
+
+TEST_F(CoordinatorTest, merge_tree_of_kelvins) {
+  PX_SET_FOR_SCOPE(FLAGS_planner_merge_tree_hop_cost, 0);
+  auto physical_plan = CoordinateQuery(kPartialAggQuery, SixPEMsThreeKelvinsDistributedState());
+
+  ASSERT_EQ(9, physical_plan->dag().nodes().size());
+  auto kelvin = physical_plan->kelvin();
+  EXPECT_EQ("kelvin", kelvin->QueryBrokerAddress());
+  ASSERT_EQ(2, physical_plan->intermediate_mergers().size());
+  EXPECT_THAT(physical_plan->dag().ParentsOf(kelvin->id()),
+              UnorderedElementsAre(physical_plan->intermediate_mergers()[0].first->id(),
+                                   physical_plan->intermediate_mergers()[1].first->id()));
+  auto kelvin_aggs = kelvin->plan()->FindNodesThatMatch(BlockingAgg());
+  ASSERT_EQ(1, kelvin_aggs.size());
+  EXPECT_MATCH(kelvin_aggs[0], FinalizeAgg());
+
+  absl::flat_hash_set<int64_t> merged_sources;
+  for (const auto& [merger, sources] : physical_plan->intermediate_mergers()) {
+    SCOPED_TRACE(merger->QueryBrokerAddress());
+    EXPECT_THAT(merger->QueryBrokerAddress(), ContainsRegex("kelvin[23]"));
+    EXPECT_EQ(3, sources.size());
+    for (int64_t source : sources) {
+      EXPECT_THAT(physical_plan->dag().DependenciesOf(source), ElementsAre(merger->id()));
+      merged_sources.insert(source);
+    }
+
+    // The merger combines the partial states of its PEMs and sends them on to the Kelvin.
+    auto aggs = merger->plan()->FindNodesThatMatch(BlockingAgg());
+    ASSERT_EQ(1, aggs.size());
+    EXPECT_MATCH(aggs[0], MergeAgg());
+    EXPECT_MATCH(static_cast<OperatorIR*>(aggs[0])->parents()[0], GRPCSourceGroup());
+    auto sinks = merger->plan()->FindNodesThatMatch(GRPCSink());
+    ASSERT_EQ(1, sinks.size());
+    EXPECT_EQ(aggs[0], static_cast<OperatorIR*>(sinks[0])->parents()[0]);
+  }
+  EXPECT_EQ(6, merged_sources.size());
+}
+
+TEST_F(CoordinatorTest, merge_tree_not_worth_the_hop) {
+  auto physical_plan = CoordinateQuery(kPartialAggQuery, SixPEMsThreeKelvinsDistributedState());
+
+  EXPECT_EQ(7, physical_plan->dag().nodes().size());
+  EXPECT_EQ(0, physical_plan->intermediate_mergers().size());
+  EXPECT_EQ(6, physical_plan->dag().ParentsOf(physical_plan->kelvin()->id()).size());
+}
+
 constexpr char kExtraPEM[] = R"carnotinfo(
 query_broker_address: "pem5"
 agent_id {
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/planner/distributed/coordinator/merge_tree.h"
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
+#include "src/carnot/planner/ir/grpc_sink_ir.h"
+#include "src/carnot/planner/ir/grpc_source_group_ir.h"
+#include "src/carnot/planner/ir/limit_ir.h"
+#include "src/carnot/planner/ir/sort_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+namespace {
+
+// Returns the operator that merges the streams read by the source group, if it can run on an
+// intermediate node.
+OperatorIR* GetIntermediateMergeOp(const GRPCSourceGroupIR* source_group) {
+  auto children = source_group->Children();
+  if (children.size() != 1) {
+    return nullptr;
+  }
+  if (Match(children[0], FinalizeAgg()) || Match(children[0], Limit())) {
+    return children[0];
+  }
+  if (Match(children[0], Sort()) && static_cast<SortIR*>(children[0])->has_limit()) {
+    return children[0];
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+int64_t NumIntermediateMergers(int64_t num_sources, int64_t max_mergers, double hop_cost) {
+  // Every intermediate node should at least merge two sources.
+  max_mergers = std::min(max_mergers, num_sources / 2);
+  double best_cost = static_cast<double>(num_sources);
+  int64_t best_num_mergers = 0;
+  for (int64_t k = 2; k <= max_mergers; ++k) {
+    int64_t fan_in = (num_sources + k - 1) / k;
+    double cost = static_cast<double>(fan_in + k) + hop_cost;
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_num_mergers = k;
+    }
+  }
+  return best_num_mergers;
+}
+
+bool HasIntermediateMergeOps(const IR* kelvin_plan) {
+  for (IRNode* node : kelvin_plan->FindNodesOfType(IRNodeType::kGRPCSourceGroup)) {
+    if (GetIntermediateMergeOp(static_cast<GRPCSourceGroupIR*>(node)) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+StatusOr<std::unique_ptr<IR>> CreateIntermediateMergePlan(const IR* kelvin_plan) {
+  auto plan = std::make_unique<IR>();
+  // Copied nodes keep the ids they have in the Kelvin plan, so every node is copied before any
+  // node is created, otherwise the ids could collide.
+  std::vector<std::pair<OperatorIR*, int64_t>> bridges;
+  for (IRNode* node : kelvin_plan->FindNodesOfType(IRNodeType::kGRPCSourceGroup)) {
+    auto kelvin_source_group = static_cast<GRPCSourceGroupIR*>(node);
+    PX_ASSIGN_OR_RETURN(GRPCSourceGroupIR * source_group, plan->CopyNode(kelvin_source_group));
+    OperatorIR* merge_op = GetIntermediateMergeOp(kelvin_source_group);
+    if (merge_op == nullptr) {
+      bridges.emplace_back(source_group, kelvin_source_group->source_id());
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(OperatorIR * new_merge_op, plan->CopyNode(merge_op));
+    PX_RETURN_IF_ERROR(new_merge_op->AddParent(source_group));
+    if (Match(new_merge_op, BlockingAgg())) {
+      // Keep the states serialized, the Kelvin merges them again.
+      auto agg = static_cast<BlockingAggIR*>(new_merge_op);
+      agg->SetFinalizeResults(false);
+      PX_RETURN_IF_ERROR(agg->SetResolvedType(source_group->resolved_type()));
+    }
+    bridges.emplace_back(new_merge_op, kelvin_source_group->source_id());
+  }
+
+  for (const auto& [parent, bridge_id] : bridges) {
+    PX_ASSIGN_OR_RETURN(GRPCSinkIR * sink,
+                        plan->CreateNode<GRPCSinkIR>(parent->ast(), parent, bridge_id));
+    PX_RETURN_IF_ERROR(sink->SetResolvedType(parent->resolved_type()));
+  }
+  return plan;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
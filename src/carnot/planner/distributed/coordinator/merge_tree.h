@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "src/carnot/planner/ir/ir.h"
+#include "src/carnot/planner/ir/pattern_match.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * @brief Returns the number of intermediate nodes that the results of num_sources data sources
+ * should be merged through before they reach the Kelvin, or 0 if every source should send to the
+ * Kelvin directly.
+ *
+ * Merging the stream of a single source costs roughly the same on every node, so with k
+ * intermediate nodes the slowest path through the tree merges ceil(num_sources / k) streams on an
+ * intermediate node and k streams on the Kelvin, plus the cost of the extra hop. hop_cost is
+ * expressed in units of merging one stream.
+ */
+int64_t NumIntermediateMergers(int64_t num_sources, int64_t max_mergers, double hop_cost);
+
+/**
+ * @brief Returns true if the Kelvin plan merges the streams of its GRPCSourceGroups with
+ * operators that can also run on an intermediate node, i.e. merge aggregates, limits and top-k
+ * sorts.
+ * Intermediate nodes that only forward their inputs would just add a hop.
+ */
+bool HasIntermediateMergeOps(const IR* kelvin_plan);
+
+/**
+ * @brief Creates the plan of an intermediate node in the merge tree from the plan of the Kelvin.
+ *
+ * For every GRPCSourceGroup in the Kelvin plan, the intermediate plan reads the same GRPC bridge,
+ * partially merges what it reads, and sends the result to the Kelvin on the same bridge. Merge
+ * aggregates are run without finalizing their results, so the Kelvin still receives serialized
+ * UDA states. Limits and top-k sorts are copied as is. Other bridges are forwarded without changes.
+ *
+ * Every intermediate node needs its own copy of the plan, because the GRPCSourceGroups track the
+ * sinks that send to them.
+ */
+StatusOr<std::unique_ptr<IR>> CreateIntermediateMergePlan(const IR* kelvin_plan);
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
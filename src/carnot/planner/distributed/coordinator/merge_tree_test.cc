@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/distributed/coordinator/merge_tree.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+TEST(NumIntermediateMergersTest, small_clusters_send_to_kelvin) {
+  EXPECT_EQ(0, NumIntermediateMergers(3, 10, 0));
+  EXPECT_EQ(0, NumIntermediateMergers(100, 10, 128));
+  // Not enough spare Kelvins.
+  EXPECT_EQ(0, NumIntermediateMergers(1000, 1, 0));
+}
+
+TEST(NumIntermediateMergersTest, balances_fan_in) {
+  // ceil(n / k) + k is smallest around k = sqrt(n).
+  EXPECT_EQ(32, NumIntermediateMergers(1024, 100, 0));
+  EXPECT_EQ(32, NumIntermediateMergers(1024, 100, 128));
+  EXPECT_EQ(2, NumIntermediateMergers(6, 2, 0));
+}
+
+TEST(NumIntermediateMergersTest, limited_by_spare_kelvins) {
+  EXPECT_EQ(4, NumIntermediateMergers(1000, 4, 0));
+  // 38 + 4 + 128 is more than the 150 streams the Kelvin would merge by itself.
+  EXPECT_EQ(0, NumIntermediateMergers(150, 4, 128));
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
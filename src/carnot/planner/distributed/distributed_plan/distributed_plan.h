@@ -114,7 +114,12 @@ class DistributedPlan {
 
   void AddEdge(CarnotInstance* from, CarnotInstance* to) { dag_.AddEdge(from->id(), to->id()); }
   void AddEdge(int64_t from, int64_t to) { dag_.AddEdge(from, to); }
+  void ReplaceChildEdge(int64_t parent, int64_t old_child, int64_t new_child) {
+    dag_.ReplaceChildEdge(parent, old_child, new_child);
+  }
   bool HasNode(int64_t node_id) const { return dag_.HasNode(node_id); }
+  // The id that the next Carnot instance added to the plan will get.
+  int64_t next_node_id() const { return id_counter_; }
 
   Status DeleteNode(int64_t node) {
     if (!HasNode(node)) {
@@ -164,11 +169,26 @@ class DistributedPlan {
 
   CarnotInstance* kelvin() const { return kelvin_; }
 
+  /**
+   * @brief Adds an intermediate node of the merge tree, which merges the results of the given
+   * data sources before sending them to the Kelvin.
+   */
+  void AddIntermediateMerger(CarnotInstance* merger, absl::flat_hash_set<int64_t> sources) {
+    DCHECK(id_to_node_map_.contains(merger->id()));
+    intermediate_mergers_.emplace_back(merger, std::move(sources));
+  }
+
+  const std::vector<std::pair<CarnotInstance*, absl::flat_hash_set<int64_t>>>&
+  intermediate_mergers() const {
+    return intermediate_mergers_;
+  }
+
  private:
   plan::DAG dag_;
   absl::flat_hash_map<int64_t, std::unique_ptr<CarnotInstance>> id_to_node_map_;
   absl::flat_hash_map<IR*, absl::flat_hash_set<int64_t>> plan_to_agent_map_;
   CarnotInstance* kelvin_ = nullptr;
+  std::vector<std::pair<CarnotInstance*, absl::flat_hash_set<int64_t>>> intermediate_mergers_;
   std::vector<std::unique_ptr<IR>> plan_pool_;
   absl::flat_hash_map<int64_t, IR*> agent_to_plan_map_;
   absl::flat_hash_map<sole::uuid, int64_t> uuid_to_id_map_;
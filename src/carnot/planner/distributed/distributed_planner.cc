@@ -52,10 +52,47 @@ Status StitchPlan(DistributedPlan* distributed_plan) {
   DistributedSetSourceGroupGRPCAddressRule set_grpc_address_rule;
   PX_RETURN_IF_ERROR(set_grpc_address_rule.Apply(remote_carnot));
 
+  // Connect the agents that are merged by an intermediate node to that node, and the intermediate
+  // node to the Kelvin.
+  GRPCSourceGroupConversionRule conversion_rule;
+  absl::flat_hash_set<int64_t> merged_agents;
+  for (const auto& [merger, merger_agents] : distributed_plan->intermediate_mergers()) {
+    PX_RETURN_IF_ERROR(set_grpc_address_rule.Apply(merger));
+    for (const auto& [plan, agents] : distributed_plan->plan_to_agent_map()) {
+      absl::flat_hash_set<int64_t> agents_to_merge;
+      for (int64_t agent : agents) {
+        if (merger_agents.contains(agent)) {
+          agents_to_merge.insert(agent);
+        }
+      }
+      if (agents_to_merge.empty()) {
+        continue;
+      }
+      PX_ASSIGN_OR_RETURN(auto did_connect_plan, AssociateDistributedPlanEdgesRule::ConnectGraphs(
+                                                     plan, agents_to_merge, merger->plan()));
+      DCHECK(did_connect_plan);
+    }
+    PX_ASSIGN_OR_RETURN(auto did_connect_merger,
+                        AssociateDistributedPlanEdgesRule::ConnectGraphs(
+                            merger->plan(), {merger->id()}, remote_plan));
+    DCHECK(did_connect_merger);
+    PX_RETURN_IF_ERROR(conversion_rule.Execute(merger->plan()));
+    merged_agents.insert(merger_agents.begin(), merger_agents.end());
+  }
+
   // Connect the plans.
   for (const auto& [plan, agents] : distributed_plan->plan_to_agent_map()) {
+    absl::flat_hash_set<int64_t> unmerged_agents;
+    for (int64_t agent : agents) {
+      if (!merged_agents.contains(agent)) {
+        unmerged_agents.insert(agent);
+      }
+    }
+    if (unmerged_agents.empty()) {
+      continue;
+    }
     PX_ASSIGN_OR_RETURN(auto did_connect_plan, AssociateDistributedPlanEdgesRule::ConnectGraphs(
-                                                   plan, agents, remote_plan));
+                                                   plan, unmerged_agents, remote_plan));
     DCHECK(did_connect_plan);
   }
 
@@ -64,7 +101,6 @@ Status StitchPlan(DistributedPlan* distributed_plan) {
       AssociateDistributedPlanEdgesRule::ConnectGraphs(remote_plan, {remote_node_id}, remote_plan));
 
   // Expand GRPCSourceGroups in the remote_plan.
-  GRPCSourceGroupConversionRule conversion_rule;
   PX_RETURN_IF_ERROR(conversion_rule.Execute(remote_plan));
   return MergeSameNodeGRPCBridgeRule(remote_node_id).Execute(remote_plan).status();
 }
@@ -398,6 +398,54 @@ TEST_F(DistributedRulesTest, init_args) {
   EXPECT_OK(distributed_plan_or_s);
 }
 
+constexpr char kPartialAggQuery[] = R"pxl(
+import px
+
+df = px.DataFrame(table='http_events', start_time='-120s', select=['upid', 'remote_port'])
+df = df.groupby('upid').agg(count=('remote_port', px.count))
+px.display(df, 't1')
+)pxl";
+
+TEST_F(DistributedRulesTest, merge_tree_of_kelvins) {
+  compiler::Compiler compiler;
+  auto single_node_plan =
+      compiler.CompileToIR(kPartialAggQuery, compiler_state_.get()).ConsumeValueOrDie();
+
+  FLAGS_planner_merge_tree_hop_cost = 0;
+  auto distributed_planner = distributed::DistributedPlanner::Create().ConsumeValueOrDie();
+  auto distributed_plan_or_s = distributed_planner->Plan(SixPEMsThreeKelvinsDistributedState(),
+                                                         compiler_state_.get(),
+                                                         single_node_plan.get());
+  FLAGS_planner_merge_tree_hop_cost = 128;
+  ASSERT_OK(distributed_plan_or_s);
+  auto distributed_plan = distributed_plan_or_s.ConsumeValueOrDie();
+  ASSERT_EQ(2, distributed_plan->intermediate_mergers().size());
+
+  // The PEMs share a plan, but each PEM sends to the address of its own merger.
+  for (const auto& [merger, sources] : distributed_plan->intermediate_mergers()) {
+    SCOPED_TRACE(merger->QueryBrokerAddress());
+    for (int64_t source : sources) {
+      auto pem_sinks = distributed_plan->Get(source)->plan()->FindNodesThatMatch(GRPCSink());
+      ASSERT_EQ(1, pem_sinks.size());
+      planpb::Operator op;
+      ASSERT_OK(static_cast<GRPCSinkIR*>(pem_sinks[0])->ToProto(&op, source));
+      EXPECT_EQ(merger->carnot_info().grpc_address(), op.grpc_sink_op().address());
+    }
+
+    auto merger_sinks = merger->plan()->FindNodesThatMatch(GRPCSink());
+    ASSERT_EQ(1, merger_sinks.size());
+    planpb::Operator op;
+    ASSERT_OK(static_cast<GRPCSinkIR*>(merger_sinks[0])->ToProto(&op, merger->id()));
+    EXPECT_EQ(distributed_plan->kelvin()->carnot_info().grpc_address(),
+              op.grpc_sink_op().address());
+  }
+
+  // Every bridge into the Kelvin is fed by a merger.
+  auto kelvin_sources = distributed_plan->kelvin()->plan()->FindNodesThatMatch(GRPCSource());
+  EXPECT_EQ(2, kelvin_sources.size());
+  EXPECT_OK(distributed_plan->ToProto());
+}
+
 }  // namespace distributed
 }  // namespace planner
 }  // namespace carnot
@@ -44,6 +44,23 @@ StatusOr<OperatorIR*> LimitOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR
   return new_limit;
 }
 
+StatusOr<OperatorIR*> SortOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
+  DCHECK(Matches(op));
+  SortIR* sort = static_cast<SortIR*>(op);
+  PX_ASSIGN_OR_RETURN(SortIR * new_sort, plan->CopyNode(sort));
+  PX_RETURN_IF_ERROR(new_sort->CopyParentsFrom(sort));
+  return new_sort;
+}
+
+StatusOr<OperatorIR*> SortOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                                           OperatorIR* op) const {
+  DCHECK(Matches(op));
+  SortIR* sort = static_cast<SortIR*>(op);
+  PX_ASSIGN_OR_RETURN(SortIR * new_sort, plan->CopyNode(sort));
+  PX_RETURN_IF_ERROR(new_sort->AddParent(new_parent));
+  return new_sort;
+}
+
 StatusOr<OperatorIR*> AggOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
   DCHECK(Matches(op));
   BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
@@ -87,6 +87,24 @@ class LimitOperatorMgr : public PartialOperatorMgr {
                                             OperatorIR* op) const override;
 };
 
+/**
+ * @brief SortOperatorMgr manages splitting top-k sorts, i.e. sorts with a limit, over the
+ * boundary. Every agent keeps its own top k rows, so at most k rows per agent are sent to the
+ * merging sort.
+ */
+class SortOperatorMgr : public PartialOperatorMgr {
+ public:
+  bool Matches(OperatorIR* op) const override {
+    if (!Match(op, Sort())) {
+      return false;
+    }
+    return static_cast<SortIR*>(op)->has_limit();
+  }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+};
+
 /**
  * @brief AggOperatorMgr manages splitting aggregates into partial aggregate and the merging node
  * over a network boundary.
@@ -98,6 +116,11 @@ class AggOperatorMgr : public PartialOperatorMgr {
       return false;
     }
     BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
+    // The partial side of a streaming window aggregate would only emit its windows at eos, so
+    // the whole aggregate runs after the data is sent over.
+    if (agg->has_streaming_window()) {
+      return false;
+    }
     for (const auto& col_expr : agg->aggregate_expressions()) {
       if (!Match(col_expr.node, PartialUDA())) {
         return false;
@@ -152,6 +152,25 @@ TEST_F(PartialOpMgrTest, agg_where_fn_cant_partial) {
   AggOperatorMgr mgr;
   EXPECT_FALSE(mgr.Matches(agg));
 }
+
+// Streaming window aggregates have to see every row of a window before they emit it, so they are
+// not split either.
+TEST_F(PartialOpMgrTest, streaming_window_agg_not_split) {
+  auto relation = MakeRelation();
+  auto mem_src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+  auto mean_func = MakeMeanFunc(MakeColumn("count", 0));
+  auto agg = MakeBlockingAgg(mem_src, {MakeColumn("count", 0)}, {{"mean", mean_func}});
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  AggOperatorMgr mgr;
+  EXPECT_TRUE(mgr.Matches(agg));
+  agg->SetStreamingWindow("count", 10, 0);
+  EXPECT_FALSE(mgr.Matches(agg));
+}
 }  // namespace distributed
 }  // namespace planner
 }  // namespace carnot
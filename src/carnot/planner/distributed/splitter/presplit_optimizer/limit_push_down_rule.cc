@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/limit_push_down_rule.h"
 #include "src/carnot/planner/distributed/splitter/executor_utils.h"
 
@@ -59,6 +61,20 @@ StatusOr<absl::flat_hash_set<OperatorIR*>> LimitPushdownRule::NewLimitParents(
   return absl::flat_hash_set<OperatorIR*>{current_node};
 }
 
+StatusOr<bool> LimitPushdownRule::FoldIntoSort(LimitIR* limit, SortIR* sort) {
+  int64_t limit_value = limit->limit_value();
+  if (sort->has_limit()) {
+    limit_value = std::min(limit_value, sort->limit());
+  }
+  sort->SetLimit(limit_value);
+  for (OperatorIR* child : limit->Children()) {
+    PX_RETURN_IF_ERROR(child->ReplaceParent(limit, sort));
+  }
+  PX_RETURN_IF_ERROR(limit->RemoveParent(sort));
+  PX_RETURN_IF_ERROR(sort->graph()->DeleteNode(limit->id()));
+  return true;
+}
+
 StatusOr<bool> LimitPushdownRule::Apply(IRNode* ir_node) {
   if (!Match(ir_node, Limit())) {
     return false;
@@ -70,6 +86,14 @@ StatusOr<bool> LimitPushdownRule::Apply(IRNode* ir_node) {
   DCHECK_EQ(1U, limit->parents().size());
   OperatorIR* limit_parent = limit->parents()[0];
 
+  // A limit directly after a sort turns the sort into a top-k, which can then be split so that
+  // every agent only sends its own top rows. A sort limit of 0 means "no limit", so head(0) stays a
+  // separate Limit.
+  if (Match(limit_parent, Sort()) && !limit->pem_only() && limit->limit_value() > 0 &&
+      limit_parent->Children().size() == 1) {
+    return FoldIntoSort(limit, static_cast<SortIR*>(limit_parent));
+  }
+
   PX_ASSIGN_OR_RETURN(auto new_parents, NewLimitParents(limit_parent));
   // If we don't push the limit up at all, just return.
   if (new_parents.size() == 1 && new_parents.find(limit_parent) != new_parents.end()) {
@@ -29,7 +29,7 @@ namespace distributed {
 
 /**
  * @brief This rule pushes limits as early in the IR as possible, without pushing them
- * past PEM-only operators.
+ * past PEM-only operators. Limits that directly follow a sort are folded into the sort.
  */
 class LimitPushdownRule : public Rule {
  public:
@@ -41,6 +41,8 @@ class LimitPushdownRule : public Rule {
 
  private:
   StatusOr<absl::flat_hash_set<OperatorIR*>> NewLimitParents(OperatorIR* current_node);
+  // Sets the limit on the sort that is the only parent of the limit, and removes the limit.
+  StatusOr<bool> FoldIntoSort(LimitIR* limit, SortIR* sort);
 };
 
 }  // namespace distributed
@@ -161,6 +161,74 @@ TEST_F(LimitPushdownRuleTest, multi_branch_union) {
   EXPECT_THAT(*new_limit2->resolved_table_type(), IsTableType(relation2));
 }
 
+TEST_F(LimitPushdownRuleTest, fold_into_sort) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+  SortIR* sort = MakeSort(src, {"xyz"}, {false});
+  MapIR* map = MakeMap(sort, {{"def", MakeColumn("abc", 0)}}, false);
+  MemorySinkIR* sink = MakeMemSink(MakeLimit(map, 10), "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  LimitPushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  // The limit is pushed above the map and then folded into the sort.
+  EXPECT_EQ(0, graph->FindNodesThatMatch(Limit()).size());
+  EXPECT_EQ(10, sort->limit());
+  EXPECT_THAT(sink->parents(), ElementsAre(map));
+  EXPECT_THAT(map->parents(), ElementsAre(sort));
+}
+
+TEST_F(LimitPushdownRuleTest, fold_into_sort_keeps_smaller_limit) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+  SortIR* sort = MakeSort(src, {"xyz"}, {true}, 5);
+  MemorySinkIR* sink = MakeMemSink(MakeLimit(sort, 10), "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  LimitPushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  EXPECT_EQ(5, sort->limit());
+  EXPECT_THAT(sink->parents(), ElementsAre(sort));
+}
+
+TEST_F(LimitPushdownRuleTest, zero_limit_not_folded_into_sort) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+  SortIR* sort = MakeSort(src, {"xyz"}, {true}, 5);
+  LimitIR* limit = MakeLimit(sort, 0);
+  MemorySinkIR* sink = MakeMemSink(limit, "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  LimitPushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+
+  // head(0) must still return no rows, so it can't become the sort's "no limit" of 0.
+  EXPECT_EQ(5, sort->limit());
+  EXPECT_THAT(sink->parents(), ElementsAre(limit));
+  EXPECT_THAT(limit->parents(), ElementsAre(sort));
+  EXPECT_EQ(0, limit->limit_value());
+}
+
 }  // namespace distributed
 }  // namespace planner
 }  // namespace carnot
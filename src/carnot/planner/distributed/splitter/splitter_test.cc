@@ -280,6 +280,70 @@ TEST_F(SplitterTest, limit_test_pem_only) {
   EXPECT_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
 }
 
+TEST_F(SplitterTest, top_k_sort_test) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto sort = MakeSort(mem_src, {"cpu0"}, {false}, 10);
+  auto sink = MakeMemSink(sort, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+
+  // Every agent keeps its own top k rows.
+  MemorySourceIR* new_mem_src = GetEquivalentInNewPlan(before_blocking, mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL) << new_mem_src->ChildrenDebugString();
+  OperatorIR* mem_src_child = new_mem_src->Children()[0];
+  ASSERT_MATCH(mem_src_child, Sort());
+  SortIR* prepare_sort = static_cast<SortIR*>(mem_src_child);
+  EXPECT_EQ(prepare_sort->limit(), 10);
+  EXPECT_THAT(prepare_sort->sort_cols(), ElementsAre("cpu0"));
+  ASSERT_EQ(prepare_sort->Children().size(), 1UL);
+  ASSERT_MATCH(prepare_sort->Children()[0], GRPCSink());
+  GRPCSinkIR* grpc_sink = static_cast<GRPCSinkIR*>(prepare_sort->Children()[0]);
+
+  // The Kelvin merges the top rows of every agent.
+  OperatorIR* sink_parent = GetEquivalentInNewPlan(after_blocking, sink)->parents()[0];
+  ASSERT_MATCH(sink_parent, Sort());
+  SortIR* merge_sort = static_cast<SortIR*>(sink_parent);
+  EXPECT_EQ(merge_sort->limit(), 10);
+  ASSERT_MATCH(merge_sort->parents()[0], GRPCSourceGroup());
+  GRPCSourceGroupIR* grpc_source_group = static_cast<GRPCSourceGroupIR*>(merge_sort->parents()[0]);
+
+  EXPECT_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
+}
+
+TEST_F(SplitterTest, full_sort_runs_on_kelvin) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto sort = MakeSort(mem_src, {"cpu0"}, {true});
+  auto sink = MakeMemSink(sort, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  MemorySourceIR* new_mem_src = GetEquivalentInNewPlan(split_plan->before_blocking.get(), mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL) << new_mem_src->ChildrenDebugString();
+  EXPECT_MATCH(new_mem_src->Children()[0], GRPCSink());
+
+  OperatorIR* sink_parent =
+      GetEquivalentInNewPlan(split_plan->after_blocking.get(), sink)->parents()[0];
+  ASSERT_MATCH(sink_parent, Sort());
+  EXPECT_MATCH(sink_parent->parents()[0], GRPCSourceGroup());
+}
+
 TEST_F(SplitterTest, sink_only_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto map1 = MakeMap(mem_src, {{"cpu0", MakeColumn("cpu0", 0)}, {"cpu1", MakeColumn("cpu1", 0)}});
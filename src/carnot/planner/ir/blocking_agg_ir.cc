@@ -16,6 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <vector>
+
 #include "src/carnot/planner/ir/blocking_agg_ir.h"
 #include "src/carnot/planner/ir/func_ir.h"
 #include "src/carnot/planner/ir/ir.h"
@@ -139,6 +142,21 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
 
+  if (has_streaming_window()) {
+    std::vector<ColumnIR*> groups = this->groups();
+    auto window_it = std::find_if(groups.begin(), groups.end(), [this](const ColumnIR* group) {
+      return group->col_name() == window_col_;
+    });
+    if (window_it == groups.end()) {
+      return CreateIRNodeError("Streaming window column '$0' is not a group of the aggregate",
+                               window_col_);
+    }
+    auto window_pb = pb->mutable_streaming_window();
+    window_pb->set_group_index(std::distance(groups.begin(), window_it));
+    window_pb->set_size_ns(window_size_ns_);
+    window_pb->set_allowed_lateness_ns(allowed_lateness_ns_);
+  }
+
   op->set_op_type(planpb::AGGREGATE_OPERATOR);
   return Status::OK();
 }
@@ -166,6 +184,9 @@ Status BlockingAggIR::CopyFromNodeImpl(
   finalize_results_ = blocking_agg->finalize_results_;
   partial_agg_ = blocking_agg->partial_agg_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
+  window_col_ = blocking_agg->window_col_;
+  window_size_ns_ = blocking_agg->window_size_ns_;
+  allowed_lateness_ns_ = blocking_agg->allowed_lateness_ns_;
 
   return Status::OK();
 }
@@ -74,6 +74,22 @@ class BlockingAggIR : public GroupAcceptorIR {
   void SetPreSplitProto(const planpb::AggregateOperator& pre_split_proto) {
     pre_split_proto_ = pre_split_proto;
   }
+
+  /**
+   * @brief Makes this a streaming window aggregate, which emits the groups of each window as soon
+   * as the watermark passes it. The group named window_col must hold the start of the window of
+   * each row.
+   */
+  void SetStreamingWindow(const std::string& window_col, int64_t window_size_ns,
+                          int64_t allowed_lateness_ns) {
+    window_col_ = window_col;
+    window_size_ns_ = window_size_ns;
+    allowed_lateness_ns_ = allowed_lateness_ns;
+  }
+  bool has_streaming_window() const { return window_size_ns_ > 0; }
+  const std::string& window_col() const { return window_col_; }
+  int64_t window_size_ns() const { return window_size_ns_; }
+  int64_t allowed_lateness_ns() const { return allowed_lateness_ns_; }
   std::string DebugString() const override;
 
  protected:
@@ -88,6 +104,10 @@ class BlockingAggIR : public GroupAcceptorIR {
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
   planpb::AggregateOperator pre_split_proto_;
+  // Set for streaming window aggregates, see SetStreamingWindow().
+  std::string window_col_;
+  int64_t window_size_ns_ = 0;
+  int64_t allowed_lateness_ns_ = 0;
 };
 }  // namespace planner
 }  // namespace carnot
@@ -29,6 +29,7 @@ Status GRPCSinkIR::CopyFromNodeImpl(const IRNode* node,
   destination_id_ = grpc_sink->destination_id_;
   destination_address_ = grpc_sink->destination_address_;
   destination_ssl_targetname_ = grpc_sink->destination_ssl_targetname_;
+  agent_id_to_destination_address_ = grpc_sink->agent_id_to_destination_address_;
   name_ = grpc_sink->name_;
   out_columns_ = grpc_sink->out_columns_;
   return Status::OK();
@@ -56,8 +57,14 @@ Status GRPCSinkIR::ToProto(planpb::Operator* op) const {
 Status GRPCSinkIR::ToProto(planpb::Operator* op, int64_t agent_id) const {
   auto pb = op->mutable_grpc_sink_op();
   op->set_op_type(planpb::GRPC_SINK_OPERATOR);
-  pb->set_address(destination_address());
-  pb->mutable_connection_options()->set_ssl_targetname(destination_ssl_targetname());
+  auto address_it = agent_id_to_destination_address_.find(agent_id);
+  if (address_it != agent_id_to_destination_address_.end()) {
+    pb->set_address(address_it->second.first);
+    pb->mutable_connection_options()->set_ssl_targetname(address_it->second.second);
+  } else {
+    pb->set_address(destination_address());
+    pb->mutable_connection_options()->set_ssl_targetname(destination_ssl_targetname());
+  }
   if (!agent_id_to_destination_id_.contains(agent_id)) {
     return CreateIRNodeError("No agent ID '$0' found in grpc sink '$1'", agent_id, DebugString());
   }
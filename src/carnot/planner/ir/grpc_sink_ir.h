@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -110,6 +111,13 @@ class GRPCSinkIR : public OperatorIR {
     destination_ssl_targetname_ = ssl_targetname;
   }
 
+  // Overrides the destination address for a single agent. Plans are shared between agents, and
+  // the agents that share a plan can send their results to different nodes.
+  void AddDestinationAddressMap(int64_t agent_id, const std::string& address,
+                                const std::string& ssl_targetname) {
+    agent_id_to_destination_address_[agent_id] = {address, ssl_targetname};
+  }
+
   const std::string& destination_address() const { return destination_address_; }
   bool DestinationAddressSet() const { return destination_address_ != ""; }
   const std::string& destination_ssl_targetname() const { return destination_ssl_targetname_; }
@@ -156,6 +164,9 @@ class GRPCSinkIR : public OperatorIR {
   std::string name_;
   std::vector<std::string> out_columns_;
   absl::flat_hash_map<int64_t, int64_t> agent_id_to_destination_id_;
+  // The (address, ssl_targetname) overrides of the destination for each agent.
+  absl::flat_hash_map<int64_t, std::pair<std::string, std::string>>
+      agent_id_to_destination_address_;
 };
 
 }  // namespace planner
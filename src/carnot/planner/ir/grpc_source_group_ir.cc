@@ -60,6 +60,9 @@ Status GRPCSourceGroupIR::AddGRPCSink(GRPCSinkIR* sink_op,
   }
   sink_op->SetDestinationAddress(grpc_address_);
   sink_op->SetDestinationSSLTargetName(ssl_targetname_);
+  for (int64_t agent : agents) {
+    sink_op->AddDestinationAddressMap(agent, grpc_address_, ssl_targetname_);
+  }
   dependent_sinks_.emplace_back(sink_op, agents);
   return Status::OK();
 }
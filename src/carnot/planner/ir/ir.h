@@ -262,6 +262,9 @@ class IR {
     return os << "ir";
   }
 
+  // The id that the next node created in the graph will get. Ids are never reused.
+  int64_t next_node_id() const { return id_node_counter; }
+
  private:
   Status OutputProto(planpb::PlanFragment* pf, const OperatorIR* op_node, int64_t agent_id) const;
   // Helper function for Clone and CopySelectedOperators.
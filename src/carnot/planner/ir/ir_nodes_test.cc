@@ -472,6 +472,50 @@ TEST_F(ToProtoTest, agg_ir_with_presplit_proto) {
   EXPECT_THAT(cloned_pb, EqualsProto(kExpectedAggPb));
 }
 
+TEST_F(ToProtoTest, streaming_window_agg_ir) {
+  auto mem_src = graph
+                     ->CreateNode<MemorySourceIR>(
+                         ast, "source", std::vector<std::string>{"time_", "group1", "column"})
+                     .ValueOrDie();
+  table_store::schema::Relation rel({types::TIME64NS, types::INT64, types::INT64},
+                                    {"time_", "group1", "column"});
+  compiler_state_->relation_map()->emplace("source", rel);
+  auto col = graph->CreateNode<ColumnIR>(ast, "column", /*parent_op_idx*/ 0).ValueOrDie();
+  auto agg_func = graph
+                      ->CreateNode<FuncIR>(ast, FuncIR::Op{FuncIR::Opcode::non_op, "", "mean"},
+                                           std::vector<ExpressionIR*>{col})
+                      .ValueOrDie();
+  EXPECT_OK(AddUDAToRegistry("mean", types::INT64, {types::INT64}));
+  auto group1 = graph->CreateNode<ColumnIR>(ast, "group1", /*parent_op_idx*/ 0).ValueOrDie();
+  auto window = graph->CreateNode<ColumnIR>(ast, "time_", /*parent_op_idx*/ 0).ValueOrDie();
+
+  auto agg = graph
+                 ->CreateNode<BlockingAggIR>(ast, mem_src, std::vector<ColumnIR*>{group1, window},
+                                             ColExpressionVector{{"mean", agg_func}})
+                 .ValueOrDie();
+  agg->SetStreamingWindow("time_", 1000, 10);
+
+  ASSERT_OK(ResolveOperatorType(mem_src, compiler_state_.get()));
+  ASSERT_OK(ResolveOperatorType(agg, compiler_state_.get()));
+
+  planpb::Operator pb;
+  ASSERT_OK(agg->ToProto(&pb));
+  ASSERT_TRUE(pb.agg_op().has_streaming_window());
+  EXPECT_EQ(1, pb.agg_op().streaming_window().group_index());
+  EXPECT_EQ(1000, pb.agg_op().streaming_window().size_ns());
+  EXPECT_EQ(0, pb.agg_op().streaming_window().slide_ns());
+  EXPECT_EQ(10, pb.agg_op().streaming_window().allowed_lateness_ns());
+
+  ASSERT_OK_AND_ASSIGN(BlockingAggIR * cloned_agg, graph->CopyNode(agg));
+  EXPECT_TRUE(cloned_agg->has_streaming_window());
+  EXPECT_EQ("time_", cloned_agg->window_col());
+
+  // The window column must be one of the groups.
+  agg->SetStreamingWindow("window", 1000, 10);
+  planpb::Operator bad_pb;
+  EXPECT_NOT_OK(agg->ToProto(&bad_pb));
+}
+
 constexpr char kExpectedLimitPb[] = R"(
   op_type: LIMIT_OPERATOR
   limit_op {
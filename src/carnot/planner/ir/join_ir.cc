@@ -52,6 +52,7 @@ Status JoinIR::CopyFromNodeImpl(const IRNode* node,
 
   PX_RETURN_IF_ERROR(SetJoinColumns(new_left_columns, new_right_columns));
   suffix_strs_ = join_node->suffix_strs_;
+  build_side_ = join_node->build_side_;
   return Status::OK();
 }
 
@@ -112,6 +113,7 @@ Status JoinIR::ToProto(planpb::Operator* op) const {
   for (const auto& col_name : column_names_) {
     *(pb->add_column_names()) = col_name;
   }
+  pb->set_build_side(build_side_);
   // NOTE: not setting value as this is set in the execution engine. Keeping this here in case it
   // needs to be modified in the future.
   // pb->set_rows_per_batch(1024);
@@ -90,6 +90,10 @@ class JoinIR : public OperatorIR {
                           const std::vector<ColumnIR*>& columns);
   bool specified_as_right() const { return specified_as_right_; }
 
+  // The parent to build the hash table from, relative to the current order of the parents.
+  planpb::JoinOperator::BuildSide build_side() const { return build_side_; }
+  void SetBuildSide(planpb::JoinOperator::BuildSide build_side) { build_side_ = build_side; }
+
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
 
   const std::tuple<std::shared_ptr<TableType>, std::shared_ptr<TableType>> left_right_table_types()
@@ -161,6 +165,7 @@ class JoinIR : public OperatorIR {
   // Whether this join was originally specified as a right join.
   // Used because we transform left joins into right joins but need to do some back transform.
   bool specified_as_right_ = false;
+  planpb::JoinOperator::BuildSide build_side_ = planpb::JoinOperator::BUILD_DEFAULT;
 };
 
 }  // namespace planner
@@ -102,6 +102,8 @@ Status MemorySourceIR::CopyFromNodeImpl(const IRNode* node,
   table_name_ = source_ir->table_name_;
   time_start_ns_ = source_ir->time_start_ns_;
   time_stop_ns_ = source_ir->time_stop_ns_;
+  time_start_relative_ = source_ir->time_start_relative_;
+  time_stop_relative_ = source_ir->time_stop_relative_;
   column_names_ = source_ir->column_names_;
   column_index_map_set_ = source_ir->column_index_map_set_;
   column_index_map_ = source_ir->column_index_map_;
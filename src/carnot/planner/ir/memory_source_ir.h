@@ -71,6 +71,12 @@ class MemorySourceIR : public OperatorIR {
   int64_t time_start_ns() const { return time_start_ns_.value(); }
   int64_t time_stop_ns() const { return time_stop_ns_.value(); }
 
+  // Whether the start and stop times were specified relative to the compile time, e.g. '-5m'.
+  void SetTimeStartRelative(bool relative) { time_start_relative_ = relative; }
+  void SetTimeStopRelative(bool relative) { time_stop_relative_ = relative; }
+  bool time_start_relative() const { return time_start_relative_; }
+  bool time_stop_relative() const { return time_stop_relative_; }
+
   const std::vector<int64_t>& column_index_map() const { return column_index_map_; }
   bool column_index_map_set() const { return column_index_map_set_; }
   void SetColumnIndexMap(const std::vector<int64_t>& column_index_map) {
@@ -116,6 +122,8 @@ class MemorySourceIR : public OperatorIR {
 
   std::optional<int64_t> time_start_ns_;
   std::optional<int64_t> time_stop_ns_;
+  bool time_start_relative_ = false;
+  bool time_stop_relative_ = false;
 
   // Hold of columns in the order that they are selected.
   std::vector<std::string> column_names_;
@@ -25,6 +25,7 @@ PX_CARNOT_IR_NODE(Drop)
 PX_CARNOT_IR_NODE(BlockingAgg)
 PX_CARNOT_IR_NODE(Filter)
 PX_CARNOT_IR_NODE(Limit)
+PX_CARNOT_IR_NODE(Sort)
 PX_CARNOT_IR_NODE(GRPCSourceGroup)
 PX_CARNOT_IR_NODE(GRPCSource)
 PX_CARNOT_IR_NODE(GRPCSink)
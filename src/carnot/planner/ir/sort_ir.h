@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/operator_ir.h"
+#include "src/carnot/planner/types/types.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief The SortIR orders the rows of its parent by one or more columns. If the limit is set,
+ * only the first limit rows of the ordering are kept, which lets the sort be split into a partial
+ * top-k on every agent and a merging top-k on the Kelvin.
+ */
+class SortIR : public OperatorIR {
+ public:
+  SortIR() = delete;
+  explicit SortIR(int64_t id) : OperatorIR(id, IRNodeType::kSort) {}
+
+  Status Init(OperatorIR* parent, const std::vector<std::string>& sort_cols,
+              const std::vector<bool>& ascending, int64_t limit = 0);
+
+  Status ToProto(planpb::Operator*) const override;
+
+  const std::vector<std::string>& sort_cols() const { return sort_cols_; }
+  const std::vector<bool>& ascending() const { return ascending_; }
+
+  // A limit of 0 means that all of the rows are kept.
+  int64_t limit() const { return limit_; }
+  bool has_limit() const { return limit_ > 0; }
+  void SetLimit(int64_t limit) { limit_ = limit; }
+
+  Status CopyFromNodeImpl(const IRNode* node,
+                          absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
+  inline bool IsBlocking() const override { return true; }
+
+  StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
+
+  Status ResolveType(CompilerState* compiler_state);
+
+ protected:
+  StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
+      const absl::flat_hash_set<std::string>& output_cols) override {
+    return output_cols;
+  }
+
+ private:
+  std::vector<std::string> sort_cols_;
+  // Whether each of the sort columns is ordered ascending.
+  std::vector<bool> ascending_;
+  int64_t limit_ = 0;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
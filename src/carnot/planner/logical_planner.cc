@@ -24,6 +24,7 @@
 #include "src/carnot/planner/ir/ast_utils.h"
 #include "src/carnot/planner/otel_generator/otel_generator.h"
 #include "src/carnot/planner/parser/parser.h"
+#include "src/common/metrics/metrics.h"
 #include "src/shared/scriptspb/scripts.pb.h"
 
 namespace px {
@@ -118,6 +119,8 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
   compiler_ = compiler::Compiler();
   registry_info_ = std::make_unique<planner::RegistryInfo>();
   PX_RETURN_IF_ERROR(registry_info_->Init(udf_info));
+  registry_version_ = ProtoFingerprint(udf_info);
+  plan_cache_ = std::make_unique<PlanCache>(&GetMetricsRegistry(), FLAGS_planner_plan_cache_size);
 
   PX_ASSIGN_OR_RETURN(distributed_planner_, distributed::DistributedPlanner::Create());
   return Status::OK();
@@ -132,23 +135,50 @@ StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
   PX_ASSIGN_OR_RETURN(
       std::unique_ptr<CompilerState> compiler_state,
       CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  return PlanWithCompilerState(query_request, compiler_state.get());
+}
 
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::PlanWithCompilerState(
+    const plannerpb::QueryRequest& query_request, CompilerState* compiler_state) {
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
-  PX_ASSIGN_OR_RETURN(
-      std::shared_ptr<IR> single_node_plan,
-      compiler_.CompileToIR(query_request.query_str(), compiler_state.get(), exec_funcs));
+  PX_ASSIGN_OR_RETURN(std::shared_ptr<IR> single_node_plan,
+                      compiler_.CompileToIR(query_request.query_str(), compiler_state, exec_funcs));
   // Create the distributed plan.
   PX_ASSIGN_OR_RETURN(
       auto distributed_plan,
       distributed_planner_->Plan(query_request.logical_planner_state().distributed_state(),
-                                 compiler_state.get(), single_node_plan.get()));
+                                 compiler_state, single_node_plan.get()));
   distributed_plan->SetExecutionCompleteAddress(
       query_request.logical_planner_state().result_address(),
       query_request.logical_planner_state().result_ssl_targetname());
   return distributed_plan;
 }
 
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanToProto(
+    const plannerpb::QueryRequest& query_request) {
+  PlanCacheKey key = PlanCache::MakeKey(query_request, registry_version_);
+  auto cached_plan = plan_cache_->Lookup(key, px::CurrentTimeNS());
+  if (cached_plan.has_value()) {
+    return std::move(cached_plan.value());
+  }
+
+  const auto& logical_state = query_request.logical_planner_state();
+  auto ms = logical_state.plan_options().max_output_rows_per_table();
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<CompilerState> compiler_state,
+                      CreateCompilerState(logical_state, registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(auto distributed_plan,
+                      PlanWithCompilerState(query_request, compiler_state.get()));
+  distributed_plan->SetPlanOptions(logical_state.plan_options());
+  PX_ASSIGN_OR_RETURN(distributedpb::DistributedPlan plan_pb, distributed_plan->ToProto());
+  // Plans that hold values computed from the compile time, e.g. px.now(), can't be rebound.
+  if (!compiler_state->time_now_baked_in()) {
+    plan_cache_->Insert(key, plan_pb, compiler_state->time_now().val,
+                        RelativeTimeBindings(*distributed_plan));
+  }
+  return plan_pb;
+}
+
 StatusOr<std::unique_ptr<compiler::MutationsIR>> LogicalPlanner::CompileTrace(
     const plannerpb::CompileMutationsRequest& mutations_req) {
   // Compile into the IR.
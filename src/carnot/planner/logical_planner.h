@@ -25,6 +25,7 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/service.pb.h"
 #include "src/carnot/planner/probes/probes.h"
 #include "src/shared/scriptspb/scripts.pb.h"
@@ -57,6 +58,16 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query and returns the proto of the distributed plan, with the plan options of
+   * the logical planner state set. Plans are reused from the plan cache when the same script is
+   * planned again against the same state.
+   *
+   * @param query: QueryRequest
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanToProto(const plannerpb::QueryRequest& query);
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -66,6 +77,8 @@ class LogicalPlanner : public NotCopyable {
   Status Init(std::unique_ptr<planner::RegistryInfo> registry_info);
   Status Init(const udfspb::UDFInfo& udf_info);
 
+  PlanCache* plan_cache() const { return plan_cache_.get(); }
+
  protected:
   LogicalPlanner() {}
 
@@ -73,6 +86,12 @@ class LogicalPlanner : public NotCopyable {
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  // Fingerprint of the UDFInfo the registry was initialized with.
+  uint64_t registry_version_ = 0;
+  std::unique_ptr<PlanCache> plan_cache_;
+
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> PlanWithCompilerState(
+      const plannerpb::QueryRequest& query_request, CompilerState* compiler_state);
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
@@ -43,7 +43,24 @@ void BM_Query(benchmark::State& state) {
   }
 }
 
+// Plans the same script repeatedly through the plan cache, as dashboards and export scripts do.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryCached(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanToProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+  state.counters["cache_hits"] = planner->plan_cache()->hits();
+}
+
 BENCHMARK(BM_Query);
+BENCHMARK(BM_QueryCached);
 
 }  // namespace logical_planner
 }  // namespace planner
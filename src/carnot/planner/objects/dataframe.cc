@@ -99,6 +99,13 @@ StatusOr<std::vector<std::string>> ParseAsListOfStrings(QLObjectPtr obj,
   return strs;
 }
 
+// Whether the time argument is a duration relative to the time the query is compiled at, such as
+// "-5m". Absolute time strings are not.
+bool IsRelativeTime(ExpressionIR* time_expr) {
+  return Match(time_expr, String()) &&
+         ParseDurationFmt(static_cast<StringIR*>(time_expr), /*time_now*/ 0).ok();
+}
+
 /**
  * @brief Implements the DataFrame() constructor logic.
  */
@@ -117,12 +124,14 @@ StatusOr<QLObjectPtr> DataFrameConstructor(CompilerState* compiler_state, IR* gr
     PX_ASSIGN_OR_RETURN(auto start_time_ns,
                         ParseAllTimeFormats(compiler_state->time_now().val, start_time));
     mem_source_op->SetTimeStartNS(start_time_ns);
+    mem_source_op->SetTimeStartRelative(IsRelativeTime(start_time));
   }
   if (!NoneObject::IsNoneObject(args.GetArg("end_time"))) {
     PX_ASSIGN_OR_RETURN(ExpressionIR * end_time, GetArgAs<ExpressionIR>(ast, args, "end_time"));
     PX_ASSIGN_OR_RETURN(auto end_time_ns,
                         ParseAllTimeFormats(compiler_state->time_now().val, end_time));
     mem_source_op->SetTimeStopNS(end_time_ns);
+    mem_source_op->SetTimeStopRelative(IsRelativeTime(end_time));
   }
   return Dataframe::Create(compiler_state, mem_source_op, visitor);
 }
@@ -270,6 +279,33 @@ StatusOr<QLObjectPtr> LimitHandler(CompilerState* compiler_state, IR* graph, Ope
   return Dataframe::Create(compiler_state, limit_op, visitor);
 }
 
+// Handles the sort_values() DataFrame logic.
+StatusOr<QLObjectPtr> SortHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  PX_ASSIGN_OR_RETURN(std::vector<std::string> sort_cols,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  QLObjectPtr ascending_arg = args.GetArg("ascending");
+  PX_ASSIGN_OR_RETURN(std::vector<BoolIR*> ascending_irs,
+                      ParseAsListOf<BoolIR>(ascending_arg, "ascending"));
+  std::vector<bool> ascending;
+  if (!CollectionObject::IsCollection(ascending_arg)) {
+    // A single direction applies to all of the sort columns.
+    ascending.assign(sort_cols.size(), ascending_irs[0]->val());
+  } else {
+    for (BoolIR* ascending_ir : ascending_irs) {
+      ascending.push_back(ascending_ir->val());
+    }
+  }
+  if (ascending.size() != sort_cols.size()) {
+    return CreateAstError(ast, "Length of 'ascending' ($0) must match length of 'by' ($1)",
+                          ascending.size(), sort_cols.size());
+  }
+
+  PX_ASSIGN_OR_RETURN(SortIR * sort_op, graph->CreateNode<SortIR>(ast, op, sort_cols, ascending));
+  return Dataframe::Create(compiler_state, sort_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -515,6 +551,23 @@ Status Dataframe::Init() {
   PX_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort_values(self, by, ascending=True):
+   *     ...
+   */
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(
+          kSortOpID, {"by", "ascending"}, {{"ascending", "True"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&SortHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PX_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
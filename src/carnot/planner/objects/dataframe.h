@@ -281,6 +281,31 @@ class Dataframe : public QLObject {
     px.DataFrame: DataFrame with the first n rows.
   )doc";
 
+  inline static constexpr char kSortOpID[] = "sort_values";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sorts the rows by the values of one or more columns.
+
+  Returns a DataFrame ordered by the first column in `by`, with ties broken by the following
+  columns. A sort followed by `head(n)` only keeps the top n rows, which is computed on every
+  agent before the rows are sent to be merged.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events', start_time='-5m')
+    # Keep the 10 slowest http requests.
+    df = df.sort_values('latency', ascending=False).head(10)
+
+  Args:
+    by (string or List[string]): The column names to sort by.
+    ascending (bool or List[bool], optional): The order of each of the sort columns. A single
+      value applies to all of the columns. Defaults to True.
+
+  Returns:
+    px.DataFrame: DataFrame with the rows in sorted order.
+  )doc";
+
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
   Merges the input DataFrame with this one using a database-style join.
@@ -383,7 +408,8 @@ class Dataframe : public QLObject {
   Groups the data by rolling windows.
 
   Rolls up data into groups based on the rolling window that it belongs to. Used to define
-  window aggregates, the streaming analog of batch aggregates.
+  window aggregates, the streaming analog of batch aggregates. The result of each window is
+  emitted as soon as rows past the end of the window arrive, rather than when the query ends.
 
   Examples:
     df = px.DataFrame('process_stats')
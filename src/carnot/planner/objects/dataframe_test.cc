@@ -167,6 +167,35 @@ TEST_F(DataframeTest, Drop_ErrorIfNotString) {
               HasCompilerError("Expected arg.*as type 'String', received 'Int"));
 }
 
+TEST_F(DataframeTest, Sort_SingleDirection) {
+  ASSERT_OK(ParseScript(var_table, "sorted = df.sort_values(['foo', 'bar'], ascending=False)"));
+  auto var = var_table->Lookup("sorted");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto df_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(df_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(df_obj->op());
+  EXPECT_EQ(sort->sort_cols(), std::vector<std::string>({"foo", "bar"}));
+  EXPECT_EQ(sort->ascending(), std::vector<bool>({false, false}));
+  EXPECT_FALSE(sort->has_limit());
+}
+
+TEST_F(DataframeTest, Sort_DirectionPerColumn) {
+  ASSERT_OK(ParseScript(var_table, "sorted = df.sort_values(['foo', 'bar'], [True, False])"));
+  auto var = var_table->Lookup("sorted");
+  auto df_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(df_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(df_obj->op());
+  EXPECT_EQ(sort->ascending(), std::vector<bool>({true, false}));
+}
+
+TEST_F(DataframeTest, Sort_ErrorIfDirectionsMismatch) {
+  EXPECT_THAT(
+      ParseScript(var_table, "df.sort_values(['foo', 'bar'], [True])"),
+      HasCompilerError("Length of 'ascending' \\(1\\) must match length of 'by' \\(2\\)"));
+}
+
 TEST_F(DataframeTest, Agg) {
   std::string script = R"pxl(agg = df.agg(
   outcol1=('col1', mean),
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/hash/hash.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "src/carnot/planner/ir/memory_source_ir.h"
+
+DEFINE_int64(planner_plan_cache_size, gflags::Int64FromEnv("PL_PLANNER_PLAN_CACHE_SIZE", 64),
+             "The number of compiled plans that the planner keeps for reuse. 0 disables the "
+             "cache.");
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+uint64_t ProtoFingerprint(const google::protobuf::Message& msg) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    // Map fields are otherwise serialized in an unspecified order.
+    coded_stream.SetSerializationDeterministic(true);
+    msg.SerializeToCodedStream(&coded_stream);
+  }
+  return absl::Hash<std::string>{}(serialized);
+}
+
+std::vector<RelativeTimeBinding> RelativeTimeBindings(const distributed::DistributedPlan& plan) {
+  std::vector<RelativeTimeBinding> bindings;
+  for (int64_t carnot_id : plan.dag().nodes()) {
+    distributed::CarnotInstance* carnot = plan.Get(carnot_id);
+    if (carnot->plan() == nullptr) {
+      continue;
+    }
+    for (IRNode* node : carnot->plan()->FindNodesThatMatch(MemorySource())) {
+      auto mem_src = static_cast<MemorySourceIR*>(node);
+      bool start_time = mem_src->IsTimeStartSet() && mem_src->time_start_relative();
+      bool stop_time = mem_src->IsTimeStopSet() && mem_src->time_stop_relative();
+      if (start_time || stop_time) {
+        bindings.push_back({carnot->QueryBrokerAddress(), mem_src->id(), start_time, stop_time});
+      }
+    }
+  }
+  return bindings;
+}
+
+PlanCache::PlanCache(prometheus::Registry* registry, int64_t capacity)
+    : capacity_(capacity),
+      hits_counter_(prometheus::BuildCounter()
+                        .Name("planner_plan_cache_lookups")
+                        .Help("Total number of plan cache lookups by whether the plan was cached")
+                        .Register(*registry)
+                        .Add({{"result", "hit"}})),
+      misses_counter_(
+          prometheus::BuildCounter()
+              .Name("planner_plan_cache_lookups")
+              .Help("Total number of plan cache lookups by whether the plan was cached")
+              .Register(*registry)
+              .Add({{"result", "miss"}})) {}
+
+PlanCacheKey PlanCache::MakeKey(const plannerpb::QueryRequest& query_request,
+                                uint64_t registry_version) {
+  PlanCacheKey key;
+  key.query_str = query_request.query_str();
+  for (const auto& exec_func : query_request.exec_funcs()) {
+    key.exec_funcs += exec_func.SerializeAsString();
+  }
+  key.registry_version = registry_version;
+  key.state_fingerprint = ProtoFingerprint(query_request.logical_planner_state());
+  return key;
+}
+
+namespace {
+
+void ShiftTime(google::protobuf::Int64Value* time, int64_t delta_ns) {
+  time->set_value(time->value() + delta_ns);
+}
+
+void RebindTimes(distributedpb::DistributedPlan* plan,
+                 const std::vector<RelativeTimeBinding>& bindings, int64_t delta_ns) {
+  auto qb_address_to_plan = plan->mutable_qb_address_to_plan();
+  for (const auto& binding : bindings) {
+    auto plan_it = qb_address_to_plan->find(binding.qb_address);
+    if (plan_it == qb_address_to_plan->end()) {
+      continue;
+    }
+    for (auto& fragment : *plan_it->second.mutable_nodes()) {
+      for (auto& node : *fragment.mutable_nodes()) {
+        if (static_cast<int64_t>(node.id()) != binding.node_id ||
+            !node.op().has_mem_source_op()) {
+          continue;
+        }
+        auto mem_src = node.mutable_op()->mutable_mem_source_op();
+        if (binding.start_time) {
+          ShiftTime(mem_src->mutable_start_time(), delta_ns);
+        }
+        if (binding.stop_time) {
+          ShiftTime(mem_src->mutable_stop_time(), delta_ns);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+std::optional<distributedpb::DistributedPlan> PlanCache::Lookup(const PlanCacheKey& key,
+                                                                int64_t time_now_ns) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    misses_counter_.Increment();
+    return std::nullopt;
+  }
+  ++hits_;
+  hits_counter_.Increment();
+  // Move the entry to the front of the list.
+  entries_.splice(entries_.begin(), entries_, it->second);
+  const Entry& entry = *it->second;
+
+  distributedpb::DistributedPlan plan = entry.plan;
+  RebindTimes(&plan, entry.bindings, time_now_ns - entry.time_now_ns);
+  return plan;
+}
+
+void PlanCache::Insert(const PlanCacheKey& key, distributedpb::DistributedPlan plan,
+                       int64_t time_now_ns, std::vector<RelativeTimeBinding> bindings) {
+  if (capacity_ <= 0) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front({key, std::move(plan), time_now_ns, std::move(bindings)});
+  index_[key] = entries_.begin();
+  while (static_cast<int64_t>(entries_.size()) > capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+void PlanCache::Clear() {
+  absl::MutexLock lock(&mu_);
+  index_.clear();
+  entries_.clear();
+}
+
+int64_t PlanCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+int64_t PlanCache::hits() const {
+  absl::MutexLock lock(&mu_);
+  return hits_;
+}
+
+int64_t PlanCache::misses() const {
+  absl::MutexLock lock(&mu_);
+  return misses_;
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
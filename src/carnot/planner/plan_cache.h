@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <prometheus/counter.h>
+#include <prometheus/registry.h>
+
+#include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/service.pb.h"
+#include "src/common/base/base.h"
+
+DECLARE_int64(planner_plan_cache_size);
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief Identifies the compiled plan of a query. Plans only depend on the script, the functions
+ * it executes, the registered UDFs and the logical planner state, i.e. the schemas and the agents
+ * that the plan is distributed over.
+ */
+struct PlanCacheKey {
+  std::string query_str;
+  // The serialized exec funcs, including their arguments.
+  std::string exec_funcs;
+  uint64_t registry_version = 0;
+  // Fingerprint of the serialized LogicalPlannerState.
+  uint64_t state_fingerprint = 0;
+
+  bool operator==(const PlanCacheKey& other) const {
+    return registry_version == other.registry_version &&
+           state_fingerprint == other.state_fingerprint && query_str == other.query_str &&
+           exec_funcs == other.exec_funcs;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const PlanCacheKey& key) {
+    return H::combine(std::move(h), key.query_str, key.exec_funcs, key.registry_version,
+                      key.state_fingerprint);
+  }
+};
+
+/**
+ * @brief A time of a MemorySource that the script specified relative to the compile time, such
+ * as start_time='-5m', and that has to follow the current time when the plan is reused.
+ */
+struct RelativeTimeBinding {
+  std::string qb_address;
+  int64_t node_id;
+  bool start_time;
+  bool stop_time;
+};
+
+/**
+ * @brief Returns the MemorySource times of the distributed plan that were specified relative to
+ * the compile time.
+ */
+std::vector<RelativeTimeBinding> RelativeTimeBindings(const distributed::DistributedPlan& plan);
+
+/**
+ * @brief PlanCache keeps the most recently used compiled plans, so that scripts that are run
+ * periodically, e.g. by dashboards and export scripts, skip compilation and distributed planning.
+ *
+ * Cached plans are stored with the time they were compiled at. When a plan is reused, the
+ * relative MemorySource times are shifted by the time that passed since it was compiled.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  PlanCache(prometheus::Registry* registry, int64_t capacity);
+
+  static PlanCacheKey MakeKey(const plannerpb::QueryRequest& query_request,
+                              uint64_t registry_version);
+
+  /**
+   * @brief Returns the cached plan for the key, with its relative times rebound to time_now_ns,
+   * or std::nullopt if the plan is not cached.
+   */
+  std::optional<distributedpb::DistributedPlan> Lookup(const PlanCacheKey& key,
+                                                       int64_t time_now_ns);
+
+  void Insert(const PlanCacheKey& key, distributedpb::DistributedPlan plan, int64_t time_now_ns,
+              std::vector<RelativeTimeBinding> bindings);
+
+  void Clear();
+
+  int64_t size() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Entry {
+    PlanCacheKey key;
+    distributedpb::DistributedPlan plan;
+    int64_t time_now_ns;
+    std::vector<RelativeTimeBinding> bindings;
+  };
+  using EntryList = std::list<Entry>;
+
+  const int64_t capacity_;
+  mutable absl::Mutex mu_;
+  // Ordered from the most to the least recently used.
+  EntryList entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<PlanCacheKey, EntryList::iterator> index_ ABSL_GUARDED_BY(mu_);
+  int64_t hits_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(mu_) = 0;
+
+  prometheus::Counter& hits_counter_;
+  prometheus::Counter& misses_counter_;
+};
+
+/**
+ * @brief Returns a fingerprint of the deterministic serialization of the message.
+ */
+uint64_t ProtoFingerprint(const google::protobuf::Message& msg);
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
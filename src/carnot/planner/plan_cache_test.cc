@@ -0,0 +1,217 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <prometheus/registry.h>
+
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/plan_cache.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/testing/protobuf.h"
+#include "src/common/testing/status.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using ::px::testing::proto::EqualsProto;
+
+constexpr char kMemSourcePlan[] = R"proto(
+qb_address_to_plan {
+  key: "pem"
+  value {
+    nodes {
+      id: 1
+      nodes {
+        id: 3
+        op {
+          op_type: MEMORY_SOURCE_OPERATOR
+          mem_source_op {
+            name: "http_events"
+            start_time { value: 100 }
+            stop_time { value: 200 }
+          }
+        }
+      }
+    }
+  }
+}
+)proto";
+
+PlanCacheKey MakeKey(const std::string& query_str) {
+  PlanCacheKey key;
+  key.query_str = query_str;
+  return key;
+}
+
+class PlanCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kMemSourcePlan, &plan_));
+  }
+  const planpb::MemorySourceOperator& MemSource(const distributedpb::DistributedPlan& plan) {
+    return plan.qb_address_to_plan().at("pem").nodes(0).nodes(0).op().mem_source_op();
+  }
+
+  prometheus::Registry registry_;
+  distributedpb::DistributedPlan plan_;
+};
+
+TEST_F(PlanCacheTest, rebinds_relative_times) {
+  PlanCache cache(&registry_, 8);
+  EXPECT_FALSE(cache.Lookup(MakeKey("script"), 1000).has_value());
+
+  // Only the start time was relative to the compile time.
+  cache.Insert(MakeKey("script"), plan_, /* time_now_ns */ 1000, {{"pem", 3, true, false}});
+  auto cached = cache.Lookup(MakeKey("script"), 1500);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(600, MemSource(cached.value()).start_time().value());
+  EXPECT_EQ(200, MemSource(cached.value()).stop_time().value());
+
+  // The cached plan itself is not modified.
+  cached = cache.Lookup(MakeKey("script"), 1000);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(100, MemSource(cached.value()).start_time().value());
+
+  EXPECT_EQ(2, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+}
+
+TEST_F(PlanCacheTest, evicts_least_recently_used) {
+  PlanCache cache(&registry_, 2);
+  cache.Insert(MakeKey("a"), plan_, 0, {});
+  cache.Insert(MakeKey("b"), plan_, 0, {});
+  // Use "a" so that "b" is the least recently used.
+  EXPECT_TRUE(cache.Lookup(MakeKey("a"), 0).has_value());
+  cache.Insert(MakeKey("c"), plan_, 0, {});
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_TRUE(cache.Lookup(MakeKey("a"), 0).has_value());
+  EXPECT_FALSE(cache.Lookup(MakeKey("b"), 0).has_value());
+  EXPECT_TRUE(cache.Lookup(MakeKey("c"), 0).has_value());
+}
+
+TEST_F(PlanCacheTest, zero_capacity_disables_cache) {
+  PlanCache cache(&registry_, 0);
+  cache.Insert(MakeKey("a"), plan_, 0, {});
+  EXPECT_EQ(0, cache.size());
+  EXPECT_FALSE(cache.Lookup(MakeKey("a"), 0).has_value());
+}
+
+class LogicalPlannerPlanCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+    planner_ = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  }
+  plannerpb::QueryRequest MakeQueryRequest(const std::string& query) {
+    plannerpb::QueryRequest query_request;
+    query_request.set_query_str(query);
+    *query_request.mutable_logical_planner_state() =
+        testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+    return query_request;
+  }
+
+  std::unique_ptr<LogicalPlanner> planner_;
+};
+
+// Clears the MemorySource times, which move with the time the plan is requested at.
+void ClearTimes(distributedpb::DistributedPlan* plan) {
+  for (auto& [address, agent_plan] : *plan->mutable_qb_address_to_plan()) {
+    for (auto& fragment : *agent_plan.mutable_nodes()) {
+      for (auto& node : *fragment.mutable_nodes()) {
+        if (node.op().has_mem_source_op()) {
+          node.mutable_op()->mutable_mem_source_op()->clear_start_time();
+          node.mutable_op()->mutable_mem_source_op()->clear_stop_time();
+        }
+      }
+    }
+  }
+}
+
+TEST_F(LogicalPlannerPlanCacheTest, reuses_plans) {
+  auto query_request = MakeQueryRequest(testutils::kHttpRequestStats);
+  ASSERT_OK_AND_ASSIGN(auto first_plan, planner_->PlanToProto(query_request));
+  ASSERT_OK_AND_ASSIGN(auto second_plan, planner_->PlanToProto(query_request));
+  EXPECT_EQ(1, planner_->plan_cache()->misses());
+  EXPECT_EQ(1, planner_->plan_cache()->hits());
+
+  ClearTimes(&first_plan);
+  ClearTimes(&second_plan);
+  EXPECT_THAT(second_plan, EqualsProto(first_plan.DebugString()));
+}
+
+TEST_F(LogicalPlannerPlanCacheTest, state_changes_miss) {
+  auto query_request = MakeQueryRequest(testutils::kHttpRequestStats);
+  ASSERT_OK(planner_->PlanToProto(query_request));
+  query_request.mutable_logical_planner_state()->mutable_plan_options()->set_explain(true);
+  ASSERT_OK(planner_->PlanToProto(query_request));
+  EXPECT_EQ(2, planner_->plan_cache()->misses());
+  EXPECT_EQ(0, planner_->plan_cache()->hits());
+}
+
+TEST_F(LogicalPlannerPlanCacheTest, now_is_not_cached) {
+  auto query_request = MakeQueryRequest(R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time=px.now())
+px.display(df)
+)pxl");
+  ASSERT_OK(planner_->PlanToProto(query_request));
+  ASSERT_OK(planner_->PlanToProto(query_request));
+  EXPECT_EQ(0, planner_->plan_cache()->size());
+  EXPECT_EQ(0, planner_->plan_cache()->hits());
+}
+
+TEST_F(LogicalPlannerPlanCacheTest, absolute_times_are_not_rebound) {
+  auto query_request = MakeQueryRequest(R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='2020-07-13 18:02:05.00 -0700', end_time='-5m')
+px.display(df)
+)pxl");
+  constexpr int64_t kStartTimeNS = 1594688525000000000;
+  ASSERT_OK(planner_->PlanToProto(query_request));
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  ASSERT_OK_AND_ASSIGN(auto plan, planner_->PlanToProto(query_request));
+  EXPECT_EQ(1, planner_->plan_cache()->hits());
+
+  int num_mem_sources = 0;
+  for (const auto& [address, agent_plan] : plan.qb_address_to_plan()) {
+    for (const auto& fragment : agent_plan.nodes()) {
+      for (const auto& node : fragment.nodes()) {
+        if (node.op().has_mem_source_op()) {
+          ++num_mem_sources;
+          EXPECT_EQ(kStartTimeNS, node.op().mem_source_op().start_time().value());
+        }
+      }
+    }
+  }
+  EXPECT_GT(num_mem_sources, 0);
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
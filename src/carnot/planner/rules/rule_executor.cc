@@ -0,0 +1,23 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/rules/rule_executor.h"
+
+DEFINE_bool(planner_incremental_rules, gflags::BoolFromEnv("PL_PLANNER_INCREMENTAL_RULES", false),
+            "After the first iteration of a rule batch, only revisit the IR nodes around the "
+            "changes made by the previous rules.");
@@ -17,16 +17,23 @@
  */
 
 #pragma once
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 #include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/compilerpb/compiler_status.pb.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/rules/rules.h"
 
+DECLARE_bool(planner_incremental_rules);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -123,32 +130,9 @@ class RuleExecutor {
 
  public:
   virtual ~RuleExecutor() = default;
-  // TODO(philkuz) figure out how to collect stats on the execution.
   Status Execute(TPlan* ir_graph) {
     for (const auto& rb : rule_batches) {
-      bool can_continue = true;
-      int64_t iteration = 0;
-      // We continue executing a batch until a stop condition is met.
-      while (can_continue) {
-        iteration += 1;
-        bool graph_is_updated = false;
-        for (const auto& rule : rb->rules()) {
-          PX_ASSIGN_OR_RETURN(bool rule_updates_graph, rule->Execute(ir_graph));
-          graph_is_updated = graph_is_updated || rule_updates_graph;
-        }
-        if (iteration >= rb->max_iterations() && graph_is_updated) {
-          PX_RETURN_IF_ERROR(rb->MaxIterationsHandler());
-          // TODO(philkuz) Reviewer: should this be a failure somehow?
-          can_continue = false;
-        }
-        // TODO(philkuz) in the future we might have a fast way to check whether the graph has
-        // changed. For now let's be lazy and leave it up to the user to make sure rules properly
-        // update.
-        // (graph_is_updated == false) => the graph has reached a fixed point and is done
-        if (!graph_is_updated) {
-          can_continue = false;
-        }
-      }
+      PX_RETURN_IF_ERROR(ExecuteBatch(ir_graph, rb.get(), stats_.add_batches()));
     }
     return Status::OK();
   }
@@ -160,8 +144,89 @@ class RuleExecutor {
     return out_ptr;
   }
 
+  // Statistics of the rule batches run by Execute().
+  const compilerpb::RuleExecutorStats& stats() const { return stats_; }
+
  private:
+  // The nodes that a rule has to revisit, or std::nullopt if it has to visit the whole graph.
+  using NodesToVisit = std::optional<absl::flat_hash_set<int64_t>>;
+
+  Status ExecuteBatch(TPlan* ir_graph, TRuleBatch* rb, compilerpb::RuleBatchStats* batch_stats) {
+    auto batch_start = std::chrono::steady_clock::now();
+    batch_stats->set_name(rb->name());
+    const auto& rules = rb->rules();
+    std::vector<NodesToVisit> nodes_to_visit(rules.size());
+    for (const auto& rule : rules) {
+      batch_stats->add_rules()->set_name(rule->name());
+    }
+
+    bool can_continue = true;
+    int64_t iteration = 0;
+    // We continue executing a batch until a stop condition is met.
+    while (can_continue) {
+      iteration += 1;
+      bool graph_is_updated = false;
+      for (const auto& [rule_idx, rule] : Enumerate(rules)) {
+        // After the first pass, a rule only has to revisit the nodes around the changes made since
+        // it last ran. Those are the only nodes that it could apply to differently.
+        NodesToVisit visit = std::move(nodes_to_visit[rule_idx]);
+        nodes_to_visit[rule_idx] = absl::flat_hash_set<int64_t>{};
+        if (!FLAGS_planner_incremental_rules) {
+          visit.reset();
+        }
+        rule->SetNodesToVisit(visit.has_value() ? &visit.value() : nullptr);
+        rule->ResetChangesTracked();
+
+        auto rule_stats = batch_stats->mutable_rules(rule_idx);
+        int64_t nodes_visited_before = rule->num_nodes_visited();
+        auto rule_start = std::chrono::steady_clock::now();
+        auto rule_updates_graph_or_s = rule->Execute(ir_graph);
+        rule_stats->set_total_time_ns(rule_stats->total_time_ns() +
+                                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - rule_start)
+                                          .count());
+        rule->SetNodesToVisit(nullptr);
+        PX_ASSIGN_OR_RETURN(bool rule_updates_graph, rule_updates_graph_or_s);
+
+        rule_stats->set_executions(rule_stats->executions() + 1);
+        rule_stats->set_nodes_visited(rule_stats->nodes_visited() + rule->num_nodes_visited() -
+                                      nodes_visited_before);
+        if (rule_updates_graph) {
+          rule_stats->set_changing_executions(rule_stats->changing_executions() + 1);
+          for (NodesToVisit& other_visit : nodes_to_visit) {
+            if (!other_visit.has_value()) {
+              continue;
+            }
+            if (!rule->changes_tracked()) {
+              // We don't know which nodes changed.
+              other_visit.reset();
+              continue;
+            }
+            other_visit->insert(rule->changed_nodes().begin(), rule->changed_nodes().end());
+          }
+        }
+        graph_is_updated = graph_is_updated || rule_updates_graph;
+      }
+      if (iteration >= rb->max_iterations() && graph_is_updated) {
+        batch_stats->set_iterations(iteration);
+        PX_RETURN_IF_ERROR(rb->MaxIterationsHandler());
+        // TODO(philkuz) Reviewer: should this be a failure somehow?
+        can_continue = false;
+      }
+      // (graph_is_updated == false) => the graph has reached a fixed point and is done
+      if (!graph_is_updated) {
+        can_continue = false;
+      }
+    }
+    batch_stats->set_iterations(iteration);
+    batch_stats->set_total_time_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - batch_start)
+                                       .count());
+    return Status::OK();
+  }
+
   std::vector<std::unique_ptr<TRuleBatch>> rule_batches;
+  compilerpb::RuleExecutorStats stats_;
 };
 
 }  // namespace planner
@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -182,6 +183,103 @@ TEST_F(RuleExecutorTest, exit_early) {
   EXPECT_NOT_OK(executor->Execute(graph.get()));
 }
 
+TEST_F(RuleExecutorTest, collects_stats) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  MockRule* rule1 = rule_batch->AddRule<MockRule>(compiler_state_.get());
+  EXPECT_CALL(*rule1, Execute(_)).Times(2).WillOnce(Return(true)).WillRepeatedly(Return(false));
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  const auto& stats = executor->stats();
+  ASSERT_EQ(stats.batches_size(), 1);
+  EXPECT_EQ(stats.batches(0).name(), "resolve");
+  EXPECT_EQ(stats.batches(0).iterations(), 2);
+  ASSERT_EQ(stats.batches(0).rules_size(), 1);
+  EXPECT_EQ(stats.batches(0).rules(0).name(), "MockRule");
+  EXPECT_EQ(stats.batches(0).rules(0).executions(), 2);
+  EXPECT_EQ(stats.batches(0).rules(0).changing_executions(), 1);
+}
+
+// Changes the given node the first time that it is visited.
+class ChangeNodeOnceRule : public Rule {
+ public:
+  ChangeNodeOnceRule(CompilerState* compiler_state, int64_t node_id)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false),
+        node_id_(node_id) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override {
+    if (ir_node->id() != node_id_ || changed_) {
+      return false;
+    }
+    changed_ = true;
+    return true;
+  }
+
+ private:
+  int64_t node_id_;
+  bool changed_ = false;
+};
+
+// Tests that after the first iteration, rules only revisit the nodes around the changes.
+TEST_F(RuleExecutorTest, revisits_changed_nodes) {
+  PX_SET_FOR_SCOPE(FLAGS_planner_incremental_rules, true);
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  rule_batch->AddRule<ChangeNodeOnceRule>(compiler_state_.get(), func->id());
+  int64_t num_nodes = graph->dag().nodes().size();
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  const auto& rule_stats = executor->stats().batches(0).rules(0);
+  EXPECT_EQ(rule_stats.executions(), 2);
+  EXPECT_EQ(rule_stats.changing_executions(), 1);
+  // The second iteration visits func, its expressions, and the expression and map that own it.
+  EXPECT_EQ(rule_stats.nodes_visited(), num_nodes + 5);
+}
+
+TEST_F(RuleExecutorTest, revisits_whole_graph_by_default) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  rule_batch->AddRule<ChangeNodeOnceRule>(compiler_state_.get(), func->id());
+  int64_t num_nodes = graph->dag().nodes().size();
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  const auto& rule_stats = executor->stats().batches(0).rules(0);
+  EXPECT_EQ(rule_stats.executions(), 2);
+  EXPECT_EQ(rule_stats.nodes_visited(), 2 * num_nodes);
+}
+
+// Records the nodes that it visits, and changes the given node the first time that it is visited.
+class RecordVisitsRule : public ChangeNodeOnceRule {
+ public:
+  RecordVisitsRule(CompilerState* compiler_state, int64_t node_id)
+      : ChangeNodeOnceRule(compiler_state, node_id) {}
+
+  const std::vector<int64_t>& visited() const { return visited_; }
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override {
+    visited_.push_back(ir_node->id());
+    return ChangeNodeOnceRule::Apply(ir_node);
+  }
+
+ private:
+  std::vector<int64_t> visited_;
+};
+
+TEST_F(RuleExecutorTest, revisits_changed_nodes_in_id_order) {
+  PX_SET_FOR_SCOPE(FLAGS_planner_incremental_rules, true);
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  RecordVisitsRule* rule = rule_batch->AddRule<RecordVisitsRule>(compiler_state_.get(), func->id());
+  int64_t num_nodes = graph->dag().nodes().size();
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  std::vector<int64_t> revisited(rule->visited().begin() + num_nodes, rule->visited().end());
+  EXPECT_EQ(revisited.size(), 5);
+  EXPECT_TRUE(std::is_sorted(revisited.begin(), revisited.end()));
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
@@ -17,12 +17,20 @@
  */
 
 #pragma once
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <queue>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
@@ -56,15 +64,58 @@ class BaseRule {
 
   virtual StatusOr<bool> Execute(TPlan* graph) {
     bool any_changed = false;
+    changed_nodes_.clear();
+    int64_t first_new_node_id = graph->next_node_id();
     if (!use_topo_) {
       PX_ASSIGN_OR_RETURN(any_changed, ExecuteUnsorted(graph));
     } else {
       PX_ASSIGN_OR_RETURN(any_changed, ExecuteTopologicalSorted(graph));
     }
     PX_RETURN_IF_ERROR(EmptyDeleteQueue(graph));
+    // Nodes created by the rule are new to the other rules, even if they aren't connected to the
+    // nodes that the rule changed.
+    for (int64_t node_i = first_new_node_id; node_i < graph->next_node_id(); ++node_i) {
+      if (graph->HasNode(node_i)) {
+        changed_nodes_.insert(node_i);
+      }
+    }
+    changes_tracked_ = true;
     return any_changed;
   }
 
+  /**
+   * @brief Restricts the following calls to Execute() to the given nodes, or to the whole graph
+   * if nodes is nullptr. Used by the RuleExecutor to only revisit the nodes around the changes of
+   * the previous iteration.
+   */
+  void SetNodesToVisit(const absl::flat_hash_set<int64_t>* nodes) { nodes_to_visit_ = nodes; }
+
+  /**
+   * @brief Returns the nodes that the last call to Execute() changed or created, along with their
+   * parents and children before and after the change.
+   */
+  const absl::flat_hash_set<int64_t>& changed_nodes() const { return changed_nodes_; }
+
+  /**
+   * @brief Whether the last call to Execute() tracked the nodes it changed. Rules that override
+   * Execute() don't, so all of the nodes have to be considered changed.
+   */
+  bool changes_tracked() const { return changes_tracked_; }
+  void ResetChangesTracked() { changes_tracked_ = false; }
+
+  int64_t num_nodes_visited() const { return num_nodes_visited_; }
+
+  std::string name() const {
+    int status = 0;
+    const char* mangled_name = typeid(*this).name();
+    std::unique_ptr<char, void (*)(void*)> demangled(
+        abi::__cxa_demangle(mangled_name, nullptr, nullptr, &status), std::free);
+    std::string_view name = status == 0 ? demangled.get() : mangled_name;
+    // Drop the namespaces.
+    auto pos = name.rfind("::");
+    return std::string(pos == std::string_view::npos ? name : name.substr(pos + 2));
+  }
+
  protected:
   StatusOr<bool> ExecuteTopologicalSorted(TPlan* graph) {
     bool any_changed = false;
@@ -73,11 +124,10 @@ class BaseRule {
       std::reverse(topo_graph.begin(), topo_graph.end());
     }
     for (int64_t node_i : topo_graph) {
-      // The node may have been deleted by a prior call to Apply on a parent or child node.
-      if (!graph->HasNode(node_i)) {
+      if (nodes_to_visit_ != nullptr && !nodes_to_visit_->contains(node_i)) {
         continue;
       }
-      PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      PX_ASSIGN_OR_RETURN(bool node_is_changed, ApplyAndTrack(graph, node_i));
       any_changed = any_changed || node_is_changed;
     }
     return any_changed;
@@ -86,19 +136,74 @@ class BaseRule {
   StatusOr<bool> ExecuteUnsorted(TPlan* graph) {
     bool any_changed = false;
     // We need to copy over nodes because the Apply() might add nodes which can affect traversal,
-    // causing nodes to be skipped.
-    auto nodes = graph->dag().nodes();
+    // causing nodes to be skipped. Nodes that are revisited are visited in id order, so that the
+    // result of a rule batch doesn't depend on the iteration order of the hash set.
+    std::vector<int64_t> nodes;
+    if (nodes_to_visit_ == nullptr) {
+      nodes.assign(graph->dag().nodes().begin(), graph->dag().nodes().end());
+    } else {
+      nodes.assign(nodes_to_visit_->begin(), nodes_to_visit_->end());
+      std::sort(nodes.begin(), nodes.end());
+    }
     for (int64_t node_i : nodes) {
-      // The node may have been deleted by a prior call to Apply on a parent or child node.
-      if (!graph->HasNode(node_i)) {
-        continue;
-      }
-      PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      PX_ASSIGN_OR_RETURN(bool node_is_changed, ApplyAndTrack(graph, node_i));
       any_changed = any_changed || node_is_changed;
     }
     return any_changed;
   }
 
+  StatusOr<bool> ApplyAndTrack(TPlan* graph, int64_t node_i) {
+    // The node may have been deleted by a prior call to Apply on a parent or child node.
+    if (!graph->HasNode(node_i)) {
+      return false;
+    }
+    ++num_nodes_visited_;
+    std::vector<int64_t> parents = graph->dag().ParentsOf(node_i);
+    std::vector<int64_t> children = graph->dag().DependenciesOf(node_i);
+    PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+    if (!node_is_changed) {
+      return false;
+    }
+    // The neighbors of a changed node may now match rules that they didn't match before.
+    changed_nodes_.insert(node_i);
+    changed_nodes_.insert(parents.begin(), parents.end());
+    changed_nodes_.insert(children.begin(), children.end());
+    if (graph->HasNode(node_i)) {
+      for (int64_t parent : graph->dag().ParentsOf(node_i)) {
+        changed_nodes_.insert(parent);
+      }
+      for (int64_t child : graph->dag().DependenciesOf(node_i)) {
+        changed_nodes_.insert(child);
+      }
+    }
+    if constexpr (std::is_same_v<TPlan, IR>) {
+      for (int64_t parent : parents) {
+        AddOwningOperators(graph, parent);
+      }
+    }
+    return true;
+  }
+
+  // Rules that apply to operators look at the whole expression trees of the operators, so a change
+  // anywhere in an expression tree is also a change of the operators that own it.
+  void AddOwningOperators(IR* graph, int64_t node_i) {
+    std::vector<int64_t> to_visit{node_i};
+    absl::flat_hash_set<int64_t> visited{node_i};
+    while (!to_visit.empty()) {
+      int64_t current = to_visit.back();
+      to_visit.pop_back();
+      if (!graph->HasNode(current) || !graph->Get(current)->IsExpression()) {
+        continue;
+      }
+      for (int64_t parent : graph->dag().ParentsOf(current)) {
+        changed_nodes_.insert(parent);
+        if (visited.insert(parent).second) {
+          to_visit.push_back(parent);
+        }
+      }
+    }
+  }
+
   /**
    * @brief Applies the rule to a node.
    * Should include a check for type and should return true if it changes the node.
@@ -125,6 +230,12 @@ class BaseRule {
   CompilerState* compiler_state_;
   bool use_topo_;
   bool reverse_topological_execution_;
+
+ private:
+  const absl::flat_hash_set<int64_t>* nodes_to_visit_ = nullptr;
+  absl::flat_hash_set<int64_t> changed_nodes_;
+  bool changes_tracked_ = false;
+  int64_t num_nodes_visited_ = 0;
 };
 
 using Rule = BaseRule<IR>;
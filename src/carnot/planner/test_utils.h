@@ -2228,6 +2228,35 @@ class DistributedRulesTest : public OperatorTests {
     return coordinator->Coordinate(graph.get()).ConsumeValueOrDie();
   }
 
+  // Extends kThreePEMsOneKelvinDistributedState to six PEMs and three Kelvins, which is enough to
+  // merge the results of the PEMs through two intermediate Kelvins.
+  distributedpb::DistributedState SixPEMsThreeKelvinsDistributedState() {
+    auto ps = LoadDistributedStatePb(kThreePEMsOneKelvinDistributedState);
+    distributedpb::CarnotInfo pem = ps.carnot_info(0);
+    distributedpb::CarnotInfo kelvin = ps.carnot_info(3);
+    for (int64_t i = 4; i <= 6; ++i) {
+      auto new_pem = ps.add_carnot_info();
+      *new_pem = pem;
+      new_pem->set_query_broker_address(absl::StrCat("pem", i));
+      new_pem->mutable_agent_id()->set_low_bits(i + 1);
+      new_pem->set_asid(1000 + i);
+      for (auto& schema_info : *ps.mutable_schema_info()) {
+        if (schema_info.agent_list_size() > 1) {
+          *schema_info.add_agent_list() = new_pem->agent_id();
+        }
+      }
+    }
+    for (int64_t i = 2; i <= 3; ++i) {
+      auto new_kelvin = ps.add_carnot_info();
+      *new_kelvin = kelvin;
+      new_kelvin->set_query_broker_address(absl::StrCat("kelvin", i));
+      new_kelvin->mutable_agent_id()->set_low_bits(6 + i);
+      new_kelvin->set_grpc_address(absl::StrCat(i, i, i, i));
+      new_kelvin->set_asid(2000 + i);
+    }
+    return ps;
+  }
+
   absl::flat_hash_set<int64_t> SourceNodeIds(distributed::DistributedPlan* plan) {
     absl::flat_hash_set<int64_t> node_ids;
     if (!plan) {
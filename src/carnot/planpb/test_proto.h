@@ -328,6 +328,31 @@ columns {
 }
 )";
 
+constexpr char kSortOperator1[] = R"(
+sort_columns {
+  column {
+    node: 1
+    index: 1
+  }
+  ascending: false
+}
+sort_columns {
+  column {
+    node: 1
+    index: 0
+  }
+  ascending: true
+}
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 1
+}
+)";
+
 constexpr char kLimitDropOperator1[] = R"(
 limit: 10
 columns {
@@ -1474,6 +1499,13 @@ planpb::Operator CreateTestLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestSort1PB() {
+  planpb::Operator op;
+  auto op_proto = absl::Substitute(kOperatorProtoTmpl, "SORT_OPERATOR", "sort_op", kSortOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestDropLimit1PB() {
   planpb::Operator op;
   auto op_proto =
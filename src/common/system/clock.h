@@ -52,5 +52,9 @@ using boot_clock = basic_clock<CLOCK_BOOTTIME>;
 // the same timestamp if within the resolution window (i.e. if < 4 ms. have elapsed between calls).
 using coarse_steady_clock = basic_clock<CLOCK_MONOTONIC_COARSE>;
 
+// Clock based on CLOCK_THREAD_CPUTIME_ID.
+// Measures the CPU time consumed by the calling thread.
+using thread_cpu_clock = basic_clock<CLOCK_THREAD_CPUTIME_ID>;
+
 }  // namespace chrono
 }  // namespace px
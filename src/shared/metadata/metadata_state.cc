@@ -27,19 +27,30 @@
 namespace px {
 namespace md {
 
+namespace {
+
+// Objects are shared with the clones of a state until they are modified, so they are cloned the
+// first time they are written to in a state.
+template <typename T>
+T* MutableObject(std::shared_ptr<T>* obj) {
+  return CopyOnWrite(obj, [](const T& t) { return std::shared_ptr<T>(t.Clone()); });
+}
+
+}  // namespace
+
 const K8sMetadataObject* K8sMetadataState::K8sMetadataObjectByID(UIDView id,
                                                                  K8sObjectType type) const {
-  auto it = k8s_objects_by_id_.find(id);
+  auto obj = k8s_objects_by_id_.find(id);
 
-  if (it == k8s_objects_by_id_.end()) {
+  if (obj == nullptr) {
     return nullptr;
   }
 
-  if (it->second->type() != type) {
+  if ((*obj)->type() != type) {
     return nullptr;
   }
 
-  return it->second.get();
+  return obj->get();
 }
 
 const PodInfo* K8sMetadataState::PodInfoByID(UIDView pod_id) const {
@@ -69,32 +80,42 @@ const DeploymentInfo* K8sMetadataState::DeploymentInfoByID(UIDView deployment_id
 }
 
 const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
-  auto it = containers_by_id_.find(id);
+  auto container = containers_by_id_.find(id);
+
+  if (container == nullptr) {
+    return nullptr;
+  }
+
+  return container->get();
+}
+
+ContainerInfo* K8sMetadataState::MutableContainerInfoByID(CIDView id) {
+  auto container = containers_by_id_.FindMutable(id);
 
-  if (it == containers_by_id_.end()) {
+  if (container == nullptr) {
     return nullptr;
   }
 
-  return it->second.get();
+  return MutableObject(container);
 }
 
 UID K8sMetadataState::PodIDByName(K8sNameIdentView pod_name) const {
-  auto it = pods_by_name_.find(pod_name);
-  return (it == pods_by_name_.end()) ? "" : it->second;
+  auto id = pods_by_name_.find(pod_name);
+  return (id == nullptr) ? "" : *id;
 }
 
 UID K8sMetadataState::PodIDByIP(std::string_view pod_ip) const {
-  auto it = pods_by_ip_.find(pod_ip);
-  return (it == pods_by_ip_.end()) ? "" : it->second;
+  auto id = pods_by_ip_.find(pod_ip);
+  return (id == nullptr) ? "" : *id;
 }
 
 UID K8sMetadataState::PodIDByIPAtTime(std::string_view pod_ip, int64_t ts) const {
-  auto it = pods_by_ip_and_start_time_.find(pod_ip);
-  if (it == pods_by_ip_and_start_time_.end()) {
+  auto pod_set = pods_by_ip_and_start_time_.find(pod_ip);
+  if (pod_set == nullptr) {
     return "";
   }
-  auto up = it->second.upper_bound({"", ts});
-  if (up == it->second.begin()) {
+  auto up = pod_set->upper_bound({"", ts});
+  if (up == pod_set->begin()) {
     return "";
   }
   --up;
@@ -102,33 +123,33 @@ UID K8sMetadataState::PodIDByIPAtTime(std::string_view pod_ip, int64_t ts) const
 }
 
 UID K8sMetadataState::ServiceIDByClusterIP(std::string_view cluster_ip) const {
-  auto it = services_by_cluster_ip_.find(cluster_ip);
-  return (it == services_by_cluster_ip_.end()) ? "" : it->second;
+  auto id = services_by_cluster_ip_.find(cluster_ip);
+  return (id == nullptr) ? "" : *id;
 }
 
 CID K8sMetadataState::ContainerIDByName(std::string_view container_name) const {
-  auto it = containers_by_name_.find(container_name);
-  return (it == containers_by_name_.end()) ? "" : it->second;
+  auto id = containers_by_name_.find(container_name);
+  return (id == nullptr) ? "" : *id;
 }
 
 UID K8sMetadataState::ServiceIDByName(K8sNameIdentView service_name) const {
-  auto it = services_by_name_.find(service_name);
-  return (it == services_by_name_.end()) ? "" : it->second;
+  auto id = services_by_name_.find(service_name);
+  return (id == nullptr) ? "" : *id;
 }
 
 UID K8sMetadataState::NamespaceIDByName(K8sNameIdentView namespace_name) const {
-  auto it = namespaces_by_name_.find(namespace_name);
-  return (it == namespaces_by_name_.end()) ? "" : it->second;
+  auto id = namespaces_by_name_.find(namespace_name);
+  return (id == nullptr) ? "" : *id;
 }
 
 UID K8sMetadataState::ReplicaSetIDByName(K8sNameIdentView replica_set_name) const {
-  auto it = replica_sets_by_name_.find(replica_set_name);
-  return (it == replica_sets_by_name_.end()) ? "" : it->second;
+  auto id = replica_sets_by_name_.find(replica_set_name);
+  return (id == nullptr) ? "" : *id;
 }
 
 UID K8sMetadataState::DeploymentIDByName(K8sNameIdentView deployment_name) const {
-  auto it = deployments_by_name_.find(deployment_name);
-  return (it == deployments_by_name_.end()) ? "" : it->second;
+  auto id = deployments_by_name_.find(deployment_name);
+  return (id == nullptr) ? "" : *id;
 }
 
 const ReplicaSetInfo* K8sMetadataState::OwnerReplicaSetInfo(
@@ -165,16 +186,9 @@ std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
   other->pod_cidrs_ = pod_cidrs_;
   other->service_cidr_ = service_cidr_;
 
-  other->k8s_objects_by_id_.reserve(k8s_objects_by_id_.size());
-  for (const auto& [k, v] : k8s_objects_by_id_) {
-    other->k8s_objects_by_id_[k] = v->Clone();
-  }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
-  }
-
+  // The maps and the objects in them are copied on write, so copying them is O(1).
+  other->k8s_objects_by_id_ = k8s_objects_by_id_;
+  other->containers_by_id_ = containers_by_id_;
   other->pods_by_name_ = pods_by_name_;
   other->services_by_name_ = services_by_name_;
   other->namespaces_by_name_ = namespaces_by_name_;
@@ -251,13 +265,12 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(object_uid);
-  if (it == k8s_objects_by_id_.end()) {
-    auto pod = std::make_unique<PodInfo>(update);
-    VLOG(1) << "Adding Pod: " << pod->DebugString();
-    it = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
+  auto [pod, inserted] = k8s_objects_by_id_.TryEmplace(object_uid);
+  if (inserted) {
+    *pod = std::make_shared<PodInfo>(update);
+    VLOG(1) << "Adding Pod: " << (*pod)->DebugString();
   }
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info = static_cast<PodInfo*>(MutableObject(pod));
 
   // We always just add to the container set even if the container is stopped.
   // We expect all cleanup to happen periodically to allow stale objects to be queried for some
@@ -266,7 +279,8 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   // state might be periodically inconsistent.
 
   for (const auto& cid : update.container_ids()) {
-    if (containers_by_id_.find(cid) == containers_by_id_.end()) {
+    auto container = containers_by_id_.FindMutable(cid);
+    if (container == nullptr) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
@@ -275,7 +289,7 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    MutableObject(container)->set_pod_id(object_uid);
   }
 
   for (const auto& owner_ref : update.owner_references()) {
@@ -293,12 +307,13 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   pod_info->set_phase_reason(update.reason());
   pod_info->set_pod_labels(update.labels());
 
-  pods_by_name_[{ns, name}] = object_uid;
+  pods_by_name_.InsertOrAssign(K8sNameIdentView(ns, name), object_uid);
   // Filter out daemonsets which don't have their own, unique podIP.
   if (update.host_ip() != update.pod_ip() && update.pod_ip() != "") {
-    pods_by_ip_[update.pod_ip()] = object_uid;
+    pods_by_ip_.InsertOrAssign(update.pod_ip(), object_uid);
     if (update.start_timestamp_ns() > 0) {
-      pods_by_ip_and_start_time_[update.pod_ip()].insert({object_uid, update.start_timestamp_ns()});
+      pods_by_ip_and_start_time_.TryEmplace(update.pod_ip())
+          .first->insert({object_uid, update.start_timestamp_ns()});
     }
   }
 
@@ -308,21 +323,20 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
 Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
   const CID& cid = update.cid();
 
-  auto it = containers_by_id_.find(cid);
-  if (it == containers_by_id_.end()) {
-    auto container = std::make_unique<ContainerInfo>(update);
-    VLOG(1) << "Adding Container: " << container->DebugString();
-    it = containers_by_id_.try_emplace(cid, std::move(container)).first;
+  auto [container, inserted] = containers_by_id_.TryEmplace(cid);
+  if (inserted) {
+    *container = std::make_shared<ContainerInfo>(update);
+    VLOG(1) << "Adding Container: " << (*container)->DebugString();
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = MutableObject(container);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
   container_info->set_state_reason(update.reason());
 
-  containers_by_name_[update.name()] = cid;
+  containers_by_name_.InsertOrAssign(update.name(), cid);
 
   return Status::OK();
 }
@@ -332,25 +346,25 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(service_uid);
-  if (it == k8s_objects_by_id_.end()) {
-    auto service = std::make_unique<ServiceInfo>(service_uid, ns, name);
-    VLOG(1) << "Adding Service: " << service->DebugString();
-    it = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
+  auto [service, inserted] = k8s_objects_by_id_.TryEmplace(service_uid);
+  if (inserted) {
+    *service = std::make_shared<ServiceInfo>(service_uid, ns, name);
+    VLOG(1) << "Adding Service: " << (*service)->DebugString();
   }
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
+  auto service_info = static_cast<ServiceInfo*>(MutableObject(service));
 
   for (const auto& uid : update.pod_ids()) {
-    if (k8s_objects_by_id_.find(uid) == k8s_objects_by_id_.end()) {
+    auto pod = k8s_objects_by_id_.FindMutable(uid);
+    if (pod == nullptr) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
       LOG(INFO) << absl::Substitute("Didn't find pod UID $0 for service $1/$2", uid, ns, name);
       continue;
     }
-    ECHECK(k8s_objects_by_id_[uid]->type() == K8sObjectType::kPod);
+    ECHECK((*pod)->type() == K8sObjectType::kPod);
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_by_id_[uid].get());
+    PodInfo* pod_info = static_cast<PodInfo*>(MutableObject(pod));
     pod_info->AddService(service_uid);
   }
   if (update.start_timestamp_ns() != 0) {
@@ -360,7 +374,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     service_info->set_stop_time_ns(update.stop_timestamp_ns());
   }
   if (update.cluster_ip() != "") {
-    services_by_cluster_ip_[update.cluster_ip()] = service_uid;
+    services_by_cluster_ip_.InsertOrAssign(update.cluster_ip(), service_uid);
     service_info->set_cluster_ip(update.cluster_ip());
   }
   if (update.external_ips().size()) {
@@ -370,7 +384,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   }
 
   VLOG(1) << "service update: " << update.name();
-  services_by_name_[{ns, name}] = service_uid;
+  services_by_name_.InsertOrAssign(K8sNameIdentView(ns, name), service_uid);
   return Status::OK();
 }
 
@@ -379,20 +393,19 @@ Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.name();
 
-  auto it = k8s_objects_by_id_.find(namespace_uid);
-  if (it == k8s_objects_by_id_.end()) {
-    auto ns_obj = std::make_unique<NamespaceInfo>(namespace_uid, ns, name);
-    VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
-    it = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
+  auto [ns_obj, inserted] = k8s_objects_by_id_.TryEmplace(namespace_uid);
+  if (inserted) {
+    *ns_obj = std::make_shared<NamespaceInfo>(namespace_uid, ns, name);
+    VLOG(1) << "Adding Namespace: " << (*ns_obj)->DebugString();
   }
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info = static_cast<NamespaceInfo*>(MutableObject(ns_obj));
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
 
   VLOG(1) << "namespace update: " << update.name();
 
-  namespaces_by_name_[{ns, name}] = namespace_uid;
+  namespaces_by_name_.InsertOrAssign(K8sNameIdentView(ns, name), namespace_uid);
   return Status::OK();
 }
 
@@ -408,13 +421,12 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(replica_set_uid);
-  if (it == k8s_objects_by_id_.end()) {
-    auto replica_set = std::make_unique<ReplicaSetInfo>(update);
-    VLOG(1) << "Adding ReplicaSet: " << replica_set->DebugString();
-    it = k8s_objects_by_id_.try_emplace(replica_set_uid, std::move(replica_set)).first;
+  auto [replica_set, inserted] = k8s_objects_by_id_.TryEmplace(replica_set_uid);
+  if (inserted) {
+    *replica_set = std::make_shared<ReplicaSetInfo>(update);
+    VLOG(1) << "Adding ReplicaSet: " << (*replica_set)->DebugString();
   }
-  auto replica_set_info = static_cast<ReplicaSetInfo*>(it->second.get());
+  auto replica_set_info = static_cast<ReplicaSetInfo*>(MutableObject(replica_set));
 
   for (const auto& owner_ref : update.owner_references()) {
     replica_set_info->AddOwnerReference(owner_ref.uid(), owner_ref.name(), owner_ref.kind());
@@ -432,7 +444,7 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
 
   VLOG(1) << "replica set update: " << update.name();
 
-  replica_sets_by_name_[{ns, name}] = replica_set_uid;
+  replica_sets_by_name_.InsertOrAssign(K8sNameIdentView(ns, name), replica_set_uid);
   return Status::OK();
 }
 
@@ -441,13 +453,12 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(deployment_uid);
-  if (it == k8s_objects_by_id_.end()) {
-    auto deployment = std::make_unique<DeploymentInfo>(update);
-    VLOG(1) << "Adding Deployment: " << deployment->DebugString();
-    it = k8s_objects_by_id_.try_emplace(deployment_uid, std::move(deployment)).first;
+  auto [deployment, inserted] = k8s_objects_by_id_.TryEmplace(deployment_uid);
+  if (inserted) {
+    *deployment = std::make_shared<DeploymentInfo>(update);
+    VLOG(1) << "Adding Deployment: " << (*deployment)->DebugString();
   }
-  auto deployment_info = static_cast<DeploymentInfo*>(it->second.get());
+  auto deployment_info = static_cast<DeploymentInfo*>(MutableObject(deployment));
 
   deployment_info->set_start_time_ns(update.start_timestamp_ns());
   deployment_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -462,7 +473,7 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
 
   VLOG(1) << "deployment update: " << update.name();
 
-  deployments_by_name_[{ns, name}] = deployment_uid;
+  deployments_by_name_.InsertOrAssign(K8sNameIdentView(ns, name), deployment_uid);
   return Status::OK();
 }
 
@@ -478,11 +489,10 @@ bool IsExpired(const T& obj, int64_t retention_time, int64_t now) {
 }
 
 Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_time_ns) {
-  for (auto iter = k8s_objects_by_id_.begin(); iter != k8s_objects_by_id_.end();) {
-    const auto& k8s_object = iter->second;
-
+  // Iterate over a snapshot of the objects, which is unaffected by the erasures below.
+  const K8sObjectsByIDMap k8s_objects = k8s_objects_by_id_;
+  for (const auto& [uid, k8s_object] : k8s_objects) {
     if (!IsExpired(*k8s_object, retention_time_ns, now)) {
-      ++iter;
       continue;
     }
 
@@ -490,58 +500,57 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_t
       case K8sObjectType::kPod: {
         if (PodIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          pods_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          pods_by_name_.Erase(K8sNameIdentView(k8s_object->ns(), k8s_object->name()));
         }
         auto pod_ip = static_cast<PodInfo*>(k8s_object.get())->pod_ip();
         // There could be a new pod assigned to the podIP now, we should only
         // delete the IP from the map if it belongs to the terminated pod.
         if (PodIDByIP(pod_ip) == k8s_object->uid()) {
-          pods_by_ip_.erase(pod_ip);
+          pods_by_ip_.Erase(pod_ip);
         }
 
-        auto it = pods_by_ip_and_start_time_.find(pod_ip);
-        if (it != pods_by_ip_and_start_time_.end()) {
-          auto& pod_set = it->second;
-          auto erase_end = pod_set.upper_bound({"", now - retention_time_ns});
+        auto pod_set = pods_by_ip_and_start_time_.FindMutable(pod_ip);
+        if (pod_set != nullptr) {
+          auto erase_end = pod_set->upper_bound({"", now - retention_time_ns});
 
-          if (erase_end != pod_set.begin()) {
+          if (erase_end != pod_set->begin()) {
             // Check if the last pod we might erase is still running.
             // If the last of the pods being erased is running though it's
             // before the expiration time, leave it alone.
             auto prev_obj = k8s_objects_by_id_.find(std::prev(erase_end)->first);
-            if (prev_obj != k8s_objects_by_id_.end()) {
-              auto prev_pod = static_cast<PodInfo*>(prev_obj->second.get());
+            if (prev_obj != nullptr) {
+              auto prev_pod = static_cast<const PodInfo*>(prev_obj->get());
               if (prev_pod->phase() == PodPhase::kRunning || prev_pod->stop_time_ns() == 0) {
                 --erase_end;
               }
             }
           }
-          pod_set.erase(pod_set.begin(), erase_end);
+          pod_set->erase(pod_set->begin(), erase_end);
         }
         break;
       }
       case K8sObjectType::kNamespace:
         if (NamespaceIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          namespaces_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          namespaces_by_name_.Erase(K8sNameIdentView(k8s_object->ns(), k8s_object->name()));
         }
         break;
       case K8sObjectType::kService:
         if (ServiceIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          services_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          services_by_name_.Erase(K8sNameIdentView(k8s_object->ns(), k8s_object->name()));
         }
         break;
       case K8sObjectType::kReplicaSet:
         if (ReplicaSetIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          replica_sets_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          replica_sets_by_name_.Erase(K8sNameIdentView(k8s_object->ns(), k8s_object->name()));
         }
         break;
       case K8sObjectType::kDeployment:
         if (DeploymentIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          deployments_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          deployments_by_name_.Erase(K8sNameIdentView(k8s_object->ns(), k8s_object->name()));
         }
         break;
       default:
@@ -549,19 +558,17 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_t
                                         static_cast<int>(k8s_object->type()));
     }
 
-    k8s_objects_by_id_.erase(iter++);
+    k8s_objects_by_id_.Erase(uid);
   }
 
-  for (auto iter = containers_by_id_.begin(); iter != containers_by_id_.end();) {
-    const auto& cinfo = iter->second;
-
+  const ContainersByIDMap containers = containers_by_id_;
+  for (const auto& [cid, cinfo] : containers) {
     if (!IsExpired(*cinfo, retention_time_ns, now)) {
-      ++iter;
       continue;
     }
 
-    containers_by_name_.erase(cinfo->name());
-    containers_by_id_.erase(iter++);
+    containers_by_name_.Erase(cinfo->name());
+    containers_by_id_.Erase(cid);
   }
 
   return Status::OK();
@@ -574,10 +581,7 @@ std::shared_ptr<AgentMetadataState> AgentMetadataState::CloneToShared() const {
   state->last_update_ts_ns_ = last_update_ts_ns_;
   state->epoch_id_ = epoch_id_;
   state->k8s_metadata_state_ = k8s_metadata_state_->Clone();
-  state->pids_by_upid_.reserve(pids_by_upid_.size());
-  for (const auto& [k, v] : pids_by_upid_) {
-    state->pids_by_upid_[k] = v->Clone();
-  }
+  state->pids_by_upid_ = pids_by_upid_;
   state->upids_ = upids_;
   return state;
 }
@@ -34,6 +34,7 @@
 #include "src/common/event/time_system.h"
 #include "src/shared/k8s/metadatapb/metadata.pb.h"
 #include "src/shared/metadata/k8s_objects.h"
+#include "src/shared/metadata/persistent_hash_map.h"
 #include "src/shared/metadata/pids.h"
 #include "src/shared/upid/upid.h"
 
@@ -42,7 +43,11 @@ namespace md {
 
 using K8sMetadataObjectUPtr = std::unique_ptr<K8sMetadataObject>;
 using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
+using K8sMetadataObjectSPtr = std::shared_ptr<K8sMetadataObject>;
+using ContainerInfoSPtr = std::shared_ptr<ContainerInfo>;
 using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
+using PIDInfoSPtr = std::shared_ptr<PIDInfo>;
+using PIDInfoByUPIDMap = PersistentHashMap<UPID, PIDInfoSPtr>;
 using AgentID = sole::uuid;
 
 using UIDAndStart = std::pair<UID, int64_t>;
@@ -54,6 +59,9 @@ struct SortByStart {
 
 /**
  * This class contains all kubernetes relate metadata.
+ *
+ * All the maps are persistent, and the objects in them are shared between clones of the state
+ * until they are modified, so Clone() is O(1) and an update only copies what it changes.
  */
 class K8sMetadataState : NotCopyable {
  public:
@@ -106,17 +114,23 @@ class K8sMetadataState : NotCopyable {
     };
   };
   using K8sEntityByNameMap =
-      absl::flat_hash_map<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
+      PersistentHashMap<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
+
+  // Hashes strings and string views the same way, to allow heterogeneous lookups.
+  template <typename V>
+  using StringKeyMap = PersistentHashMap<std::string, V, absl::Hash<std::string_view>>;
 
   using PodsByNameMap = K8sEntityByNameMap;
   using ServicesByNameMap = K8sEntityByNameMap;
   using ReplicaSetByNameMap = K8sEntityByNameMap;
   using DeploymentByNameMap = K8sEntityByNameMap;
   using NamespacesByNameMap = K8sEntityByNameMap;
-  using ContainersByNameMap = absl::flat_hash_map<std::string, CID>;
-  using PodsByPodIPMap = absl::flat_hash_map<std::string, UID>;
-  using PodsByIPAndStartTime = absl::flat_hash_map<std::string, std::set<UIDAndStart, SortByStart>>;
-  using ServicesByServiceIpMap = absl::flat_hash_map<std::string, UID>;
+  using ContainersByNameMap = StringKeyMap<CID>;
+  using PodsByPodIPMap = StringKeyMap<UID>;
+  using PodsByIPAndStartTime = StringKeyMap<std::set<UIDAndStart, SortByStart>>;
+  using ServicesByServiceIpMap = StringKeyMap<UID>;
+  using K8sObjectsByIDMap = StringKeyMap<K8sMetadataObjectSPtr>;
+  using ContainersByIDMap = StringKeyMap<ContainerInfoSPtr>;
 
   void set_service_cidr(CIDRBlock cidr) {
     if (!service_cidr_.has_value() || service_cidr_.value() != cidr) {
@@ -273,7 +287,16 @@ class K8sMetadataState : NotCopyable {
 
   Status CleanupExpiredMetadata(int64_t now, int64_t retention_time_ns);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  const ContainersByIDMap& containers_by_id() const { return containers_by_id_; }
+
+  /**
+   * MutableContainerInfoByID returns the container info by ID, after making sure that it is not
+   * shared with other clones of this state.
+   * @param id The ID of the container.
+   * @return ContainerInfo or nullptr if not found.
+   */
+  ContainerInfo* MutableContainerInfoByID(CIDView id);
+
   std::string DebugString(int indent_level = 0) const;
 
  private:
@@ -286,10 +309,10 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_by_id_;
+  K8sObjectsByIDMap k8s_objects_by_id_;
 
   // This stores container objects, complementing k8s_objects_by_id_.
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  ContainersByIDMap containers_by_id_;
 
   /**
    * Mapping of pods by name.
@@ -377,10 +400,10 @@ class AgentMetadataState : NotCopyable {
 
   std::shared_ptr<AgentMetadataState> CloneToShared() const;
 
-  PIDInfo* GetPIDByUPID(UPID upid) const {
-    auto it = pids_by_upid_.find(upid);
-    if (it != pids_by_upid_.end()) {
-      return it->second.get();
+  const PIDInfo* GetPIDByUPID(UPID upid) const {
+    auto pid_info = pids_by_upid_.find(upid);
+    if (pid_info != nullptr) {
+      return pid_info->get();
     }
     return nullptr;
   }
@@ -389,21 +412,23 @@ class AgentMetadataState : NotCopyable {
     DCHECK(pid_info != nullptr);
     DCHECK_EQ(pid_info->stop_time_ns(), 0);
 
-    pids_by_upid_[upid] = std::move(pid_info);
+    pids_by_upid_.InsertOrAssign(upid, PIDInfoSPtr(std::move(pid_info)));
     upids_.insert(upid);
   }
 
   void MarkUPIDAsStopped(UPID upid, int64_t ts) {
-    auto* pid_info = GetPIDByUPID(upid);
+    auto pid_info = pids_by_upid_.FindMutable(upid);
     if (pid_info != nullptr) {
-      pid_info->set_stop_time_ns(ts);
+      // The PIDInfo may be shared with other clones of this state.
+      CopyOnWrite(pid_info, [](const PIDInfo& p) { return PIDInfoSPtr(p.Clone()); })
+          ->set_stop_time_ns(ts);
       upids_.erase(upid);
     } else {
       DCHECK(!upids_.contains(upid));
     }
   }
 
-  const absl::flat_hash_map<UPID, PIDInfoUPtr>& pids_by_upid() const { return pids_by_upid_; }
+  const PIDInfoByUPIDMap& pids_by_upid() const { return pids_by_upid_; }
 
   const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
 
@@ -446,7 +471,7 @@ class AgentMetadataState : NotCopyable {
   /**
    * Mapping of PIDs by UPID for active pods on the system.
    */
-  absl::flat_hash_map<UPID, PIDInfoUPtr> pids_by_upid_;
+  PIDInfoByUPIDMap pids_by_upid_;
 
   /**
    * All active UPIDs. Unlike pids_by_upid_, this does not contain stopped pids.
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/benchmark/benchmark.h"
+#include "src/common/event/real_time_system.h"
+#include "src/shared/metadata/metadata_state.h"
+
+using ::px::md::AgentMetadataState;
+using ::px::md::K8sMetadataState;
+using ::px::md::PIDInfo;
+using ::px::md::UPID;
+
+namespace {
+
+constexpr int kContainersPerPod = 2;
+constexpr int kPodsPerService = 10;
+constexpr int kNumNamespaces = 100;
+// PIDs are only tracked for the pods of the local node.
+constexpr int kNumPIDs = 1000;
+
+px::event::RealTimeSystem* TimeSystem() {
+  static auto* time_system = new px::event::RealTimeSystem();
+  return time_system;
+}
+
+K8sMetadataState::PodUpdate PodUpdate(int pod, int64_t ts) {
+  K8sMetadataState::PodUpdate update;
+  update.set_uid(absl::Substitute("pod_uid_$0", pod));
+  update.set_name(absl::Substitute("pod_$0", pod));
+  update.set_namespace_(absl::Substitute("ns_$0", pod % kNumNamespaces));
+  update.set_start_timestamp_ns(ts);
+  for (int c = 0; c < kContainersPerPod; ++c) {
+    update.add_container_ids(absl::Substitute("container_uid_$0_$1", pod, c));
+    update.add_container_names(absl::Substitute("container_$0", c));
+  }
+  update.set_phase(px::shared::k8s::metadatapb::RUNNING);
+  update.set_node_name(absl::Substitute("node_$0", pod / 100));
+  update.set_hostname(update.node_name());
+  update.set_pod_ip(absl::Substitute("10.$0.$1.$2", pod >> 16, (pod >> 8) & 0xff, pod & 0xff));
+  update.set_host_ip(absl::Substitute("192.168.$0.$1", (pod / 100) >> 8, (pod / 100) & 0xff));
+  update.set_labels(R"({"app":"benchmark","tier":"backend"})");
+  return update;
+}
+
+// Builds the state of an agent in a cluster with the given number of pods.
+std::shared_ptr<AgentMetadataState> CreateState(int num_pods) {
+  auto state = std::make_shared<AgentMetadataState>(
+      "host", /* asid */ 1, /* pid */ 123, sole::uuid4(), "pem", sole::uuid4(), "vizier",
+      "pl", TimeSystem());
+  K8sMetadataState* k8s_state = state->k8s_metadata_state();
+
+  for (int ns = 0; ns < kNumNamespaces; ++ns) {
+    K8sMetadataState::NamespaceUpdate update;
+    update.set_uid(absl::Substitute("ns_uid_$0", ns));
+    update.set_name(absl::Substitute("ns_$0", ns));
+    PX_CHECK_OK(k8s_state->HandleNamespaceUpdate(update));
+  }
+
+  for (int pod = 0; pod < num_pods; ++pod) {
+    for (int c = 0; c < kContainersPerPod; ++c) {
+      K8sMetadataState::ContainerUpdate update;
+      update.set_cid(absl::Substitute("container_uid_$0_$1", pod, c));
+      update.set_name(absl::Substitute("container_$0", c));
+      update.set_start_timestamp_ns(1);
+      update.set_container_state(px::shared::k8s::metadatapb::CONTAINER_STATE_RUNNING);
+      PX_CHECK_OK(k8s_state->HandleContainerUpdate(update));
+    }
+    PX_CHECK_OK(k8s_state->HandlePodUpdate(PodUpdate(pod, 1)));
+  }
+
+  for (int service = 0; service < num_pods / kPodsPerService; ++service) {
+    K8sMetadataState::ServiceUpdate update;
+    update.set_uid(absl::Substitute("service_uid_$0", service));
+    update.set_name(absl::Substitute("service_$0", service));
+    update.set_namespace_(absl::Substitute("ns_$0", service % kNumNamespaces));
+    update.set_start_timestamp_ns(1);
+    update.set_cluster_ip(absl::Substitute("172.16.$0.$1", service >> 8, service & 0xff));
+    for (int pod = 0; pod < kPodsPerService; ++pod) {
+      update.add_pod_ids(absl::Substitute("pod_uid_$0", service * kPodsPerService + pod));
+    }
+    PX_CHECK_OK(k8s_state->HandleServiceUpdate(update));
+  }
+
+  for (int pid = 0; pid < kNumPIDs; ++pid) {
+    UPID upid(1, pid, pid);
+    state->AddUPID(upid, std::make_unique<PIDInfo>(upid, "/usr/bin/server", "server --port=8080",
+                                                   "container_uid_0_0"));
+  }
+  return state;
+}
+
+}  // namespace
+
+// Clones the state and applies a burst of pod updates to the clone, which is what every metadata
+// update of an agent does.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CloneAndApply(benchmark::State& state) {
+  const int num_pods = state.range(0);
+  const int num_updates = state.range(1);
+  std::shared_ptr<AgentMetadataState> current = CreateState(num_pods);
+
+  int64_t ts = 2;
+  int next_pod = 0;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    std::shared_ptr<AgentMetadataState> shadow = current->CloneToShared();
+    for (int i = 0; i < num_updates; ++i) {
+      PX_CHECK_OK(shadow->k8s_metadata_state()->HandlePodUpdate(PodUpdate(next_pod, ts)));
+      next_pod = (next_pod + 1) % num_pods;
+    }
+    shadow->MarkUPIDAsStopped(UPID(1, ts % kNumPIDs, ts % kNumPIDs), ts);
+    ++ts;
+    // Readers may still hold the previous state, so it is released after the swap.
+    current = std::move(shadow);
+  }
+  state.SetItemsProcessed(state.iterations() * num_updates);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PodLookup(benchmark::State& state) {
+  const int num_pods = state.range(0);
+  std::shared_ptr<AgentMetadataState> md = CreateState(num_pods);
+  const K8sMetadataState& k8s_state = md->k8s_metadata_state();
+
+  std::vector<std::string> pod_ids;
+  for (int pod = 0; pod < num_pods; pod += 7) {
+    pod_ids.push_back(absl::Substitute("pod_uid_$0", pod));
+  }
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    for (const auto& pod_id : pod_ids) {
+      benchmark::DoNotOptimize(k8s_state.PodInfoByID(pod_id));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * pod_ids.size());
+}
+
+BENCHMARK(BM_CloneAndApply)
+    ->ArgNames({"pods", "updates"})
+    ->Args({1000, 10})
+    ->Args({10000, 10})
+    ->Args({50000, 10})
+    ->Args({50000, 100})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PodLookup)->ArgName("pods")->Arg(1000)->Arg(10000)->Arg(50000);
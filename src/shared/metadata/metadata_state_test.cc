@@ -324,6 +324,33 @@ TEST(K8sMetadataStateTest, CloneCopiedCIDR) {
   EXPECT_EQ(service_cidr.prefix_length, state_copy->service_cidr()->prefix_length);
 }
 
+TEST(K8sMetadataStateTest, CloneUnaffectedByUpdates) {
+  K8sMetadataState state;
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kContainer0UpdatePbTxt, &container_update))
+      << "Failed to parse proto";
+
+  K8sMetadataState::PodUpdate pod_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod_update))
+      << "Failed to parse proto";
+
+  EXPECT_OK(state.HandleContainerUpdate(container_update));
+  auto state_copy = state.Clone();
+  // Objects are shared until they are modified.
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  EXPECT_OK(state.HandlePodUpdate(pod_update));
+  EXPECT_NE(nullptr, state.PodInfoByID("pod0_uid"));
+  EXPECT_EQ("pod0_uid", state.PodIDByName({"ns0", "pod0"}));
+  EXPECT_EQ("pod0_uid", state.ContainerInfoByID("container0_uid")->pod_id());
+
+  EXPECT_EQ(nullptr, state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ("", state_copy->PodIDByName({"ns0", "pod0"}));
+  EXPECT_EQ("", state_copy->ContainerInfoByID("container0_uid")->pod_id());
+}
+
 TEST(K8sMetadataStateTest, HandleContainerUpdate) {
   K8sMetadataState state;
 
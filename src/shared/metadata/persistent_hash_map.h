@@ -0,0 +1,388 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <absl/container/inlined_vector.h>
+#include <absl/hash/hash.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace md {
+
+/**
+ * Makes *ptr exclusively owned by the caller, by replacing it with clone(**ptr) if it is shared,
+ * and returns it for modification.
+ */
+template <typename T, typename TCloneFn>
+T* CopyOnWrite(std::shared_ptr<T>* ptr, TCloneFn clone) {
+  if (ptr->use_count() != 1) {
+    *ptr = clone(**ptr);
+  } else {
+    // Pairs with the release done by other owners when they dropped their references, so that
+    // their reads of *ptr happen before our writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return ptr->get();
+}
+
+/**
+ * PersistentHashMap is a hash array mapped trie (HAMT) whose nodes are shared between copies of
+ * the map. Copying a map is O(1), and a write to a copy only copies the O(log n) nodes on the path
+ * to the written key, so the other copies are never affected by it.
+ *
+ * This makes it possible to publish immutable snapshots of a large map and to build the next
+ * snapshot by applying a small number of changes to a copy of the current one.
+ *
+ * A map must not be written to concurrently, but copies of it can be read and written to from
+ * different threads. Lookups are heterogeneous when Hash and Eq are transparent.
+ */
+template <typename K, typename V, typename Hash = absl::Hash<K>, typename Eq = std::equal_to<>>
+class PersistentHashMap {
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K, V>;
+  class const_iterator;
+  using iterator = const_iterator;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @return a pointer to the value of key, or nullptr if the key is not in the map. The pointer
+   * is valid until the next write to this map.
+   */
+  template <typename KeyArg>
+  const V* find(const KeyArg& key) const {
+    const size_t hash = hash_(key);
+    const Node* node = root_.get();
+    for (int shift = 0; node != nullptr; shift += kBitsPerLevel) {
+      const uint32_t bit = SlotBit(hash, shift);
+      if ((node->bitmap & bit) == 0) {
+        return nullptr;
+      }
+      const Slot& slot = node->slots[SlotIndex(node->bitmap, bit)];
+      if (slot.node != nullptr) {
+        node = slot.node.get();
+        continue;
+      }
+      if (slot.leaf->hash != hash) {
+        return nullptr;
+      }
+      for (const auto& entry : slot.leaf->entries) {
+        if (eq_(entry.first, key)) {
+          return &entry.second;
+        }
+      }
+      return nullptr;
+    }
+    return nullptr;
+  }
+
+  template <typename KeyArg>
+  bool contains(const KeyArg& key) const {
+    return find(key) != nullptr;
+  }
+
+  /**
+   * @return a pointer to the value of key that can be modified without affecting other copies of
+   * this map, or nullptr if the key is not in the map. The pointer is valid until the next write
+   * to this map.
+   */
+  template <typename KeyArg>
+  V* FindMutable(const KeyArg& key) {
+    if (find(key) == nullptr) {
+      // Avoid copying the path of a key that isn't there.
+      return nullptr;
+    }
+    return Upsert</*insert*/ false>(key).first;
+  }
+
+  /**
+   * Inserts key with a value constructed from args if it is not in the map.
+   * @return a mutable pointer to the value of key, and whether it was inserted.
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<V*, bool> TryEmplace(KeyArg&& key, Args&&... args) {
+    return Upsert</*insert*/ true>(std::forward<KeyArg>(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Sets the value of key, inserting it if it is not in the map.
+   */
+  template <typename KeyArg, typename VArg>
+  void InsertOrAssign(KeyArg&& key, VArg&& value) {
+    auto [v, inserted] = Upsert</*insert*/ true>(std::forward<KeyArg>(key), value);
+    if (!inserted) {
+      *v = std::forward<VArg>(value);
+    }
+  }
+
+  /**
+   * @return whether the key was in the map.
+   */
+  template <typename KeyArg>
+  bool Erase(const KeyArg& key) {
+    if (find(key) == nullptr) {
+      return false;
+    }
+    EraseFromNode(&root_, hash_(key), 0, key);
+    if (root_->slots.empty()) {
+      root_.reset();
+    }
+    --size_;
+    return true;
+  }
+
+  const_iterator begin() const { return const_iterator(root_.get()); }
+  const_iterator end() const { return const_iterator(); }
+
+ private:
+  // Each level of the trie consumes this many bits of the hash.
+  static constexpr int kBitsPerLevel = 5;
+  static constexpr uint64_t kLevelMask = (1 << kBitsPerLevel) - 1;
+
+  struct Node;
+
+  // All the entries of a leaf have the same hash. There is more than one entry only when the full
+  // hashes of keys collide.
+  struct Leaf {
+    uint64_t hash;
+    absl::InlinedVector<value_type, 1> entries;
+  };
+
+  // Exactly one of node and leaf is set.
+  struct Slot {
+    std::shared_ptr<Node> node;
+    std::shared_ptr<Leaf> leaf;
+  };
+
+  // The slot for the i-th set bit of bitmap is slots[i].
+  struct Node {
+    uint32_t bitmap = 0;
+    std::vector<Slot> slots;
+  };
+
+  static uint32_t SlotBit(uint64_t hash, int shift) {
+    return 1u << ((hash >> shift) & kLevelMask);
+  }
+
+  static size_t SlotIndex(uint32_t bitmap, uint32_t bit) {
+    return __builtin_popcount(bitmap & (bit - 1));
+  }
+
+  template <typename T>
+  static T* Writable(std::shared_ptr<T>* ptr) {
+    return CopyOnWrite(ptr, [](const T& t) { return std::make_shared<T>(t); });
+  }
+
+  // Returns a mutable pointer to the value of key, after copying the shared nodes on its path.
+  // When the key is not in the map, it is inserted if insert is true, or nullptr is returned.
+  template <bool insert, typename KeyArg, typename... Args>
+  std::pair<V*, bool> Upsert(KeyArg&& key, Args&&... args) {
+    const uint64_t hash = hash_(key);
+    if (root_ == nullptr) {
+      if (!insert) {
+        return {nullptr, false};
+      }
+      root_ = std::make_shared<Node>();
+    }
+    Node* node = Writable(&root_);
+    for (int shift = 0;; shift += kBitsPerLevel) {
+      const uint32_t bit = SlotBit(hash, shift);
+      const size_t idx = SlotIndex(node->bitmap, bit);
+      if ((node->bitmap & bit) == 0) {
+        if (!insert) {
+          return {nullptr, false};
+        }
+        auto leaf = std::make_shared<Leaf>();
+        leaf->hash = hash;
+        leaf->entries.emplace_back(std::piecewise_construct,
+                                   std::forward_as_tuple(std::forward<KeyArg>(key)),
+                                   std::forward_as_tuple(std::forward<Args>(args)...));
+        node->bitmap |= bit;
+        node->slots.insert(node->slots.begin() + idx, Slot{nullptr, leaf});
+        ++size_;
+        return {&leaf->entries.back().second, true};
+      }
+
+      Slot& slot = node->slots[idx];
+      if (slot.node != nullptr) {
+        node = Writable(&slot.node);
+        continue;
+      }
+
+      if (slot.leaf->hash == hash) {
+        Leaf* leaf = Writable(&slot.leaf);
+        for (auto& entry : leaf->entries) {
+          if (eq_(entry.first, key)) {
+            return {&entry.second, false};
+          }
+        }
+        if (!insert) {
+          return {nullptr, false};
+        }
+        leaf->entries.emplace_back(std::piecewise_construct,
+                                   std::forward_as_tuple(std::forward<KeyArg>(key)),
+                                   std::forward_as_tuple(std::forward<Args>(args)...));
+        ++size_;
+        return {&leaf->entries.back().second, true};
+      }
+
+      if (!insert) {
+        return {nullptr, false};
+      }
+      // The slot holds a leaf with another hash: push it one level down, where the hashes are
+      // compared on the next bits. Different hashes always diverge before the bits run out.
+      DCHECK_LT(shift + kBitsPerLevel, 64);
+      auto child = std::make_shared<Node>();
+      child->bitmap = SlotBit(slot.leaf->hash, shift + kBitsPerLevel);
+      child->slots.push_back(Slot{nullptr, std::move(slot.leaf)});
+      slot.leaf = nullptr;
+      slot.node = child;
+      node = child.get();
+    }
+  }
+
+  // Removes key, which must be in the subtree, from the subtree rooted at *node_ptr.
+  template <typename KeyArg>
+  void EraseFromNode(std::shared_ptr<Node>* node_ptr, uint64_t hash, int shift,
+                     const KeyArg& key) {
+    Node* node = Writable(node_ptr);
+    const uint32_t bit = SlotBit(hash, shift);
+    const size_t idx = SlotIndex(node->bitmap, bit);
+    Slot& slot = node->slots[idx];
+
+    bool remove_slot = false;
+    if (slot.node != nullptr) {
+      EraseFromNode(&slot.node, hash, shift + kBitsPerLevel, key);
+      const Node* child = slot.node.get();
+      if (child->slots.empty()) {
+        remove_slot = true;
+      } else if (child->slots.size() == 1 && child->slots[0].leaf != nullptr) {
+        // Pull a lone leaf back up, so that the trie doesn't keep chains of single child nodes.
+        auto leaf = child->slots[0].leaf;
+        slot.node = nullptr;
+        slot.leaf = std::move(leaf);
+      }
+    } else {
+      Leaf* leaf = Writable(&slot.leaf);
+      for (auto it = leaf->entries.begin(); it != leaf->entries.end(); ++it) {
+        if (eq_(it->first, key)) {
+          leaf->entries.erase(it);
+          break;
+        }
+      }
+      remove_slot = leaf->entries.empty();
+    }
+
+    if (remove_slot) {
+      node->bitmap &= ~bit;
+      node->slots.erase(node->slots.begin() + idx);
+    }
+  }
+
+  std::shared_ptr<Node> root_;
+  size_t size_ = 0;
+  Hash hash_;
+  Eq eq_;
+
+ public:
+  /**
+   * Iterates over the entries in an unspecified order. Iterators are invalidated by writes to the
+   * map, but not by writes to its copies.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PersistentHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return leaf_->entries[entry_]; }
+    pointer operator->() const { return &leaf_->entries[entry_]; }
+
+    const_iterator& operator++() {
+      if (++entry_ == leaf_->entries.size()) {
+        NextLeaf();
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return leaf_ == other.leaf_ && entry_ == other.entry_;
+    }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class PersistentHashMap;
+
+    explicit const_iterator(const Node* root) {
+      if (root != nullptr) {
+        stack_.emplace_back(root, 0);
+        NextLeaf();
+      }
+    }
+
+    // Moves to the first entry of the next leaf in depth first order.
+    void NextLeaf() {
+      leaf_ = nullptr;
+      entry_ = 0;
+      while (!stack_.empty()) {
+        auto& [node, idx] = stack_.back();
+        if (idx == node->slots.size()) {
+          stack_.pop_back();
+          continue;
+        }
+        const Slot& slot = node->slots[idx++];
+        if (slot.leaf != nullptr) {
+          leaf_ = slot.leaf.get();
+          return;
+        }
+        stack_.emplace_back(slot.node.get(), 0);
+      }
+    }
+
+    // The nodes on the path to the current leaf, with the index of the next slot to visit.
+    std::vector<std::pair<const Node*, size_t>> stack_;
+    const Leaf* leaf_ = nullptr;
+    size_t entry_ = 0;
+  };
+};
+
+}  // namespace md
+}  // namespace px
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+
+#include "src/shared/metadata/persistent_hash_map.h"
+
+namespace px {
+namespace md {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+// Only uses the low bits of the key, so that full hashes collide.
+struct CollidingHash {
+  size_t operator()(int v) const { return v % 4; }
+};
+
+TEST(PersistentHashMap, insert_find_erase) {
+  PersistentHashMap<std::string, int, absl::Hash<std::string_view>> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(nullptr, map.find("a"));
+
+  auto [a, inserted] = map.TryEmplace("a", 1);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(1, *a);
+  EXPECT_FALSE(map.TryEmplace("a", 2).second);
+  map.InsertOrAssign(std::string_view("b"), 2);
+  map.InsertOrAssign("a", 3);
+  *map.FindMutable(std::string_view("b")) += 10;
+
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ(3, *map.find(std::string_view("a")));
+  EXPECT_EQ(12, *map.find("b"));
+  EXPECT_EQ(nullptr, map.FindMutable("c"));
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("a", 3), Pair("b", 12)));
+
+  EXPECT_TRUE(map.Erase("a"));
+  EXPECT_FALSE(map.Erase("a"));
+  EXPECT_EQ(1, map.size());
+  EXPECT_FALSE(map.contains("a"));
+  EXPECT_TRUE(map.Erase("b"));
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(PersistentHashMap, copies_are_isolated) {
+  PersistentHashMap<int, std::string> map;
+  for (int i = 0; i < 1000; ++i) {
+    map.InsertOrAssign(i, std::to_string(i));
+  }
+
+  auto copy = map;
+  copy.InsertOrAssign(1, "one");
+  copy.Erase(2);
+  copy.TryEmplace(1000, "1000");
+  *copy.FindMutable(3) = "three";
+
+  EXPECT_EQ(1000, map.size());
+  EXPECT_EQ("1", *map.find(1));
+  EXPECT_EQ("2", *map.find(2));
+  EXPECT_EQ("3", *map.find(3));
+  EXPECT_FALSE(map.contains(1000));
+
+  EXPECT_EQ(1000, copy.size());
+  EXPECT_EQ("one", *copy.find(1));
+  EXPECT_FALSE(copy.contains(2));
+  EXPECT_EQ("three", *copy.find(3));
+  EXPECT_EQ("1000", *copy.find(1000));
+
+  // Writing to the original doesn't affect the copy either.
+  map.Erase(1);
+  EXPECT_EQ("one", *copy.find(1));
+}
+
+TEST(PersistentHashMap, hash_collisions) {
+  PersistentHashMap<int, int, CollidingHash> map;
+  for (int i = 0; i < 20; ++i) {
+    map.InsertOrAssign(i, i * 2);
+  }
+  auto copy = map;
+  for (int i = 0; i < 20; i += 2) {
+    EXPECT_TRUE(copy.Erase(i));
+  }
+
+  EXPECT_EQ(20, map.size());
+  EXPECT_EQ(10, copy.size());
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_NE(nullptr, map.find(i));
+    EXPECT_EQ(i * 2, *map.find(i));
+    EXPECT_EQ(i % 2 == 1, copy.contains(i));
+  }
+}
+
+TEST(PersistentHashMap, matches_std_map) {
+  std::mt19937 rng(37);
+  std::uniform_int_distribution<int> key_dist(0, 5000);
+  PersistentHashMap<int, int> map;
+  std::map<int, int> expected;
+  std::vector<std::pair<PersistentHashMap<int, int>, std::map<int, int>>> snapshots;
+
+  for (int i = 0; i < 50000; ++i) {
+    int key = key_dist(rng);
+    if (i % 3 == 0) {
+      EXPECT_EQ(expected.erase(key) == 1, map.Erase(key));
+    } else {
+      map.InsertOrAssign(key, i);
+      expected[key] = i;
+    }
+    if (i % 10000 == 0) {
+      snapshots.emplace_back(map, expected);
+    }
+  }
+  snapshots.emplace_back(map, expected);
+
+  for (const auto& [snapshot, snapshot_expected] : snapshots) {
+    ASSERT_EQ(snapshot_expected.size(), snapshot.size());
+    std::map<int, int> actual(snapshot.begin(), snapshot.end());
+    EXPECT_EQ(snapshot_expected, actual);
+  }
+}
+
+}  // namespace md
+}  // namespace px
@@ -235,9 +235,11 @@ Status ProcessPIDUpdates(
     int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState* md,
     CGroupMetadataReader* md_reader,
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
-  const auto& k8s_md_state = md->k8s_metadata_state();
+  auto* k8s_md_state = md->k8s_metadata_state();
 
-  for (const auto& [cid, cinfo] : k8s_md_state->containers_by_id()) {
+  // Iterate over a snapshot of the containers, so that they are only copied when they change.
+  const K8sMetadataState::ContainersByIDMap containers = k8s_md_state->containers_by_id();
+  for (const auto& [cid, cinfo] : containers) {
     if (cinfo->stop_time_ns() != 0) {
       // Ignore dead containers.
       // TODO(zasgar): Come up with a cleaner way of doing this. Probably by using active/inactive
@@ -263,7 +265,7 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      k8s_md_state->MutableContainerInfoByID(cid)->set_stop_time_ns(pod_info->stop_time_ns());
       continue;
     }
 
@@ -281,17 +283,23 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
+        ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfoByID(cid);
+        mutable_cinfo->set_stop_time_ns(ts);
+        for (const auto& upid : mutable_cinfo->active_upids()) {
           md->MarkUPIDAsStopped(upid, ts);
         }
-        cinfo->mutable_active_upids()->clear();
+        mutable_cinfo->mutable_active_upids()->clear();
       }
       continue;
     }
 
-    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, cinfo->mutable_active_upids(),
-                               &cgroups_active_pids, pid_updates);
+    StartTimeOrderedUPIDSet active_upids = cinfo->active_upids();
+    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, &active_upids, &cgroups_active_pids,
+                               pid_updates);
+    if (active_upids != cinfo->active_upids()) {
+      *k8s_md_state->MutableContainerInfoByID(cid)->mutable_active_upids() =
+          std::move(active_upids);
+    }
   }
 
   return Status::OK();
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+
+#include "src/shared/types/tracking_memory_pool.h"
+
+namespace px {
+namespace types {
+
+TrackingMemoryPool::TrackingMemoryPool(std::string_view name, arrow::MemoryPool* backing_pool,
+                                       int64_t hard_limit, int64_t soft_limit)
+    : name_(name),
+      parent_(nullptr),
+      backing_pool_(backing_pool),
+      hard_limit_(hard_limit),
+      soft_limit_(soft_limit) {}
+
+TrackingMemoryPool::TrackingMemoryPool(std::string_view name, TrackingMemoryPool* parent,
+                                       int64_t hard_limit, int64_t soft_limit)
+    : name_(absl::StrCat(parent->name(), "/", name)),
+      parent_(parent),
+      backing_pool_(parent->backing_pool_),
+      hard_limit_(hard_limit),
+      soft_limit_(soft_limit) {}
+
+TrackingMemoryPool::~TrackingMemoryPool() {
+  absl::base_internal::SpinLockHolder lock(&children_lock_);
+  for (const auto& [child, released] : children_) {
+    delete child;
+  }
+  LOG_IF(WARNING, bytes_allocated() != 0) << absl::Substitute(
+      "Memory pool $0 is deleted with $1 bytes still allocated.", name_, bytes_allocated());
+}
+
+TrackingMemoryPool* TrackingMemoryPool::ProcessPool() {
+  static auto* pool = new TrackingMemoryPool("process", arrow::default_memory_pool());
+  return pool;
+}
+
+TrackingMemoryPool* TrackingMemoryPool::CreateChild(std::string_view name, int64_t hard_limit,
+                                                    int64_t soft_limit) {
+  auto* child = new TrackingMemoryPool(name, this, hard_limit, soft_limit);
+  absl::base_internal::SpinLockHolder lock(&children_lock_);
+  DeleteFreedChildren();
+  children_[child] = false;
+  return child;
+}
+
+void TrackingMemoryPool::ReleaseChild(TrackingMemoryPool* child) {
+  absl::base_internal::SpinLockHolder lock(&children_lock_);
+  auto it = children_.find(child);
+  DCHECK(it != children_.end()) << absl::Substitute("$0 is not a child of $1", child->name(),
+                                                    name_);
+  if (it == children_.end()) {
+    return;
+  }
+  it->second = true;
+  DeleteFreedChildren();
+}
+
+void TrackingMemoryPool::DeleteFreedChildren() {
+  for (auto it = children_.begin(); it != children_.end();) {
+    auto* child = it->first;
+    bool released = it->second;
+    if (released && child->CanDelete()) {
+      delete child;
+      children_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool TrackingMemoryPool::CanDelete() const {
+  // bytes_ is read first: a Track() whose update of bytes_ is observed here has already
+  // incremented active_tracks_ of the pool it started at, so it is seen by HasActiveTracks() until
+  // it stops touching this pool and its ancestors.
+  if (bytes_.load(std::memory_order_acquire) != 0) {
+    return false;
+  }
+  return !HasActiveTracks();
+}
+
+bool TrackingMemoryPool::HasActiveTracks() const {
+  if (active_tracks_.load(std::memory_order_acquire) != 0) {
+    return true;
+  }
+  absl::base_internal::SpinLockHolder lock(&children_lock_);
+  for (const auto& [child, released] : children_) {
+    if (child->HasActiveTracks()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t TrackingMemoryPool::NumChildren() const {
+  absl::base_internal::SpinLockHolder lock(&children_lock_);
+  return children_.size();
+}
+
+arrow::Status TrackingMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  auto status = backing_pool_->Allocate(size, out);
+  if (status.ok()) {
+    Track(size);
+  }
+  return status;
+}
+
+arrow::Status TrackingMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  auto status = backing_pool_->Reallocate(old_size, new_size, ptr);
+  if (status.ok()) {
+    Track(new_size - old_size);
+  }
+  return status;
+}
+
+void TrackingMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  backing_pool_->Free(buffer, size);
+  Track(-size);
+}
+
+void TrackingMemoryPool::Track(int64_t delta) {
+  // Once the bytes of a released pool reach 0 its parent may delete it, while this call still
+  // walks up through it. The active count keeps this pool and, since a pool is only deleted along
+  // with its children, all of its ancestors alive until the walk is done.
+  active_tracks_.fetch_add(1, std::memory_order_seq_cst);
+  for (TrackingMemoryPool* pool = this; pool != nullptr; pool = pool->parent_) {
+    int64_t bytes = pool->bytes_.fetch_add(delta, std::memory_order_acq_rel) + delta;
+    pool->UpdateLimitState(bytes, delta);
+  }
+  active_tracks_.fetch_sub(1, std::memory_order_release);
+}
+
+void TrackingMemoryPool::UpdateLimitState(int64_t bytes, int64_t delta) {
+  if (delta > 0) {
+    int64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (bytes > peak &&
+           !peak_bytes_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+    }
+  }
+  if (soft_limit_ <= 0) {
+    return;
+  }
+  if (bytes > soft_limit_) {
+    // Only warn when the limit is crossed, not on every allocation above it.
+    if (!above_soft_limit_.exchange(true, std::memory_order_relaxed)) {
+      LOG(WARNING) << absl::Substitute(
+          "Memory pool $0 is using $1 bytes, above its soft limit of $2 bytes.", name_, bytes,
+          soft_limit_);
+    }
+  } else if (above_soft_limit_.load(std::memory_order_relaxed)) {
+    above_soft_limit_.store(false, std::memory_order_relaxed);
+  }
+}
+
+Status TrackingMemoryPool::CheckLimits() const {
+  for (const TrackingMemoryPool* pool = this; pool != nullptr; pool = pool->parent_) {
+    int64_t bytes = pool->bytes_allocated();
+    if (pool->hard_limit_ > 0 && bytes > pool->hard_limit_) {
+      return error::ResourceUnavailable(
+          "Memory pool $0 is using $1 bytes, above its limit of $2 bytes (peak $3 bytes).",
+          pool->name_, bytes, pool->hard_limit_, pool->max_memory());
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace types
+}  // namespace px
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace types {
+
+/**
+ * TrackingMemoryPool is an arrow::MemoryPool that accounts for the bytes allocated through it and
+ * through all of its descendants, so that memory can be attributed along a hierarchy such as
+ * process -> table_store -> table, or process -> carnot -> query -> exec node. All allocations are
+ * served by the arrow pool of the root.
+ *
+ * Each pool may have a soft limit, above which a warning is logged, and a hard limit, above which
+ * CheckLimits() fails. Allocations themselves are never refused because of a limit: many arrow
+ * builder call sites treat an allocation failure as fatal, so the limits are enforced by the
+ * owners of the pools checking them between units of work.
+ *
+ * Children are owned by their parent. Arrow buffers keep a raw pointer to the pool that allocated
+ * them, so a released child is only deleted once all of its memory has been freed, and no Free()
+ * of one of its descendants is still walking up through it.
+ */
+class TrackingMemoryPool : public arrow::MemoryPool {
+ public:
+  /**
+   * Creates a root pool, which allocates from backing_pool.
+   * @param hard_limit the hard limit in bytes, or 0 for no limit.
+   * @param soft_limit the soft limit in bytes, or 0 for no limit.
+   */
+  TrackingMemoryPool(std::string_view name, arrow::MemoryPool* backing_pool,
+                     int64_t hard_limit = 0, int64_t soft_limit = 0);
+  ~TrackingMemoryPool() override;
+
+  /**
+   * @return the root pool of the process, which allocates from arrow's default pool.
+   */
+  static TrackingMemoryPool* ProcessPool();
+
+  /**
+   * Creates a child pool, named <name of this pool>/<name>. The child is valid until it is passed
+   * to ReleaseChild and all the memory allocated from it has been freed.
+   */
+  TrackingMemoryPool* CreateChild(std::string_view name, int64_t hard_limit = 0,
+                                  int64_t soft_limit = 0);
+
+  /**
+   * Releases a child created by CreateChild. No new allocations may be made from it afterwards.
+   */
+  void ReleaseChild(TrackingMemoryPool* child);
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  /**
+   * Accounts for memory that wasn't allocated through this pool, e.g. the column wrappers written
+   * to a table. The caller must track the same bytes with a negative delta once they are freed.
+   */
+  void TrackExternal(int64_t delta) { Track(delta); }
+
+  /**
+   * @return the bytes currently allocated from this pool and its descendants.
+   */
+  int64_t bytes_allocated() const override { return bytes_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the peak of bytes_allocated().
+   */
+  int64_t max_memory() const override { return peak_bytes_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return ResourceUnavailable if this pool or any of its ancestors is above its hard limit.
+   */
+  Status CheckLimits() const;
+
+  const std::string& name() const { return name_; }
+  int64_t hard_limit() const { return hard_limit_; }
+  int64_t soft_limit() const { return soft_limit_; }
+  TrackingMemoryPool* parent() const { return parent_; }
+
+  /**
+   * @return the number of children that were not deleted yet, including released ones.
+   */
+  size_t NumChildren() const;
+
+ private:
+  TrackingMemoryPool(std::string_view name, TrackingMemoryPool* parent, int64_t hard_limit,
+                     int64_t soft_limit);
+
+  // Adds delta to the bytes of this pool and all of its ancestors.
+  void Track(int64_t delta);
+  void UpdateLimitState(int64_t bytes, int64_t delta);
+  void DeleteFreedChildren() ABSL_EXCLUSIVE_LOCKS_REQUIRED(children_lock_);
+  // Whether nothing is allocated from this pool and no Track() of it or its descendants is running.
+  bool CanDelete() const;
+  bool HasActiveTracks() const;
+
+  const std::string name_;
+  TrackingMemoryPool* const parent_;
+  arrow::MemoryPool* const backing_pool_;
+  const int64_t hard_limit_;
+  const int64_t soft_limit_;
+
+  std::atomic<int64_t> bytes_ = 0;
+  std::atomic<int64_t> peak_bytes_ = 0;
+  std::atomic<bool> above_soft_limit_ = false;
+  // The number of Track() calls that started at this pool and are still walking its ancestors.
+  std::atomic<int64_t> active_tracks_ = 0;
+
+  mutable absl::base_internal::SpinLock children_lock_;
+  // The value is whether the child was released.
+  absl::flat_hash_map<TrackingMemoryPool*, bool> children_ ABSL_GUARDED_BY(children_lock_);
+};
+
+}  // namespace types
+}  // namespace px
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/tracking_memory_pool.h"
+
+namespace px {
+namespace types {
+
+TEST(TrackingMemoryPool, tracks_allocations_up_the_hierarchy) {
+  TrackingMemoryPool root("root", arrow::default_memory_pool());
+  TrackingMemoryPool* query = root.CreateChild("query");
+  TrackingMemoryPool* node1 = query->CreateChild("node_1");
+  TrackingMemoryPool* node2 = query->CreateChild("node_2");
+  EXPECT_EQ("root/query/node_1", node1->name());
+
+  uint8_t* buf1;
+  uint8_t* buf2;
+  ASSERT_TRUE(node1->Allocate(100, &buf1).ok());
+  ASSERT_TRUE(node2->Allocate(50, &buf2).ok());
+  EXPECT_EQ(100, node1->bytes_allocated());
+  EXPECT_EQ(50, node2->bytes_allocated());
+  EXPECT_EQ(150, query->bytes_allocated());
+  EXPECT_EQ(150, root.bytes_allocated());
+
+  ASSERT_TRUE(node1->Reallocate(100, 300, &buf1).ok());
+  EXPECT_EQ(350, root.bytes_allocated());
+  node1->Free(buf1, 300);
+  EXPECT_EQ(0, node1->bytes_allocated());
+  EXPECT_EQ(300, node1->max_memory());
+  EXPECT_EQ(50, root.bytes_allocated());
+  EXPECT_EQ(350, root.max_memory());
+
+  node2->Free(buf2, 50);
+  EXPECT_EQ(0, root.bytes_allocated());
+}
+
+TEST(TrackingMemoryPool, tracks_external_memory) {
+  TrackingMemoryPool root("root", arrow::default_memory_pool());
+  TrackingMemoryPool* table = root.CreateChild("table");
+
+  table->TrackExternal(200);
+  EXPECT_EQ(200, table->bytes_allocated());
+  EXPECT_EQ(200, root.bytes_allocated());
+  table->TrackExternal(-150);
+  EXPECT_EQ(50, root.bytes_allocated());
+  EXPECT_EQ(200, root.max_memory());
+
+  table->TrackExternal(-50);
+  root.ReleaseChild(table);
+  EXPECT_EQ(0u, root.NumChildren());
+}
+
+TEST(TrackingMemoryPool, arrow_builders_allocate_from_pool) {
+  TrackingMemoryPool root("root", arrow::default_memory_pool());
+  TrackingMemoryPool* table = root.CreateChild("table");
+  {
+    std::vector<Int64Value> values(1000, 1);
+    auto array = ToArrow(values, table);
+    EXPECT_GE(table->bytes_allocated(), 1000 * static_cast<int64_t>(sizeof(int64_t)));
+  }
+  EXPECT_EQ(0, table->bytes_allocated());
+}
+
+TEST(TrackingMemoryPool, check_limits) {
+  TrackingMemoryPool root("root", arrow::default_memory_pool(), /*hard_limit*/ 1000);
+  TrackingMemoryPool* query = root.CreateChild("query", /*hard_limit*/ 200, /*soft_limit*/ 100);
+  TrackingMemoryPool* other_query = root.CreateChild("other_query");
+
+  uint8_t* buf1;
+  ASSERT_TRUE(query->Allocate(150, &buf1).ok());
+  // Above the soft limit only warns.
+  EXPECT_OK(query->CheckLimits());
+
+  uint8_t* buf2;
+  ASSERT_TRUE(query->Allocate(100, &buf2).ok());
+  auto status = query->CheckLimits();
+  EXPECT_EQ(statuspb::RESOURCE_UNAVAILABLE, status.code());
+  EXPECT_THAT(status.msg(), ::testing::HasSubstr("root/query"));
+  EXPECT_OK(other_query->CheckLimits());
+  query->Free(buf2, 100);
+  EXPECT_OK(query->CheckLimits());
+
+  // The limit of an ancestor applies to all of its descendants.
+  uint8_t* buf3;
+  ASSERT_TRUE(other_query->Allocate(900, &buf3).ok());
+  EXPECT_NOT_OK(other_query->CheckLimits());
+  EXPECT_NOT_OK(query->CheckLimits());
+
+  query->Free(buf1, 150);
+  other_query->Free(buf3, 900);
+  EXPECT_OK(root.CheckLimits());
+}
+
+TEST(TrackingMemoryPool, released_child_outlives_its_allocations) {
+  TrackingMemoryPool root("root", arrow::default_memory_pool());
+  TrackingMemoryPool* query = root.CreateChild("query");
+  query->CreateChild("node_1");
+
+  uint8_t* buf;
+  ASSERT_TRUE(query->Allocate(64, &buf).ok());
+  root.ReleaseChild(query);
+  // The query still has memory allocated, so it is kept around.
+  EXPECT_EQ(1, root.NumChildren());
+  query->Free(buf, 64);
+
+  // Freed children are deleted on the next change to the parent's children.
+  root.CreateChild("other_query");
+  EXPECT_EQ(1, root.NumChildren());
+  EXPECT_EQ(0, root.bytes_allocated());
+}
+
+// Frees the last allocation of released children while other threads delete freed children. Run
+// under ASAN to catch a child deleted while its Free() is still updating the ancestors.
+TEST(TrackingMemoryPool, concurrent_free_and_delete) {
+  constexpr int kNumThreads = 4;
+  constexpr int kIterations = 2000;
+  TrackingMemoryPool root("root", arrow::default_memory_pool());
+  TrackingMemoryPool* carnot = root.CreateChild("carnot", /*hard_limit*/ 0, /*soft_limit*/ 1);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([carnot] {
+      for (int i = 0; i < kIterations; ++i) {
+        TrackingMemoryPool* query = carnot->CreateChild("query");
+        TrackingMemoryPool* node = query->CreateChild("node");
+        uint8_t* buf;
+        ASSERT_TRUE(node->Allocate(64, &buf).ok());
+        carnot->ReleaseChild(query);
+        node->Free(buf, 64);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(0, root.bytes_allocated());
+  carnot->CreateChild("last_query");
+  EXPECT_EQ(1, carnot->NumChildren());
+}
+
+}  // namespace types
+}  // namespace px
@@ -136,7 +136,10 @@ struct FixedSizedValueType : BaseValueType {
   }
 
   Status Deserialize(const StringValue& in) {
-    DCHECK(sizeof(val) == in.size());
+    if (in.size() != sizeof(val)) {
+      return error::InvalidArgument("Expected a serialized value of $0 bytes, got $1", sizeof(val),
+                                    in.size());
+    }
     std::memcpy(reinterpret_cast<char*>(&val), in.data(), sizeof(val));
     return Status::OK();
   }
@@ -70,9 +70,9 @@ StandaloneContext::StandaloneContext(absl::flat_hash_set<md::UPID> upids,
   for (auto upid : upids_) {
     std::string exe_path = proc_parser.GetExePath(upid.pid()).ValueOr("");
     std::string cmdline = proc_parser.GetPIDCmdline(upid.pid());
-    auto pid_info = std::make_unique<md::PIDInfo>(upid, std::move(exe_path), std::move(cmdline),
+    auto pid_info = std::make_shared<md::PIDInfo>(upid, std::move(exe_path), std::move(cmdline),
                                                   /*cid*/ md::CID{});
-    upid_pidinfo_map_[upid] = std::move(pid_info);
+    upid_pidinfo_map_.InsertOrAssign(upid, std::move(pid_info));
   }
 }
 
@@ -58,7 +58,7 @@ class ConnectorContext {
   /**
    * Return detailed information on UPIDs.
    */
-  virtual const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const = 0;
+  virtual const md::PIDInfoByUPIDMap& GetPIDInfoMap() const = 0;
 
   /**
    * Return K8s information (Pod and container information)
@@ -101,7 +101,7 @@ class AgentContext : public ConnectorContext {
     return agent_metadata_state_->upids();
   }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
+  const md::PIDInfoByUPIDMap& GetPIDInfoMap() const override {
     return agent_metadata_state_->pids_by_upid();
   }
 
@@ -132,9 +132,7 @@ class StandaloneContext : public ConnectorContext {
 
   const absl::flat_hash_set<md::UPID>& GetUPIDs() const override { return upids_; }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
-    return upid_pidinfo_map_;
-  }
+  const md::PIDInfoByUPIDMap& GetPIDInfoMap() const override { return upid_pidinfo_map_; }
 
   const md::K8sMetadataState& GetK8SMetadata() override {
     static const md::K8sMetadataState kEmpty;
@@ -149,7 +147,7 @@ class StandaloneContext : public ConnectorContext {
 
  protected:
   absl::flat_hash_set<md::UPID> upids_;
-  absl::flat_hash_map<md::UPID, md::PIDInfoUPtr> upid_pidinfo_map_;
+  md::PIDInfoByUPIDMap upid_pidinfo_map_;
 
  private:
   std::vector<CIDRBlock> cidrs_;
@@ -140,9 +140,9 @@ class ResolveTargetObjPathTest : public ::testing::Test {
     ASSERT_OK(k8s_mds_.HandlePodUpdate(pod0_update));
     ASSERT_OK(k8s_mds_.HandlePodUpdate(pod1_update));
 
-    k8s_mds_.containers_by_id()["pod0_container0"]->mutable_active_upids()->emplace(
+    k8s_mds_.MutableContainerInfoByID("pod0_container0")->mutable_active_upids()->emplace(
         PIDToUPID(server_.child_pid()));
-    k8s_mds_.containers_by_id()["pod1_container0"]->mutable_active_upids()->emplace(
+    k8s_mds_.MutableContainerInfoByID("pod1_container0")->mutable_active_upids()->emplace(
         PIDToUPID(client_.child_pid()));
 
     // On some machines, apparently it can take some time for /proc/<pid>/cmdline
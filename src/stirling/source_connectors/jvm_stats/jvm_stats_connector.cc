@@ -56,11 +56,11 @@ void JVMStatsConnector::FindJavaUPIDs(const ConnectorContext& ctx) {
       continue;
     }
 
-    auto iter = upid_pidinfo_map.find(upid);
-    if (iter == upid_pidinfo_map.end() || iter->second == nullptr) {
+    auto pid_info = upid_pidinfo_map.find(upid);
+    if (pid_info == nullptr || *pid_info == nullptr) {
       continue;
     }
-    const std::filesystem::path proc_exe = iter->second->exe_path();
+    const std::filesystem::path proc_exe = (*pid_info)->exe_path();
     if (DetectApplication(proc_exe) != Application::kJava) {
       continue;
     }
@@ -135,8 +135,7 @@ void ProcExitConnector::TransferDataImpl(ConnectorContext* ctx) {
 }
 
 void ProcExitConnector::UpdateCrashedJavaProcCounters(
-    uint32_t asid, const proc_exit_event_t& event,
-    const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& upid_pid_info_map) {
+    uint32_t asid, const proc_exit_event_t& event, const md::PIDInfoByUPIDMap& upid_pid_info_map) {
   const uint8_t exit_signal = GetExitSignal(event.exit_code);
 
   const bool is_sig_abrt = exit_signal == SIGABRT;
@@ -152,16 +151,16 @@ void ProcExitConnector::UpdateCrashedJavaProcCounters(
   }
 
   md::UPID md_upid = event.upid.ToMetadataUPID(asid);
-  auto iter = upid_pid_info_map.find(md_upid);
+  auto pid_info_ptr = upid_pid_info_map.find(md_upid);
   if (
       // Don't track any non-K8s process. upid_pid_info_map was obtained from K8s metadata, which
       // indicates whether or not a process is managed by K8s.
-      iter == upid_pid_info_map.end() ||
+      pid_info_ptr == nullptr ||
       // Missing PIDInfo
-      iter->second == nullptr) {
+      *pid_info_ptr == nullptr) {
     return;
   }
-  const md::PIDInfo& pid_info = *iter->second;
+  const md::PIDInfo& pid_info = **pid_info_ptr;
   if (DetectApplication(pid_info.exe_path()) != Application::kJava) {
     return;
   }
@@ -20,8 +20,11 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/strings/str_format.h>
 #include "src/common/base/base.h"
 #include "src/shared/types/arrow_adapter.h"
@@ -34,7 +37,30 @@ namespace schema {
 
 using types::DataType;
 
-std::shared_ptr<arrow::Array> RowBatch::ColumnAt(int64_t i) const { return columns_[i]; }
+Status DictionaryDecodeStrings(std::shared_ptr<arrow::Array>* output_column,
+                               const table_store::schemapb::DictionaryStringColumn& input_data);
+
+std::shared_ptr<arrow::Array> RowBatch::ColumnAt(int64_t i) const {
+  if (columns_[i] != nullptr) {
+    return columns_[i];
+  }
+  auto* dictionary_column = dictionary_columns_[i].get();
+  std::call_once(dictionary_column->expand_once, [dictionary_column]() {
+    // The column was checked by FromProto, so only running out of memory can fail here.
+    PX_CHECK_OK(DictionaryDecodeStrings(&dictionary_column->array, dictionary_column->data));
+    dictionary_column->data.Clear();
+  });
+  return dictionary_column->array;
+}
+
+std::vector<std::shared_ptr<arrow::Array>> RowBatch::columns() const {
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  columns.reserve(columns_.size());
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    columns.push_back(ColumnAt(i));
+  }
+  return columns;
+}
 
 Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
   if (columns_.size() >= desc_.size()) {
@@ -51,6 +77,13 @@ Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
   return Status::OK();
 }
 
+void RowBatch::AddDictionaryColumn(table_store::schemapb::DictionaryStringColumn data) {
+  dictionary_columns_.resize(columns_.size() + 1);
+  dictionary_columns_.back() = std::make_shared<DictionaryColumn>();
+  dictionary_columns_.back()->data = std::move(data);
+  columns_.emplace_back(nullptr);
+}
+
 bool RowBatch::HasColumn(int64_t i) const { return columns_.size() > static_cast<size_t>(i); }
 
 std::string RowBatch::DebugString() const {
@@ -58,7 +91,7 @@ std::string RowBatch::DebugString() const {
     return "RowBatch: <empty>";
   }
   std::string debug_string = absl::StrFormat("RowBatch(eow=%d, eos=%d):\n", eow_, eos_);
-  for (const auto& col : columns_) {
+  for (const auto& col : columns()) {
     debug_string += absl::StrFormat("  %s\n", col->ToString());
   }
   return debug_string;
@@ -70,7 +103,7 @@ int64_t RowBatch::NumBytes() const {
   }
 
   int64_t total_bytes = 0;
-  for (auto col : columns_) {
+  for (const auto& col : columns()) {
 #define TYPE_CASE(_dt_) total_bytes += types::GetArrowArrayBytes<_dt_>(col.get());
     PX_SWITCH_FOREACH_DATATYPE(types::ArrowToDataType(col->type_id()), TYPE_CASE);
 #undef TYPE_CASE
@@ -158,7 +191,102 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
   return Status::OK();
 }
 
-Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
+// Dictionary encodes input_column, unless more than half of its values are distinct. Returns
+// whether the column was encoded.
+bool DictionaryEncodeStrings(table_store::schemapb::Column* output_column,
+                             arrow::Array* input_column) {
+  int64_t col_length = input_column->length();
+  if (col_length == 0) {
+    return false;
+  }
+  absl::flat_hash_map<std::string_view, uint32_t> value_indices;
+  std::vector<std::string_view> dictionary;
+  std::vector<uint32_t> indices;
+  indices.reserve(col_length);
+  for (int64_t i = 0; i < col_length; ++i) {
+    auto value = types::GetStringViewFromArrowArray(input_column, i);
+    auto [it, inserted] = value_indices.try_emplace(value, dictionary.size());
+    if (inserted) {
+      if (2 * static_cast<int64_t>(dictionary.size() + 1) > col_length) {
+        return false;
+      }
+      dictionary.push_back(value);
+    }
+    indices.push_back(it->second);
+  }
+
+  auto output_data = output_column->mutable_dictionary_string_data();
+  output_data->mutable_dictionary()->Reserve(dictionary.size());
+  for (const auto& value : dictionary) {
+    output_data->add_dictionary(value.data(), value.size());
+  }
+  output_data->mutable_indices()->Add(indices.begin(), indices.end());
+  return true;
+}
+
+void DeltaEncodeTimes(table_store::schemapb::Column* output_column, arrow::Array* input_column) {
+  int64_t col_length = input_column->length();
+  auto deltas = output_column->mutable_delta_time64ns_data()->mutable_deltas();
+  deltas->Reserve(col_length);
+  // Unsigned arithmetic, so that the deltas wrap around instead of overflowing.
+  uint64_t prev = 0;
+  for (int64_t i = 0; i < col_length; ++i) {
+    auto val =
+        static_cast<uint64_t>(types::GetValueFromArrowArray<DataType::TIME64NS>(input_column, i));
+    deltas->Add(static_cast<int64_t>(val - prev));
+    prev = val;
+  }
+}
+
+Status CheckDictionaryStrings(const table_store::schemapb::DictionaryStringColumn& input_data,
+                              int64_t num_rows) {
+  if (input_data.indices_size() != num_rows) {
+    return error::InvalidArgument("Dictionary column has $0 values, expected $1",
+                                  input_data.indices_size(), num_rows);
+  }
+  for (auto idx : input_data.indices()) {
+    if (idx >= static_cast<uint32_t>(input_data.dictionary_size())) {
+      return error::InvalidArgument("Dictionary index $0 is out of range, dictionary has $1 values",
+                                    idx, input_data.dictionary_size());
+    }
+  }
+  return Status::OK();
+}
+
+// Expands a dictionary column that was checked with CheckDictionaryStrings.
+Status DictionaryDecodeStrings(std::shared_ptr<arrow::Array>* output_column,
+                               const table_store::schemapb::DictionaryStringColumn& input_data) {
+  const auto& dictionary = input_data.dictionary();
+  int64_t data_size = 0;
+  for (auto idx : input_data.indices()) {
+    DCHECK_LT(idx, static_cast<uint32_t>(dictionary.size()));
+    data_size += dictionary[idx].size();
+  }
+
+  arrow::StringBuilder builder(arrow::default_memory_pool());
+  PX_RETURN_IF_ERROR(builder.Reserve(input_data.indices_size()));
+  PX_RETURN_IF_ERROR(builder.ReserveData(data_size));
+  for (auto idx : input_data.indices()) {
+    builder.UnsafeAppend(dictionary[idx]);
+  }
+  PX_RETURN_IF_ERROR(builder.Finish(output_column));
+  return Status::OK();
+}
+
+Status DeltaDecodeTimes(std::shared_ptr<arrow::Array>* output_column,
+                        const table_store::schemapb::DeltaTime64NSColumn& input_data) {
+  auto builder = MakeArrowBuilder(DataType::TIME64NS, arrow::default_memory_pool());
+  PX_RETURN_IF_ERROR(builder->Reserve(input_data.deltas_size()));
+  uint64_t val = 0;
+  for (auto delta : input_data.deltas()) {
+    val += static_cast<uint64_t>(delta);
+    PX_RETURN_IF_ERROR(CopyValue<DataType::TIME64NS>(builder.get(), static_cast<int64_t>(val)));
+  }
+  PX_RETURN_IF_ERROR(builder->Finish(output_column));
+  return Status::OK();
+}
+
+Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto, bool encode_columns) const {
   proto->set_num_rows(num_rows_);
   proto->set_eow(eow_);
   proto->set_eos(eos_);
@@ -168,6 +296,16 @@ Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
     auto output_col_data = proto->add_cols();
     auto dt = desc_.type(col_idx);
 
+    if (encode_columns) {
+      if (dt == DataType::STRING && DictionaryEncodeStrings(output_col_data, input_col)) {
+        continue;
+      }
+      if (dt == DataType::TIME64NS) {
+        DeltaEncodeTimes(output_col_data, input_col);
+        continue;
+      }
+    }
+
 #define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col);
     PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
@@ -190,7 +328,10 @@ StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
     case table_store::schemapb::Column::kFloat64Data:
       return DataType::FLOAT64;
     case table_store::schemapb::Column::kStringData:
+    case table_store::schemapb::Column::kDictionaryStringData:
       return DataType::STRING;
+    case table_store::schemapb::Column::kDeltaTime64NsData:
+      return DataType::TIME64NS;
     default:
       return error::Internal("Received unknown column data type '$0' in ProtoDataType",
                              magic_enum::enum_name(proto.col_data_case()));
@@ -204,7 +345,16 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
 
   for (auto i = 0; i < proto.cols_size(); ++i) {
     PX_ASSIGN_OR_RETURN(types[i], ProtoDataType(proto.cols(i)));
-    std::shared_ptr<arrow::Array> output_array;
+    const auto& col = proto.cols(i);
+    if (col.has_dictionary_string_data()) {
+      // Expanded by ColumnAt when the column is first read.
+      PX_RETURN_IF_ERROR(CheckDictionaryStrings(col.dictionary_string_data(), proto.num_rows()));
+      continue;
+    }
+    if (col.has_delta_time64ns_data()) {
+      PX_RETURN_IF_ERROR(DeltaDecodeTimes(&data_columns[i], col.delta_time64ns_data()));
+      continue;
+    }
 
 #define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(CopyFromInputPB<_dt_>(&data_columns[i], proto.cols(i)));
     PX_SWITCH_FOREACH_DATATYPE(types[i], TYPE_CASE);
@@ -217,6 +367,10 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
   output_rb->set_eos(proto.eos());
 
   for (auto i = 0; i < proto.cols_size(); ++i) {
+    if (data_columns[i] == nullptr) {
+      output_rb->AddDictionaryColumn(proto.cols(i).dictionary_string_data());
+      continue;
+    }
     PX_RETURN_IF_ERROR(output_rb->AddColumn(data_columns[i]));
   }
 
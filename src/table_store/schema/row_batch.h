@@ -22,6 +22,7 @@
 #include <arrow/type.h>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -49,7 +50,20 @@ class RowBatch {
     columns_.reserve(desc_.size());
   }
 
-  Status ToProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
+  /**
+   * Serializes the row batch to proto.
+   *
+   * @param encode_columns whether to encode the columns to make them smaller: string columns where
+   * values repeat are dictionary encoded, and time columns are delta encoded. FromProto decodes
+   * these columns, but other readers of RowBatchData may not.
+   */
+  Status ToProto(table_store::schemapb::RowBatchData* row_batch_proto,
+                 bool encode_columns = false) const;
+  /**
+   * Deserializes a row batch from proto. Dictionary encoded string columns are only expanded into
+   * arrow arrays the first time they are read with ColumnAt, so columns that are never read are
+   * never expanded.
+   */
   static StatusOr<std::unique_ptr<RowBatch>> FromProto(
       const table_store::schemapb::RowBatchData& row_batch_proto);
 
@@ -116,7 +130,7 @@ class RowBatch {
   const RowDescriptor& desc() const { return desc_; }
 
   std::string DebugString() const;
-  std::vector<std::shared_ptr<arrow::Array>> columns() const { return columns_; }
+  std::vector<std::shared_ptr<arrow::Array>> columns() const;
 
   int64_t NumBytes() const;
 
@@ -126,6 +140,19 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+
+  // A dictionary encoded string column, expanded the first time it is read. Copies of the row batch
+  // share it, so that it is expanded only once.
+  struct DictionaryColumn {
+    table_store::schemapb::DictionaryStringColumn data;
+    std::once_flag expand_once;
+    std::shared_ptr<arrow::Array> array;
+  };
+  // Adds a dictionary column that was already checked against the schema. Its entry in columns_
+  // stays null.
+  void AddDictionaryColumn(table_store::schemapb::DictionaryStringColumn data);
+  // Indexed like columns_, null for the columns that aren't dictionary encoded.
+  std::vector<std::shared_ptr<DictionaryColumn>> dictionary_columns_;
 };
 
 // Append a scalar value to an arrow::Array.
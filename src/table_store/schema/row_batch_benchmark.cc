@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zlib.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <benchmark/benchmark.h>
+
+#include "src/common/benchmark/benchmark.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::table_store::schemapb::RowBatchData;
+using px::types::DataType;
+
+namespace {
+
+// Builds a batch that looks like the results of a query on http_events: increasing timestamps,
+// service, pod and namespace columns with few distinct values, and mostly distinct bodies.
+std::unique_ptr<RowBatch> HTTPEventsRowBatch(int64_t num_rows) {
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<int64_t> time_step(0, 1000 * 1000);
+  std::uniform_int_distribution<int> service_idx(0, 19);
+  std::uniform_int_distribution<int> pod_idx(0, 4);
+  std::uniform_int_distribution<int> namespace_idx(0, 2);
+  std::uniform_int_distribution<int> path_idx(0, 49);
+  std::uniform_int_distribution<int64_t> latency_ns(100 * 1000, 100 * 1000 * 1000);
+
+  std::vector<px::types::Time64NSValue> times;
+  std::vector<px::types::StringValue> services;
+  std::vector<px::types::StringValue> pods;
+  std::vector<px::types::StringValue> namespaces;
+  std::vector<px::types::StringValue> req_paths;
+  std::vector<px::types::Int64Value> resp_statuses;
+  std::vector<px::types::Int64Value> latencies;
+  std::vector<px::types::StringValue> resp_bodies;
+  int64_t time = 1640000000000000000;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    time += time_step(rng);
+    times.push_back(time);
+    int service = service_idx(rng);
+    int ns = namespace_idx(rng);
+    services.push_back(absl::Substitute("ns-$0/service-$1", ns, service));
+    pods.push_back(absl::Substitute("ns-$0/service-$1-7d9f8c6b5-$2", ns, service, pod_idx(rng)));
+    namespaces.push_back(absl::Substitute("ns-$0", ns));
+    req_paths.push_back(absl::Substitute("/api/v1/resource-$0", path_idx(rng)));
+    resp_statuses.push_back(i % 50 == 0 ? 500 : 200);
+    int64_t latency = latency_ns(rng);
+    latencies.push_back(latency);
+    resp_bodies.push_back(absl::Substitute(R"({"id": $0, "latency": $1})", i, latency));
+  }
+
+  auto rb = std::make_unique<RowBatch>(
+      RowDescriptor({DataType::TIME64NS, DataType::STRING, DataType::STRING, DataType::STRING,
+                     DataType::STRING, DataType::INT64, DataType::INT64, DataType::STRING}),
+      num_rows);
+  auto* pool = arrow::default_memory_pool();
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(times, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(services, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(pods, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(namespaces, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(req_paths, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(resp_statuses, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(latencies, pool)));
+  PX_CHECK_OK(rb->AddColumn(px::types::ToArrow(resp_bodies, pool)));
+  return rb;
+}
+
+// Compresses like GRPC's gzip message compression, up to the few bytes of the gzip header.
+std::string Compress(const std::string& in) {
+  uLongf out_size = compressBound(in.size());
+  std::string out(out_size, '\0');
+  CHECK_EQ(Z_OK, compress2(reinterpret_cast<Bytef*>(out.data()), &out_size,
+                           reinterpret_cast<const Bytef*>(in.data()), in.size(),
+                           Z_DEFAULT_COMPRESSION));
+  out.resize(out_size);
+  return out;
+}
+
+std::string Uncompress(const std::string& in, size_t size) {
+  std::string out(size, '\0');
+  uLongf out_size = size;
+  CHECK_EQ(Z_OK, uncompress(reinterpret_cast<Bytef*>(out.data()), &out_size,
+                            reinterpret_cast<const Bytef*>(in.data()), in.size()));
+  return out;
+}
+
+}  // namespace
+
+// Serializes a batch as it is sent to the query broker, and reports the bytes on the wire.
+template <bool encode_columns, bool compress>
+static void BM_RowBatchToWire(benchmark::State& state) {  // NOLINT
+  auto rb = HTTPEventsRowBatch(state.range(0));
+  size_t wire_bytes = 0;
+  for (auto _ : state) {
+    RowBatchData proto;
+    PX_CHECK_OK(rb->ToProto(&proto, encode_columns));
+    std::string serialized = proto.SerializeAsString();
+    if constexpr (compress) {
+      serialized = Compress(serialized);
+    }
+    wire_bytes = serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.counters["WireBytes"] = wire_bytes;
+  state.counters["WireBytesPerRow"] = static_cast<double>(wire_bytes) / state.range(0);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Reads a batch received from the wire back into arrow arrays.
+template <bool encode_columns, bool compress>
+static void BM_RowBatchFromWire(benchmark::State& state) {  // NOLINT
+  auto rb = HTTPEventsRowBatch(state.range(0));
+  RowBatchData proto;
+  PX_CHECK_OK(rb->ToProto(&proto, encode_columns));
+  std::string serialized = proto.SerializeAsString();
+  size_t serialized_size = serialized.size();
+  if constexpr (compress) {
+    serialized = Compress(serialized);
+  }
+  for (auto _ : state) {
+    RowBatchData received;
+    if constexpr (compress) {
+      CHECK(received.ParseFromString(Uncompress(serialized, serialized_size)));
+    } else {
+      CHECK(received.ParseFromString(serialized));
+    }
+    auto received_rb = RowBatch::FromProto(received).ConsumeValueOrDie();
+    // Read every column, so that dictionary columns are expanded too.
+    for (int64_t i = 0; i < received_rb->num_columns(); ++i) {
+      benchmark::DoNotOptimize(received_rb->ColumnAt(i));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_RowBatchToWire, false, false)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchToWire, false, true)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchToWire, true, false)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchToWire, true, true)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchFromWire, false, false)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchFromWire, false, true)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchFromWire, true, false)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_RowBatchFromWire, true, true)->Arg(1000)->Arg(100000);
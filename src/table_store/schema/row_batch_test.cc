@@ -179,6 +179,118 @@ TEST_F(RowBatchTest, to_from_proto) {
   EXPECT_TRUE(differ.Compare(input_proto, output_proto));
 }
 
+constexpr char kEncodedRowBatchProto[] = R"(
+cols {
+  delta_time64ns_data {
+    deltas: 100
+    deltas: 10
+    deltas: 0
+    deltas: -20
+  }
+}
+cols {
+  dictionary_string_data {
+    dictionary: "svc_a"
+    dictionary: "svc_b"
+    indices: 0
+    indices: 1
+    indices: 0
+    indices: 0
+  }
+}
+cols {
+  string_data {
+    data: "a"
+    data: "b"
+    data: "c"
+    data: "a"
+  }
+}
+eow: false
+eos: true
+num_rows: 4
+)";
+
+TEST_F(RowBatchTest, to_from_encoded_proto) {
+  RowBatch rb(RowDescriptor({types::DataType::TIME64NS, types::DataType::STRING,
+                             types::DataType::STRING}),
+              4);
+  std::vector<types::Time64NSValue> times = {100, 110, 110, 90};
+  std::vector<types::StringValue> services = {"svc_a", "svc_b", "svc_a", "svc_a"};
+  // Mostly distinct strings aren't worth a dictionary.
+  std::vector<types::StringValue> names = {"a", "b", "c", "a"};
+  ASSERT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  ASSERT_OK(rb.AddColumn(types::ToArrow(services, arrow::default_memory_pool())));
+  ASSERT_OK(rb.AddColumn(types::ToArrow(names, arrow::default_memory_pool())));
+  rb.set_eos(true);
+
+  table_store::schemapb::RowBatchData encoded_proto;
+  EXPECT_OK(rb.ToProto(&encoded_proto, /* encode_columns */ true));
+  table_store::schemapb::RowBatchData expected_proto;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::MergeFromString(kEncodedRowBatchProto, &expected_proto));
+  google::protobuf::util::MessageDifferencer differ;
+  EXPECT_TRUE(differ.Compare(expected_proto, encoded_proto));
+
+  ASSERT_OK_AND_ASSIGN(auto decoded_rb, RowBatch::FromProto(encoded_proto));
+  EXPECT_EQ(rb.desc(), decoded_rb->desc());
+  EXPECT_TRUE(decoded_rb->eos());
+  EXPECT_EQ(rb.DebugString(), decoded_rb->DebugString());
+
+  // The decoded batch serializes to the same proto as the original one.
+  table_store::schemapb::RowBatchData plain_proto;
+  table_store::schemapb::RowBatchData decoded_plain_proto;
+  EXPECT_OK(rb.ToProto(&plain_proto));
+  EXPECT_OK(decoded_rb->ToProto(&decoded_plain_proto));
+  EXPECT_TRUE(differ.Compare(plain_proto, decoded_plain_proto));
+}
+
+TEST_F(RowBatchTest, from_proto_invalid_dictionary_index) {
+  table_store::schemapb::RowBatchData proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(R"(
+cols {
+  dictionary_string_data {
+    dictionary: "a"
+    indices: 0
+    indices: 1
+  }
+}
+num_rows: 2
+)",
+                                                            &proto));
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
+TEST_F(RowBatchTest, from_proto_dictionary_row_count_mismatch) {
+  table_store::schemapb::RowBatchData proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(R"(
+cols {
+  dictionary_string_data {
+    dictionary: "a"
+    indices: 0
+    indices: 0
+  }
+}
+num_rows: 3
+)",
+                                                            &proto));
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
+TEST_F(RowBatchTest, from_proto_expands_dictionary_once) {
+  table_store::schemapb::RowBatchData proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kEncodedRowBatchProto, &proto));
+  ASSERT_OK_AND_ASSIGN(auto rb, RowBatch::FromProto(proto));
+  RowBatch rb_copy = *rb;
+
+  auto services = rb->ColumnAt(1);
+  ASSERT_EQ(4, services->length());
+  EXPECT_EQ("svc_b", types::GetValueFromArrowArray<types::DataType::STRING>(services.get(), 1));
+  // Copies of the batch share the expanded column.
+  EXPECT_EQ(services.get(), rb_copy.ColumnAt(1).get());
+  EXPECT_EQ(services.get(), rb->ColumnAt(1).get());
+}
+
 TEST_F(RowBatchTest, with_zero_rows) {
   bool eow = true;
   bool eos = false;
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/table_store/table/compaction_scheduler.h"
+
+DEFINE_int32(table_store_compaction_threads,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_THREADS", 2),
+             "The number of background threads that compact tables in the table store. 0 compacts "
+             "the tables serially on the thread that triggers compaction.");
+
+namespace px {
+namespace table_store {
+
+CompactionScheduler::CompactionScheduler(int num_threads) {
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&CompactionScheduler::WorkerLoop, this);
+  }
+}
+
+CompactionScheduler::~CompactionScheduler() { Stop(); }
+
+void CompactionScheduler::Stop() {
+  {
+    absl::MutexLock lock(&mu_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+    queue_.clear();
+    work_cv_.SignalAll();
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  absl::MutexLock lock(&mu_);
+  idle_cv_.SignalAll();
+}
+
+int64_t CompactionScheduler::Priority(Table* table) {
+  auto stats = table->GetTableStats();
+  int64_t& last_bytes_added = last_bytes_added_[table];
+  int64_t bytes_written = stats.bytes_added - last_bytes_added;
+  last_bytes_added = stats.bytes_added;
+  return stats.hot_bytes + bytes_written;
+}
+
+void CompactionScheduler::Enqueue(std::shared_ptr<Table> table) {
+  int64_t priority = Priority(table.get());
+  pending_.insert(table.get());
+  queue_.push_back(QueuedTable{priority, std::move(table)});
+  std::push_heap(queue_.begin(), queue_.end());
+  work_cv_.Signal();
+}
+
+void CompactionScheduler::Schedule(const std::vector<std::shared_ptr<Table>>& tables) {
+  absl::MutexLock lock(&mu_);
+  if (stopped_) {
+    return;
+  }
+  // Forget the dropped tables, whose address may be reused by a new table. Pending tables are
+  // still referenced by the queue or a worker.
+  absl::flat_hash_set<const Table*> live_tables;
+  for (const auto& table : tables) {
+    live_tables.insert(table.get());
+  }
+  absl::erase_if(last_bytes_added_, [&](const auto& entry) {
+    return !live_tables.contains(entry.first) && !pending_.contains(entry.first);
+  });
+
+  for (const auto& table : tables) {
+    if (pending_.contains(table.get()) || !table->CompactionReady()) {
+      continue;
+    }
+    Enqueue(table);
+  }
+}
+
+void CompactionScheduler::WaitForIdle() {
+  absl::MutexLock lock(&mu_);
+  while (!stopped_ && (!queue_.empty() || num_running_ > 0)) {
+    idle_cv_.Wait(&mu_);
+  }
+}
+
+void CompactionScheduler::WorkerLoop() {
+  absl::MutexLock lock(&mu_);
+  while (true) {
+    while (!stopped_ && queue_.empty()) {
+      work_cv_.Wait(&mu_);
+    }
+    if (stopped_) {
+      return;
+    }
+    std::pop_heap(queue_.begin(), queue_.end());
+    std::shared_ptr<Table> table = std::move(queue_.back().table);
+    queue_.pop_back();
+    ++num_running_;
+
+    Status status;
+    {
+      mu_.Unlock();
+      status = table->CompactHotToCold();
+      mu_.Lock();
+    }
+    LOG_IF(ERROR, !status.ok()) << status.msg();
+
+    --num_running_;
+    pending_.erase(table.get());
+    // Each call compacts a bounded number of batches, so requeue tables that are still behind to
+    // give the other tables a turn in between.
+    if (status.ok() && !stopped_ && table->CompactionReady()) {
+      Enqueue(std::move(table));
+    }
+    if (queue_.empty() && num_running_ == 0) {
+      idle_cv_.SignalAll();
+    }
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
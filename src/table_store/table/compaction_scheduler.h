@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+DECLARE_int32(table_store_compaction_threads);
+
+namespace px {
+namespace table_store {
+
+/**
+ * CompactionScheduler compacts tables on a pool of background threads.
+ *
+ * Schedule() queues every table that has a compacted batch ready, ordered by how much hot data it
+ * holds plus how many bytes were written to it since it was last scheduled, so that the busiest
+ * tables are compacted first. Each worker compacts one table at a time, for at most
+ * Table::kMaxBatchesPerCompactionCall batches, and requeues the table if it still has data ready.
+ * A table is never compacted by two workers at once, but different tables are compacted in
+ * parallel.
+ */
+class CompactionScheduler : public NotCopyable {
+ public:
+  explicit CompactionScheduler(int num_threads);
+  ~CompactionScheduler();
+
+  /**
+   * Queues the tables that are ready to be compacted. Doesn't block on the compaction itself.
+   * Called with all the tables of the store, tables missing from it are forgotten.
+   */
+  void Schedule(const std::vector<std::shared_ptr<Table>>& tables);
+
+  /**
+   * Blocks until all queued compactions have finished.
+   */
+  void WaitForIdle();
+
+  /**
+   * Stops the workers. Queued compactions that haven't started are dropped.
+   */
+  void Stop();
+
+ private:
+  struct QueuedTable {
+    int64_t priority;
+    std::shared_ptr<Table> table;
+
+    bool operator<(const QueuedTable& other) const { return priority < other.priority; }
+  };
+
+  void WorkerLoop();
+  // Returns the priority of the table, and records its bytes added for the next call.
+  int64_t Priority(Table* table) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Enqueue(std::shared_ptr<Table> table) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  std::vector<std::thread> workers_;
+
+  absl::Mutex mu_;
+  absl::CondVar work_cv_;
+  absl::CondVar idle_cv_;
+  // Max-heap of tables waiting for a worker.
+  std::vector<QueuedTable> queue_ ABSL_GUARDED_BY(mu_);
+  // Tables that are queued or being compacted.
+  absl::flat_hash_set<const Table*> pending_ ABSL_GUARDED_BY(mu_);
+  // The bytes added to each table as of its last priority computation.
+  absl::flat_hash_map<const Table*, int64_t> last_bytes_added_ ABSL_GUARDED_BY(mu_);
+  int64_t num_running_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stopped_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/schema/row_descriptor.h"
+#include "src/table_store/table/compaction_scheduler.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+constexpr int64_t kRowsPerBatch = 10;
+// Each batch of int64 rows is 80 bytes, so every cold batch holds 4 hot batches.
+constexpr int64_t kCompactedBatchSize = 320;
+
+std::shared_ptr<Table> TestTable(const schema::Relation& rel) {
+  return std::make_shared<Table>("test_table", rel, 1024 * 1024, kCompactedBatchSize);
+}
+
+void WriteBatches(Table* table, const schema::Relation& rel, int64_t num_batches) {
+  schema::RowDescriptor rd(rel.col_types());
+  std::vector<types::Int64Value> col(kRowsPerBatch, 1);
+  for (int64_t i = 0; i < num_batches; ++i) {
+    schema::RowBatch rb(rd, col.size());
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(col, arrow::default_memory_pool())));
+    PX_CHECK_OK(table->WriteRowBatch(rb));
+  }
+}
+
+int64_t CountRows(Table* table) {
+  int64_t num_rows = 0;
+  Table::Cursor cursor(table);
+  while (!cursor.Done()) {
+    auto rb_or_s = cursor.GetNextRowBatch({0});
+    EXPECT_OK(rb_or_s);
+    num_rows += rb_or_s.ConsumeValueOrDie()->num_rows();
+  }
+  return num_rows;
+}
+
+}  // namespace
+
+TEST(CompactionSchedulerTest, compacts_tables_in_background) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  std::vector<std::shared_ptr<Table>> tables;
+  for (int i = 0; i < 4; ++i) {
+    tables.push_back(TestTable(rel));
+    WriteBatches(tables.back().get(), rel, 8 * (i + 1));
+  }
+
+  CompactionScheduler scheduler(2);
+  scheduler.Schedule(tables);
+  scheduler.WaitForIdle();
+
+  for (int64_t i = 0; i < static_cast<int64_t>(tables.size()); ++i) {
+    const auto& table = tables[i];
+    auto stats = table->GetTableStats();
+    EXPECT_EQ(2 * (i + 1), stats.compacted_batches);
+    EXPECT_EQ(0, stats.hot_bytes);
+    EXPECT_FALSE(table->CompactionReady());
+    EXPECT_EQ(8 * (i + 1) * kRowsPerBatch, CountRows(table.get()));
+  }
+}
+
+TEST(CompactionSchedulerTest, requeues_tables_that_are_behind) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  auto table = TestTable(rel);
+  // More cold batches than a single CompactHotToCold call creates.
+  int64_t num_cold_batches = Table::kMaxBatchesPerCompactionCall + 10;
+  WriteBatches(table.get(), rel, 4 * num_cold_batches);
+
+  CompactionScheduler scheduler(1);
+  scheduler.Schedule({table});
+  scheduler.WaitForIdle();
+
+  EXPECT_EQ(num_cold_batches, table->GetTableStats().compacted_batches);
+  EXPECT_FALSE(table->CompactionReady());
+}
+
+TEST(CompactionSchedulerTest, concurrent_writes) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  auto table = TestTable(rel);
+  CompactionScheduler scheduler(2);
+
+  constexpr int64_t kNumRounds = 100;
+  std::thread writer([&]() {
+    for (int64_t i = 0; i < kNumRounds; ++i) {
+      WriteBatches(table.get(), rel, 5);
+    }
+  });
+  for (int64_t i = 0; i < kNumRounds; ++i) {
+    scheduler.Schedule({table});
+  }
+  writer.join();
+  scheduler.Schedule({table});
+  scheduler.WaitForIdle();
+
+  EXPECT_FALSE(table->CompactionReady());
+  EXPECT_EQ(kNumRounds * 5 * kRowsPerBatch, CountRows(table.get()));
+}
+
+}  // namespace table_store
+}  // namespace px
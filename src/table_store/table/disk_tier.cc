@@ -0,0 +1,203 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/substitute.h>
+
+#include "src/common/fs/fs_wrapper.h"
+#include "src/table_store/table/disk_tier.h"
+
+DEFINE_string(table_store_disk_tier_dir, gflags::StringFromEnv("PL_TABLE_STORE_DISK_TIER_DIR", ""),
+              "Directory on local disk where data expired from the in-memory tables is kept, so "
+              "it can still be queried. Empty disables the disk tier.");
+DEFINE_int32(table_store_disk_tier_size_limit_mb,
+             gflags::Int32FromEnv("PL_TABLE_STORE_DISK_TIER_SIZE_LIMIT_MB", 1024),
+             "The maximal size of the on-disk segments of a table. When the size grows beyond this "
+             "limit, the oldest segment is deleted.");
+DEFINE_int32(table_store_disk_segment_size,
+             gflags::Int32FromEnv("PL_TABLE_STORE_DISK_SEGMENT_SIZE", 16 * 1024 * 1024),
+             "The number of bytes of expired data to gather before writing it to a segment file.");
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+constexpr char kSegmentExtension[] = ".seg";
+
+int64_t ColdBatchBytes(const internal::ColdBatch& batch) {
+  int64_t bytes = 0;
+  for (const auto& array : batch) {
+    for (const auto& buffer : array->data()->buffers) {
+      if (buffer != nullptr) {
+        bytes += buffer->size();
+      }
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
+
+DiskTier::DiskTier(const std::filesystem::path& dir, const schema::Relation& rel,
+                   int64_t time_col_idx, int64_t max_bytes, int64_t segment_size)
+    : dir_(dir),
+      rel_(rel),
+      max_bytes_(max_bytes),
+      segment_size_(segment_size),
+      store_(rel, time_col_idx) {}
+
+StatusOr<std::unique_ptr<DiskTier>> DiskTier::Create(const std::filesystem::path& dir,
+                                                     const schema::Relation& rel,
+                                                     int64_t time_col_idx, int64_t max_bytes,
+                                                     int64_t segment_size) {
+  PX_RETURN_IF_ERROR(fs::CreateDirectories(dir));
+  auto disk_tier = std::unique_ptr<DiskTier>(
+      new DiskTier(dir, rel, time_col_idx, max_bytes, segment_size));
+  PX_RETURN_IF_ERROR(disk_tier->LoadSegments());
+  return disk_tier;
+}
+
+Status DiskTier::LoadSegments() {
+  std::vector<std::pair<int64_t, std::filesystem::path>> segment_files;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+    const auto& path = entry.path();
+    int64_t seq;
+    if (path.extension() == kSegmentExtension && absl::SimpleAtoi(path.stem().string(), &seq)) {
+      segment_files.emplace_back(seq, path);
+    } else if (path.extension() == ".tmp") {
+      // Left over from a write that didn't complete.
+      PX_RETURN_IF_ERROR(fs::Remove(path));
+    }
+  }
+  if (ec) {
+    return error::Internal("Failed to list segment directory $0: $1", dir_.string(),
+                           ec.message());
+  }
+  std::sort(segment_files.begin(), segment_files.end());
+
+  for (const auto& [seq, path] : segment_files) {
+    next_segment_seq_ = seq + 1;
+    auto segment_or_s = internal::MappedSegment::Open(path, rel_);
+    if (!segment_or_s.ok()) {
+      LOG(WARNING) << absl::Substitute("Dropping unreadable segment $0: $1", path.string(),
+                                       segment_or_s.status().msg());
+      PX_RETURN_IF_ERROR(fs::Remove(path));
+      continue;
+    }
+    auto segment = segment_or_s.ConsumeValueOrDie();
+    RowID first_row_id = store_.Size() > 0 ? store_.LastRowID() + 1 : 0;
+    for (const auto& batch : segment->batches()) {
+      store_.EmplaceBack(first_row_id, batch);
+      first_row_id += batch[0]->length();
+    }
+    AddSegment(path, *segment);
+  }
+  EvictSegments();
+  return Status::OK();
+}
+
+void DiskTier::AddSegment(const std::filesystem::path& path,
+                          const internal::MappedSegment& segment) {
+  segments_.push_back(Segment{path, static_cast<int64_t>(segment.batches().size()),
+                              segment.file_size()});
+  segment_bytes_ += segment.file_size();
+}
+
+void DiskTier::Append(RowID first_row_id, ColdBatch batch) {
+  int64_t bytes = ColdBatchBytes(batch);
+  store_.EmplaceBack(first_row_id, std::move(batch));
+  pending_batch_bytes_.push_back(bytes);
+  pending_bytes_ += bytes;
+  EvictSegments();
+}
+
+DiskTier::PendingSegment DiskTier::StartSeal() {
+  DCHECK(!sealing_);
+  sealing_ = true;
+  PendingSegment pending;
+  pending.path = dir_ / absl::StrFormat("%012d%s", next_segment_seq_++, kSegmentExtension);
+  size_t first_pending = store_.Size() - pending_batch_bytes_.size();
+  for (size_t i = first_pending; i < store_.Size(); ++i) {
+    pending.batches.push_back(store_.at(i));
+  }
+  pending.bytes = pending_bytes_;
+  return pending;
+}
+
+StatusOr<std::unique_ptr<internal::MappedSegment>> DiskTier::WriteSegment(
+    const PendingSegment& pending, const schema::Relation& rel) {
+  PX_RETURN_IF_ERROR(internal::WriteSegmentFile(pending.path, rel, pending.batches));
+  return internal::MappedSegment::Open(pending.path, rel);
+}
+
+void DiskTier::FinishSeal(const PendingSegment& pending,
+                          std::unique_ptr<internal::MappedSegment> segment) {
+  DCHECK(sealing_);
+  sealing_ = false;
+  // Batches appended while the segment was written are still pending, after the sealed ones.
+  size_t first_pending = store_.Size() - pending_batch_bytes_.size();
+  for (const auto& [i, batch] : Enumerate(segment->batches())) {
+    store_.at(first_pending + i) = batch;
+    pending_bytes_ -= pending_batch_bytes_.front();
+    pending_batch_bytes_.pop_front();
+  }
+  AddSegment(pending.path, *segment);
+  retry_seal_bytes_ = 0;
+  EvictSegments();
+}
+
+void DiskTier::AbortSeal() {
+  DCHECK(sealing_);
+  sealing_ = false;
+  retry_seal_bytes_ = pending_bytes_ + segment_size_;
+  EvictSegments();
+}
+
+void DiskTier::EvictSegments() {
+  auto too_much_pending = [this]() {
+    return !sealing_ && pending_bytes_ > kMaxPendingSegments * segment_size_;
+  };
+  // Segments are older than the pending batches, so they go first.
+  while (!segments_.empty() && (segment_bytes_ > max_bytes_ || too_much_pending())) {
+    const auto& segment = segments_.front();
+    for (int64_t i = 0; i < segment.num_batches; ++i) {
+      store_.PopFront();
+    }
+    segment_bytes_ -= segment.bytes;
+    auto status = fs::Remove(segment.path);
+    LOG_IF(ERROR, !status.ok()) << status.msg();
+    segments_.pop_front();
+  }
+  while (segments_.empty() && too_much_pending()) {
+    store_.PopFront();
+    pending_bytes_ -= pending_batch_bytes_.front();
+    pending_batch_bytes_.pop_front();
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
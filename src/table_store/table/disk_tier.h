@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/segment_file.h"
+#include "src/table_store/table/internal/store_with_row_accounting.h"
+#include "src/table_store/table/internal/types.h"
+
+DECLARE_string(table_store_disk_tier_dir);
+DECLARE_int32(table_store_disk_tier_size_limit_mb);
+DECLARE_int32(table_store_disk_segment_size);
+
+namespace px {
+namespace table_store {
+
+/**
+ * DiskTier keeps the cold batches that a Table expires from memory, in segment files on local
+ * disk. Expired batches are first held in memory as a pending segment; once enough of them have
+ * accumulated, they are written to a segment file and replaced by arrays that point into the
+ * memory mapped file. When the segments exceed the size limit, the oldest segment is deleted.
+ *
+ * Pending and sealed batches live in a single store with the same row and time accounting as the
+ * hot and cold stores, so the table can read them through the same cursor logic.
+ *
+ * DiskTier is not thread safe, it is synchronized by the owning Table. Writing a segment file is
+ * split into StartSeal, WriteSegment and FinishSeal (or AbortSeal) so that the write can happen
+ * without holding the table's lock, off the path of the writers.
+ *
+ * If a write fails, its batches stay pending and the write is retried once another segment worth
+ * of batches was expired. To bound the memory held meanwhile, the oldest data is dropped once the
+ * pending batches exceed kMaxPendingSegments segments.
+ */
+class DiskTier : public NotCopyable {
+  using RowID = internal::RowID;
+  using ColdBatch = internal::ColdBatch;
+
+ public:
+  using Store = internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>;
+
+  struct PendingSegment {
+    std::filesystem::path path;
+    std::vector<ColdBatch> batches;
+    int64_t bytes = 0;
+  };
+
+  /**
+   * Creates a disk tier that writes its segments to dir, and loads the segments a previous process
+   * left there, numbering their rows from 0.
+   * @param rel the relation of the table, which must outlive the disk tier.
+   * @param max_bytes the size limit of the segment files.
+   * @param segment_size the number of bytes of batches to gather before writing a segment.
+   */
+  static StatusOr<std::unique_ptr<DiskTier>> Create(const std::filesystem::path& dir,
+                                                    const schema::Relation& rel,
+                                                    int64_t time_col_idx, int64_t max_bytes,
+                                                    int64_t segment_size);
+
+  /**
+   * Adds a batch that was expired from the cold store to the pending segment.
+   */
+  void Append(RowID first_row_id, ColdBatch batch);
+
+  /**
+   * @return whether the pending segment is large enough to be written, and no write is ongoing.
+   */
+  bool SealReady() const {
+    return !sealing_ && pending_bytes_ >= std::max(segment_size_, retry_seal_bytes_);
+  }
+
+  /**
+   * Snapshots the pending batches for writing. Must be followed by FinishSeal.
+   */
+  PendingSegment StartSeal();
+
+  /**
+   * Writes and maps the segment file. Doesn't touch the disk tier, so needs no synchronization.
+   */
+  static StatusOr<std::unique_ptr<internal::MappedSegment>> WriteSegment(
+      const PendingSegment& pending, const schema::Relation& rel);
+
+  /**
+   * Swaps the in memory batches of the segment for the mapped ones and deletes the oldest
+   * segments if the size limit is exceeded.
+   */
+  void FinishSeal(const PendingSegment& pending, std::unique_ptr<internal::MappedSegment> segment);
+
+  /**
+   * Ends a seal whose segment failed to be written. Its batches stay pending in memory.
+   */
+  void AbortSeal();
+
+  Store* store() { return &store_; }
+  const Store* store() const { return &store_; }
+
+  /**
+   * @return bytes in segment files plus bytes of the pending segment.
+   */
+  int64_t Bytes() const { return segment_bytes_ + pending_bytes_; }
+
+ private:
+  static constexpr int64_t kMaxPendingSegments = 4;
+
+  struct Segment {
+    std::filesystem::path path;
+    int64_t num_batches;
+    int64_t bytes;
+  };
+
+  DiskTier(const std::filesystem::path& dir, const schema::Relation& rel, int64_t time_col_idx,
+           int64_t max_bytes, int64_t segment_size);
+
+  Status LoadSegments();
+  void AddSegment(const std::filesystem::path& path, const internal::MappedSegment& segment);
+  // Drops the oldest data while the segments exceed max_bytes_ or the pending batches exceed
+  // kMaxPendingSegments segments.
+  void EvictSegments();
+
+  const std::filesystem::path dir_;
+  const schema::Relation& rel_;
+  const int64_t max_bytes_;
+  const int64_t segment_size_;
+
+  Store store_;
+  std::deque<Segment> segments_;
+  int64_t segment_bytes_ = 0;
+  // Batches at the back of the store that are not in a segment file yet.
+  std::deque<int64_t> pending_batch_bytes_;
+  int64_t pending_bytes_ = 0;
+  int64_t next_segment_seq_ = 0;
+  bool sealing_ = false;
+  // After a failed write, the pending bytes needed before the next attempt.
+  int64_t retry_seal_bytes_ = 0;
+};
+
+}  // namespace table_store
+}  // namespace px
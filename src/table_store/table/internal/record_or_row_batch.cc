@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "src/common/base/utils.h"
@@ -192,6 +194,22 @@ std::vector<uint64_t> RecordOrRowBatch::GetVariableSizedColumnRowBytes(size_t co
   return rows_bytes;
 }
 
+RecordOrRowBatch RecordOrRowBatch::Snapshot() const {
+  auto snapshot = std::visit(
+      overloaded{
+          [](const RecordBatchWithCache& record_batch_w_cache) {
+            RecordBatchWithCache record_batch_copy;
+            record_batch_copy.record_batch = std::make_unique<types::ColumnWrapperRecordBatch>(
+                *record_batch_w_cache.record_batch);
+            return RecordOrRowBatch(std::move(record_batch_copy));
+          },
+          [](const schema::RowBatch& row_batch) { return RecordOrRowBatch(row_batch); },
+      },
+      batch_);
+  snapshot.row_offset_ = row_offset_;
+  return snapshot;
+}
+
 }  // namespace internal
 }  // namespace table_store
 }  // namespace px
@@ -125,6 +125,14 @@ class RecordOrRowBatch {
    */
   std::vector<uint64_t> GetVariableSizedColumnRowBytes(size_t col_idx) const;
 
+  /**
+   * Snapshot returns a batch that shares the columns of this record or row batch, starting at the
+   * same row. The snapshot keeps the columns alive after this batch is destroyed, and is not
+   * affected by later calls to RemovePrefix on this batch. The arrow cache is not copied.
+   * @return a new RecordOrRowBatch with the same rows as this one.
+   */
+  RecordOrRowBatch Snapshot() const;
+
  private:
   std::variant<RecordBatchWithCache, schema::RowBatch> batch_;
   int64_t row_offset_ = 0;
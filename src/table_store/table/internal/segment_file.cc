@@ -0,0 +1,281 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/segment_file.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+constexpr char kSegmentMagic[8] = {'P', 'X', 'S', 'E', 'G', '0', '0', '2'};
+constexpr int64_t kNullBuffer = -1;
+
+// MappedRegion owns the mapping of a segment file, and unmaps it once the last buffer pointing
+// into it is released.
+class MappedRegion {
+ public:
+  MappedRegion(const uint8_t* data, int64_t size) : data_(data), size_(size) {}
+  ~MappedRegion() { munmap(const_cast<uint8_t*>(data_), size_); }
+
+  const uint8_t* data() const { return data_; }
+  int64_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_;
+  int64_t size_;
+};
+
+class MappedBuffer : public arrow::Buffer {
+ public:
+  MappedBuffer(std::shared_ptr<MappedRegion> region, int64_t offset, int64_t size)
+      : arrow::Buffer(region->data() + offset, size), region_(std::move(region)) {}
+
+ private:
+  std::shared_ptr<MappedRegion> region_;
+};
+
+class SegmentWriter {
+ public:
+  explicit SegmentWriter(std::ofstream* out) : out_(out) {}
+
+  void Write(const void* data, int64_t size) {
+    out_->write(static_cast<const char*>(data), size);
+    pos_ += size;
+  }
+  void WriteInt(int64_t value) { Write(&value, sizeof(value)); }
+  void Align() {
+    static constexpr char kPadding[kSegmentBufferAlignment] = {};
+    int64_t padding = (kSegmentBufferAlignment - pos_ % kSegmentBufferAlignment) %
+                      kSegmentBufferAlignment;
+    Write(kPadding, padding);
+  }
+  int64_t pos() const { return pos_; }
+
+ private:
+  std::ofstream* out_;
+  int64_t pos_ = 0;
+};
+
+class SegmentReader {
+ public:
+  SegmentReader(const uint8_t* data, int64_t begin, int64_t end)
+      : data_(data), pos_(begin), end_(end) {}
+
+  StatusOr<int64_t> ReadInt() {
+    if (pos_ + static_cast<int64_t>(sizeof(int64_t)) > end_) {
+      return error::Internal("Segment index is truncated.");
+    }
+    int64_t value;
+    std::memcpy(&value, data_ + pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return value;
+  }
+
+ private:
+  const uint8_t* data_;
+  int64_t pos_;
+  int64_t end_;
+};
+
+}  // namespace
+
+StatusOr<int64_t> WriteSegmentFile(const std::filesystem::path& path, const schema::Relation& rel,
+                                   const std::vector<ColdBatch>& batches) {
+  const auto& col_types = rel.col_types();
+  for (const auto& batch : batches) {
+    if (batch.size() != col_types.size()) {
+      return error::InvalidArgument("Batch has $0 columns, but the table has $1.", batch.size(),
+                                    col_types.size());
+    }
+  }
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    return error::Internal("Failed to open segment file $0.", tmp_path.string());
+  }
+  SegmentWriter writer(&out);
+  writer.Write(kSegmentMagic, sizeof(kSegmentMagic));
+  writer.WriteInt(col_types.size());
+  for (auto col_type : col_types) {
+    writer.WriteInt(static_cast<int64_t>(col_type));
+  }
+
+  // Write the buffers, recording where each one went for the index.
+  std::vector<int64_t> index;
+  index.push_back(batches.size());
+  for (const auto& batch : batches) {
+    for (const auto& array : batch) {
+      const auto& data = array->data();
+      if (!data->child_data.empty()) {
+        return error::Unimplemented("Segment files don't support nested arrays.");
+      }
+      index.push_back(data->length);
+      index.push_back(data->null_count);
+      index.push_back(data->offset);
+      index.push_back(data->buffers.size());
+      for (const auto& buffer : data->buffers) {
+        if (buffer == nullptr) {
+          index.push_back(kNullBuffer);
+          index.push_back(0);
+          continue;
+        }
+        writer.Align();
+        index.push_back(writer.pos());
+        index.push_back(buffer->size());
+        writer.Write(buffer->data(), buffer->size());
+      }
+    }
+  }
+
+  writer.Align();
+  int64_t index_offset = writer.pos();
+  writer.Write(index.data(), index.size() * sizeof(int64_t));
+  writer.WriteInt(index_offset);
+  writer.Write(kSegmentMagic, sizeof(kSegmentMagic));
+  out.close();
+  if (out.fail()) {
+    return error::Internal("Failed to write segment file $0.", tmp_path.string());
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Failed to rename segment file $0: $1", tmp_path.string(),
+                           ec.message());
+  }
+  return writer.pos();
+}
+
+StatusOr<std::unique_ptr<MappedSegment>> MappedSegment::Open(const std::filesystem::path& path,
+                                                             const schema::Relation& rel) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return error::Internal("Failed to open segment file $0. errno $1.", path.string(), errno);
+  }
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) == -1) {
+    close(fd);
+    return error::Internal("Failed to stat segment file $0. errno $1.", path.string(), errno);
+  }
+  int64_t file_size = statbuf.st_size;
+  constexpr int64_t kMinSize = 2 * sizeof(kSegmentMagic) + sizeof(int64_t);
+  if (file_size < kMinSize) {
+    close(fd);
+    return error::Internal("Segment file $0 is truncated.", path.string());
+  }
+  void* mapped = mmap(/*addr*/ nullptr, file_size, PROT_READ, MAP_SHARED, fd, /*offset*/ 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return error::Internal("Failed to map segment file $0. errno $1.", path.string(), errno);
+  }
+  auto region = std::make_shared<MappedRegion>(static_cast<const uint8_t*>(mapped), file_size);
+  const uint8_t* data = region->data();
+
+  const int64_t footer_offset = file_size - sizeof(kSegmentMagic) - sizeof(int64_t);
+  if (std::memcmp(data, kSegmentMagic, sizeof(kSegmentMagic)) != 0 ||
+      std::memcmp(data + file_size - sizeof(kSegmentMagic), kSegmentMagic,
+                  sizeof(kSegmentMagic)) != 0) {
+    return error::Internal("Segment file $0 has a bad magic.", path.string());
+  }
+  int64_t index_offset;
+  std::memcpy(&index_offset, data + footer_offset, sizeof(index_offset));
+  if (index_offset < static_cast<int64_t>(sizeof(kSegmentMagic)) ||
+      index_offset > footer_offset) {
+    return error::Internal("Segment file $0 has a bad index offset.", path.string());
+  }
+
+  // The column types in the header must match the table, or the buffers would be misread.
+  const auto& col_types = rel.col_types();
+  SegmentReader header_reader(data, sizeof(kSegmentMagic), index_offset);
+  PX_ASSIGN_OR_RETURN(int64_t num_cols, header_reader.ReadInt());
+  if (num_cols != static_cast<int64_t>(col_types.size())) {
+    return error::Internal("Segment file $0 has $1 columns, but the table has $2.", path.string(),
+                           num_cols, col_types.size());
+  }
+  for (const auto& [col_idx, col_type] : Enumerate(col_types)) {
+    PX_ASSIGN_OR_RETURN(int64_t segment_col_type, header_reader.ReadInt());
+    if (segment_col_type != static_cast<int64_t>(col_type)) {
+      return error::Internal("Segment file $0 has type $1 for column $2, but the table has $3.",
+                             path.string(), segment_col_type, col_idx,
+                             static_cast<int64_t>(col_type));
+    }
+  }
+
+  std::vector<std::shared_ptr<arrow::DataType>> arrow_types;
+  for (auto data_type : col_types) {
+    arrow_types.push_back(types::MakeArrowBuilder(data_type, arrow::default_memory_pool())->type());
+  }
+
+  SegmentReader reader(data, index_offset, footer_offset);
+  PX_ASSIGN_OR_RETURN(int64_t num_batches, reader.ReadInt());
+
+  auto segment = std::unique_ptr<MappedSegment>(new MappedSegment());
+  segment->file_size_ = file_size;
+  segment->batches_.reserve(num_batches);
+  for (int64_t batch_idx = 0; batch_idx < num_batches; ++batch_idx) {
+    ColdBatch batch;
+    for (int64_t col_idx = 0; col_idx < num_cols; ++col_idx) {
+      PX_ASSIGN_OR_RETURN(int64_t length, reader.ReadInt());
+      PX_ASSIGN_OR_RETURN(int64_t null_count, reader.ReadInt());
+      PX_ASSIGN_OR_RETURN(int64_t offset, reader.ReadInt());
+      PX_ASSIGN_OR_RETURN(int64_t num_buffers, reader.ReadInt());
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+      for (int64_t i = 0; i < num_buffers; ++i) {
+        PX_ASSIGN_OR_RETURN(int64_t buffer_offset, reader.ReadInt());
+        PX_ASSIGN_OR_RETURN(int64_t buffer_size, reader.ReadInt());
+        if (buffer_offset == kNullBuffer) {
+          buffers.push_back(nullptr);
+          continue;
+        }
+        if (buffer_offset < 0 || buffer_size < 0 || buffer_offset + buffer_size > index_offset) {
+          return error::Internal("Segment file $0 has a buffer outside of its data.",
+                                 path.string());
+        }
+        buffers.push_back(std::make_shared<MappedBuffer>(region, buffer_offset, buffer_size));
+      }
+      auto array_data = std::make_shared<arrow::ArrayData>(arrow_types[col_idx], length,
+                                                           std::move(buffers), null_count, offset);
+      batch.push_back(arrow::MakeArray(array_data));
+    }
+    segment->batches_.push_back(std::move(batch));
+  }
+  return segment;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * A segment file holds a sequence of cold batches in a columnar layout that can be memory mapped
+ * and read back without copying. The layout is:
+ *   - an 8 byte magic,
+ *   - a header holding the number of columns and the data type of each column,
+ *   - the arrow buffers of every column of every batch, each aligned to kSegmentBufferAlignment,
+ *   - an index describing, for each batch and column, the array length, null count, offset and
+ *     the location of each of its buffers,
+ *   - a footer holding the file offset of the index followed by the magic again.
+ * Integers are stored in host byte order, since segments are only read back on the node that
+ * wrote them.
+ */
+constexpr int64_t kSegmentBufferAlignment = 64;
+
+/**
+ * Writes the given batches of a table with the given relation to a segment file at path. The file
+ * is written under a temporary name and renamed once complete, so a crash never leaves a partial
+ * segment behind.
+ * @return the size of the file in bytes.
+ */
+StatusOr<int64_t> WriteSegmentFile(const std::filesystem::path& path, const schema::Relation& rel,
+                                   const std::vector<ColdBatch>& batches);
+
+/**
+ * MappedSegment is a segment file mapped into memory. The arrow arrays of its batches point
+ * directly into the mapping, and keep it alive for as long as they are referenced, so batches can
+ * be handed out to queries and outlive the MappedSegment itself.
+ */
+class MappedSegment {
+ public:
+  /**
+   * Maps the segment file at path and validates it against the relation of its table. Fails if
+   * the segment was written with other column types.
+   */
+  static StatusOr<std::unique_ptr<MappedSegment>> Open(const std::filesystem::path& path,
+                                                       const schema::Relation& rel);
+
+  const std::vector<ColdBatch>& batches() const { return batches_; }
+  int64_t file_size() const { return file_size_; }
+
+ private:
+  MappedSegment() = default;
+
+  std::vector<ColdBatch> batches_;
+  int64_t file_size_ = 0;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
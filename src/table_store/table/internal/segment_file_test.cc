@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/segment_file.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class SegmentFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = schema::Relation({types::DataType::TIME64NS, types::DataType::BOOLEAN,
+                             types::DataType::STRING, types::DataType::UINT128},
+                            {"time_", "col1", "col2", "col3"});
+  }
+
+  ColdBatch MakeBatch(const std::vector<types::Time64NSValue>& times,
+                      const std::vector<types::BoolValue>& bools,
+                      const std::vector<types::StringValue>& strings,
+                      const std::vector<types::UInt128Value>& uint128s) {
+    return ColdBatch{
+        types::ToArrow(times, arrow::default_memory_pool()),
+        types::ToArrow(bools, arrow::default_memory_pool()),
+        types::ToArrow(strings, arrow::default_memory_pool()),
+        types::ToArrow(uint128s, arrow::default_memory_pool()),
+    };
+  }
+
+  void ExpectBatchesEqual(const std::vector<ColdBatch>& expected,
+                          const std::vector<ColdBatch>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(expected[i].size(), actual[i].size());
+      for (size_t col = 0; col < expected[i].size(); ++col) {
+        EXPECT_TRUE(expected[i][col]->Equals(actual[i][col]))
+            << "batch " << i << " column " << col;
+      }
+    }
+  }
+
+  testing::TempDir temp_dir_;
+  schema::Relation rel_;
+};
+
+TEST_F(SegmentFileTest, write_and_map) {
+  std::vector<ColdBatch> batches{
+      MakeBatch({1, 2, 3}, {true, false, true}, {"a", "bc", ""}, {{0, 1}, {2, 3}, {4, 5}}),
+      MakeBatch({4, 5}, {false, false}, {"def", "ghij"}, {{6, 7}, {8, 9}}),
+  };
+  // Sliced arrays keep their offset into the original buffers.
+  auto sliced = MakeBatch({6, 7, 8, 9}, {true, true, false, false}, {"k", "l", "m", "n"},
+                          {{1, 1}, {2, 2}, {3, 3}, {4, 4}});
+  for (auto& array : sliced) {
+    array = array->Slice(1, 2);
+  }
+  batches.push_back(sliced);
+
+  auto path = temp_dir_.path() / "000000000000.seg";
+  ASSERT_OK_AND_ASSIGN(int64_t file_size, WriteSegmentFile(path, rel_, batches));
+  EXPECT_EQ(file_size, static_cast<int64_t>(std::filesystem::file_size(path)));
+  EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+  ASSERT_OK_AND_ASSIGN(auto segment, MappedSegment::Open(path, rel_));
+  EXPECT_EQ(file_size, segment->file_size());
+  ExpectBatchesEqual(batches, segment->batches());
+
+  // Arrays keep the mapping alive after the segment is released.
+  ColdBatch mapped_batch = segment->batches()[1];
+  segment.reset();
+  EXPECT_TRUE(batches[1][2]->Equals(mapped_batch[2]));
+}
+
+TEST_F(SegmentFileTest, rejects_corrupt_file) {
+  auto path = temp_dir_.path() / "000000000000.seg";
+  ASSERT_OK(WriteSegmentFile(path, rel_, {MakeBatch({1}, {true}, {"a"}, {{0, 1}})}));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+  EXPECT_NOT_OK(MappedSegment::Open(path, rel_));
+
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "not a segment";
+  }
+  EXPECT_NOT_OK(MappedSegment::Open(path, rel_));
+}
+
+TEST_F(SegmentFileTest, rejects_mismatched_relation) {
+  auto path = temp_dir_.path() / "000000000000.seg";
+  ASSERT_OK(WriteSegmentFile(path, rel_, {MakeBatch({1}, {true}, {"a"}, {{0, 1}})}));
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  EXPECT_NOT_OK(MappedSegment::Open(path, rel));
+
+  // Same number of columns, but the type of a column changed.
+  schema::Relation retyped_rel({types::DataType::TIME64NS, types::DataType::INT64,
+                                types::DataType::STRING, types::DataType::UINT128},
+                               {"time_", "col1", "col2", "col3"});
+  EXPECT_NOT_OK(MappedSegment::Open(path, retyped_rel));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -154,6 +154,19 @@ class StoreWithRowTimeAccounting {
     return batches_.front();
   }
 
+  /**
+   * at gets a reference to the batch at the given position, counting from the front of the store.
+   * @return reference to the batch.
+   */
+  const TBatch& at(size_t batch_idx) const {
+    DCHECK_LT(batch_idx, batches_.size());
+    return batches_[batch_idx];
+  }
+  TBatch& at(size_t batch_idx) {
+    DCHECK_LT(batch_idx, batches_.size());
+    return batches_[batch_idx];
+  }
+
   /**
    * PopFront removes the first batch in the store, and returns an rvalue reference to it.
    * @return rvalue reference to the removed batch.
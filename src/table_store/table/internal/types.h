@@ -53,6 +53,8 @@ struct RecordBatchWithCache {
 enum StoreType {
   Hot,
   Cold,
+  // Cold batches that were expired from memory and spilled to segment files on disk.
+  Disk,
 };
 
 struct BatchHints {
@@ -74,6 +76,10 @@ template <>
 struct StoreTypeTraits<StoreType::Cold> {
   using batch_type = ColdBatch;
 };
+template <>
+struct StoreTypeTraits<StoreType::Disk> {
+  using batch_type = ColdBatch;
+};
 
 }  // namespace internal
 }  // namespace table_store
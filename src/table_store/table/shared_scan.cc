@@ -0,0 +1,248 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/shared_scan.h"
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+schema::RowDescriptor RowDescriptorForColumns(const schema::Relation& relation,
+                                              const std::vector<int64_t>& cols) {
+  std::vector<types::DataType> types;
+  types.reserve(cols.size());
+  for (int64_t col : cols) {
+    types.push_back(relation.GetColumnType(col));
+  }
+  return schema::RowDescriptor(types);
+}
+
+}  // namespace
+
+SharedScan::Reader::Reader(std::shared_ptr<SharedScan> scan, Table::Cursor::StartSpec start,
+                           std::vector<int64_t> cols)
+    : scan_(std::move(scan)),
+      cols_(std::move(cols)),
+      desc_(RowDescriptorForColumns(scan_->table_->GetRelation(), cols_)) {
+  Table::Cursor::StopSpec stop;
+  stop.type = Table::Cursor::StopSpec::StopType::Infinite;
+  cursor_ = std::make_unique<Table::Cursor>(scan_->table_, start, stop);
+  last_row_id_ = SharedScan::LastReadRowID(cursor_.get());
+}
+
+SharedScan::Reader::~Reader() { scan_->Detach(this); }
+
+bool SharedScan::Reader::attached() {
+  absl::MutexLock lock(&scan_->mu_);
+  return attached_;
+}
+
+void SharedScan::Reader::MaybeAttach() {
+  if (cursor_ == nullptr) {
+    absl::MutexLock lock(&scan_->mu_);
+    if (attached_) {
+      return;
+    }
+    // The scan detached the reader because it fell behind, so it catches up on its own again.
+    cursor_ = SharedScan::CursorAfter(scan_->table_, last_row_id_);
+  }
+  if (!cursor_->NextBatchReady() && scan_->TryAttach(this)) {
+    cursor_.reset();
+  }
+}
+
+bool SharedScan::Reader::NextBatchReady() {
+  MaybeAttach();
+  if (cursor_ != nullptr) {
+    return cursor_->NextBatchReady();
+  }
+  absl::MutexLock lock(&scan_->mu_);
+  return !queue_.empty() || scan_->NextBatchReadyLocked();
+}
+
+StatusOr<std::unique_ptr<schema::RowBatch>> SharedScan::Reader::GetNextRowBatch() {
+  MaybeAttach();
+  if (cursor_ != nullptr) {
+    if (!cursor_->NextBatchReady()) {
+      return schema::RowBatch::WithZeroRows(desc_, /* eow */ false, /* eos */ false);
+    }
+    PX_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(cols_));
+    last_row_id_ = SharedScan::LastReadRowID(cursor_.get());
+    return row_batch;
+  }
+
+  std::optional<ScanBatch> scan_batch;
+  {
+    absl::MutexLock lock(&scan_->mu_);
+    while (!scan_batch.has_value()) {
+      if (queue_.empty()) {
+        // If the reader was detached in the meantime, it catches up on its own on the next call.
+        if (!attached_ || !scan_->NextBatchReadyLocked()) {
+          break;
+        }
+        PX_RETURN_IF_ERROR(scan_->AdvanceLocked());
+        continue;
+      }
+      ScanBatch front = std::move(queue_.front());
+      queue_.pop_front();
+      // Skip the rows that the reader returned before it attached.
+      if (front.last_row_id > last_row_id_) {
+        scan_batch = std::move(front);
+      }
+    }
+  }
+  if (!scan_batch.has_value()) {
+    return schema::RowBatch::WithZeroRows(desc_, /* eow */ false, /* eos */ false);
+  }
+  return Project(scan_batch.value());
+}
+
+StatusOr<std::unique_ptr<schema::RowBatch>> SharedScan::Reader::Project(
+    const ScanBatch& scan_batch) {
+  int64_t offset = std::max<RowID>(0, last_row_id_ + 1 - scan_batch.first_row_id);
+  int64_t num_rows = scan_batch.row_batch->num_rows() - offset;
+  auto row_batch = std::make_unique<schema::RowBatch>(desc_, num_rows);
+  const std::vector<int64_t>& scan_cols = *scan_batch.cols;
+  for (int64_t col : cols_) {
+    auto it = std::lower_bound(scan_cols.begin(), scan_cols.end(), col);
+    DCHECK(it != scan_cols.end() && *it == col);
+    auto array = scan_batch.row_batch->ColumnAt(std::distance(scan_cols.begin(), it));
+    PX_RETURN_IF_ERROR(row_batch->AddColumn(offset == 0 ? array : array->Slice(offset)));
+  }
+  last_row_id_ = scan_batch.last_row_id;
+  return row_batch;
+}
+
+int64_t SharedScan::num_attached_readers() const {
+  absl::MutexLock lock(&mu_);
+  return readers_.size();
+}
+
+bool SharedScan::TryAttach(Reader* reader) {
+  absl::MutexLock lock(&mu_);
+  if (cursor_ == nullptr) {
+    cursor_ = CursorAfter(table_, reader->last_row_id_);
+  } else if (reader->last_row_id_ < LastReadRowID(cursor_.get())) {
+    // The reader would miss the rows in between.
+    return false;
+  }
+
+  std::vector<int64_t> cols(reader->cols_);
+  std::sort(cols.begin(), cols.end());
+  if (cols_ == nullptr || !std::includes(cols_->begin(), cols_->end(), cols.begin(), cols.end())) {
+    if (cols_ != nullptr) {
+      cols.insert(cols.end(), cols_->begin(), cols_->end());
+      std::sort(cols.begin(), cols.end());
+    }
+    cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+    cols_ = std::make_shared<const std::vector<int64_t>>(std::move(cols));
+  }
+
+  readers_.insert(reader);
+  reader->attached_ = true;
+  return true;
+}
+
+void SharedScan::Detach(Reader* reader) {
+  absl::MutexLock lock(&mu_);
+  DetachLocked(reader);
+}
+
+void SharedScan::DetachLocked(Reader* reader) {
+  readers_.erase(reader);
+  reader->attached_ = false;
+  reader->queue_.clear();
+  if (readers_.empty()) {
+    cursor_.reset();
+    cols_.reset();
+  }
+}
+
+bool SharedScan::NextBatchReadyLocked() { return cursor_ != nullptr && cursor_->NextBatchReady(); }
+
+Status SharedScan::AdvanceLocked() {
+  if (!NextBatchReadyLocked()) {
+    return Status::OK();
+  }
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<schema::RowBatch> row_batch,
+                      cursor_->GetNextRowBatch(*cols_));
+  RowID last_row_id = LastReadRowID(cursor_.get());
+  Reader::ScanBatch scan_batch{last_row_id - row_batch->num_rows() + 1, last_row_id,
+                               std::move(row_batch), cols_};
+
+  std::vector<Reader*> lagging_readers;
+  for (Reader* reader : readers_) {
+    reader->queue_.push_back(scan_batch);
+    if (static_cast<int64_t>(reader->queue_.size()) > max_queued_batches_) {
+      lagging_readers.push_back(reader);
+    }
+  }
+  for (Reader* reader : lagging_readers) {
+    DetachLocked(reader);
+  }
+  return Status::OK();
+}
+
+std::unique_ptr<Table::Cursor> SharedScan::CursorAfter(const Table* table, RowID row_id) {
+  Table::Cursor::StopSpec stop;
+  stop.type = Table::Cursor::StopSpec::StopType::Infinite;
+  auto cursor = std::make_unique<Table::Cursor>(table, Table::Cursor::StartSpec{}, stop);
+  // If the row has expired in the meantime, the table moves the cursor to the first row it has.
+  *cursor->LastReadRowID() = row_id;
+  return cursor;
+}
+
+std::unique_ptr<SharedScan::Reader> SharedScanRegistry::CreateReader(
+    const Table* table, Table::Cursor::StartSpec start, std::vector<int64_t> cols) {
+  std::shared_ptr<SharedScan> scan;
+  {
+    absl::MutexLock lock(&mu_);
+    for (auto it = scans_.begin(); it != scans_.end();) {
+      if (it->second.expired()) {
+        scans_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    std::weak_ptr<SharedScan>& weak_scan = scans_[table];
+    scan = weak_scan.lock();
+    if (scan == nullptr) {
+      scan = std::make_shared<SharedScan>(table, max_queued_batches_);
+      weak_scan = scan;
+    }
+  }
+  return std::make_unique<SharedScan::Reader>(std::move(scan), start, std::move(cols));
+}
+
+int64_t SharedScanRegistry::num_scans() {
+  absl::MutexLock lock(&mu_);
+  int64_t num_scans = 0;
+  for (const auto& [table, scan] : scans_) {
+    num_scans += !scan.expired();
+  }
+  return num_scans;
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/schema/row_descriptor.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * SharedScan tails a table on behalf of all of the infinite streaming queries reading it. Each new
+ * batch of the table is read once, with the union of the columns that the readers need, and is
+ * handed out to every attached reader, which then slices out its own columns. Without it, every
+ * query would read (and convert) the same batches from the table with its own Cursor.
+ *
+ * Readers join and leave a running scan at any time:
+ * - A new reader first catches up with the end of the table using its own Cursor, starting from
+ *   its own StartSpec. Once it has caught up to the position of the shared scan, it attaches and
+ *   from then on only receives the batches that the scan reads.
+ * - The batches are tagged with the row ids that they cover, so a reader that attaches while ahead
+ *   of the scan skips the rows that it has already returned.
+ * - Whichever attached reader runs out of batches advances the scan, so the scan doesn't need a
+ *   thread of its own.
+ * - A reader that falls more than max_queued_batches behind is detached, and catches up again
+ *   with its own Cursor from the last row that it returned. This keeps one slow query from
+ *   pinning an unbounded number of batches.
+ *
+ * Like an infinite Cursor, a reader is never done.
+ */
+class SharedScan {
+  using RowID = internal::RowID;
+
+ public:
+  class Reader;
+
+  SharedScan(const Table* table, int64_t max_queued_batches)
+      : table_(table), max_queued_batches_(max_queued_batches) {}
+
+  /**
+   * Reader returns the rows of the table starting at the given StartSpec, for the given columns.
+   * It detaches itself from the scan when destroyed. A Reader must only be used by one thread at
+   * a time, but different readers of the same scan can be used concurrently.
+   */
+  class Reader : public NotCopyable {
+   public:
+    Reader(std::shared_ptr<SharedScan> scan, Table::Cursor::StartSpec start,
+           std::vector<int64_t> cols);
+    ~Reader();
+
+    // Whether GetNextRowBatch() has new rows to return.
+    bool NextBatchReady();
+    // Returns the next rows of the table, or a batch with zero rows if there are none yet.
+    StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch();
+
+    // Whether the reader currently gets its batches from the shared scan.
+    bool attached();
+
+   private:
+    friend class SharedScan;
+
+    // A batch read by the shared scan, which covers the rows [first_row_id, last_row_id].
+    struct ScanBatch {
+      RowID first_row_id;
+      RowID last_row_id;
+      std::shared_ptr<const schema::RowBatch> row_batch;
+      // The columns of the table that row_batch holds.
+      std::shared_ptr<const std::vector<int64_t>> cols;
+    };
+
+    // Attaches to the scan if the own cursor has caught up with it.
+    void MaybeAttach();
+    StatusOr<std::unique_ptr<schema::RowBatch>> Project(const ScanBatch& scan_batch);
+
+    std::shared_ptr<SharedScan> scan_;
+    const std::vector<int64_t> cols_;
+    const schema::RowDescriptor desc_;
+    // Set while the reader is not attached to the scan.
+    std::unique_ptr<Table::Cursor> cursor_;
+    // The id of the last row returned by the reader.
+    RowID last_row_id_;
+
+    // The following are guarded by scan_->mu_.
+    bool attached_ = false;
+    std::deque<ScanBatch> queue_;
+  };
+
+  // The number of readers currently attached to the scan.
+  int64_t num_attached_readers() const;
+
+ private:
+  bool TryAttach(Reader* reader) ABSL_LOCKS_EXCLUDED(mu_);
+  void Detach(Reader* reader) ABSL_LOCKS_EXCLUDED(mu_);
+  void DetachLocked(Reader* reader) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool NextBatchReadyLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Reads the next batch of the table, if any, and queues it for every attached reader.
+  Status AdvanceLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns an infinite cursor of the table that starts right after the given row.
+  static std::unique_ptr<Table::Cursor> CursorAfter(const Table* table, RowID row_id);
+  static RowID LastReadRowID(Table::Cursor* cursor) { return *cursor->LastReadRowID(); }
+
+  const Table* table_;
+  const int64_t max_queued_batches_;
+
+  mutable absl::Mutex mu_;
+  // Only set while readers are attached.
+  std::unique_ptr<Table::Cursor> cursor_ ABSL_GUARDED_BY(mu_);
+  // The sorted union of the columns of the attached readers.
+  std::shared_ptr<const std::vector<int64_t>> cols_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_set<Reader*> readers_ ABSL_GUARDED_BY(mu_);
+};
+
+/**
+ * SharedScanRegistry keeps track of the running shared scan of each table.
+ */
+class SharedScanRegistry : public NotCopyable {
+ public:
+  static inline constexpr int64_t kDefaultMaxQueuedBatches = 64;
+
+  explicit SharedScanRegistry(int64_t max_queued_batches = kDefaultMaxQueuedBatches)
+      : max_queued_batches_(max_queued_batches) {}
+
+  /**
+   * Returns a reader of the shared scan of the table, starting the scan if none is running.
+   * The scan stops once all of its readers are destroyed.
+   */
+  std::unique_ptr<SharedScan::Reader> CreateReader(const Table* table,
+                                                   Table::Cursor::StartSpec start,
+                                                   std::vector<int64_t> cols);
+
+  // The number of tables that have a running shared scan.
+  int64_t num_scans();
+
+ private:
+  const int64_t max_queued_batches_;
+  absl::Mutex mu_;
+  absl::flat_hash_map<const Table*, std::weak_ptr<SharedScan>> scans_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/array.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/shared_scan.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+class SharedScanTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = schema::Relation({types::DataType::INT64, types::DataType::TIME64NS}, {"col1", "time_"});
+    table_ = Table::Create("test_table", rel_);
+    WriteBatch({1, 2, 3});
+  }
+
+  void WriteBatch(const std::vector<types::Int64Value>& values) {
+    std::vector<types::Time64NSValue> times;
+    for (const auto& value : values) {
+      times.push_back(value.val);
+    }
+    schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), values.size());
+    EXPECT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(table_->WriteRowBatch(rb));
+  }
+
+  // Reads the next batch from the reader and checks that it holds the given values in its first
+  // column.
+  std::unique_ptr<schema::RowBatch> ExpectNext(SharedScan::Reader* reader,
+                                               const std::vector<types::Int64Value>& values) {
+    EXPECT_TRUE(reader->NextBatchReady());
+    auto rb = reader->GetNextRowBatch().ConsumeValueOrDie();
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(values, arrow::default_memory_pool())))
+        << rb->ColumnAt(0)->ToString();
+    return rb;
+  }
+
+  schema::Relation rel_;
+  std::shared_ptr<Table> table_;
+};
+
+TEST_F(SharedScanTest, readers_share_batches) {
+  SharedScanRegistry registry;
+  auto reader1 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0});
+  auto reader2 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0, 1});
+  EXPECT_EQ(1, registry.num_scans());
+
+  // Both readers catch up on their own, then attach to the scan.
+  ExpectNext(reader1.get(), {1, 2, 3});
+  ExpectNext(reader2.get(), {1, 2, 3});
+  EXPECT_FALSE(reader1->NextBatchReady());
+  EXPECT_FALSE(reader2->NextBatchReady());
+  EXPECT_TRUE(reader1->attached());
+  EXPECT_TRUE(reader2->attached());
+
+  WriteBatch({4, 5});
+  auto rb1 = ExpectNext(reader1.get(), {4, 5});
+  auto rb2 = ExpectNext(reader2.get(), {4, 5});
+  EXPECT_EQ(1, rb1->num_columns());
+  EXPECT_EQ(2, rb2->num_columns());
+  // The batch was only read once from the table.
+  EXPECT_EQ(rb1->ColumnAt(0).get(), rb2->ColumnAt(0).get());
+  EXPECT_FALSE(reader1->NextBatchReady());
+  EXPECT_FALSE(reader2->NextBatchReady());
+
+  reader1.reset();
+  reader2.reset();
+  EXPECT_EQ(0, registry.num_scans());
+}
+
+TEST_F(SharedScanTest, reader_ahead_of_scan_skips_rows) {
+  SharedScanRegistry registry;
+  auto reader1 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0});
+  ExpectNext(reader1.get(), {1, 2, 3});
+  EXPECT_FALSE(reader1->NextBatchReady());
+  EXPECT_TRUE(reader1->attached());
+
+  // The second reader reads the new batch on its own, before the scan gets to it.
+  WriteBatch({4, 5});
+  auto reader2 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0});
+  ExpectNext(reader2.get(), {1, 2, 3});
+  ExpectNext(reader2.get(), {4, 5});
+  EXPECT_FALSE(reader2->NextBatchReady());
+  EXPECT_TRUE(reader2->attached());
+
+  ExpectNext(reader1.get(), {4, 5});
+  WriteBatch({6});
+  ExpectNext(reader2.get(), {6});
+  ExpectNext(reader1.get(), {6});
+  EXPECT_FALSE(reader1->NextBatchReady());
+  EXPECT_FALSE(reader2->NextBatchReady());
+}
+
+TEST_F(SharedScanTest, start_time) {
+  SharedScanRegistry registry;
+  auto reader1 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0});
+  ExpectNext(reader1.get(), {1, 2, 3});
+  EXPECT_FALSE(reader1->NextBatchReady());
+
+  Table::Cursor::StartSpec start;
+  start.type = Table::Cursor::StartSpec::StartType::StartAtTime;
+  start.start_time = 2;
+  auto reader2 = registry.CreateReader(table_.get(), start, {0});
+  ExpectNext(reader2.get(), {2, 3});
+  EXPECT_FALSE(reader2->NextBatchReady());
+  EXPECT_TRUE(reader2->attached());
+
+  WriteBatch({4});
+  ExpectNext(reader2.get(), {4});
+  ExpectNext(reader1.get(), {4});
+}
+
+TEST_F(SharedScanTest, lagging_reader_catches_up_on_its_own) {
+  SharedScanRegistry registry(/* max_queued_batches */ 1);
+  auto reader1 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0});
+  auto reader2 = registry.CreateReader(table_.get(), Table::Cursor::StartSpec{}, {0});
+  ExpectNext(reader1.get(), {1, 2, 3});
+  ExpectNext(reader2.get(), {1, 2, 3});
+  EXPECT_FALSE(reader1->NextBatchReady());
+  EXPECT_FALSE(reader2->NextBatchReady());
+
+  WriteBatch({4});
+  WriteBatch({5});
+  ExpectNext(reader1.get(), {4});
+  ExpectNext(reader1.get(), {5});
+  EXPECT_TRUE(reader1->attached());
+  EXPECT_FALSE(reader2->attached());
+
+  // The detached reader doesn't miss any rows.
+  ExpectNext(reader2.get(), {4});
+  ExpectNext(reader2.get(), {5});
+  EXPECT_FALSE(reader2->NextBatchReady());
+  EXPECT_TRUE(reader2->attached());
+
+  WriteBatch({6});
+  ExpectNext(reader2.get(), {6});
+  ExpectNext(reader1.get(), {6});
+}
+
+}  // namespace table_store
+}  // namespace px
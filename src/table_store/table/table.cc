@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -27,6 +28,7 @@
 #include <vector>
 
 #include <absl/strings/str_format.h>
+#include <absl/strings/substitute.h>
 #include "internal/store_with_row_accounting.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -48,6 +50,17 @@ DEFINE_int32(table_store_table_size_limit,
 namespace px {
 namespace table_store {
 
+namespace {
+
+// Parent of the pools of all tables in the process. Never deleted, since tables may outlive the
+// table store that created them.
+types::TrackingMemoryPool* TableStoreMemoryPool() {
+  static auto* pool = types::TrackingMemoryPool::ProcessPool()->CreateChild("table_store");
+  return pool;
+}
+
+}  // namespace
+
 Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
     : table_(table), hints_(internal::BatchHints{}) {
   AdvanceToStart(start);
@@ -173,8 +186,8 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_(relation),
       max_table_size_(max_table_size),
       compacted_batch_size_(compacted_batch_size),
-      // TODO(james): move mem_pool into constructor.
-      compactor_(rel_, arrow::default_memory_pool()) {
+      mem_pool_(TableStoreMemoryPool()->CreateChild(table_name)),
+      compactor_(rel_, mem_pool_) {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   for (const auto& [i, col_name] : Enumerate(rel_.col_names())) {
@@ -189,6 +202,23 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_, time_col_idx_);
 }
 
+Table::~Table() {
+  {
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    mem_pool_->TrackExternal(-tracked_hot_bytes_);
+    tracked_hot_bytes_ = 0;
+  }
+  // The pool is only deleted once the batches allocated from it, which may still be referenced by
+  // queries, are freed.
+  TableStoreMemoryPool()->ReleaseChild(mem_pool_);
+}
+
+void Table::TrackHotBytes() {
+  int64_t hot_bytes = batch_size_accountant_->HotBytes();
+  mem_pool_->TrackExternal(hot_bytes - tracked_hot_bytes_);
+  tracked_hot_bytes_ = hot_bytes;
+}
+
 Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
   CHECK(table_proto != nullptr);
   std::vector<int64_t> col_selector;
@@ -212,10 +242,25 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
     Cursor* cursor, const std::vector<int64_t>& cols) const {
   DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  std::unique_ptr<schema::RowBatch> rb;
+  if (disk_tier_ != nullptr && disk_tier_->store()->Size() > 0) {
+    const auto* disk_store = disk_tier_->store();
+    if (*cursor->LastReadRowID() + 1 < disk_store->FirstRowID()) {
+      // The cursor was pointing to rows that were deleted from disk, so continue from the oldest
+      // row that is left.
+      *cursor->LastReadRowID() = disk_store->FirstRowID() - 1;
+    }
+    if (!cursor->Done()) {
+      PX_ASSIGN_OR_RETURN(rb, disk_store->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
+                                                          cursor->StopRowID(), cols));
+    }
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  PX_ASSIGN_OR_RETURN(auto rb,
-                      cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                   cursor->StopRowID(), cols));
+  if (rb == nullptr) {
+    PX_ASSIGN_OR_RETURN(rb, cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
+                                                         cursor->StopRowID(), cols));
+  }
   if (rb == nullptr) {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     PX_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
@@ -234,20 +279,24 @@ StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
   if (rb == nullptr) {
     return error::InvalidArgument("Data after Cursor is not in the table.");
   }
+  batches_read_.fetch_add(1, std::memory_order_relaxed);
+  metrics_.batches_read_counter.Increment();
   return rb;
 }
 
 Status Table::ExpireRowBatches(int64_t row_batch_size) {
-  if (row_batch_size > max_table_size_) {
+  absl::MutexLock expiry_lock(&expiry_lock_);
+  const int64_t max_table_size = max_table_size_.load();
+  if (row_batch_size > max_table_size) {
     return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
-                                  row_batch_size, max_table_size_);
+                                  row_batch_size, max_table_size);
   }
   int64_t bytes;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
   }
-  while (bytes + row_batch_size > max_table_size_) {
+  while (bytes + row_batch_size > max_table_size) {
     PX_RETURN_IF_ERROR(ExpireBatch());
     {
       absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
@@ -306,6 +355,7 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
     batch_size_accountant_->NewHotBatch(std::move(batch_stats));
     hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
     next_row_id_ += batch_length;
+    TrackHotBytes();
   }
 
   {
@@ -322,6 +372,10 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
 }
 
 Table::RowID Table::FirstRowID() const {
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  if (disk_tier_ != nullptr && disk_tier_->store()->Size() > 0) {
+    return disk_tier_->store()->FirstRowID();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   if (cold_store_->Size() > 0) {
     return cold_store_->FirstRowID();
@@ -334,6 +388,7 @@ Table::RowID Table::FirstRowID() const {
 }
 
 Table::RowID Table::LastRowID() const {
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() > 0) {
@@ -342,10 +397,14 @@ Table::RowID Table::LastRowID() const {
   if (cold_store_->Size() > 0) {
     return cold_store_->LastRowID();
   }
+  if (disk_tier_ != nullptr && disk_tier_->store()->Size() > 0) {
+    return disk_tier_->store()->LastRowID();
+  }
   return -1;
 }
 
 Table::Time Table::MaxTime() const {
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() > 0) {
@@ -354,12 +413,23 @@ Table::Time Table::MaxTime() const {
   if (cold_store_->Size() > 0) {
     return cold_store_->MaxTime();
   }
+  if (disk_tier_ != nullptr && disk_tier_->store()->Size() > 0) {
+    return disk_tier_->store()->MaxTime();
+  }
   return -1;
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  std::optional<RowID> optional_row_id;
+  if (disk_tier_ != nullptr) {
+    optional_row_id = disk_tier_->store()->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+    if (optional_row_id.has_value()) {
+      return optional_row_id.value();
+    }
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
@@ -372,8 +442,16 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  std::optional<RowID> optional_row_id;
+  if (disk_tier_ != nullptr) {
+    optional_row_id = disk_tier_->store()->FindRowIDFromTimeFirstGreaterThan(time);
+    if (optional_row_id.has_value()) {
+      return optional_row_id.value();
+    }
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
@@ -393,9 +471,17 @@ TableStats Table::GetTableStats() const {
   int64_t num_batches = 0;
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
+  int64_t disk_bytes = 0;
   {
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    if (disk_tier_ != nullptr) {
+      disk_bytes = disk_tier_->Bytes();
+      min_time = disk_tier_->store()->MinTime();
+    }
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    min_time = cold_store_->MinTime();
+    if (min_time == -1) {
+      min_time = cold_store_->MinTime();
+    }
     num_batches += cold_store_->Size();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     num_batches += hot_store_->Size();
@@ -414,38 +500,83 @@ TableStats Table::GetTableStats() const {
   info.bytes = hot_bytes + cold_bytes;
   info.hot_bytes = hot_bytes;
   info.cold_bytes = cold_bytes;
+  info.disk_bytes = disk_bytes;
   info.compacted_batches = compacted_batches_;
-  info.max_table_size = max_table_size_;
+  info.batches_read = batches_read_.load(std::memory_order_relaxed);
+  info.max_table_size = max_table_size_.load();
   info.min_time = min_time;
 
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
-  const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+Status Table::SetMaxTableSize(int64_t max_table_size) {
+  if (max_table_size < 0) {
+    return error::InvalidArgument("Maximum table size ($0) must not be negative.", max_table_size);
+  }
+  max_table_size_ = max_table_size;
+  // Expiring with an empty incoming batch trims the table down to the new limit.
+  PX_RETURN_IF_ERROR(ExpireRowBatches(0));
+  return UpdateTableMetricGauges();
+}
 
-  PX_RETURN_IF_ERROR(
-      compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+StatusOr<bool> Table::CompactSingleBatch() {
+  absl::MutexLock compaction_lock(&compaction_lock_);
 
-  RowID first_row_id = -1;
-  for (auto hot_slice : compaction_spec.hot_slices) {
-    if (first_row_id == -1) {
-      first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
+  while (true) {
+    internal::BatchSizeAccountant::CompactedBatchSpec compaction_spec;
+    std::vector<internal::RecordOrRowBatch> slice_batches;
+    RowID first_row_id = -1;
+    {
+      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+      if (!batch_size_accountant_->CompactedBatchReady()) {
+        return false;
+      }
+      // Copy the spec, since writers may append to the accountant while the batch is being built.
+      // The spec of a ready batch is full, so new hot batches never change it.
+      compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+      first_row_id = hot_store_->FirstRowID() + compaction_spec.hot_slices.front().start_row;
+      // Snapshot the hot batches, so that they can be expired or trimmed while the cold batch is
+      // built from them.
+      size_t batch_idx = 0;
+      for (const auto& hot_slice : compaction_spec.hot_slices) {
+        slice_batches.push_back(hot_store_->at(batch_idx).Snapshot());
+        if (hot_slice.last_slice_for_batch) {
+          ++batch_idx;
+        }
+      }
     }
 
-    compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row, hot_slice.end_row);
-    if (hot_slice.last_slice_for_batch) {
-      hot_store_->PopFront();
+    // Build the cold batch without holding the store locks.
+    PX_RETURN_IF_ERROR(
+        compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+    for (const auto& [i, hot_slice] : Enumerate(compaction_spec.hot_slices)) {
+      compactor_.UnsafeAppendBatchSlice(slice_batches[i], hot_slice.start_row, hot_slice.end_row);
     }
-  }
-
-  PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
+    PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
+    slice_batches.clear();
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
-
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
-  if (num_rows_to_remove > 0) {
-    hot_store_->RemovePrefix(num_rows_to_remove);
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    // A hot batch of the spec was expired while the cold batch was built, so the cold batch is
+    // stale. Expiry always moves the first hot row forward, so comparing it detects this.
+    if (!batch_size_accountant_->CompactedBatchReady() ||
+        hot_store_->FirstRowID() +
+                batch_size_accountant_->GetNextCompactedBatchSpec().hot_slices.front().start_row !=
+            first_row_id) {
+      continue;
+    }
+    for (const auto& hot_slice : compaction_spec.hot_slices) {
+      if (hot_slice.last_slice_for_batch) {
+        hot_store_->PopFront();
+      }
+    }
+    cold_store_->EmplaceBack(first_row_id, out_columns);
+    auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+    if (num_rows_to_remove > 0) {
+      hot_store_->RemovePrefix(num_rows_to_remove);
+    }
+    TrackHotBytes();
+    break;
   }
 
   {
@@ -453,40 +584,109 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
     compacted_batches_++;
     metrics_.compacted_batches_counter.Increment();
   }
-  return Status::OK();
+  return true;
 }
 
-Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
-  bool next_ready = false;
+Status Table::CompactHotToCold() {
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < kMaxBatchesPerCompactionCall; ++i) {
+    PX_ASSIGN_OR_RETURN(bool compacted, CompactSingleBatch());
+    if (!compacted) {
+      break;
+    }
+  }
+  auto latency = std::chrono::steady_clock::now() - start;
+  metrics_.compaction_latency_ns_gauge.Set(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+
+  // Segment files are written here rather than on expiry, to keep the disk writes off the path of
+  // the table's writer.
+  SealDiskSegment();
+
+  // The lag is the age of the oldest row that is still waiting in the hot store.
+  int64_t hot_min_time = -1;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    next_ready = batch_size_accountant_->CompactedBatchReady();
+    hot_min_time = hot_store_->MinTime();
   }
-  while (next_ready) {
-    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    // We have to check CompactedBatchReady() again, in case hot batches were expired since the last
-    // check.
-    if (!batch_size_accountant_->CompactedBatchReady()) {
-      break;
-    }
-    PX_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
-    next_ready = batch_size_accountant_->CompactedBatchReady();
+  int64_t lag_ns = 0;
+  if (hot_min_time > 0) {
+    int64_t current_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count();
+    lag_ns = std::max<int64_t>(0, current_time_ns - hot_min_time);
   }
+  metrics_.compaction_lag_ns_gauge.Set(lag_ns);
   return Status::OK();
 }
 
-StatusOr<bool> Table::ExpireCold() {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+bool Table::CompactionReady() const {
+  {
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    if (disk_tier_ != nullptr && disk_tier_->SealReady()) {
+      return true;
+    }
+  }
+  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  return batch_size_accountant_->CompactedBatchReady();
+}
+
+bool Table::ExpireCold() {
   if (cold_store_->Size() == 0) {
     return false;
   }
+  auto first_row_id = cold_store_->FirstRowID();
+  ColdBatch batch = std::move(cold_store_->front());
   cold_store_->PopFront();
+  if (disk_tier_ != nullptr) {
+    disk_tier_->Append(first_row_id, std::move(batch));
+  }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   batch_size_accountant_->ExpireColdBatch();
   return true;
 }
 
+Status Table::EnableDiskTier(const std::filesystem::path& dir, int64_t max_bytes,
+                             int64_t segment_size) {
+  PX_ASSIGN_OR_RETURN(auto disk_tier,
+                      DiskTier::Create(dir, rel_, time_col_idx_, max_bytes, segment_size));
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  if (disk_tier_ != nullptr || next_row_id_ > 0) {
+    return error::FailedPrecondition(
+        "The disk tier can only be enabled once, before any data is written to the table.");
+  }
+  // Continue numbering rows after the ones loaded from disk.
+  if (disk_tier->store()->Size() > 0) {
+    next_row_id_ = disk_tier->store()->LastRowID() + 1;
+  }
+  disk_tier_ = std::move(disk_tier);
+  return Status::OK();
+}
+
+void Table::SealDiskSegment() {
+  DiskTier::PendingSegment pending;
+  {
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    if (disk_tier_ == nullptr || !disk_tier_->SealReady()) {
+      return;
+    }
+    pending = disk_tier_->StartSeal();
+  }
+  // Write the segment without holding the lock, readers keep using the in memory batches.
+  auto segment_or_s = DiskTier::WriteSegment(pending, rel_);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  if (!segment_or_s.ok()) {
+    // The disk may recover, e.g. once space is freed, so the batches are kept for a later attempt.
+    LOG(ERROR) << absl::Substitute("Failed to write segment $0, keeping its batches in memory: $1",
+                                   pending.path.string(), segment_or_s.status().msg());
+    disk_tier_->AbortSeal();
+    return;
+  }
+  disk_tier_->FinishSeal(pending, segment_or_s.ConsumeValueOrDie());
+}
+
 Status Table::ExpireHot() {
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() == 0) {
@@ -494,16 +694,20 @@ Status Table::ExpireHot() {
   }
   hot_store_->PopFront();
   batch_size_accountant_->ExpireHotBatch();
+  TrackHotBytes();
   return Status::OK();
 }
 
 Status Table::ExpireBatch() {
-  PX_ASSIGN_OR_RETURN(auto expired_cold, ExpireCold());
-  if (expired_cold) {
+  // cold_lock_ is held across both stores, so that a compaction can't move the oldest hot batches
+  // to the cold store after it was found empty, which would expire a newer batch first. An in
+  // progress compaction builds from snapshots of the hot batches, so it doesn't block expiry.
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  if (ExpireCold()) {
     return Status::OK();
   }
-  // If we get to this point then there were no cold batches to expire, so we try to expire a hot
-  // batch.
+  // There were no cold batches to expire, so we try to expire a hot batch.
   return ExpireHot();
 }
 
@@ -515,6 +719,7 @@ Status Table::UpdateTableMetricGauges() {
   metrics_.hot_bytes_gauge.Set(stats.hot_bytes);
   metrics_.num_batches_gauge.Set(stats.num_batches);
   metrics_.max_table_size_gauge.Set(stats.max_table_size);
+  metrics_.disk_bytes_gauge.Set(stats.disk_bytes);
   // Compute retention gauge
   int64_t current_retention_ns = 0;
   // If min_time is 0, there is no data in the table.
@@ -22,7 +22,9 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
@@ -36,11 +38,13 @@
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
 #include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/tracking_memory_pool.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/schemapb/schema.pb.h"
+#include "src/table_store/table/disk_tier.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
@@ -55,15 +59,19 @@ namespace table_store {
 
 using RecordBatchSPtr = std::shared_ptr<arrow::RecordBatch>;
 
+class SharedScan;
+
 struct TableStats {
   int64_t bytes;
   int64_t hot_bytes;
   int64_t cold_bytes;
+  int64_t disk_bytes;
   int64_t num_batches;
   int64_t batches_added;
   int64_t batches_expired;
   int64_t bytes_added;
   int64_t compacted_batches;
+  int64_t batches_read;
   int64_t max_table_size;
   int64_t min_time;
 };
@@ -212,6 +220,7 @@ class Table : public NotCopyable {
     StopState stop_;
 
     friend class Table;
+    friend class SharedScan;
   };
 
   /**
@@ -229,6 +238,8 @@ class Table : public NotCopyable {
   Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
         size_t compacted_batch_size_);
 
+  ~Table();
+
   /**
    * Get a RowBatch of data corresponding to the next data after the given cursor.
    * @param cursor the Table::Cursor to get the next row batch after.
@@ -294,12 +305,41 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * @return the pool tracking the memory of the hot and cold batches of this table.
+   */
+  const types::TrackingMemoryPool* mem_pool() const { return mem_pool_; }
+
+  /**
+   * Changes the maximum number of bytes the table can hold. If the table currently holds more than
+   * the new limit, the oldest batches are expired until it fits.
+   * @param max_table_size the new cap on the table size.
+   */
+  Status SetMaxTableSize(int64_t max_table_size);
+
+  /**
+   * Keeps the cold batches that are expired from memory in segment files under dir, where queries
+   * can still read them, instead of dropping them. Segments that a previous process left in dir are
+   * loaded, so this must be called before any data is written to the table.
+   * @param max_bytes the size limit of the segment files, beyond which the oldest are deleted.
+   * @param segment_size the number of bytes of expired batches to gather per segment file.
+   */
+  Status EnableDiskTier(const std::filesystem::path& dir, int64_t max_bytes, int64_t segment_size);
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
-   * @param mem_pool arrow MemoryPool to be used for creating new cold batches.
+   * Cold batches are built without holding the hot or cold locks, and swapped into the cold store
+   * once complete, so writers and readers are only blocked for the swap. Also writes the segment
+   * file of the disk tier once enough batches were expired to it.
    */
-  Status CompactHotToCold(arrow::MemoryPool* mem_pool);
+  Status CompactHotToCold();
+
+  /**
+   * @return whether the hot store holds enough data to create a compacted cold batch, or the disk
+   * tier has a segment file to write.
+   */
+  bool CompactionReady() const;
 
  private:
   TableMetrics metrics_;
@@ -311,7 +351,9 @@ class Table : public NotCopyable {
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t bytes_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
-  int64_t max_table_size_ = 0;
+  // Count of batches handed out to cursors. Used as a measure of how often the table is queried.
+  mutable std::atomic<int64_t> batches_read_ = 0;
+  std::atomic<int64_t> max_table_size_ = 0;
   const int64_t compacted_batch_size_;
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
@@ -322,6 +364,11 @@ class Table : public NotCopyable {
       ABSL_GUARDED_BY(cold_lock_);
   std::deque<int64_t> cold_batch_bytes_ ABSL_GUARDED_BY(cold_lock_);
 
+  // Lock order is disk_lock_, then cold_lock_, then hot_lock_.
+  mutable absl::base_internal::SpinLock disk_lock_;
+  // Only set when the disk tier is enabled.
+  std::unique_ptr<DiskTier> disk_tier_ ABSL_GUARDED_BY(disk_lock_);
+
   // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
   // accessed on a hot write.
   int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
@@ -330,18 +377,33 @@ class Table : public NotCopyable {
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
 
   Status ExpireBatch();
-  Status ExpireHot();
-  StatusOr<bool> ExpireCold();
+  Status ExpireHot() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
+  bool ExpireCold() ABSL_EXCLUSIVE_LOCKS_REQUIRED(disk_lock_, cold_lock_);
+  void SealDiskSegment();
   Status ExpireRowBatches(int64_t row_batch_size);
-  Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  StatusOr<bool> CompactSingleBatch();
   Status UpdateTableMetricGauges();
 
   Time MaxTime() const;
 
   std::unique_ptr<internal::BatchSizeAccountant> batch_size_accountant_ ABSL_GUARDED_BY(hot_lock_);
 
-  internal::ArrowArrayCompactor compactor_;
+  // Tracks the memory of the cold batches built by compaction, and the hot batches through
+  // TrackExternal. Child of the process wide table_store pool.
+  types::TrackingMemoryPool* mem_pool_;
+  // The hot bytes currently tracked in mem_pool_.
+  int64_t tracked_hot_bytes_ ABSL_GUARDED_BY(hot_lock_) = 0;
+  // Updates mem_pool_ to the current hot bytes of the table. Called after each change to them.
+  void TrackHotBytes() ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+
+  // Serializes expiry between the writer and SetMaxTableSize, so that they don't both try to expire
+  // the last batch. Taken before disk_lock_.
+  absl::Mutex expiry_lock_;
+  // Serializes compactions of this table. Expiry doesn't take it: the compactor reads snapshots of
+  // the hot batches, and drops its build if they were expired meanwhile. Lock order is
+  // compaction_lock_, then disk_lock_, then cold_lock_, then hot_lock_.
+  absl::Mutex compaction_lock_;
+  internal::ArrowArrayCompactor compactor_ ABSL_GUARDED_BY(compaction_lock_);
 
   friend class Cursor;
 };
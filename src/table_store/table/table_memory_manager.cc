@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/table_store/table/table_memory_manager.h"
+
+DEFINE_int64(table_store_global_size_limit_mb,
+             gflags::Int64FromEnv("PL_TABLE_STORE_GLOBAL_SIZE_LIMIT_MB", 0),
+             "The total number of megabytes shared by all tables in the table store. When set, "
+             "table sizes are rebalanced periodically based on their write rate, read rate and "
+             "retention policy. 0 keeps a fixed size per table.");
+
+namespace px {
+namespace table_store {
+
+Status TableMemoryManager::Rebalance(const std::vector<NamedTable>& tables,
+                                     std::chrono::steady_clock::time_point now) {
+  if (tables.empty() || global_size_limit_ <= 0) {
+    return Status::OK();
+  }
+  absl::MutexLock lock(&mu_);
+  const int64_t num_tables = static_cast<int64_t>(tables.size());
+
+  // Forget dropped tables, whose address may be reused by a new table.
+  absl::flat_hash_map<const Table*, TableUsage> usage;
+  for (const auto& [name, table] : tables) {
+    auto it = usage_.find(table);
+    if (it != usage_.end()) {
+      usage.insert(*it);
+    }
+  }
+  usage_ = std::move(usage);
+
+  std::vector<TableRetentionPolicy> policies(tables.size());
+  std::vector<double> floors(tables.size());
+  std::vector<int64_t> current_sizes(tables.size());
+  double total_floor = 0;
+  double total_read_rate = 0;
+  for (const auto& [i, named_table] : Enumerate(tables)) {
+    const auto& [name, table] = named_table;
+    auto policy_it = policies_.find(name);
+    if (policy_it != policies_.end()) {
+      policies[i] = policy_it->second;
+    }
+
+    auto stats = table->GetTableStats();
+    current_sizes[i] = stats.max_table_size;
+    auto [usage_it, inserted] = usage_.try_emplace(table);
+    TableUsage& usage = usage_it->second;
+    double elapsed_s = std::chrono::duration<double>(now - usage.last_time).count();
+    if (inserted) {
+      // The rates of a new table are only known from its second measurement on.
+      usage.last_time = now;
+      usage.last_bytes_added = stats.bytes_added;
+      usage.last_batches_read = stats.batches_read;
+    } else if (elapsed_s > 0) {
+      double write_rate = (stats.bytes_added - usage.last_bytes_added) / elapsed_s;
+      double read_rate = (stats.batches_read - usage.last_batches_read) / elapsed_s;
+      usage.write_rate = kRateSmoothing * write_rate + (1 - kRateSmoothing) * usage.write_rate;
+      usage.read_rate = kRateSmoothing * read_rate + (1 - kRateSmoothing) * usage.read_rate;
+      usage.last_time = now;
+      usage.last_bytes_added = stats.bytes_added;
+      usage.last_batches_read = stats.batches_read;
+    }
+    total_read_rate += usage.read_rate;
+
+    floors[i] = std::max(policies[i].min_bytes,
+                         global_size_limit_ / (kFloorShareDivisor * num_tables));
+    total_floor += floors[i];
+  }
+
+  // If the reserved bytes alone exceed the budget, every table gets a proportional cut.
+  double floor_scale = 1.0;
+  if (total_floor > global_size_limit_) {
+    floor_scale = global_size_limit_ / total_floor;
+  }
+  double remaining = std::max(0.0, global_size_limit_ - total_floor * floor_scale);
+
+  std::vector<double> weights(tables.size());
+  double total_weight = 0;
+  for (const auto& [i, named_table] : Enumerate(tables)) {
+    const TableUsage& usage = usage_[named_table.second];
+    // The +1 keeps idle tables with a non-zero weight, so that an all-idle store is split evenly.
+    double weight = std::max(0.0, policies[i].priority) * (usage.write_rate + 1);
+    if (total_read_rate > 0) {
+      weight *= 1 + usage.read_rate / total_read_rate;
+    }
+    weights[i] = weight;
+    total_weight += weight;
+  }
+
+  std::vector<int64_t> quotas(tables.size());
+  std::vector<size_t> order(tables.size());
+  for (size_t i = 0; i < tables.size(); ++i) {
+    double share = total_weight > 0 ? weights[i] / total_weight : 1.0 / num_tables;
+    quotas[i] = static_cast<int64_t>(floors[i] * floor_scale + remaining * share);
+    order[i] = i;
+  }
+
+  // Shrink tables first so that the total never exceeds the budget while quotas are applied.
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return quotas[a] - current_sizes[a] < quotas[b] - current_sizes[b];
+  });
+  for (size_t i : order) {
+    PX_RETURN_IF_ERROR(tables[i].second->SetMaxTableSize(quotas[i]));
+  }
+  return Status::OK();
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+DECLARE_int64(table_store_global_size_limit_mb);
+
+namespace px {
+namespace table_store {
+
+/**
+ * TableRetentionPolicy configures how a table competes for the global table store budget.
+ */
+struct TableRetentionPolicy {
+  // Relative weight of the table. A table with priority 2 gets twice the share of the budget that
+  // a table with priority 1 gets at the same write and read rate.
+  double priority = 1.0;
+  // Bytes reserved for the table regardless of how busy it is.
+  int64_t min_bytes = 0;
+};
+
+/**
+ * TableMemoryManager splits one global byte budget between all the tables in a TableStore.
+ *
+ * Each call to Rebalance measures how many bytes per second were written to and how many batches
+ * per second were read from each table since the previous call, and redistributes the budget
+ * accordingly:
+ *   - Every table keeps a floor of max(min_bytes, budget / (kFloorShareDivisor * num_tables)), so
+ *     an idle table can still accept a burst of writes.
+ *   - The rest of the budget is split proportionally to priority * write rate, boosted by the
+ *     table's share of reads.
+ * Sizing quotas by write rate keeps the retention horizons of equally weighted tables roughly
+ * equal, so the data dropped when a table shrinks is the oldest data in the store rather than
+ * whatever happens to live in the busiest table.
+ *
+ * The manager is thread-safe, but rebalancing shrinks tables that are being written to, so the
+ * TableStore only rebalances from its periodic compaction.
+ */
+class TableMemoryManager {
+ public:
+  using NamedTable = std::pair<std::string, Table*>;
+
+  explicit TableMemoryManager(int64_t global_size_limit) : global_size_limit_(global_size_limit) {}
+
+  /**
+   * Sets the retention policy for all tablets of the given table.
+   */
+  void SetRetentionPolicy(const std::string& table_name, TableRetentionPolicy policy) {
+    absl::MutexLock lock(&mu_);
+    policies_[table_name] = policy;
+  }
+
+  /**
+   * Recomputes the quota of every table and applies it, shrinking tables before growing others so
+   * the store never holds more than the global budget.
+   */
+  Status Rebalance(const std::vector<NamedTable>& tables) {
+    return Rebalance(tables, std::chrono::steady_clock::now());
+  }
+
+  /**
+   * Same as above, with the time of the measurement, which turns the bytes written and batches
+   * read since the previous call into rates.
+   */
+  Status Rebalance(const std::vector<NamedTable>& tables,
+                   std::chrono::steady_clock::time_point now);
+
+  int64_t global_size_limit() const { return global_size_limit_; }
+
+ private:
+  // Weight given to the latest measurement when smoothing the write and read rates.
+  static constexpr double kRateSmoothing = 0.5;
+  // Fraction (1 / kFloorShareDivisor) of the even split that is always reserved for each table.
+  static constexpr int64_t kFloorShareDivisor = 4;
+
+  struct TableUsage {
+    std::chrono::steady_clock::time_point last_time;
+    int64_t last_bytes_added = 0;
+    int64_t last_batches_read = 0;
+    // Bytes written per second.
+    double write_rate = 0;
+    // Batches read per second.
+    double read_rate = 0;
+  };
+
+  const int64_t global_size_limit_;
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, TableRetentionPolicy> policies_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<const Table*, TableUsage> usage_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/schema/row_descriptor.h"
+#include "src/table_store/table/table_memory_manager.h"
+#include "src/table_store/table/table_store.h"
+
+namespace px {
+namespace table_store {
+
+using std::chrono::seconds;
+
+class TableMemoryManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = schema::Relation({types::DataType::INT64}, {"col1"});
+    table_a_ = Table::Create("table_a", rel_);
+    table_b_ = Table::Create("table_b", rel_);
+  }
+
+  void WriteBatches(Table* table, int64_t num_batches) {
+    schema::RowDescriptor rd(rel_.col_types());
+    std::vector<types::Int64Value> col(10, 1);
+    for (int64_t i = 0; i < num_batches; ++i) {
+      schema::RowBatch rb(rd, col.size());
+      PX_CHECK_OK(rb.AddColumn(types::ToArrow(col, arrow::default_memory_pool())));
+      PX_CHECK_OK(table->WriteRowBatch(rb));
+    }
+  }
+
+  std::vector<TableMemoryManager::NamedTable> Tables() {
+    return {{"table_a", table_a_.get()}, {"table_b", table_b_.get()}};
+  }
+
+  const std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+  schema::Relation rel_;
+  std::shared_ptr<Table> table_a_;
+  std::shared_ptr<Table> table_b_;
+};
+
+TEST_F(TableMemoryManagerTest, idle_tables_split_evenly) {
+  TableMemoryManager manager(1000);
+  ASSERT_OK(manager.Rebalance(Tables()));
+
+  EXPECT_EQ(500, table_a_->GetTableStats().max_table_size);
+  EXPECT_EQ(500, table_b_->GetTableStats().max_table_size);
+}
+
+TEST_F(TableMemoryManagerTest, busy_table_gets_more_and_expires_oldest) {
+  TableMemoryManager manager(1000);
+  ASSERT_OK(manager.Rebalance(Tables(), start_));
+  WriteBatches(table_a_.get(), 20);
+  WriteBatches(table_b_.get(), 6);
+  auto bytes_before = table_b_->GetTableStats().bytes;
+  ASSERT_OK(manager.Rebalance(Tables(), start_ + seconds(1)));
+
+  auto stats_a = table_a_->GetTableStats();
+  auto stats_b = table_b_->GetTableStats();
+  EXPECT_GT(stats_a.max_table_size, stats_b.max_table_size);
+  EXPECT_LE(stats_a.max_table_size + stats_b.max_table_size, 1000);
+  // Every table keeps its floor of a quarter of the even split.
+  EXPECT_GE(stats_b.max_table_size, 125);
+
+  // Table b held more than its new quota, so its oldest batches were expired.
+  EXPECT_GT(bytes_before, stats_b.max_table_size);
+  EXPECT_LE(stats_b.bytes, stats_b.max_table_size);
+  EXPECT_GT(stats_b.batches_expired, 0);
+}
+
+TEST_F(TableMemoryManagerTest, rates_are_per_second) {
+  TableMemoryManager manager(1000);
+  ASSERT_OK(manager.Rebalance(Tables(), start_));
+  // Table a writes twice the bytes of table b, but over ten times the time.
+  WriteBatches(table_a_.get(), 2);
+  ASSERT_OK(manager.Rebalance(Tables(), start_ + seconds(10)));
+  WriteBatches(table_b_.get(), 1);
+  ASSERT_OK(manager.Rebalance(Tables(), start_ + seconds(11)));
+
+  EXPECT_GT(table_b_->GetTableStats().max_table_size, table_a_->GetTableStats().max_table_size);
+}
+
+TEST_F(TableMemoryManagerTest, read_table_gets_more) {
+  TableMemoryManager manager(1000);
+  WriteBatches(table_a_.get(), 1);
+  WriteBatches(table_b_.get(), 1);
+  ASSERT_OK(manager.Rebalance(Tables(), start_));
+
+  Table::Cursor cursor(table_b_.get());
+  while (!cursor.Done()) {
+    ASSERT_OK(cursor.GetNextRowBatch({0}));
+  }
+  ASSERT_OK(manager.Rebalance(Tables(), start_ + seconds(1)));
+
+  EXPECT_GT(table_b_->GetTableStats().max_table_size, table_a_->GetTableStats().max_table_size);
+}
+
+TEST_F(TableMemoryManagerTest, retention_policy) {
+  TableMemoryManager manager(1000);
+  manager.SetRetentionPolicy("table_a", TableRetentionPolicy{3.0, 0});
+  ASSERT_OK(manager.Rebalance(Tables()));
+
+  // Both tables keep a floor of 125, and the remaining 750 is split 3:1.
+  EXPECT_EQ(687, table_a_->GetTableStats().max_table_size);
+  EXPECT_EQ(312, table_b_->GetTableStats().max_table_size);
+
+  manager.SetRetentionPolicy("table_b", TableRetentionPolicy{1.0, 600});
+  ASSERT_OK(manager.Rebalance(Tables()));
+  EXPECT_GE(table_b_->GetTableStats().max_table_size, 600);
+  EXPECT_LE(table_a_->GetTableStats().max_table_size + table_b_->GetTableStats().max_table_size,
+            1000);
+}
+
+TEST_F(TableMemoryManagerTest, table_store_rebalances_on_compaction) {
+  TableStore table_store(1000);
+  table_store.AddTable(table_a_, "table_a");
+  table_store.AddTable(table_b_, "table_b");
+  // Sizes are only rebalanced by the periodic compaction.
+  EXPECT_EQ(FLAGS_table_store_table_size_limit, table_a_->GetTableStats().max_table_size);
+
+  EXPECT_OK(table_store.RunCompaction());
+  EXPECT_EQ(500, table_a_->GetTableStats().max_table_size);
+  EXPECT_EQ(500, table_b_->GetTableStats().max_table_size);
+
+  EXPECT_OK(table_store.SetRetentionPolicy("table_b", TableRetentionPolicy{1.0, 800}));
+  EXPECT_OK(table_store.RunCompaction());
+  EXPECT_GE(table_b_->GetTableStats().max_table_size, 800);
+}
+
+TEST_F(TableMemoryManagerTest, table_store_without_budget) {
+  TableStore table_store(0);
+  table_store.AddTable(table_a_, "table_a");
+  EXPECT_EQ(FLAGS_table_store_table_size_limit, table_a_->GetTableStats().max_table_size);
+  EXPECT_NOT_OK(table_store.SetRetentionPolicy("table_a", TableRetentionPolicy{}));
+}
+
+}  // namespace table_store
+}  // namespace px
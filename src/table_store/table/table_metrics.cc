@@ -36,6 +36,11 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                           .Help("Current hot data bytes in the table")
                           .Register(*registry)
                           .Add({{"name", table_name}})),
+      disk_bytes_gauge(prometheus::BuildGauge()
+                           .Name("table_disk_bytes")
+                           .Help("Current bytes of the table kept in segment files on disk")
+                           .Register(*registry)
+                           .Add({{"name", table_name}})),
       num_batches_gauge(prometheus::BuildGauge()
                             .Name("table_num_batches")
                             .Help("Current number of row batches in the table")
@@ -58,6 +63,11 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
               .Help("Total batches compacted in the table in the table's lifetime")
               .Register(*registry)
               .Add({{"name", table_name}})),
+      batches_read_counter(prometheus::BuildCounter()
+                               .Name("table_batches_read")
+                               .Help("Total batches read from the table in the table's lifetime")
+                               .Register(*registry)
+                               .Add({{"name", table_name}})),
       max_table_size_gauge(prometheus::BuildGauge()
                                .Name("table_max_table_size")
                                .Help("The cap on the table size")
@@ -67,4 +77,16 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                              .Name("min_time")
                              .Help("The current retention window for data in this table")
                              .Register(*registry)
-                             .Add({{"name", table_name}})) {}
+                             .Add({{"name", table_name}})),
+      compaction_latency_ns_gauge(
+          prometheus::BuildGauge()
+              .Name("table_compaction_latency_ns")
+              .Help("Duration of the most recent compaction of the table")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
+      compaction_lag_ns_gauge(
+          prometheus::BuildGauge()
+              .Name("table_compaction_lag_ns")
+              .Help("Age of the oldest row in the table that has not been compacted yet")
+              .Register(*registry)
+              .Add({{"name", table_name}})) {}
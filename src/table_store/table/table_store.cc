@@ -17,9 +17,13 @@
  */
 
 #include <algorithm>
+#include <filesystem>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include <absl/strings/substitute.h>
+
 #include "src/table_store/table/table_store.h"
 
 namespace px {
@@ -44,6 +48,7 @@ StatusOr<Table*> TableStore::CreateNewTablet(uint64_t table_id, const types::Tab
   const schema::Relation& relation = table_info.relation;
 
   std::shared_ptr<Table> new_tablet = Table::Create(table_info.table_name, relation);
+  MaybeEnableDiskTier(new_tablet.get(), table_info.table_name, tablet_id);
 
   TableIDTablet id_key = {table_id, tablet_id};
   id_to_table_map_[id_key] = new_tablet;
@@ -115,6 +120,7 @@ void TableStore::RegisterTableID(uint64_t table_id, TableInfo table_info,
 void TableStore::AddTable(std::shared_ptr<table_store::Table> table, const std::string& table_name,
                           std::optional<uint64_t> table_id, const types::TabletID& tablet_id) {
   const auto& table_relation = table->GetRelation();
+  MaybeEnableDiskTier(table.get(), table_name, tablet_id);
 
   // Register the table by name.
   RegisterTableName(table_name, tablet_id, table_relation, table);
@@ -158,12 +164,65 @@ std::vector<uint64_t> TableStore::GetTableIDs() const {
   return ids;
 }
 
-Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
+Status TableStore::RunCompaction() {
+  if (FLAGS_table_store_compaction_threads <= 0) {
+    for (const auto& it : name_to_table_map_) {
+      PX_RETURN_IF_ERROR(it.second->CompactHotToCold());
+    }
+    return RebalanceTableSizes();
+  }
+
+  if (compaction_scheduler_ == nullptr) {
+    compaction_scheduler_ =
+        std::make_unique<CompactionScheduler>(FLAGS_table_store_compaction_threads);
+  }
+  std::vector<std::shared_ptr<Table>> tables;
+  tables.reserve(name_to_table_map_.size());
   for (const auto& it : name_to_table_map_) {
-    PX_RETURN_IF_ERROR(it.second->CompactHotToCold(mem_pool));
+    tables.push_back(it.second);
+  }
+  compaction_scheduler_->Schedule(tables);
+  return RebalanceTableSizes();
+}
+
+void TableStore::MaybeEnableDiskTier(Table* table, const std::string& table_name,
+                                     const types::TabletID& tablet_id) {
+  if (FLAGS_table_store_disk_tier_dir.empty()) {
+    return;
+  }
+  std::filesystem::path dir = std::filesystem::path(FLAGS_table_store_disk_tier_dir) / table_name;
+  if (tablet_id != kDefaultTablet) {
+    dir /= tablet_id;
   }
+  auto status = table->EnableDiskTier(
+      dir, static_cast<int64_t>(FLAGS_table_store_disk_tier_size_limit_mb) * 1024 * 1024,
+      FLAGS_table_store_disk_segment_size);
+  LOG_IF(WARNING, !status.ok()) << absl::Substitute("Disk tier disabled for table $0: $1",
+                                                    table_name, status.msg());
+}
+
+Status TableStore::SetRetentionPolicy(const std::string& table_name,
+                                      TableRetentionPolicy policy) {
+  if (memory_manager_ == nullptr) {
+    return error::FailedPrecondition(
+        "Cannot set the retention policy of table $0, the table store has no global size limit.",
+        table_name);
+  }
+  memory_manager_->SetRetentionPolicy(table_name, policy);
   return Status::OK();
 }
 
+Status TableStore::RebalanceTableSizes() {
+  if (memory_manager_ == nullptr) {
+    return Status::OK();
+  }
+  std::vector<TableMemoryManager::NamedTable> tables;
+  tables.reserve(name_to_table_map_.size());
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    tables.emplace_back(name_tablet.name_, table.get());
+  }
+  return memory_manager_->Rebalance(tables);
+}
+
 }  // namespace table_store
 }  // namespace px
@@ -31,7 +31,10 @@
 #include "src/shared/types/hash_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/schema.h"
+#include "src/table_store/table/compaction_scheduler.h"
+#include "src/table_store/table/shared_scan.h"
 #include "src/table_store/table/table.h"
+#include "src/table_store/table/table_memory_manager.h"
 #include "src/table_store/table/tablets_group.h"
 
 namespace px {
@@ -80,7 +83,17 @@ class TableStore {
  public:
   using RelationMap = std::unordered_map<std::string, schema::Relation>;
 
-  TableStore() = default;
+  TableStore() : TableStore(FLAGS_table_store_global_size_limit_mb * 1024 * 1024) {}
+
+  /**
+   * @param global_size_limit the number of bytes shared by all tables in the store. If positive,
+   * table sizes are rebalanced within this budget instead of each table keeping a fixed size.
+   */
+  explicit TableStore(int64_t global_size_limit) {
+    if (global_size_limit > 0) {
+      memory_manager_ = std::make_unique<TableMemoryManager>(global_size_limit);
+    }
+  }
 
   /**
    * Get table IDs returns a list of table ids available in the table store.
@@ -165,7 +178,24 @@ class TableStore {
     return "";
   }
 
-  Status RunCompaction(arrow::MemoryPool* mem_pool);
+  /**
+   * Compacts the hot data of every table, then rebalances the table sizes. With
+   * --table_store_compaction_threads > 0 the compaction is handed off to background threads and
+   * this call doesn't wait for it. This is the only place sizes are rebalanced, so new tables keep
+   * the default table size until the next call.
+   */
+  Status RunCompaction();
+
+  /**
+   * Sets the retention policy used to split the global budget for all tablets of the given table.
+   * @return Error if the store has no global budget.
+   */
+  Status SetRetentionPolicy(const std::string& table_name, TableRetentionPolicy policy);
+
+  /**
+   * @return The shared scans that the streaming queries reading the tables can attach to.
+   */
+  SharedScanRegistry* shared_scans() { return &shared_scans_; }
 
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
@@ -175,6 +205,9 @@ class TableStore {
   void RegisterTableID(uint64_t table_id, TableInfo table_info, const types::TabletID& tablet_id,
                        std::shared_ptr<table_store::Table> table);
 
+  // Redistributes the global budget between the tables. A no-op without a global budget.
+  Status RebalanceTableSizes();
+
   /**
    * Create a new tablet inside of the table with table_id
    *
@@ -184,6 +217,12 @@ class TableStore {
    */
   StatusOr<Table*> CreateNewTablet(uint64_t table_id, const types::TabletID& tablet_id);
 
+  /**
+   * Keeps the data expired from the table on disk, if --table_store_disk_tier_dir is set.
+   */
+  void MaybeEnableDiskTier(Table* table, const std::string& table_name,
+                           const types::TabletID& tablet_id);
+
   // The default value for tablets, when tablet is not specified.
   inline static types::TabletID kDefaultTablet = "";
   // Map a name to a table.
@@ -197,6 +236,12 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+  SharedScanRegistry shared_scans_;
+  // Only set when the store has a global budget.
+  std::unique_ptr<TableMemoryManager> memory_manager_;
+  // Created on the first call to RunCompaction, so that stores that are never compacted don't
+  // start any threads.
+  std::unique_ptr<CompactionScheduler> compaction_scheduler_;
 };
 
 }  // namespace table_store
@@ -20,6 +20,7 @@
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <filesystem>
 #include <random>
 #include <vector>
 
@@ -199,11 +200,43 @@ TEST(TableTest, bytes_test_w_compaction) {
 
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch_1)));
 
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size + rb3_size);
 }
 
+TEST(TableTest, mem_pool_tracks_hot_and_cold_bytes) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  int64_t batch_size = 3 * sizeof(int64_t);
+  Table table("test_table", rel, 3 * batch_size, 2 * batch_size);
+
+  auto write_batch = [&table]() {
+    auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    auto col_wrapper = std::make_shared<types::Int64ValueColumnWrapper>(3);
+    col_wrapper->Clear();
+    for (int64_t i = 0; i < 3; ++i) {
+      col_wrapper->Append(i);
+    }
+    wrapper_batch->push_back(col_wrapper);
+    EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
+  };
+
+  write_batch();
+  write_batch();
+  EXPECT_EQ(2 * batch_size, table.mem_pool()->bytes_allocated());
+
+  // The hot batches are released from the pool, and the cold batch is allocated from it.
+  EXPECT_OK(table.CompactHotToCold());
+  EXPECT_EQ(0, table.GetTableStats().hot_bytes);
+  EXPECT_GE(table.mem_pool()->bytes_allocated(), 2 * batch_size);
+
+  // Expiring the cold batch to make room releases it once it is no longer referenced.
+  write_batch();
+  write_batch();
+  EXPECT_EQ(1, table.GetTableStats().batches_expired);
+  EXPECT_EQ(2 * batch_size, table.mem_pool()->bytes_allocated());
+}
+
 TEST(TableTest, expiry_test) {
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
@@ -359,7 +392,7 @@ TEST(TableTest, expiry_test_w_compaction) {
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size);
 
   EXPECT_OK(table.WriteRowBatch(rb2));
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size);
 
   EXPECT_OK(table.WriteRowBatch(rb3));
@@ -492,7 +525,7 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb1->ColumnAt(0)->Equals(types::ToArrow(col1_in1, arrow::default_memory_pool())));
   EXPECT_TRUE(rb1->ColumnAt(1)->Equals(types::ToArrow(col2_in1, arrow::default_memory_pool())));
 
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   auto rb2 = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
   EXPECT_TRUE(rb2->ColumnAt(0)->Equals(types::ToArrow(col1_in2, arrow::default_memory_pool())));
@@ -596,7 +629,7 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
 
   // Run Compaction.
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
   EXPECT_EQ(0, table.FindRowIDFromTimeFirstGreaterThanOrEqual(0));
   EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(5));
 
@@ -615,7 +648,7 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
 
   // Run Compaction.
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
   EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(6));
 
   EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(8));
@@ -643,7 +676,7 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   wrapper_batch->push_back(col_wrapper);
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
   // Run Compaction.
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   EXPECT_EQ(10, table.FindRowIDFromTimeFirstGreaterThanOrEqual(13));
 
@@ -779,10 +812,10 @@ TEST(TableTest, threaded) {
 
   std::thread compaction_thread([table_ptr, done]() {
     while (!done->WaitForNotificationWithTimeout(absl::Milliseconds(50))) {
-      EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+      EXPECT_OK(table_ptr->CompactHotToCold());
     }
     // Do one last compaction after writer thread has finished writing.
-    EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+    EXPECT_OK(table_ptr->CompactHotToCold());
   });
 
   // Create the cursor before the write thread starts, to ensure that we get every row of the table.
@@ -864,6 +897,63 @@ TEST(TableTest, threaded) {
   reader_thread.join();
 }
 
+// Writes to a table that is always at its size limit, so every write expires the oldest batch
+// while compactions are building cold batches from the hot batches being expired.
+TEST(TableTest, threaded_expiry_during_compaction) {
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  int64_t max_table_size = 64 * 1024;
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, max_table_size, 5 * 1024);
+
+  int64_t max_time_counter = 1024 * 1024;
+  auto done = std::make_shared<absl::Notification>();
+
+  std::thread compaction_thread([table_ptr, done]() {
+    while (!done->HasBeenNotified()) {
+      EXPECT_OK(table_ptr->CompactHotToCold());
+    }
+  });
+
+  std::thread writer_thread([table_ptr, done, max_time_counter]() {
+    NotifyOnDeath notifier(done.get());
+    int64_t batch_size = 256;
+    for (int64_t time_counter = 0; time_counter < max_time_counter;) {
+      auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(batch_size);
+      col_wrapper->Clear();
+      for (int64_t row_idx = 0; row_idx < batch_size; ++row_idx) {
+        col_wrapper->Append(time_counter++);
+      }
+      wrapper_batch->push_back(col_wrapper);
+      EXPECT_OK(table_ptr->TransferRecordBatch(std::move(wrapper_batch)));
+    }
+    done->Notify();
+  });
+
+  writer_thread.join();
+  compaction_thread.join();
+
+  auto stats = table_ptr->GetTableStats();
+  EXPECT_LE(stats.bytes, max_table_size);
+  EXPECT_GT(stats.compacted_batches, 0);
+
+  // Expiry must have removed the oldest rows first, so the rows left are the newest ones, in order.
+  Table::Cursor cursor(table_ptr.get());
+  std::vector<int64_t> times;
+  while (!cursor.Done()) {
+    auto batch = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+    auto time_col = std::static_pointer_cast<arrow::Int64Array>(batch->ColumnAt(0));
+    for (int i = 0; i < time_col->length(); ++i) {
+      times.push_back(time_col->Value(i));
+    }
+  }
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(max_time_counter - 1, times.back());
+  for (size_t i = 1; i < times.size(); ++i) {
+    ASSERT_EQ(times[i - 1] + 1, times[i]);
+  }
+}
+
 // This test was add when `NextBatch` and `BatchSlice`'s were still around, and there was a bug with
 // generation handling of `BatchSlice`'s. Maintaining so as not to decrease test coverage, but this
 // bug should no longer even be plausible.
@@ -883,7 +973,7 @@ TEST(TableTest, NextBatch_generation_bug) {
   EXPECT_OK(rb1.AddColumn(col2_rb1_arrow));
 
   EXPECT_OK(table.WriteRowBatch(rb1));
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   Table::Cursor cursor(&table, Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{});
   // Force cold expiration.
@@ -1474,5 +1564,115 @@ INSTANTIATE_TEST_SUITE_P(CursorTableTestSuite, CursorTableTest,
                            return info.param.name;
                          });
 
+namespace {
+
+void WriteTimeBatch(Table* table, int64_t start_time, int64_t num_rows) {
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::TIME64NS, types::DataType::INT64}),
+                      num_rows);
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.push_back(start_time + i);
+    values.push_back(2 * (start_time + i));
+  }
+  PX_CHECK_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  PX_CHECK_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+  PX_CHECK_OK(table->WriteRowBatch(rb));
+}
+
+std::vector<int64_t> ReadTimes(Table* table, Table::Cursor::StartSpec start_spec) {
+  Table::Cursor cursor(table, start_spec, Table::Cursor::StopSpec{});
+  std::vector<int64_t> times;
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      times.push_back(
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i));
+      EXPECT_EQ(2 * times.back(),
+                types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(1).get(), i));
+    }
+  }
+  return times;
+}
+
+}  // namespace
+
+TEST(TableTest, disk_tier_keeps_expired_batches) {
+  testing::TempDir temp_dir;
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  // Each batch of 10 rows is 160 bytes, so the table holds 4 batches in memory, and the disk tier
+  // writes a segment for every 2 expired batches.
+  constexpr int64_t kBatchRows = 10;
+  constexpr int64_t kNumBatches = 20;
+  {
+    Table table("test_table", rel, 640, 160);
+    ASSERT_OK(table.EnableDiskTier(temp_dir.path() / "test_table", 1024 * 1024, 320));
+    for (int64_t i = 0; i < kNumBatches; ++i) {
+      WriteTimeBatch(&table, i * kBatchRows, kBatchRows);
+      ASSERT_OK(table.CompactHotToCold());
+    }
+    auto stats = table.GetTableStats();
+    EXPECT_LE(stats.bytes, 640);
+    EXPECT_GT(stats.disk_bytes, 0);
+    EXPECT_EQ(0, stats.min_time);
+
+    auto times = ReadTimes(&table, Table::Cursor::StartSpec{});
+    ASSERT_EQ(static_cast<size_t>(kNumBatches * kBatchRows), times.size());
+    for (int64_t i = 0; i < kNumBatches * kBatchRows; ++i) {
+      EXPECT_EQ(i, times[i]);
+    }
+
+    Table::Cursor::StartSpec start_spec;
+    start_spec.type = Table::Cursor::StartSpec::StartType::StartAtTime;
+    start_spec.start_time = 55;
+    times = ReadTimes(&table, start_spec);
+    ASSERT_FALSE(times.empty());
+    EXPECT_EQ(55, times.front());
+  }
+
+  // A new table on the same directory picks up the sealed segments, and keeps appending after them.
+  Table table("test_table", rel, 640, 160);
+  ASSERT_OK(table.EnableDiskTier(temp_dir.path() / "test_table", 1024 * 1024, 320));
+  auto times = ReadTimes(&table, Table::Cursor::StartSpec{});
+  ASSERT_EQ(static_cast<size_t>((kNumBatches - 4) * kBatchRows), times.size());
+  WriteTimeBatch(&table, 1000, kBatchRows);
+  times = ReadTimes(&table, Table::Cursor::StartSpec{});
+  ASSERT_EQ(static_cast<size_t>((kNumBatches - 3) * kBatchRows), times.size());
+  EXPECT_EQ(0, times.front());
+  EXPECT_EQ(1000, times[(kNumBatches - 4) * kBatchRows]);
+}
+
+TEST(TableTest, disk_tier_keeps_batches_of_failed_segment_write) {
+  testing::TempDir temp_dir;
+  auto dir = temp_dir.path() / "test_table";
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  constexpr int64_t kBatchRows = 10;
+  Table table("test_table", rel, 640, 160);
+  ASSERT_OK(table.EnableDiskTier(dir, 1024 * 1024, 320));
+
+  // Segment writes fail while the directory is missing, but the table keeps its data.
+  std::filesystem::remove_all(dir);
+  for (int64_t i = 0; i < 6; ++i) {
+    WriteTimeBatch(&table, i * kBatchRows, kBatchRows);
+    ASSERT_OK(table.CompactHotToCold());
+  }
+  EXPECT_EQ(static_cast<size_t>(6 * kBatchRows),
+            ReadTimes(&table, Table::Cursor::StartSpec{}).size());
+  EXPECT_GT(table.GetTableStats().disk_bytes, 0);
+
+  // The write is retried once another segment's worth of batches was expired.
+  std::filesystem::create_directories(dir);
+  for (int64_t i = 6; i < 8; ++i) {
+    WriteTimeBatch(&table, i * kBatchRows, kBatchRows);
+    ASSERT_OK(table.CompactHotToCold());
+  }
+  EXPECT_FALSE(std::filesystem::is_empty(dir));
+  auto times = ReadTimes(&table, Table::Cursor::StartSpec{});
+  ASSERT_EQ(static_cast<size_t>(8 * kBatchRows), times.size());
+  for (int64_t i = 0; i < 8 * kBatchRows; ++i) {
+    EXPECT_EQ(i, times[i]);
+  }
+}
+
 }  // namespace table_store
 }  // namespace px
@@ -35,6 +35,24 @@ namespace agent {
 
 using ::px::event::AsyncTask;
 
+namespace {
+
+QueryPriority GetQueryPriority(const messages::ExecuteQueryRequest& req) {
+  if (req.priority() != messages::ExecuteQueryRequest::PRIORITY_UNSPECIFIED) {
+    return req.priority();
+  }
+  for (const auto& fragment : req.plan().nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().op_type() == carnot::planpb::OTEL_EXPORT_SINK_OPERATOR) {
+        return messages::ExecuteQueryRequest::OTEL_EXPORT;
+      }
+    }
+  }
+  return messages::ExecuteQueryRequest::INTERACTIVE;
+}
+
+}  // namespace
+
 class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
  public:
   ExecuteQueryTask(ExecuteQueryMessageHandler* h, carnot::Carnot* carnot,
@@ -85,24 +103,46 @@ ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* di
                                  .Name("num_queries_in_flight")
                                  .Help("The number of queries currently running.")
                                  .Register(GetMetricsRegistry())
-                                 .Add({})) {}
+                                 .Add({})) {
+  carnot_->RegisterQueryYieldCallback([this](const sole::uuid& query_id, bool waiting_for_data) {
+    if (waiting_for_data) {
+      scheduler_.WaitForData(query_id);
+    } else {
+      scheduler_.Yield(query_id);
+    }
+  });
+}
 
 Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::VizierMessage> msg) {
-  // Create a task and run it on the threadpool.
+  auto priority = GetQueryPriority(msg->execute_query_request());
+  // Create a task and run it on the threadpool once the scheduler lets it.
   auto task = std::make_unique<ExecuteQueryTask>(this, carnot_, std::move(msg));
 
   auto query_id = task->query_id();
   auto runnable = dispatcher()->CreateAsyncTask(std::move(task));
-  auto runnable_ptr = runnable.get();
   LOG(INFO) << "Queries in flight: " << running_queries_.size();
   num_queries_in_flight_.Set(running_queries_.size());
   running_queries_[query_id] = std::move(runnable);
-  runnable_ptr->Run();
+  // The scheduler may start the query from the thread of another query, so the task is always
+  // started from the event loop.
+  scheduler_.Enqueue(query_id, priority, [this, query_id]() {
+    dispatcher()->Post([this, query_id]() { StartQuery(query_id); });
+  });
 
   return Status::OK();
 }
 
+void ExecuteQueryMessageHandler::StartQuery(sole::uuid query_id) {
+  auto it = running_queries_.find(query_id);
+  if (it == running_queries_.end()) {
+    LOG(ERROR) << "Attempting to start non-existent query: " << query_id.str();
+    return;
+  }
+  it->second->Run();
+}
+
 void ExecuteQueryMessageHandler::HandleQueryExecutionComplete(sole::uuid query_id) {
+  scheduler_.Finish(query_id);
   // Upon completion of the query, we makr the runnable task for deletion.
   auto node = running_queries_.extract(query_id);
   if (node.empty()) {
@@ -24,6 +24,7 @@
 #include <prometheus/registry.h>
 #include "src/carnot/plan/plan.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
+#include "src/vizier/services/agent/shared/manager/query_scheduler.h"
 
 namespace px {
 namespace vizier {
@@ -34,7 +35,8 @@ namespace agent {
  * If a qb_stub is specified the results will also be RPCd to the query broker,
  * otherwise only query execution is performed.
  *
- * This class runs all of it's work on a thread pool and tracks pending queries internally.
+ * This class runs all of it's work on a thread pool and tracks pending queries internally. The
+ * queries are started by a QueryScheduler, which limits how many of them run at the same time.
  */
 class ExecuteQueryMessageHandler : public Manager::MessageHandler {
  public:
@@ -56,7 +58,11 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
   // Forward declare private task class.
   class ExecuteQueryTask;
 
+  // Runs the task of the query on the thread pool.
+  void StartQuery(sole::uuid query_id);
+
   carnot::Carnot* carnot_;
+  QueryScheduler scheduler_;
   // Map from query_id -> Running query task.
   absl::flat_hash_map<sole::uuid, px::event::RunnableAsyncTaskUPtr> running_queries_;
 
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/vizier/services/agent/shared/manager/query_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/metrics/metrics.h"
+
+DEFINE_int32(agent_max_running_queries, gflags::Int32FromEnv("PL_AGENT_MAX_RUNNING_QUERIES", 3),
+             "The number of queries that an agent runs at the same time. Other queries wait for "
+             "one of them to finish.");
+DEFINE_int32(agent_max_preempted_queries,
+             gflags::Int32FromEnv("PL_AGENT_MAX_PREEMPTED_QUERIES", 1),
+             "The number of running queries that may be paused at the same time to let more "
+             "important queries run. Paused queries and queries waiting for data hold on to their "
+             "thread, so no more than the sum of this flag and agent_max_running_queries queries "
+             "are started at a time, and that sum should not exceed the size of the thread pool.");
+DEFINE_int32(agent_query_time_slice_ms, gflags::Int32FromEnv("PL_AGENT_QUERY_TIME_SLICE_MS", 100),
+             "The CPU time a query runs before it may be paused for a more important query.");
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+namespace {
+
+prometheus::Gauge& WaitingQueriesGauge() {
+  static auto& gauge =
+      BuildGauge("agent_waiting_queries", "Number of queries waiting to be run by the agent");
+  return gauge;
+}
+
+prometheus::Counter& PreemptionsCounter() {
+  static auto& counter =
+      BuildCounter("agent_query_preemptions",
+                   "Number of times a running query was paused to let a more important query run");
+  return counter;
+}
+
+prometheus::Counter& QueueWaitCounter(QueryPriority priority) {
+  static auto& family = BuildCounterFamily(
+      "agent_query_queue_wait_ns",
+      "Total time queries waited to be run or resumed by the agent, by priority");
+  return family.Add({{"priority", messages::ExecuteQueryRequest::Priority_Name(priority)}});
+}
+
+prometheus::Counter& QueueWaitsCounter(QueryPriority priority) {
+  static auto& family = BuildCounterFamily(
+      "agent_query_queue_waits",
+      "Number of times queries waited to be run or resumed by the agent, by priority");
+  return family.Add({{"priority", messages::ExecuteQueryRequest::Priority_Name(priority)}});
+}
+
+}  // namespace
+
+QueryScheduler::QueryScheduler(int max_running_queries, int max_preempted_queries,
+                               std::chrono::nanoseconds time_slice)
+    : max_running_queries_(std::max(1, max_running_queries)),
+      max_preempted_queries_(std::max(0, max_preempted_queries)),
+      max_threads_(max_running_queries_ + max_preempted_queries_),
+      time_slice_(time_slice) {}
+
+void QueryScheduler::Enqueue(const sole::uuid& query_id, QueryPriority priority,
+                             StartFunc start) {
+  std::vector<StartFunc> start_funcs;
+  {
+    absl::MutexLock lock(&mu_);
+    auto [it, inserted] = queries_.try_emplace(query_id);
+    if (!inserted) {
+      LOG(ERROR) << absl::Substitute("Query $0 is already scheduled", query_id.str());
+      return;
+    }
+    Query& query = it->second;
+    query.priority = priority;
+    query.seq = next_seq_++;
+    query.start = std::move(start);
+    query.wait_start = std::chrono::steady_clock::now();
+    waiting_.emplace(WaitKey{query.priority, query.seq}, query_id);
+    start_funcs = FillSlots();
+  }
+  for (auto& start_func : start_funcs) {
+    start_func();
+  }
+}
+
+void QueryScheduler::Finish(const sole::uuid& query_id) {
+  std::vector<StartFunc> start_funcs;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = queries_.find(query_id);
+    if (it == queries_.end()) {
+      LOG(ERROR) << absl::Substitute("Finishing query $0 which isn't scheduled", query_id.str());
+      return;
+    }
+    const Query& query = it->second;
+    if (query.state != State::kQueued) {
+      --num_threads_;
+    }
+    switch (query.state) {
+      case State::kRunning:
+        --num_running_;
+        break;
+      case State::kIdle:
+        break;
+      case State::kPreempted:
+        --num_preempted_;
+        waiting_.erase(WaitKey{query.priority, query.seq});
+        break;
+      case State::kQueued:
+      case State::kResuming:
+        waiting_.erase(WaitKey{query.priority, query.seq});
+        break;
+    }
+    queries_.erase(it);
+    start_funcs = FillSlots();
+  }
+  for (auto& start_func : start_funcs) {
+    start_func();
+  }
+}
+
+void QueryScheduler::Yield(const sole::uuid& query_id) {
+  auto now = px::chrono::thread_cpu_clock::now();
+  std::vector<StartFunc> start_funcs;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = queries_.find(query_id);
+    if (it == queries_.end()) {
+      // The query wasn't started by this scheduler.
+      return;
+    }
+    Query& query = it->second;
+    if (query.state == State::kIdle) {
+      // The query has data again. It keeps its place among the queries of its priority, and
+      // doesn't count as preempted.
+      query.state = State::kResuming;
+      query.slice_start = now;
+      query.wait_start = std::chrono::steady_clock::now();
+      waiting_.emplace(WaitKey{query.priority, query.seq}, query_id);
+      start_funcs = FillSlots();
+    } else {
+      if (!query.slice_start.has_value()) {
+        query.slice_start = now;
+        return;
+      }
+      if (now - *query.slice_start < time_slice_) {
+        return;
+      }
+      // The thread doesn't use CPU time while the query is paused, so the next slice starts now
+      // either way.
+      query.slice_start = now;
+      // Only a waiting query that can run once it has the slot is worth preempting for.
+      auto next = NextToRun();
+      if (next == waiting_.end() || next->first.first >= query.priority ||
+          num_preempted_ >= max_preempted_queries_) {
+        return;
+      }
+
+      query.state = State::kPreempted;
+      query.wait_start = std::chrono::steady_clock::now();
+      waiting_.emplace(WaitKey{query.priority, query.seq}, query_id);
+      --num_running_;
+      ++num_preempted_;
+      PreemptionsCounter().Increment();
+      start_funcs = FillSlots();
+    }
+  }
+  for (auto& start_func : start_funcs) {
+    start_func();
+  }
+
+  absl::MutexLock lock(&mu_);
+  const Query& query = queries_.at(query_id);
+  while (query.state != State::kRunning) {
+    resumed_.Wait(&mu_);
+  }
+}
+
+void QueryScheduler::WaitForData(const sole::uuid& query_id) {
+  std::vector<StartFunc> start_funcs;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = queries_.find(query_id);
+    if (it == queries_.end() || it->second.state != State::kRunning) {
+      return;
+    }
+    it->second.state = State::kIdle;
+    --num_running_;
+    start_funcs = FillSlots();
+  }
+  for (auto& start_func : start_funcs) {
+    start_func();
+  }
+}
+
+std::vector<QueryScheduler::StartFunc> QueryScheduler::FillSlots() {
+  std::vector<StartFunc> start_funcs;
+  while (num_running_ < max_running_queries_) {
+    auto it = NextToRun();
+    if (it == waiting_.end()) {
+      break;
+    }
+    Query& query = queries_.at(it->second);
+    waiting_.erase(it);
+    ++num_running_;
+
+    auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - query.wait_start);
+    QueueWaitCounter(query.priority).Increment(static_cast<double>(wait_ns.count()));
+    QueueWaitsCounter(query.priority).Increment();
+
+    if (query.state == State::kPreempted || query.state == State::kResuming) {
+      if (query.state == State::kPreempted) {
+        --num_preempted_;
+      }
+      query.state = State::kRunning;
+      resumed_.SignalAll();
+    } else {
+      query.state = State::kRunning;
+      ++num_threads_;
+      start_funcs.push_back(std::move(query.start));
+    }
+  }
+  WaitingQueriesGauge().Set(static_cast<double>(waiting_.size()));
+  return start_funcs;
+}
+
+std::map<QueryScheduler::WaitKey, sole::uuid>::iterator QueryScheduler::NextToRun() {
+  bool thread_free = num_threads_ < max_threads_;
+  for (auto it = waiting_.begin(); it != waiting_.end(); ++it) {
+    if (thread_free || queries_.at(it->second).state != State::kQueued) {
+      return it;
+    }
+  }
+  return waiting_.end();
+}
+
+int QueryScheduler::num_running() const {
+  absl::MutexLock lock(&mu_);
+  return num_running_;
+}
+
+int QueryScheduler::num_waiting() const {
+  absl::MutexLock lock(&mu_);
+  return static_cast<int>(waiting_.size());
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
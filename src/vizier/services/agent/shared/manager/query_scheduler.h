@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/node_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <sole.hpp>
+
+#include "src/common/base/base.h"
+#include "src/common/system/clock.h"
+#include "src/vizier/messages/messagespb/messages.pb.h"
+
+DECLARE_int32(agent_max_running_queries);
+DECLARE_int32(agent_max_preempted_queries);
+DECLARE_int32(agent_query_time_slice_ms);
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+// Lower values are more important.
+using QueryPriority = messages::ExecuteQueryRequest::Priority;
+
+/**
+ * QueryScheduler decides when the queries of an agent run, so that a burst of queries doesn't
+ * take all the cores of the node away from data collection and from each other.
+ *
+ * At most max_running_queries run at a time, the others wait in priority order, first come first
+ * served within a priority. A running query that used up its CPU time slice and is in the way of a
+ * more important waiting query is preempted at its next yield point: it hands its slot over and
+ * its thread blocks until a slot is free again. At most max_preempted_queries are preempted at a
+ * time.
+ *
+ * A query that waits for data, such as a streaming query between batches, hands its slot over as
+ * well, and waits for a slot again when it has data. Otherwise queries that never finish would
+ * hold on to their slots forever.
+ *
+ * Preempted queries and queries waiting for data keep their thread. So that a query given a slot
+ * always has a thread to run on, a query is only started while fewer than
+ * max_running_queries + max_preempted_queries started queries are unfinished, and that sum should
+ * not exceed the threads available to run queries.
+ *
+ * Enqueue and Finish are called from the event loop, Yield and WaitForData from the thread running
+ * the query.
+ */
+class QueryScheduler {
+ public:
+  using StartFunc = std::function<void()>;
+
+  QueryScheduler(int max_running_queries, int max_preempted_queries,
+                 std::chrono::nanoseconds time_slice);
+  QueryScheduler()
+      : QueryScheduler(FLAGS_agent_max_running_queries, FLAGS_agent_max_preempted_queries,
+                       std::chrono::milliseconds(FLAGS_agent_query_time_slice_ms)) {}
+
+  /**
+   * Queues the query. start is called once the query may run, either from this call or from a
+   * later call to Finish or Yield of another query, so it must be safe to call from any thread.
+   */
+  void Enqueue(const sole::uuid& query_id, QueryPriority priority, StartFunc start);
+
+  /**
+   * Marks the query as done, which starts the next waiting queries.
+   */
+  void Finish(const sole::uuid& query_id);
+
+  /**
+   * Called from the thread executing the query at each of its yield points. Blocks while the query
+   * is preempted.
+   */
+  void Yield(const sole::uuid& query_id);
+
+  /**
+   * Called from the thread executing the query before it waits for data. Frees the slot of the
+   * query until its next call to Yield, which blocks until the query gets a slot again.
+   */
+  void WaitForData(const sole::uuid& query_id);
+
+  int num_running() const;
+  int num_waiting() const;
+
+ private:
+  enum class State {
+    kQueued,
+    kRunning,
+    kPreempted,
+    // Waiting for data, without a slot.
+    kIdle,
+    // Done waiting for data, and waiting for a slot.
+    kResuming,
+  };
+
+  struct Query {
+    QueryPriority priority;
+    // The order in which the query was enqueued, to break ties between equal priorities.
+    int64_t seq;
+    State state = State::kQueued;
+    StartFunc start;
+    std::chrono::steady_clock::time_point wait_start;
+    // The CPU time of the executing thread when the current time slice started. Unset until the
+    // query first yields, since it is started from another thread.
+    std::optional<px::chrono::thread_cpu_clock::time_point> slice_start;
+  };
+  using WaitKey = std::pair<QueryPriority, int64_t>;
+
+  // Moves waiting queries into free slots, and returns the start functions of the newly started
+  // queries, which must be called outside of the lock.
+  std::vector<StartFunc> FillSlots() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the first waiting query that can run once it has a slot. Preempted and resuming queries
+  // already have a thread, queued queries only get one while a thread is free.
+  std::map<WaitKey, sole::uuid>::iterator NextToRun() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int max_running_queries_;
+  const int max_preempted_queries_;
+  // The number of started queries that may hold a thread at the same time.
+  const int max_threads_;
+  const std::chrono::nanoseconds time_slice_;
+
+  mutable absl::Mutex mu_;
+  // Preempted queries wait on this for their state to become kRunning.
+  absl::CondVar resumed_;
+  absl::node_hash_map<sole::uuid, Query> queries_ ABSL_GUARDED_BY(mu_);
+  // The queued, preempted and resuming queries, in the order they get a slot.
+  std::map<WaitKey, sole::uuid> waiting_ ABSL_GUARDED_BY(mu_);
+  int64_t next_seq_ ABSL_GUARDED_BY(mu_) = 0;
+  int num_running_ ABSL_GUARDED_BY(mu_) = 0;
+  int num_preempted_ ABSL_GUARDED_BY(mu_) = 0;
+  // The started queries that haven't finished, whatever their state.
+  int num_threads_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <absl/synchronization/notification.h>
+
+#include "src/common/testing/testing.h"
+#include "src/vizier/services/agent/shared/manager/query_scheduler.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using messages::ExecuteQueryRequest;
+
+namespace {
+
+// A fixed number of threads that run posted tasks in order, like the thread pool queries run on.
+class TaskPool {
+ public:
+  explicit TaskPool(int num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { RunTasks(); });
+    }
+  }
+
+  ~TaskPool() {
+    {
+      absl::MutexLock lock(&mu_);
+      stopped_ = true;
+    }
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Post(std::function<void()> task) {
+    absl::MutexLock lock(&mu_);
+    tasks_.push_back(std::move(task));
+  }
+
+ private:
+  bool HasTaskOrStopped() const ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return stopped_ || !tasks_.empty();
+  }
+
+  void RunTasks() {
+    while (true) {
+      std::function<void()> task;
+      {
+        absl::MutexLock lock(&mu_);
+        mu_.Await(absl::Condition(this, &TaskPool::HasTaskOrStopped));
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  absl::Mutex mu_;
+  std::deque<std::function<void()>> tasks_ ABSL_GUARDED_BY(mu_);
+  bool stopped_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace
+
+class QuerySchedulerTest : public ::testing::Test {
+ protected:
+  QueryScheduler::StartFunc RecordStart(const sole::uuid& query_id) {
+    return [this, query_id]() {
+      absl::MutexLock lock(&mu_);
+      started_.push_back(query_id);
+    };
+  }
+
+  std::vector<sole::uuid> started() {
+    absl::MutexLock lock(&mu_);
+    return started_;
+  }
+
+  absl::Mutex mu_;
+  std::vector<sole::uuid> started_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST_F(QuerySchedulerTest, runs_waiting_queries_by_priority) {
+  QueryScheduler scheduler(/*max_running_queries*/ 1, /*max_preempted_queries*/ 0,
+                           std::chrono::milliseconds(100));
+  auto q1 = sole::uuid4();
+  auto q2 = sole::uuid4();
+  auto q3 = sole::uuid4();
+  auto q4 = sole::uuid4();
+
+  scheduler.Enqueue(q1, ExecuteQueryRequest::INTERACTIVE, RecordStart(q1));
+  scheduler.Enqueue(q2, ExecuteQueryRequest::BACKGROUND, RecordStart(q2));
+  scheduler.Enqueue(q3, ExecuteQueryRequest::OTEL_EXPORT, RecordStart(q3));
+  scheduler.Enqueue(q4, ExecuteQueryRequest::INTERACTIVE, RecordStart(q4));
+  EXPECT_EQ(std::vector<sole::uuid>({q1}), started());
+  EXPECT_EQ(1, scheduler.num_running());
+  EXPECT_EQ(3, scheduler.num_waiting());
+
+  scheduler.Finish(q1);
+  EXPECT_EQ(std::vector<sole::uuid>({q1, q4}), started());
+  scheduler.Finish(q4);
+  scheduler.Finish(q3);
+  EXPECT_EQ(std::vector<sole::uuid>({q1, q4, q3, q2}), started());
+  scheduler.Finish(q2);
+  EXPECT_EQ(0, scheduler.num_running());
+  EXPECT_EQ(0, scheduler.num_waiting());
+}
+
+TEST_F(QuerySchedulerTest, preempts_for_more_important_query) {
+  QueryScheduler scheduler(/*max_running_queries*/ 1, /*max_preempted_queries*/ 1,
+                           std::chrono::nanoseconds(0));
+  auto background = sole::uuid4();
+  auto interactive = sole::uuid4();
+  scheduler.Enqueue(background, ExecuteQueryRequest::BACKGROUND, RecordStart(background));
+
+  absl::Notification interactive_started;
+  absl::Notification background_resumed;
+  std::thread background_thread([&]() {
+    // The first yield starts the time slice.
+    scheduler.Yield(background);
+    scheduler.Enqueue(interactive, ExecuteQueryRequest::INTERACTIVE,
+                      [&]() { interactive_started.Notify(); });
+    // The time slice is used up and a more important query is waiting.
+    scheduler.Yield(background);
+    background_resumed.Notify();
+  });
+
+  interactive_started.WaitForNotification();
+  EXPECT_EQ(1, scheduler.num_running());
+  EXPECT_EQ(1, scheduler.num_waiting());
+  EXPECT_FALSE(background_resumed.HasBeenNotified());
+
+  scheduler.Finish(interactive);
+  background_thread.join();
+  EXPECT_TRUE(background_resumed.HasBeenNotified());
+  EXPECT_EQ(1, scheduler.num_running());
+  scheduler.Finish(background);
+}
+
+TEST_F(QuerySchedulerTest, does_not_preempt_for_equally_important_query) {
+  QueryScheduler scheduler(/*max_running_queries*/ 1, /*max_preempted_queries*/ 1,
+                           std::chrono::nanoseconds(0));
+  auto q1 = sole::uuid4();
+  auto q2 = sole::uuid4();
+  scheduler.Enqueue(q1, ExecuteQueryRequest::INTERACTIVE, RecordStart(q1));
+  scheduler.Enqueue(q2, ExecuteQueryRequest::INTERACTIVE, RecordStart(q2));
+
+  // Neither yield blocks, since the waiting query is not more important.
+  scheduler.Yield(q1);
+  scheduler.Yield(q1);
+  EXPECT_EQ(std::vector<sole::uuid>({q1}), started());
+  scheduler.Finish(q1);
+  EXPECT_EQ(std::vector<sole::uuid>({q1, q2}), started());
+  scheduler.Finish(q2);
+}
+
+TEST_F(QuerySchedulerTest, streaming_queries_free_their_slot_while_waiting_for_data) {
+  constexpr int kMaxRunning = 2;
+  // Leaves a thread for the query started while the others wait for data.
+  QueryScheduler scheduler(kMaxRunning, /*max_preempted_queries*/ 1,
+                           std::chrono::milliseconds(100));
+  // One more streaming query than there are slots. None of them ever finishes.
+  std::vector<sole::uuid> queries;
+  for (int i = 0; i < kMaxRunning + 1; ++i) {
+    queries.push_back(sole::uuid4());
+    scheduler.Enqueue(queries.back(), ExecuteQueryRequest::INTERACTIVE,
+                      RecordStart(queries.back()));
+  }
+  EXPECT_EQ(kMaxRunning, scheduler.num_running());
+
+  // The running queries run out of data, which lets the last query start.
+  scheduler.WaitForData(queries[0]);
+  scheduler.WaitForData(queries[1]);
+  EXPECT_EQ(queries, started());
+  EXPECT_EQ(1, scheduler.num_running());
+
+  // A query with new data gets a slot back right away while one is free.
+  scheduler.Yield(queries[0]);
+  EXPECT_EQ(kMaxRunning, scheduler.num_running());
+
+  // Once the slots are taken, a query with new data waits for one to be freed.
+  absl::Notification resumed;
+  std::thread thread([&]() {
+    scheduler.Yield(queries[1]);
+    resumed.Notify();
+  });
+  while (scheduler.num_waiting() == 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(resumed.HasBeenNotified());
+  scheduler.WaitForData(queries[2]);
+  thread.join();
+  EXPECT_TRUE(resumed.HasBeenNotified());
+  EXPECT_EQ(kMaxRunning, scheduler.num_running());
+  EXPECT_EQ(0, scheduler.num_waiting());
+
+  // Queries can finish while waiting for data.
+  for (const auto& query : queries) {
+    scheduler.Finish(query);
+  }
+  EXPECT_EQ(0, scheduler.num_running());
+}
+
+TEST_F(QuerySchedulerTest, more_queries_waiting_for_data_than_threads) {
+  constexpr int kMaxRunning = 1;
+  constexpr int kMaxPreempted = 1;
+  constexpr int kNumThreads = kMaxRunning + kMaxPreempted;
+  constexpr int kNumQueries = 2 * kNumThreads;
+  QueryScheduler scheduler(kMaxRunning, kMaxPreempted, std::chrono::milliseconds(100));
+
+  std::vector<sole::uuid> queries;
+  absl::Notification waiting_for_data[kNumQueries];
+  absl::Notification has_data[kNumQueries];
+  absl::Notification done[kNumQueries];
+  TaskPool pool(kNumThreads);
+  for (int i = 0; i < kNumQueries; ++i) {
+    queries.push_back(sole::uuid4());
+  }
+  for (int i = 0; i < kNumQueries; ++i) {
+    // Each query waits for data once, and finishes as soon as it has it.
+    auto run_query = [&, i]() {
+      scheduler.WaitForData(queries[i]);
+      waiting_for_data[i].Notify();
+      has_data[i].WaitForNotification();
+      scheduler.Yield(queries[i]);
+      scheduler.Finish(queries[i]);
+      done[i].Notify();
+    };
+    scheduler.Enqueue(queries[i], ExecuteQueryRequest::INTERACTIVE,
+                      [&pool, run_query]() { pool.Post(run_query); });
+  }
+
+  // The queries that hold a thread all wait for data. The other queries aren't started, since they
+  // would get a slot but no thread to run on.
+  for (int i = 0; i < kNumThreads; ++i) {
+    waiting_for_data[i].WaitForNotification();
+  }
+  EXPECT_EQ(0, scheduler.num_running());
+  EXPECT_EQ(kNumQueries - kNumThreads, scheduler.num_waiting());
+
+  for (auto& notification : has_data) {
+    notification.Notify();
+  }
+  for (auto& notification : done) {
+    ASSERT_TRUE(notification.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  }
+  EXPECT_EQ(0, scheduler.num_running());
+  EXPECT_EQ(0, scheduler.num_waiting());
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -20,6 +20,7 @@ package controllers
 
 import (
 	"fmt"
+	"strings"
 
 	"golang.org/x/sync/errgroup"
 
@@ -32,8 +33,27 @@ import (
 	"px.dev/pixie/src/vizier/utils/messagebus"
 )
 
+// cronScriptQueryNamePrefix starts the query names of the cron scripts run by the script runner.
+const cronScriptQueryNamePrefix = "cron_"
+
+// QueryPriority returns the priority with which agents schedule their plan of the query: OTel exports
+// come after interactive queries, and other cron scripts come last.
+func QueryPriority(queryName string, plan *planpb.Plan) messagespb.ExecuteQueryRequest_Priority {
+	for _, fragment := range plan.Nodes {
+		for _, node := range fragment.Nodes {
+			if node.GetOp().GetOpType() == planpb.OTEL_EXPORT_SINK_OPERATOR {
+				return messagespb.OTEL_EXPORT
+			}
+		}
+	}
+	if strings.HasPrefix(queryName, cronScriptQueryNamePrefix) {
+		return messagespb.BACKGROUND
+	}
+	return messagespb.INTERACTIVE
+}
+
 // LaunchQuery launches a query by sending query fragments to relevant agents.
-func LaunchQuery(queryID uuid.UUID, natsConn *nats.Conn, planMap map[uuid.UUID]*planpb.Plan, analyze bool) error {
+func LaunchQuery(queryID uuid.UUID, natsConn *nats.Conn, planMap map[uuid.UUID]*planpb.Plan, analyze bool, queryName string) error {
 	if len(planMap) == 0 {
 		return fmt.Errorf("Received no agent plans for query %s", queryID.String())
 	}
@@ -47,9 +67,10 @@ func LaunchQuery(queryID uuid.UUID, natsConn *nats.Conn, planMap map[uuid.UUID]*
 		msg := messagespb.VizierMessage{
 			Msg: &messagespb.VizierMessage_ExecuteQueryRequest{
 				ExecuteQueryRequest: &messagespb.ExecuteQueryRequest{
-					QueryID: queryIDPB,
-					Plan:    logicalPlan,
-					Analyze: analyze,
+					QueryID:  queryIDPB,
+					Plan:     logicalPlan,
+					Analyze:  analyze,
+					Priority: QueryPriority(queryName, logicalPlan),
 				},
 			},
 		}
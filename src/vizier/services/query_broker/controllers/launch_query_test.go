@@ -89,7 +89,7 @@ func TestLaunchQuery(t *testing.T) {
 	planMap[agentUUIDs[1]] = planPB2
 
 	// Execute a query.
-	err = controllers.LaunchQuery(queryUUID, nc, planMap, false)
+	err = controllers.LaunchQuery(queryUUID, nc, planMap, false, "")
 	require.NoError(t, err)
 
 	// Check that each agent received the correct message.
@@ -105,6 +105,7 @@ func TestLaunchQuery(t *testing.T) {
 
 	assert.Equal(t, planPB1, pb.Msg.(*messagespb.VizierMessage_ExecuteQueryRequest).ExecuteQueryRequest.Plan)
 	assert.Equal(t, queryUUIDPb, pb.Msg.(*messagespb.VizierMessage_ExecuteQueryRequest).ExecuteQueryRequest.QueryID)
+	assert.Equal(t, messagespb.INTERACTIVE, pb.Msg.(*messagespb.VizierMessage_ExecuteQueryRequest).ExecuteQueryRequest.Priority)
 
 	m2, err := sub2.NextMsg(time.Second)
 	require.NoError(t, err)
@@ -113,6 +114,7 @@ func TestLaunchQuery(t *testing.T) {
 	require.NoError(t, err)
 	assert.Equal(t, planPB2, pb.Msg.(*messagespb.VizierMessage_ExecuteQueryRequest).ExecuteQueryRequest.Plan)
 	assert.Equal(t, queryUUIDPb, pb.Msg.(*messagespb.VizierMessage_ExecuteQueryRequest).ExecuteQueryRequest.QueryID)
+	assert.Equal(t, messagespb.INTERACTIVE, pb.Msg.(*messagespb.VizierMessage_ExecuteQueryRequest).ExecuteQueryRequest.Priority)
 }
 
 func TestLaunchQueryNoPlans(t *testing.T) {
@@ -126,7 +128,7 @@ func TestLaunchQueryNoPlans(t *testing.T) {
 
 	planMap := make(map[uuid.UUID]*planpb.Plan)
 
-	err = controllers.LaunchQuery(queryUUID, nc, planMap, false)
+	err = controllers.LaunchQuery(queryUUID, nc, planMap, false, "")
 
 	assert.NotNil(t, err)
 	assert.Regexp(t, fmt.Sprintf("Received no agent plans for query %s", queryIDStr), err)
@@ -173,6 +175,34 @@ func TestLaunchQueryNATSFailure(t *testing.T) {
 	cleanup()
 
 	// Execute a query. This should return an error but not hang.
-	err = controllers.LaunchQuery(queryUUID, nc, planMap, false)
+	err = controllers.LaunchQuery(queryUUID, nc, planMap, false, "")
 	require.NotNil(t, err)
 }
+
+func TestQueryPriority(t *testing.T) {
+	plan := &planpb.Plan{
+		Nodes: []*planpb.PlanFragment{
+			{
+				Nodes: []*planpb.PlanNode{
+					{Op: &planpb.Operator{OpType: planpb.MEMORY_SOURCE_OPERATOR}},
+					{Op: &planpb.Operator{OpType: planpb.GRPC_SINK_OPERATOR}},
+				},
+			},
+		},
+	}
+	otelPlan := &planpb.Plan{
+		Nodes: []*planpb.PlanFragment{
+			{
+				Nodes: []*planpb.PlanNode{
+					{Op: &planpb.Operator{OpType: planpb.MEMORY_SOURCE_OPERATOR}},
+					{Op: &planpb.Operator{OpType: planpb.OTEL_EXPORT_SINK_OPERATOR}},
+				},
+			},
+		},
+	}
+
+	assert.Equal(t, messagespb.INTERACTIVE, controllers.QueryPriority("my_script", plan))
+	assert.Equal(t, messagespb.OTEL_EXPORT, controllers.QueryPriority("my_script", otelPlan))
+	assert.Equal(t, messagespb.BACKGROUND, controllers.QueryPriority("cron_1234", plan))
+	assert.Equal(t, messagespb.OTEL_EXPORT, controllers.QueryPriority("cron_1234", otelPlan))
+}
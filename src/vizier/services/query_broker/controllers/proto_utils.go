@@ -343,6 +343,38 @@ func colToVizierCol(col *schemapb.Column) (*vizierpb.Column, error) {
 				},
 			},
 		}, nil
+	case *schemapb.Column_DictionaryStringData:
+		dict := c.DictionaryStringData.Dictionary
+		b := make([][]byte, len(c.DictionaryStringData.Indices))
+		for i, idx := range c.DictionaryStringData.Indices {
+			if int(idx) >= len(dict) {
+				return nil, fmt.Errorf("dictionary index %d out of range for dictionary of size %d", idx, len(dict))
+			}
+			// Rows with the same value share the dictionary entry's bytes.
+			b[i] = dict[idx].Bytes()
+		}
+		return &vizierpb.Column{
+			ColData: &vizierpb.Column_StringData{
+				StringData: &vizierpb.StringColumn{
+					Data: b,
+				},
+			},
+		}, nil
+	case *schemapb.Column_DeltaTime64NsData:
+		b := make([]int64, len(c.DeltaTime64NsData.Deltas))
+		// Sum in uint64 so that wrapped deltas decode to the original values.
+		var prev uint64
+		for i, d := range c.DeltaTime64NsData.Deltas {
+			prev += uint64(d)
+			b[i] = int64(prev)
+		}
+		return &vizierpb.Column{
+			ColData: &vizierpb.Column_Time64NsData{
+				Time64NsData: &vizierpb.Time64NSColumn{
+					Data: b,
+				},
+			},
+		}, nil
 	default:
 		return nil, errors.New("Could not get column type")
 	}
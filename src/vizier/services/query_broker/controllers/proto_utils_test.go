@@ -37,6 +37,7 @@ import (
 	"px.dev/pixie/src/common/base/statuspb"
 	"px.dev/pixie/src/shared/types/typespb"
 	"px.dev/pixie/src/table_store/schemapb"
+	schematypes "px.dev/pixie/src/table_store/schemapb/types"
 	"px.dev/pixie/src/utils"
 	"px.dev/pixie/src/vizier/services/query_broker/controllers"
 )
@@ -356,6 +357,78 @@ func TestRowBatchToVizierRowBatch(t *testing.T) {
 	assert.Equal(t, expectedQd, qm)
 }
 
+func TestRowBatchToVizierRowBatch_Encoded(t *testing.T) {
+	rb := &schemapb.RowBatchData{
+		NumRows: 4,
+		Eos:     true,
+		Cols: []*schemapb.Column{
+			{
+				ColData: &schemapb.Column_DeltaTime64NsData{
+					DeltaTime64NsData: &schemapb.DeltaTime64NSColumn{
+						Deltas: []int64{100, 10, -20, 0},
+					},
+				},
+			},
+			{
+				ColData: &schemapb.Column_DictionaryStringData{
+					DictionaryStringData: &schemapb.DictionaryStringColumn{
+						Dictionary: []schematypes.StringData{
+							schematypes.StringData("svc"),
+							schematypes.StringData("other_svc"),
+						},
+						Indices: []uint32{0, 0, 1, 0},
+					},
+				},
+			},
+		},
+	}
+
+	expected := &vizierpb.RowBatchData{
+		TableID: "table_id",
+		NumRows: 4,
+		Eos:     true,
+		Cols: []*vizierpb.Column{
+			{
+				ColData: &vizierpb.Column_Time64NsData{
+					Time64NsData: &vizierpb.Time64NSColumn{
+						Data: []int64{100, 110, 90, 90},
+					},
+				},
+			},
+			{
+				ColData: &vizierpb.Column_StringData{
+					StringData: &vizierpb.StringColumn{
+						Data: [][]byte{[]byte("svc"), []byte("svc"), []byte("other_svc"), []byte("svc")},
+					},
+				},
+			},
+		},
+	}
+
+	qm, err := controllers.RowBatchToVizierRowBatch(rb, "table_id")
+	require.NoError(t, err)
+	assert.Equal(t, expected, qm)
+}
+
+func TestRowBatchToVizierRowBatch_DictionaryIndexOutOfRange(t *testing.T) {
+	rb := &schemapb.RowBatchData{
+		NumRows: 1,
+		Cols: []*schemapb.Column{
+			{
+				ColData: &schemapb.Column_DictionaryStringData{
+					DictionaryStringData: &schemapb.DictionaryStringColumn{
+						Dictionary: []schematypes.StringData{schematypes.StringData("svc")},
+						Indices:    []uint32{1},
+					},
+				},
+			},
+		},
+	}
+
+	_, err := controllers.RowBatchToVizierRowBatch(rb, "table_id")
+	assert.Error(t, err)
+}
+
 func TestBuildExecuteScriptResponse_RowBatch(t *testing.T) {
 	receivedRB := new(schemapb.RowBatchData)
 	if err := proto.UnmarshalText(rowBatchPb, receivedRB); err != nil {
@@ -514,7 +514,7 @@ func (q *QueryExecutorImpl) prepareScript(ctx context.Context, resultCh chan<- *
 	if err != nil {
 		return err
 	}
-	err = LaunchQuery(q.queryID, q.natsConn, planMap, planOpts.Analyze)
+	err = LaunchQuery(q.queryID, q.natsConn, planMap, planOpts.Analyze, q.queryName)
 	if err != nil {
 		return err
 	}